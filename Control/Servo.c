@@ -1,75 +1,162 @@
-#include "tm4c123gh6pm.h"
+/*****************************************************************************
+ * File: Servo.c
+ * Module: SERVO
+ * Description: Source file for the hobby-servo outputs (PWM module 0)
+ *
+ * The generators count down from SERVO_LOAD: the output goes high at the
+ * load and low when the count meets the comparator, so the comparator
+ * holds SERVO_LOAD minus the pulse length.
+ *****************************************************************************/
 
+#include "tm4c123gh6pm.h"
 #include "Servo.h"
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SERVO_PORT_B            0x02U
+#define SERVO_PORT_E            0x10U
+#define SERVO_PINS_B            0xD0U           /* PB4, PB6, PB7 */
+#define SERVO_PINS_E            0x20U           /* PE5 */
+#define SERVO_PCTL_B_MASK       0xFF0F0000U
+#define SERVO_PCTL_B_PWM        0x44040000U     /* M0PWM2, M0PWM0, M0PWM1 */
+#define SERVO_PCTL_E_MASK       0x00F00000U
+#define SERVO_PCTL_E_PWM        0x00400000U     /* M0PWM5 */
+
+#define PWM_GEN_A_PULSE         0x0000008CU     /* High on load, low on CMPA down */
+#define PWM_GEN_B_PULSE         0x0000080CU     /* High on load, low on CMPB down */
+#define PWM_CTL_ENABLE          0x01U           /* Count-down mode, updates at zero */
+
+/* Comparators by address, as dio.c reaches its ports: the register type
+   stays uint32_t whatever the device header uses */
+#define PWM0_0_CMPA             0x40028058U
+#define PWM0_0_CMPB             0x4002805CU
+#define PWM0_1_CMPA             0x40028098U
+#define PWM0_2_CMPB             0x400280DCU
+#define PWM_REG(address)        (*((volatile uint32_t *)(address)))
+
+typedef struct
+{
+    uint32_t compare;                   /* Comparator that ends the pulse */
+    uint32_t enable;                    /* Output bit in PWM0_ENABLE_R */
+} Servo_Channel;
 
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
 
-
-// Servo control via GPIO PE5 using PWM pulse width
-
-// This code directly controls servo pulses without relying on Arduino libraries
-
-
-
+static const Servo_Channel channels[SERVO_COUNT] =
+{
+    { PWM0_2_CMPB, 0x20U },             /* M0PWM5, PE5 */
+    { PWM0_0_CMPA, 0x01U },             /* M0PWM0, PB6 */
+    { PWM0_0_CMPB, 0x02U },             /* M0PWM1, PB7 */
+    { PWM0_1_CMPA, 0x04U }              /* M0PWM2, PB4 */
+};
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Servo_Init
+ * Comparators are loaded before the generators start, so the first frame
+ * already has the 0 degree pulse.
+ */
 void Servo_Init(void)
-
 {
-
-    // Enable Port E clock
-
-    SYSCTL_RCGCGPIO_R |= 0x10;  // Port E (Bit 4 is 0x10)
-
-    while((SYSCTL_PRGPIO_R & 0x10) == 0);
-
-   
-
-    // Configure PE5 as output for servo control
-
-    GPIO_PORTE_DIR_R |= 0x20;   // PE5 as output (Bit 5 is 0x20)
-
-    GPIO_PORTE_DEN_R |= 0x20;   // Enable digital I/O
-
+    uint8_t i;
+
+    SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R0;
+    SYSCTL_RCGCGPIO_R |= SERVO_PORT_B | SERVO_PORT_E;
+    while((SYSCTL_PRGPIO_R & (SERVO_PORT_B | SERVO_PORT_E)) != (SERVO_PORT_B | SERVO_PORT_E));
+    while((SYSCTL_PRPWM_R & SYSCTL_PRPWM_R0) == 0);
+
+    SYSCTL_RCC_R = (SYSCTL_RCC_R & ~SYSCTL_RCC_PWMDIV_M) | SYSCTL_RCC_USEPWMDIV | SYSCTL_RCC_PWMDIV_64;
+
+    GPIO_PORTB_AFSEL_R |= SERVO_PINS_B;
+    GPIO_PORTB_PCTL_R = (GPIO_PORTB_PCTL_R & ~SERVO_PCTL_B_MASK) | SERVO_PCTL_B_PWM;
+    GPIO_PORTB_AMSEL_R &= ~SERVO_PINS_B;
+    GPIO_PORTB_DEN_R |= SERVO_PINS_B;
+
+    GPIO_PORTE_AFSEL_R |= SERVO_PINS_E;
+    GPIO_PORTE_PCTL_R = (GPIO_PORTE_PCTL_R & ~SERVO_PCTL_E_MASK) | SERVO_PCTL_E_PWM;
+    GPIO_PORTE_AMSEL_R &= ~SERVO_PINS_E;
+    GPIO_PORTE_DEN_R |= SERVO_PINS_E;
+
+    PWM0_0_CTL_R = 0;
+    PWM0_1_CTL_R = 0;
+    PWM0_2_CTL_R = 0;
+    PWM0_0_LOAD_R = SERVO_LOAD;
+    PWM0_1_LOAD_R = SERVO_LOAD;
+    PWM0_2_LOAD_R = SERVO_LOAD;
+    PWM0_0_GENA_R = PWM_GEN_A_PULSE;
+    PWM0_0_GENB_R = PWM_GEN_B_PULSE;
+    PWM0_1_GENA_R = PWM_GEN_A_PULSE;
+    PWM0_2_GENB_R = PWM_GEN_B_PULSE;
+
+    for(i = 0; i < SERVO_COUNT; i++)
+    {
+        Servo_SetPulse(i, SERVO_PULSE_MIN_US);
+    }
+
+    PWM0_0_CTL_R = PWM_CTL_ENABLE;
+    PWM0_1_CTL_R = PWM_CTL_ENABLE;
+    PWM0_2_CTL_R = PWM_CTL_ENABLE;
+    for(i = 0; i < SERVO_COUNT; i++)
+    {
+        PWM0_ENABLE_R |= channels[i].enable;
+    }
 }
 
-
-
-// Move servo to specific angle (0-180 degrees)
-
-// 0 degrees   = 1.0 ms pulse
-
-// 90 degrees  = 1.5 ms pulse
-
-// 180 degrees = 2.0 ms pulse
-
-void Servo_SetAngle(int angle)
-
+/*
+ * Servo_SetPulse
+ * Out-of-range channels are ignored.
+ */
+void Servo_SetPulse(uint8_t channel, uint32_t pulse_us)
 {
+    uint32_t counts;
+
+    if(channel >= SERVO_COUNT)
+    {
+        return;
+    }
+    if(pulse_us < SERVO_PULSE_MIN_US)
+    {
+        pulse_us = SERVO_PULSE_MIN_US;
+    }
+    if(pulse_us > SERVO_PULSE_MAX_US)
+    {
+        pulse_us = SERVO_PULSE_MAX_US;
+    }
+
+    counts = (pulse_us * (SERVO_PWM_CLOCK_HZ / 1000U)) / 1000U;
+    PWM_REG(channels[channel].compare) = SERVO_LOAD - counts;
+}
 
-    unsigned int pulse_us;
-
-   
-
-    // Convert angle to pulse width in microseconds
-
-    // Formula: pulse_us = 1000 + (angle * 1000 / 180)
-
-    if(angle < 0) angle = 0;
-
-    if(angle > 180) angle = 180;
-
-   
-
-    pulse_us = 1000 + (angle * 1000 / 180);  // Range: 1000 to 2000 microseconds
-
-   
-
-    // Generate PWM pulse
-
-    GPIO_PORTE_DATA_R |= 0x20;      // Set PE5 HIGH
-
-    delayUs(pulse_us);               // Pulse width
-
-    GPIO_PORTE_DATA_R &= ~0x20;     // Set PE5 LOW
-
-    delayUs(20000 - pulse_us);       // Total cycle time 20ms
+/*
+ * Servo_AngleToPulse
+ * 1.0 ms at 0 degrees to 2.0 ms at 180 degrees.
+ */
+uint32_t Servo_AngleToPulse(int angle)
+{
+    if(angle < 0)
+    {
+        angle = 0;
+    }
+    if(angle > 180)
+    {
+        angle = 180;
+    }
+    return SERVO_PULSE_MIN_US + (((uint32_t)angle * (SERVO_PULSE_MAX_US - SERVO_PULSE_MIN_US)) / 180U);
+}
 
-}
\ No newline at end of file
+/*
+ * Servo_SetAngle
+ * Convenience for tests and manual moves.
+ */
+void Servo_SetAngle(uint8_t channel, int angle)
+{
+    Servo_SetPulse(channel, Servo_AngleToPulse(angle));
+}
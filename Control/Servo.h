@@ -1,31 +1,69 @@
-#ifndef SERVO_H
+/*****************************************************************************
+ * File: Servo.h
+ * Module: SERVO
+ * Description: Header file for the hobby-servo outputs (PWM module 0)
+ *
+ * Every servo has its own PWM0 output, so the 50 Hz frames are generated
+ * by hardware and keep running while the CPU does anything else. Changing
+ * a pulse width only rewrites a comparator; the generator picks it up at
+ * the start of the next frame, so there are no runt pulses.
+ *
+ *     Channel   Pin    Output
+ *     0         PE5    M0PWM5 (generator 2 B)   door 1, the original servo
+ *     1         PB6    M0PWM0 (generator 0 A)
+ *     2         PB7    M0PWM1 (generator 0 B)
+ *     3         PB4    M0PWM2 (generator 1 A)
+ *
+ * The PWM clock is the system clock / 64 (250 kHz at 16 MHz): a 20 ms
+ * frame is 5000 counts and the pulse resolution is 4 us.
+ *****************************************************************************/
 
+#ifndef SERVO_H
 #define SERVO_H
 
-
-
 #include <stdint.h>
+#include "systick.h"    /* SYSTEM_CLOCK_HZ */
 
-#include "dio.h"
-
-
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
 
-// Define Servo Port and Pin
+#define SERVO_COUNT             4U      /* Outputs wired up, see the table above */
 
-// Using Port E, Pin 5
+#define SERVO_PWM_CLOCK_HZ      (SYSTEM_CLOCK_HZ / 64U)
+#define SERVO_FRAME_HZ          50U
+#define SERVO_LOAD              ((SERVO_PWM_CLOCK_HZ / SERVO_FRAME_HZ) - 1U)
 
-#define SERVO_PORT   PORTE
+#define SERVO_PULSE_MIN_US      1000U   /* 0 degrees */
+#define SERVO_PULSE_MAX_US      2000U   /* 180 degrees */
 
-#define SERVO_PIN    PIN5
-
-
-
-// Function Prototypes
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
 
+/*
+ * Servo_Init
+ * Starts all SERVO_COUNT outputs at the 0 degree pulse.
+ */
 void Servo_Init(void);
 
-void Servo_SetAngle(int angle);
-
-
-
-#endif
\ No newline at end of file
+/*
+ * Servo_SetPulse
+ * Sets the high time of a channel's frames, clamped to
+ * SERVO_PULSE_MIN_US..SERVO_PULSE_MAX_US. Takes effect at the next frame.
+ */
+void Servo_SetPulse(uint8_t channel, uint32_t pulse_us);
+
+/*
+ * Servo_AngleToPulse
+ * Returns: the pulse width for 0..180 degrees (clamped)
+ */
+uint32_t Servo_AngleToPulse(int angle);
+
+/*
+ * Servo_SetAngle
+ * Servo_SetPulse(channel, Servo_AngleToPulse(angle)).
+ */
+void Servo_SetAngle(uint8_t channel, int angle);
+
+#endif /* SERVO_H */
@@ -0,0 +1,342 @@
+/*****************************************************************************
+ * File: auditlog.c
+ * Module: AUDITLOG
+ * Description: Source file for the append-only audit log in EEPROM
+ *****************************************************************************/
+
+#include "auditlog.h"
+#include "eeprom.h"
+#include "systick.h"
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Macros                                         *
+ ******************************************************************************/
+
+#define RECORD_WORDS        (AUDITLOG_RECORD_SIZE / EEPROM_WORD_SIZE)
+#define RECORDS_PER_BLOCK   ((EEPROM_BLOCK_SIZE * EEPROM_WORD_SIZE) / AUDITLOG_RECORD_SIZE)
+#define SEQUENCE_BLANK      0xFFFFU
+#define SEQUENCE_SPAN       0xFFFEU     /* Sequences in use, 1..0xFFFE */
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static AuditLog_Record stage[AUDITLOG_STAGE_RECORDS];
+static uint32_t staged = 0;         /* Records waiting in RAM */
+static uint32_t head = 0;           /* Next EEPROM slot to write */
+static uint32_t stored = 0;         /* Valid records in EEPROM */
+static uint16_t next_sequence = 1;
+static uint32_t dropped = 0;
+static uint8_t disabled = 0;        /* The last AuditLog_Init() failed */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * NextSequence
+ * 1..0xFFFE; 0xFFFF is reserved because it is what blank EEPROM reads.
+ */
+static uint16_t NextSequence(uint16_t sequence)
+{
+    return (sequence >= 0xFFFEU) ? 1U : (uint16_t)(sequence + 1U);
+}
+
+/*
+ * Distance
+ * How many sequences from comes before to, across the wrap.
+ */
+static uint32_t Distance(uint16_t from, uint16_t to)
+{
+    return (((uint32_t)to + SEQUENCE_SPAN) - from) % SEQUENCE_SPAN;
+}
+
+/*
+ * Oldest
+ * Sequence of the oldest record held, stored or staged.
+ */
+static uint16_t Oldest(void)
+{
+    return (uint16_t)(((((uint32_t)next_sequence - 1U) + SEQUENCE_SPAN - (stored + staged)) % SEQUENCE_SPAN) + 1U);
+}
+
+/*
+ * Disable
+ * The head is unknown: appending could overwrite the newest records, so
+ * nothing is staged or written until an AuditLog_Init() succeeds.
+ */
+static uint8_t Disable(void)
+{
+    disabled = 1;
+    head = 0;
+    stored = 0;
+    staged = 0;
+    return AUDITLOG_ERROR;
+}
+
+/*
+ * SlotBlock / SlotOffset
+ * EEPROM address of a slot in the circular region.
+ */
+static uint32_t SlotBlock(uint32_t slot)
+{
+    return AUDITLOG_FIRST_BLOCK + (slot / RECORDS_PER_BLOCK);
+}
+
+static uint32_t SlotOffset(uint32_t slot)
+{
+    return (slot % RECORDS_PER_BLOCK) * RECORD_WORDS;
+}
+
+/*
+ * ReadSlot
+ * Reads one record from the EEPROM region.
+ */
+static uint8_t ReadSlot(uint32_t slot, AuditLog_Record *record)
+{
+    return EEPROM_ReadBuffer(SlotBlock(slot), SlotOffset(slot), (uint8_t *)record, AUDITLOG_RECORD_SIZE);
+}
+
+/*
+ * WriteSlots
+ * Writes count staged records starting at a slot (no wrap inside).
+ */
+static uint8_t WriteSlots(uint32_t slot, const AuditLog_Record *records, uint32_t count)
+{
+    return EEPROM_WriteBuffer(SlotBlock(slot), SlotOffset(slot), (const uint8_t *)records,
+                              count * AUDITLOG_RECORD_SIZE);
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * AuditLog_Init
+ * Walks the region from slot 0 while sequence numbers are consecutive.
+ * The first blank slot or break is the head; a break on a non-blank slot
+ * means the log has wrapped and every slot is valid. Anything still staged
+ * is dropped, as a reset would.
+ */
+uint8_t AuditLog_Init(void)
+{
+    AuditLog_Record record;
+    uint16_t previous;
+    uint32_t slot;
+
+    head = 0;
+    stored = 0;
+    staged = 0;                             /* Numbered from the old head */
+    next_sequence = 1;
+    disabled = 0;
+
+    if(ReadSlot(0, &record) != EEPROM_SUCCESS)
+    {
+        return Disable();
+    }
+    if(record.sequence == SEQUENCE_BLANK)
+    {
+        return AUDITLOG_SUCCESS;            /* Empty log */
+    }
+
+    previous = record.sequence;
+    stored = AUDITLOG_CAPACITY;
+
+    for(slot = 1; slot < AUDITLOG_CAPACITY; slot++)
+    {
+        if(ReadSlot(slot, &record) != EEPROM_SUCCESS)
+        {
+            return Disable();
+        }
+        if(record.sequence != NextSequence(previous))
+        {
+            if(record.sequence == SEQUENCE_BLANK)
+            {
+                stored = slot;              /* Never wrapped */
+            }
+            break;
+        }
+        previous = record.sequence;
+    }
+
+    head = slot % AUDITLOG_CAPACITY;
+    next_sequence = NextSequence(previous);
+    return AUDITLOG_SUCCESS;
+}
+
+/*
+ * AuditLog_Append
+ * RAM only: safe to call from the unlock path.
+ */
+void AuditLog_Append(uint8_t event, uint8_t result)
+{
+    AuditLog_Record *record;
+
+    if(disabled != 0U)
+    {
+        return;
+    }
+    if(staged >= AUDITLOG_STAGE_RECORDS)
+    {
+        dropped++;
+        return;
+    }
+
+    record = &stage[staged++];
+    record->timestamp = SysTick_GetTicks();
+    record->sequence = next_sequence;
+    record->event = event;
+    record->result = result;
+    next_sequence = NextSequence(next_sequence);
+}
+
+/*
+ * AuditLog_Service
+ * Batches writes so a burst of events costs one EEPROM program cycle.
+ */
+void AuditLog_Service(void)
+{
+    if(disabled != 0U || staged == 0U)
+    {
+        return;
+    }
+
+    if(staged >= AUDITLOG_STAGE_RECORDS ||
+       (SysTick_GetTicks() - stage[0].timestamp) >= AUDITLOG_FLUSH_DELAY_MS)
+    {
+        AuditLog_Flush();
+    }
+}
+
+/*
+ * AuditLog_Flush
+ * At most two EEPROM writes: up to the end of the region, then from slot 0.
+ * On failure the records stay staged and are retried on the next call.
+ */
+uint8_t AuditLog_Flush(void)
+{
+    uint32_t first;
+
+    if(disabled != 0U)
+    {
+        return AUDITLOG_ERROR;
+    }
+    if(staged == 0U)
+    {
+        return AUDITLOG_SUCCESS;
+    }
+
+    first = AUDITLOG_CAPACITY - head;
+    if(first > staged)
+    {
+        first = staged;
+    }
+
+    if(WriteSlots(head, stage, first) != EEPROM_SUCCESS)
+    {
+        return AUDITLOG_ERROR;
+    }
+    if(first < staged && WriteSlots(0, &stage[first], staged - first) != EEPROM_SUCCESS)
+    {
+        return AUDITLOG_ERROR;
+    }
+
+    head = (head + staged) % AUDITLOG_CAPACITY;
+    stored += staged;
+    if(stored > AUDITLOG_CAPACITY)
+    {
+        stored = AUDITLOG_CAPACITY;
+    }
+    staged = 0;
+    return AUDITLOG_SUCCESS;
+}
+
+/*
+ * AuditLog_ForEach
+ * One walk from AuditLog_Begin() to the end.
+ */
+uint32_t AuditLog_ForEach(AuditLog_Sink sink)
+{
+    AuditLog_Cursor cursor;
+    AuditLog_Record record;
+    uint32_t visited = 0;
+    uint8_t result;
+
+    AuditLog_Begin(&cursor);
+    while((result = AuditLog_Next(&cursor, &record)) != AUDITLOG_END)
+    {
+        if(result == AUDITLOG_SUCCESS)
+        {
+            sink(&record);
+            visited++;
+        }
+    }
+    return visited;
+}
+
+/*
+ * AuditLog_Begin
+ * The records held are the stored + staged sequences before next_sequence.
+ */
+void AuditLog_Begin(AuditLog_Cursor *cursor)
+{
+    cursor->end = next_sequence;
+    cursor->next = Oldest();
+}
+
+/*
+ * AuditLog_Next
+ * A record's age (1 = newest) says where it is: the last staged entries,
+ * then the EEPROM slots before the head. Once the log has wrapped past
+ * the cursor it continues from the oldest record still held.
+ */
+uint8_t AuditLog_Next(AuditLog_Cursor *cursor, AuditLog_Record *record)
+{
+    uint32_t held = stored + staged;
+    uint32_t age;
+    uint32_t slot;
+
+    if(cursor->next == cursor->end)
+    {
+        return AUDITLOG_END;
+    }
+
+    age = Distance(cursor->next, next_sequence);
+    if(age > held)
+    {
+        if(Distance(cursor->end, next_sequence) >= held)
+        {
+            age = 0;                        /* The whole walk was overwritten */
+        }
+        else
+        {
+            cursor->next = Oldest();
+            age = held;
+        }
+    }
+    if(disabled != 0U || age == 0U)
+    {
+        cursor->next = cursor->end;         /* Or re-initialised under the walk */
+        return AUDITLOG_END;
+    }
+
+    cursor->next = NextSequence(cursor->next);
+    if(age <= staged)
+    {
+        *record = stage[staged - age];
+        return AUDITLOG_SUCCESS;
+    }
+
+    slot = (head + AUDITLOG_CAPACITY - (age - staged)) % AUDITLOG_CAPACITY;
+    return (ReadSlot(slot, record) == EEPROM_SUCCESS) ? AUDITLOG_SUCCESS : AUDITLOG_ERROR;
+}
+
+/*
+ * AuditLog_GetDropped
+ * Records lost because the staging buffer was full.
+ */
+uint32_t AuditLog_GetDropped(void)
+{
+    return dropped;
+}
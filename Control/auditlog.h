@@ -0,0 +1,155 @@
+/*****************************************************************************
+ * File: auditlog.h
+ * Module: AUDITLOG
+ * Description: Header file for the append-only audit log in EEPROM
+ *
+ * Events are 8-byte records kept in a circular region at the top of the
+ * EEPROM (blocks 16-31, 128 records). Appends only copy the record into a
+ * RAM staging buffer, so logging never adds EEPROM latency to the unlock
+ * path; AuditLog_Service() batch-writes staged records from the idle loop.
+ *
+ * Every record carries a 16-bit sequence number. The write position is
+ * recovered at boot as the first break in the sequence, so no separate
+ * head pointer (and its extra EEPROM wear) is needed.
+ *****************************************************************************/
+
+#ifndef AUDITLOG_H_
+#define AUDITLOG_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Return codes */
+#define AUDITLOG_SUCCESS        0
+#define AUDITLOG_ERROR          1
+#define AUDITLOG_END            2       /* AuditLog_Next(): nothing left */
+
+/* EEPROM region */
+#define AUDITLOG_FIRST_BLOCK    16
+#define AUDITLOG_BLOCK_COUNT    16
+#define AUDITLOG_RECORD_SIZE    8
+#define AUDITLOG_CAPACITY       ((AUDITLOG_BLOCK_COUNT * 64) / AUDITLOG_RECORD_SIZE)   /* 128 */
+
+/* RAM staging: one EEPROM block worth of records */
+#define AUDITLOG_STAGE_RECORDS  8
+#define AUDITLOG_FLUSH_DELAY_MS 1000U   /* Flush a partial batch after this long */
+
+/* Event codes */
+#define AUDIT_EVENT_BOOT            0x01U
+#define AUDIT_EVENT_DOOR_OPEN       0x02U   /* VERIFY: */
+#define AUDIT_EVENT_DOOR_CLOSE      0x03U
+#define AUDIT_EVENT_AUTH            0x04U   /* VERIFYPWD: */
+#define AUDIT_EVENT_PASSWORD_CHANGE 0x05U
+#define AUDIT_EVENT_TIMEOUT_CHANGE  0x06U
+#define AUDIT_EVENT_LOCKOUT_ALARM   0x07U   /* 'L' from the HMI */
+
+/* Door open/close and timeout events carry the door (0-based) in the high
+   nibble; records from before multi-door support read as door 0 */
+#define AUDIT_EVENT_FOR_DOOR(event, door)   ((uint8_t)((event) | ((uint32_t)(door) << 4)))
+
+/* Results */
+#define AUDIT_RESULT_OK         0x00U
+#define AUDIT_RESULT_FAILED     0x01U       /* Wrong password */
+#define AUDIT_RESULT_LOCKED     0x02U       /* Refused, lockout window open */
+#define AUDIT_RESULT_DENIED     0x03U       /* Not authenticated */
+#define AUDIT_RESULT_ERROR      0x04U       /* EEPROM failure */
+#define AUDIT_RESULT_WATCHDOG   0x05U       /* Boot: the watchdog reset the unit */
+
+/*
+ * AuditLog_Record
+ * On-EEPROM record layout (8 bytes, two words).
+ */
+typedef struct
+{
+    uint32_t timestamp;     /* SysTick ms since boot */
+    uint16_t sequence;      /* 1..0xFFFE, wraps; locates the head at boot */
+    uint8_t  event;
+    uint8_t  result;
+} AuditLog_Record;
+
+/*
+ * AuditLog_Sink
+ * Receives records from AuditLog_ForEach(), oldest first.
+ */
+typedef void (*AuditLog_Sink)(const AuditLog_Record *record);
+
+/*
+ * AuditLog_Cursor
+ * A walk over the log taken a few records at a time. It holds sequence
+ * numbers, not slots, so appends and flushes in between do not move it.
+ */
+typedef struct
+{
+    uint16_t next;          /* Sequence of the next record */
+    uint16_t end;           /* First sequence appended after AuditLog_Begin() */
+} AuditLog_Cursor;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * AuditLog_Init
+ * Scans the EEPROM region to find the write position; anything staged is
+ * dropped. If the scan fails the log is disabled until a later call
+ * succeeds: appends are ignored, AuditLog_Flush() fails and
+ * AuditLog_ForEach() visits nothing.
+ * Returns: AUDITLOG_SUCCESS or AUDITLOG_ERROR
+ */
+uint8_t AuditLog_Init(void);
+
+/*
+ * AuditLog_Append
+ * Stages a record in RAM. Never touches the EEPROM. If the staging
+ * buffer is full the record is dropped and counted.
+ */
+void AuditLog_Append(uint8_t event, uint8_t result);
+
+/*
+ * AuditLog_Service
+ * Call from the idle loop: writes staged records once a full block is
+ * staged or the oldest staged record is AUDITLOG_FLUSH_DELAY_MS old.
+ */
+void AuditLog_Service(void);
+
+/*
+ * AuditLog_Flush
+ * Writes all staged records now.
+ * Returns: AUDITLOG_SUCCESS or AUDITLOG_ERROR
+ */
+uint8_t AuditLog_Flush(void);
+
+/*
+ * AuditLog_ForEach
+ * Calls sink for every stored and staged record, oldest first. Records
+ * the EEPROM fails to return are skipped.
+ * Returns: number of records passed to sink
+ */
+uint32_t AuditLog_ForEach(AuditLog_Sink sink);
+
+/*
+ * AuditLog_Begin
+ * Starts a walk over the records held now, stored and staged, oldest
+ * first. Records appended later are not part of it.
+ */
+void AuditLog_Begin(AuditLog_Cursor *cursor);
+
+/*
+ * AuditLog_Next
+ * Reads the next record of a walk. Records overwritten since
+ * AuditLog_Begin() are passed over.
+ * Returns: AUDITLOG_SUCCESS, AUDITLOG_ERROR if the EEPROM failed to
+ *          return the record (it is skipped), or AUDITLOG_END
+ */
+uint8_t AuditLog_Next(AuditLog_Cursor *cursor, AuditLog_Record *record);
+
+/*
+ * AuditLog_GetDropped
+ * Records lost because the staging buffer was full.
+ */
+uint32_t AuditLog_GetDropped(void);
+
+#endif /* AUDITLOG_H_ */
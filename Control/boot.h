@@ -0,0 +1,73 @@
+/*****************************************************************************
+ * File: boot.h
+ * Module: BOOT
+ * Description: Header file for peripheral clock bring-up and the boot timeline
+ *
+ * main() turns on every peripheral clock it needs with Boot_EnableClocks,
+ * one write per clock-gating register and one wait for them all, before
+ * any driver init. The drivers still enable their own clocks, but find
+ * them already running. The EEPROM's clock is started without waiting:
+ * its controller powers up while the other drivers initialise, and
+ * EEPROM_Init then finds it ready.
+ *
+ * Boot_Mark records the end of each bring-up step with its SysTick
+ * microseconds, counted from SysTick_Init, which main() calls first.
+ * Watch boot_phases in the debugger or read it with Boot_GetTimeline.
+ * The last mark is "ready": the unit accepts a password from there on,
+ * and should reach it within BOOT_BUDGET_MS.
+ *****************************************************************************/
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define BOOT_MAX_PHASES         10U
+#define BOOT_BUDGET_MS          100U    /* Reset to "ready" */
+
+/* Boot_Clocks: a bit per instance, as in the RCGC and PR registers */
+typedef struct
+{
+    uint32_t gpio;          /* Bit 0 = port A */
+    uint32_t uart;
+    uint32_t timer;
+    uint32_t pwm;
+    uint32_t adc;
+    uint32_t eeprom;        /* Not waited for */
+} Boot_Clocks;
+
+typedef struct
+{
+    const char *name;
+    uint32_t us;            /* SysTick_GetMicros() at the end of the step */
+} Boot_Phase;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Boot_EnableClocks
+ * Starts the listed clocks and waits until all but the EEPROM are ready.
+ */
+void Boot_EnableClocks(const Boot_Clocks *clocks);
+
+/*
+ * Boot_Mark
+ * Records the end of a bring-up step; name must be a string literal.
+ * Marks past BOOT_MAX_PHASES are dropped.
+ */
+void Boot_Mark(const char *name);
+
+/*
+ * Boot_GetTimeline
+ * Points phases at the recorded steps, oldest first.
+ * Returns: the number of steps
+ */
+uint8_t Boot_GetTimeline(const Boot_Phase **phases);
+
+#endif /* BOOT_H_ */
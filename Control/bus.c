@@ -0,0 +1,215 @@
+/*****************************************************************************
+ * File: bus.c
+ * Module: BUS
+ * Description: Source file for the RS-485 multi-drop bus master (polling)
+ *****************************************************************************/
+
+#include "bus.h"
+#include "uart.h"
+#include "systick.h"
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+typedef struct
+{
+    uint8_t misses;                     /* Unanswered polls in a row */
+} Bus_Node;
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static Bus_Node nodes[BUS_NODE_COUNT + 1U];     /* Index 0 unused */
+static uint8_t polled = BUS_NODE_NONE;          /* Panel whose slot is open */
+static uint32_t polled_at = 0;
+static uint8_t next_node = 1;
+static uint8_t next_absent = 1;
+static uint32_t absent_polled_at = 0;           /* Last probe of an absent panel */
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * HexValue
+ * Returns the value of an upper-case hex digit, or -1.
+ */
+static int HexValue(char c)
+{
+    if(c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if(c >= 'A' && c <= 'F')
+    {
+        return (c - 'A') + 10;
+    }
+    return -1;
+}
+
+/*
+ * Advance
+ * Steps a round-robin cursor and returns the panel it was on.
+ */
+static uint8_t Advance(uint8_t *cursor)
+{
+    uint8_t node = *cursor;
+
+    *cursor = (node >= BUS_NODE_COUNT) ? 1U : (uint8_t)(node + 1U);
+    return node;
+}
+
+/*
+ * NextNode
+ * Absent panels take turns at the probe when it is due; otherwise round
+ * robin over the present ones.
+ */
+static uint8_t NextNode(uint32_t now)
+{
+    uint8_t tries;
+    uint8_t node;
+
+    if((now - absent_polled_at) >= BUS_ABSENT_POLL_MS)
+    {
+        for(tries = 0; tries < BUS_NODE_COUNT; tries++)
+        {
+            node = Advance(&next_absent);
+            if(nodes[node].misses >= BUS_ABSENT_MISSES)
+            {
+                absent_polled_at = now;
+                return node;
+            }
+        }
+    }
+
+    for(tries = 0; tries < BUS_NODE_COUNT; tries++)
+    {
+        node = Advance(&next_node);
+        if(nodes[node].misses < BUS_ABSENT_MISSES)
+        {
+            return node;
+        }
+    }
+    return BUS_NODE_NONE;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Bus_Init
+ * Marks every panel present and closes any open slot.
+ */
+void Bus_Init(void)
+{
+    uint8_t i;
+
+    for(i = 0; i <= BUS_NODE_COUNT; i++)
+    {
+        nodes[i].misses = 0;
+    }
+    polled = BUS_NODE_NONE;
+    next_node = 1;
+    next_absent = 1;
+    absent_polled_at = SysTick_GetTicks();
+}
+
+/*
+ * Bus_Service
+ * The poll is a short line, so it is sent straight away.
+ */
+void Bus_Service(void)
+{
+    uint32_t now = SysTick_GetTicks();
+    char poll[BUS_ADDRESS_LENGTH + 3U];
+
+    if(polled != BUS_NODE_NONE)
+    {
+        if((now - polled_at) < BUS_SLOT_TIMEOUT_MS)
+        {
+            return;
+        }
+        if(nodes[polled].misses < BUS_ABSENT_MISSES)
+        {
+            nodes[polled].misses++;
+        }
+        polled = BUS_NODE_NONE;
+    }
+
+    polled = NextNode(now);
+    if(polled == BUS_NODE_NONE)
+    {
+        return;
+    }
+
+    Bus_FormatAddress(polled, poll);
+    poll[BUS_ADDRESS_LENGTH] = '?';
+    poll[BUS_ADDRESS_LENGTH + 1U] = '\n';
+    poll[BUS_ADDRESS_LENGTH + 2U] = '\0';
+    UART2_SendString(poll);
+    polled_at = now;
+}
+
+/*
+ * Bus_Accept
+ * Only the polled panel may speak; anything else on the bus is noise.
+ */
+uint8_t Bus_Accept(const char *line, const char **body)
+{
+    int high;
+    int low;
+    uint8_t node;
+
+    if(line[0] != '#')
+    {
+        return BUS_NODE_NONE;
+    }
+    high = HexValue(line[1]);
+    low = (high < 0) ? -1 : HexValue(line[2]);
+    if(low < 0)
+    {
+        return BUS_NODE_NONE;
+    }
+
+    node = (uint8_t)((high << 4) | low);
+    if(node == BUS_NODE_NONE || node != polled)
+    {
+        return BUS_NODE_NONE;
+    }
+
+    nodes[node].misses = 0;
+    polled = BUS_NODE_NONE;
+    *body = &line[BUS_ADDRESS_LENGTH];
+    return node;
+}
+
+/*
+ * Bus_FormatAddress
+ * Upper-case hex, as the panels expect.
+ */
+void Bus_FormatAddress(uint8_t node, char address[BUS_ADDRESS_LENGTH + 1])
+{
+    address[0] = '#';
+    address[1] = hex_digits[node >> 4];
+    address[2] = hex_digits[node & 0x0FU];
+    address[3] = '\0';
+}
+
+/*
+ * Bus_IsPresent
+ * Out-of-range IDs are never present.
+ */
+uint8_t Bus_IsPresent(uint8_t node)
+{
+    if(node == BUS_NODE_NONE || node > BUS_NODE_COUNT)
+    {
+        return 0;
+    }
+    return (nodes[node].misses < BUS_ABSENT_MISSES) ? 1U : 0U;
+}
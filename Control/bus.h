@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * File: bus.h
+ * Module: BUS
+ * Description: Header file for the RS-485 multi-drop bus master (polling)
+ *
+ * With UART2_RS485 set, up to BUS_NODE_COUNT HMI panels share UART2 through
+ * half-duplex transceivers. Control is the only node that speaks
+ * unprompted: it polls the panels in turn and a panel transmits only in
+ * answer to its own poll, so frames never collide.
+ *
+ *     Control -> panel  "#NN?\n"          poll, NN = panel ID in hex
+ *     panel -> Control  "#NN<line>\n"     one queued line ("@SS VERIFY:...",
+ *                                         "CLOSE", "L"), or just "#NN\n"
+ *     Control -> panel  "#NN<reply>\n"    reply, same "@SS " as the request
+ *
+ * Every poll is answered, so the next panel is polled as soon as the
+ * previous slot ends: a cycle costs bus time only. A panel that misses
+ * BUS_ABSENT_MISSES polls in a row is treated as absent. Absent panels
+ * share one probe every BUS_ABSENT_POLL_MS, so however many are missing
+ * they add at most one slot timeout to a cycle in that time.
+ *****************************************************************************/
+
+#ifndef BUS_H_
+#define BUS_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define BUS_MAX_NODES           16U     /* Two hex digits would allow more */
+
+/* Panel IDs 1..BUS_NODE_COUNT are polled */
+#ifndef BUS_NODE_COUNT
+#define BUS_NODE_COUNT          8U
+#endif
+#if (BUS_NODE_COUNT < 1) || (BUS_NODE_COUNT > BUS_MAX_NODES)
+#error "BUS_NODE_COUNT must be 1..BUS_MAX_NODES"
+#endif
+
+/* Not a panel: "no slot open", and the session of a point-to-point link */
+#define BUS_NODE_NONE           0U
+
+#define BUS_ADDRESS_LENGTH      3U      /* "#NN" */
+#define BUS_SLOT_TIMEOUT_MS     10U     /* Longest wait for a polled panel */
+#define BUS_ABSENT_MISSES       3U
+#define BUS_ABSENT_POLL_MS      100U
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Bus_Init
+ * Marks every panel present and closes any open slot.
+ */
+void Bus_Init(void);
+
+/*
+ * Bus_Service
+ * Expires an unanswered poll, then polls the next panel if no slot is open.
+ * Call every millisecond and after each handled line.
+ */
+void Bus_Service(void);
+
+/*
+ * Bus_Accept
+ * Checks that line is "#NN..." from the panel being polled and closes its
+ * slot. *body is set to the text after the address.
+ * Returns: the panel ID, or BUS_NODE_NONE if the line is to be ignored
+ */
+uint8_t Bus_Accept(const char *line, const char **body);
+
+/*
+ * Bus_FormatAddress
+ * Writes "#NN" plus a terminator.
+ */
+void Bus_FormatAddress(uint8_t node, char address[BUS_ADDRESS_LENGTH + 1]);
+
+/*
+ * Bus_IsPresent
+ * Returns: 1 unless the panel has missed BUS_ABSENT_MISSES polls in a row
+ */
+uint8_t Bus_IsPresent(uint8_t node);
+
+#endif /* BUS_H_ */
@@ -1,9 +1,22 @@
 #include "buzzer.h"
 #include "tm4c123gh6pm.h"
+#include "systick.h"
 #include <stdint.h>
-// External dependency: You likely have a Delay function available.
-// If not, we can define a simple one here. 
-void delayMs(uint32_t ms);
+
+// Timed beeps are step tables played by pattern.c, so nothing here blocks.
+
+#if BUZZER_PWM
+// PWM1 generator 1 A (M1PWM2) on PE4, divided like the servos on PWM0:
+// both modules share the RCC divider, so this must match Servo_Init.
+#define BUZZER_PWM_CLOCK_HZ     (SYSTEM_CLOCK_HZ / 64U)
+#define BUZZER_PCTL_MASK        0x000F0000U
+#define BUZZER_PCTL_PWM         0x00050000U     // M1PWM2
+#define BUZZER_PWM_ENABLE       0x04U           // M1PWM2 in PWM1_ENABLE_R
+#define BUZZER_GEN_A            0x0000008CU     // High on load, low on CMPA down
+
+static uint32_t buzzer_hz = 0;
+#endif
+
 void Buzzer_Init(void)
 {
     // 1. Enable Clock for Port E
@@ -14,10 +27,68 @@ void Buzzer_Init(void)
     GPIO_PORTE_DIR_R |= 0x10;  // Pin 4 Output
     GPIO_PORTE_DEN_R |= 0x10;  // Pin 4 Digital Enable
     GPIO_PORTE_DATA_R &= ~0x10;// Initialize Low (Off)
+
+#if BUZZER_PWM
+    // 3. Hand PE4 to M1PWM2; a disabled PWM output drives the pin low
+    SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R1;
+    while((SYSCTL_PRPWM_R & SYSCTL_PRPWM_R1) == 0);
+    SYSCTL_RCC_R = (SYSCTL_RCC_R & ~SYSCTL_RCC_PWMDIV_M) | SYSCTL_RCC_USEPWMDIV | SYSCTL_RCC_PWMDIV_64;
+
+    GPIO_PORTE_AFSEL_R |= 0x10;
+    GPIO_PORTE_PCTL_R = (GPIO_PORTE_PCTL_R & ~BUZZER_PCTL_MASK) | BUZZER_PCTL_PWM;
+    GPIO_PORTE_AMSEL_R &= ~0x10;
+
+    PWM1_1_CTL_R = 0;
+    PWM1_1_GENA_R = BUZZER_GEN_A;
+    PWM1_ENABLE_R &= ~BUZZER_PWM_ENABLE;
+    buzzer_hz = 0;
+#endif
 }
-void Buzzer_Beep(uint32_t duration_ms)
+
+void Buzzer_On(void)
 {
-    GPIO_PORTE_DATA_R |= 0x10; // Turn ON (PE4 High)
-    delayMs(duration_ms);
-    GPIO_PORTE_DATA_R &= ~0x10; // Turn OFF (PE4 Low)
-}
\ No newline at end of file
+    Buzzer_Tone(BUZZER_TONE_DEFAULT_HZ);
+}
+
+void Buzzer_Off(void)
+{
+    Buzzer_Tone(0);
+}
+
+void Buzzer_Tone(uint32_t hz)
+{
+#if BUZZER_PWM
+    uint32_t load;
+
+    if(hz == buzzer_hz)
+    {
+        return; // Keep the running wave in phase
+    }
+    buzzer_hz = hz;
+    if(hz == 0)
+    {
+        PWM1_ENABLE_R &= ~BUZZER_PWM_ENABLE;
+        PWM1_1_CTL_R = 0;
+        return;
+    }
+    if(hz < BUZZER_TONE_MIN_HZ)
+    {
+        hz = BUZZER_TONE_MIN_HZ; // Keeps the period within the 16-bit counter
+    }
+    load = (BUZZER_PWM_CLOCK_HZ / hz) - 1U;
+    PWM1_1_CTL_R = 0;
+    PWM1_1_LOAD_R = load;
+    PWM1_1_CMPA_R = load / 2U; // 50% duty
+    PWM1_1_CTL_R = 0x01;
+    PWM1_ENABLE_R |= BUZZER_PWM_ENABLE;
+#else
+    if(hz != 0)
+    {
+        GPIO_PORTE_DATA_BITS_R[0x10] = 0x10; // Turn ON (PE4 High)
+    }
+    else
+    {
+        GPIO_PORTE_DATA_BITS_R[0x10] = 0; // Turn OFF (PE4 Low)
+    }
+#endif
+}
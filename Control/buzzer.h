@@ -10,7 +10,18 @@
 #define BUZZER_PORT   PORTE
 #define BUZZER_PIN    PIN4
 
+// Build with BUZZER_PWM=1 for a passive buzzer: PE4 then carries a square
+// wave from M1PWM2 and Buzzer_Tone() sets its pitch. The default drives an
+// active buzzer, which only has on and off.
+#ifndef BUZZER_PWM
+#define BUZZER_PWM              0
+#endif
+#define BUZZER_TONE_DEFAULT_HZ  2500U
+#define BUZZER_TONE_MIN_HZ      100U
+
 void Buzzer_Init(void);
-void Buzzer_Beep(uint32_t duration_ms); // Short beep for key press
+void Buzzer_On(void);                   // Non-blocking: caller times the beep
+void Buzzer_Off(void);
+void Buzzer_Tone(uint32_t hz);          // 0 = off; pitch ignored without BUZZER_PWM
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,251 @@
+/*****************************************************************************
+ * File: command.c
+ * Module: COMMAND
+ * Description: Source file for the Control command line parser
+ *
+ * Every loop here is bounded by the length of its view, and the name table
+ * is scanned once, so the work per line is linear in the line length.
+ * Host builds may define COMMAND_STEP() to count loop iterations.
+ *****************************************************************************/
+
+#include "command.h"
+#include "door.h"
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#ifndef COMMAND_STEP
+#define COMMAND_STEP()
+#endif
+
+#define CFG_FIELD_PASSWORD      "PWD="
+#define CFG_FIELD_TIMEOUT       "TMO="
+#define CFG_FIELD_NAME_LENGTH   4U
+#define CFG_TIMEOUT_MAX_DIGITS  5U
+
+typedef struct
+{
+    const char *name;
+    uint8_t     length;
+    uint8_t     code;
+    uint8_t     exact;                  /* 1: the whole line, 0: a prefix */
+} Command_Name;
+
+#define COMMAND_NAME(lit, code, exact)  { (lit), (uint8_t)FRAME_LITERAL_LENGTH(lit), (code), (exact) }
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+/* Longer names before their own prefixes ("VERIFYPWD:" before "VERIFY:") */
+static const Command_Name names[] =
+{
+    COMMAND_NAME("L",           COMMAND_ALARM,           1U),
+    COMMAND_NAME("SETPWD:",     COMMAND_SET_PASSWORD,    0U),
+    COMMAND_NAME("TIMEOUT:",    COMMAND_TIMEOUT,         0U),
+    COMMAND_NAME("VERIFYPWD:",  COMMAND_VERIFY_SETTINGS, 0U),
+    COMMAND_NAME("VERIFY:",     COMMAND_VERIFY,          0U),
+    COMMAND_NAME("CLOSE",       COMMAND_CLOSE,           0U),
+    COMMAND_NAME("HOLD",        COMMAND_HOLD,            1U),
+    COMMAND_NAME("AUDIT?",      COMMAND_AUDIT,           1U),
+    COMMAND_NAME("CFG:",        COMMAND_CONFIG,          0U),
+    COMMAND_NAME("BAUD:COMMIT", COMMAND_BAUD_COMMIT,     1U),
+    COMMAND_NAME("BAUD:",       COMMAND_BAUD,            0U),
+    COMMAND_NAME("PING:",       COMMAND_PING,            0U),
+    COMMAND_NAME("HB:",         COMMAND_HEARTBEAT,       0U),
+    COMMAND_NAME("STATS?",      COMMAND_STATS,           0U)
+};
+
+#define COMMAND_NAME_COUNT      (sizeof(names) / sizeof(names[0]))
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * FieldLength
+ * Characters before the next ';', or the whole view if there is none.
+ */
+static uint32_t FieldLength(Frame_View view)
+{
+    const char *end = (const char *)memchr(view.text, ';', view.length);
+
+    return (end != NULL) ? (uint32_t)(end - view.text) : view.length;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Command_Parse
+ * The "@SS " check needs the full four characters, so "@SS" alone is
+ * taken as a command name.
+ */
+void Command_Parse(Frame_View line, Command *command)
+{
+    uint32_t i;
+
+    command->code = COMMAND_NONE;
+    command->door = 0;
+    command->valid = 1;
+    command->number = 0;
+    command->sequence.text = line.text;
+    command->sequence.length = 0;
+
+    if(line.length >= COMMAND_SEQ_LENGTH && line.text[0] == '@' && line.text[3] == ' ')
+    {
+        command->sequence.length = COMMAND_SEQ_LENGTH;
+        Frame_Skip(&line, COMMAND_SEQ_LENGTH);
+    }
+
+    if(line.length >= COMMAND_DOOR_LENGTH && line.text[0] == 'D' &&
+       line.text[1] >= '1' && line.text[1] <= '9' && line.text[2] == '/')
+    {
+        if((uint32_t)(line.text[1] - '0') > DOOR_COUNT)
+        {
+            command->code = COMMAND_BAD_DOOR;
+        }
+        else
+        {
+            command->door = (uint8_t)(line.text[1] - '1');
+        }
+        Frame_Skip(&line, COMMAND_DOOR_LENGTH);
+    }
+    command->argument = line;
+
+    if(command->code == COMMAND_BAD_DOOR || line.length == 0U)
+    {
+        return;
+    }
+
+    command->code = COMMAND_UNKNOWN;
+    for(i = 0; i < COMMAND_NAME_COUNT; i++)
+    {
+        const Command_Name *name = &names[i];
+
+        COMMAND_STEP();
+        if((name->exact != 0U) ? (line.length == name->length) : (line.length >= name->length))
+        {
+            if(memcmp(line.text, name->name, name->length) == 0)
+            {
+                command->code = name->code;
+                Frame_Skip(&command->argument, name->length);
+                break;
+            }
+        }
+    }
+
+    switch(command->code)
+    {
+    case COMMAND_SET_PASSWORD:
+        command->valid = (command->argument.length < PASSWORD_MAX_LENGTH) ? 1U : 0U;
+        break;
+    case COMMAND_TIMEOUT:
+    case COMMAND_BAUD:
+    case COMMAND_HEARTBEAT:
+        command->valid = Command_ParseNumber(command->argument, &command->number);
+        break;
+    case COMMAND_STATS:
+        /* The field number is optional */
+        command->valid = (command->argument.length == 0U) ? 1U :
+                         Command_ParseNumber(command->argument, &command->number);
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * Command_ParseNumber
+ * Overflow is caught before the multiply, against the digit about to be
+ * added.
+ */
+uint8_t Command_ParseNumber(Frame_View digits, uint32_t *value)
+{
+    uint32_t result = 0;
+    uint32_t i;
+
+    if(digits.length == 0U || digits.length > COMMAND_NUMBER_DIGITS)
+    {
+        return 0;
+    }
+
+    for(i = 0; i < digits.length; i++)
+    {
+        uint32_t digit = (uint32_t)(digits.text[i] - '0');
+
+        COMMAND_STEP();
+        if(digits.text[i] < '0' || digits.text[i] > '9' ||
+           result > (UINT32_MAX - digit) / 10U)
+        {
+            return 0;
+        }
+        result = (result * 10U) + digit;
+    }
+
+    *value = result;
+    return 1;
+}
+
+/*
+ * Command_ParseConfig
+ * The request is cleared first, so both strings end in a terminator; every
+ * copy is shorter than PASSWORD_MAX_LENGTH.
+ */
+uint8_t Command_ParseConfig(Frame_View args, Config_Request *request)
+{
+    uint32_t length = FieldLength(args);
+
+    memset(request, 0, sizeof(*request));
+    if(length == args.length || length == 0U || length >= PASSWORD_MAX_LENGTH)
+    {
+        return 0;                       /* No settings, or no usable credential */
+    }
+    memcpy(request->credential, args.text, length);
+    Frame_Skip(&args, length);
+
+    while(args.length != 0U)
+    {
+        Frame_View value;
+
+        COMMAND_STEP();
+        Frame_Skip(&args, 1U);          /* The ';' */
+        value.text = args.text;
+        value.length = FieldLength(args);
+        Frame_Skip(&args, value.length);
+        if(value.length <= CFG_FIELD_NAME_LENGTH)
+        {
+            return 0;
+        }
+
+        if(FRAME_STARTS_WITH(value, CFG_FIELD_PASSWORD))
+        {
+            Frame_Skip(&value, CFG_FIELD_NAME_LENGTH);
+            if(request->has_password != 0U || value.length >= PASSWORD_MAX_LENGTH)
+            {
+                return 0;
+            }
+            memcpy(request->password, value.text, value.length);
+            request->has_password = 1;
+        }
+        else if(FRAME_STARTS_WITH(value, CFG_FIELD_TIMEOUT))
+        {
+            Frame_Skip(&value, CFG_FIELD_NAME_LENGTH);
+            if(request->has_timeout != 0U || value.length > CFG_TIMEOUT_MAX_DIGITS ||
+               Command_ParseNumber(value, &request->timeout) == 0U)
+            {
+                return 0;
+            }
+            request->has_timeout = 1;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    return (request->has_password != 0U || request->has_timeout != 0U) ? 1U : 0U;
+}
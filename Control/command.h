@@ -0,0 +1,106 @@
+/*****************************************************************************
+ * File: command.h
+ * Module: COMMAND
+ * Description: Header file for the Control command line parser
+ *
+ * Turns one received line (after any "#NN" bus address) into a Command:
+ *
+ *     [@SS ][D<n>/]<name>[<argument>]
+ *
+ * The parser only reads the line and writes the Command; it has no side
+ * effects and no hardware dependencies, so the same file is built on the
+ * host by Testing/Fuzz for the fuzzer and the property tests. Acting on
+ * a command is left to main.c.
+ *
+ * Numbers must be 1 to COMMAND_NUMBER_DIGITS digits and nothing else, and
+ * must fit in 32 bits: "TIMEOUT:" with no digits, "BAUD:9600x" and digit
+ * runs that would overflow are reported as bad arguments.
+ *****************************************************************************/
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stdint.h>
+#include "frame.h"
+#include "password.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define COMMAND_LINE_SIZE       50U     /* Receive line buffer; longest line is one less */
+#define COMMAND_NUMBER_DIGITS   10U     /* 4294967295 */
+#define COMMAND_SEQ_LENGTH      4U      /* "@SS " on sequenced requests */
+#define COMMAND_DOOR_LENGTH     3U      /* "D<n>/" naming the door, n = 1..DOOR_COUNT */
+
+/* Command codes */
+#define COMMAND_NONE            0U      /* Nothing after the prefixes */
+#define COMMAND_UNKNOWN         1U
+#define COMMAND_BAD_DOOR        2U      /* "D<n>/" with n > DOOR_COUNT */
+#define COMMAND_ALARM           3U      /* "L" */
+#define COMMAND_SET_PASSWORD    4U      /* "SETPWD:<new>" */
+#define COMMAND_TIMEOUT         5U      /* "TIMEOUT:<s>" */
+#define COMMAND_VERIFY_SETTINGS 6U      /* "VERIFYPWD:<pwd>" */
+#define COMMAND_VERIFY          7U      /* "VERIFY:<pwd>" */
+#define COMMAND_CLOSE           8U      /* "CLOSE..." */
+#define COMMAND_HOLD            9U      /* "HOLD" */
+#define COMMAND_AUDIT           10U     /* "AUDIT?" */
+#define COMMAND_CONFIG          11U     /* "CFG:<pwd>;PWD=<new>;TMO=<s>" */
+#define COMMAND_BAUD_COMMIT     12U     /* "BAUD:COMMIT" */
+#define COMMAND_BAUD            13U     /* "BAUD:<rate>" */
+#define COMMAND_PING            14U     /* "PING:<text><crc>" */
+#define COMMAND_HEARTBEAT       15U     /* "HB:<uptime ms>" */
+#define COMMAND_STATS           16U     /* "STATS?" or "STATS?<field>" */
+#define COMMAND_COUNT           17U
+
+/*
+ * Command
+ * One parsed line. The views point into the line given to Command_Parse.
+ */
+typedef struct
+{
+    uint8_t    code;                    /* COMMAND_* */
+    uint8_t    door;                    /* 0-based; door 1 unless named */
+    uint8_t    valid;                   /* Argument well formed (always 1 without one) */
+    Frame_View sequence;                /* "@SS " to echo, or empty */
+    Frame_View argument;                /* Text after the command name */
+    uint32_t   number;                  /* TIMEOUT / BAUD / HB / STATS value when valid */
+} Command;
+
+/* Settings carried by one "CFG:" command; the strings are terminated */
+typedef struct
+{
+    char     credential[PASSWORD_MAX_LENGTH];
+    char     password[PASSWORD_MAX_LENGTH];
+    uint32_t timeout;
+    uint8_t  has_password;
+    uint8_t  has_timeout;
+} Config_Request;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Command_Parse
+ * Splits a line into prefixes, command and argument. Never fails: lines it
+ * does not know come back as COMMAND_UNKNOWN.
+ */
+void Command_Parse(Frame_View line, Command *command);
+
+/*
+ * Command_ParseNumber
+ * Reads a decimal number that is all of the view.
+ * Returns: 1 with *value set, or 0 if empty, not all digits, or over 32 bits
+ */
+uint8_t Command_ParseNumber(Frame_View digits, uint32_t *value);
+
+/*
+ * Command_ParseConfig
+ * Splits "<pwd>;PWD=<new>;TMO=<s>" (fields in any order, each at most
+ * once). Ranges are checked by Password_Commit.
+ * Returns: 1 if well formed and naming at least one setting, otherwise 0
+ */
+uint8_t Command_ParseConfig(Frame_View args, Config_Request *request);
+
+#endif /* COMMAND_H_ */
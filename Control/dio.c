@@ -18,103 +18,100 @@
 
 #define GPIO_LOCK_KEY           0x4C4F434B
 
-/* Helper macros to get register address based on port (0-5) */
-#define GET_GPIO_DATA(port)   ((port) == 0 ? &GPIO_PORTA_DATA_R : \
-                               (port) == 1 ? &GPIO_PORTB_DATA_R : \
-                               (port) == 2 ? &GPIO_PORTC_DATA_R : \
-                               (port) == 3 ? &GPIO_PORTD_DATA_R : \
-                               (port) == 4 ? &GPIO_PORTE_DATA_R : \
-                               &GPIO_PORTF_DATA_R)
-
-#define GET_GPIO_DIR(port)    ((port) == 0 ? &GPIO_PORTA_DIR_R : \
-                               (port) == 1 ? &GPIO_PORTB_DIR_R : \
-                               (port) == 2 ? &GPIO_PORTC_DIR_R : \
-                               (port) == 3 ? &GPIO_PORTD_DIR_R : \
-                               (port) == 4 ? &GPIO_PORTE_DIR_R : \
-                               &GPIO_PORTF_DIR_R)
-
-#define GET_GPIO_DEN(port)    ((port) == 0 ? &GPIO_PORTA_DEN_R : \
-                               (port) == 1 ? &GPIO_PORTB_DEN_R : \
-                               (port) == 2 ? &GPIO_PORTC_DEN_R : \
-                               (port) == 3 ? &GPIO_PORTD_DEN_R : \
-                               (port) == 4 ? &GPIO_PORTE_DEN_R : \
-                               &GPIO_PORTF_DEN_R)
-
-#define GET_GPIO_AFSEL(port)  ((port) == 0 ? &GPIO_PORTA_AFSEL_R : \
-                               (port) == 1 ? &GPIO_PORTB_AFSEL_R : \
-                               (port) == 2 ? &GPIO_PORTC_AFSEL_R : \
-                               (port) == 3 ? &GPIO_PORTD_AFSEL_R : \
-                               (port) == 4 ? &GPIO_PORTE_AFSEL_R : \
-                               &GPIO_PORTF_AFSEL_R)
-
-#define GET_GPIO_PUR(port)    ((port) == 0 ? &GPIO_PORTA_PUR_R : \
-                               (port) == 1 ? &GPIO_PORTB_PUR_R : \
-                               (port) == 2 ? &GPIO_PORTC_PUR_R : \
-                               (port) == 3 ? &GPIO_PORTD_PUR_R : \
-                               (port) == 4 ? &GPIO_PORTE_PUR_R : \
-                               &GPIO_PORTF_PUR_R)
-
-#define GET_GPIO_PDR(port)    ((port) == 0 ? &GPIO_PORTA_PDR_R : \
-                               (port) == 1 ? &GPIO_PORTB_PDR_R : \
-                               (port) == 2 ? &GPIO_PORTC_PDR_R : \
-                               (port) == 3 ? &GPIO_PORTD_PDR_R : \
-                               (port) == 4 ? &GPIO_PORTE_PDR_R : \
-                               &GPIO_PORTF_PDR_R)
-
-#define GET_GPIO_LOCK(port)   ((port) == 0 ? &GPIO_PORTA_LOCK_R : \
-                               (port) == 1 ? &GPIO_PORTB_LOCK_R : \
-                               (port) == 2 ? &GPIO_PORTC_LOCK_R : \
-                               (port) == 3 ? &GPIO_PORTD_LOCK_R : \
-                               (port) == 4 ? &GPIO_PORTE_LOCK_R : \
-                               &GPIO_PORTF_LOCK_R)
-
-#define GET_GPIO_CR(port)     ((port) == 0 ? &GPIO_PORTA_CR_R : \
-                               (port) == 1 ? &GPIO_PORTB_CR_R : \
-                               (port) == 2 ? &GPIO_PORTC_CR_R : \
-                               (port) == 3 ? &GPIO_PORTD_CR_R : \
-                               (port) == 4 ? &GPIO_PORTE_CR_R : \
-                               &GPIO_PORTF_CR_R)
+/* Whole register, and one bit of it through the bit-band alias */
+#define GPIO_REG(port, offset)       (*((volatile uint32_t *)(port_base[port] + (offset))))
+#define GPIO_BIT(port, offset, pin)  DIO_BITBAND(port_base[port] + (offset), (pin))
+
+#define DIO_VALID(port, pin)    ((port) < DIO_PORT_COUNT && (pin) <= PIN7)
+
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static const uint32_t port_base[DIO_PORT_COUNT] =
+{
+    DIO_PORT_BASE(PORTA),
+    DIO_PORT_BASE(PORTB),
+    DIO_PORT_BASE(PORTC),
+    DIO_PORT_BASE(PORTD),
+    DIO_PORT_BASE(PORTE),
+    DIO_PORT_BASE(PORTF)
+};
+
+/* Interrupts 0-4 (ports A-E) and 30 (port F), all in NVIC_EN0 */
+static const uint32_t port_nvic_bit[DIO_PORT_COUNT] =
+{
+    0x00000001U, 0x00000002U, 0x00000004U, 0x00000008U, 0x00000010U, 0x40000000U
+};
+
+static DIO_Callback callbacks[DIO_PORT_COUNT][8];
+
+
+/******************************************************************************
+ *                              Private Functions                              *
+ ******************************************************************************/
+
+/*
+ * Dispatch
+ * Acknowledges a port's pending edges and runs their callbacks, lowest pin
+ * first.
+ */
+static void Dispatch(uint8_t port) {
+    uint32_t pending = GPIO_REG(port, DIO_OFFSET_MIS);
+    uint8_t pin;
+
+    GPIO_REG(port, DIO_OFFSET_ICR) = pending;
+    for (pin = 0; pending != 0U; pin++, pending >>= 1) {
+        if ((pending & 1U) != 0U && callbacks[port][pin] != 0) {
+            callbacks[port][pin](port, pin);
+        }
+    }
+}
+
 
 /******************************************************************************
  *                              Function Implementations                       *
  ******************************************************************************/
 
 
+/*
+ * DIO_EnableAHB
+ * GPIOHBCTL has one bit per port, in port order.
+ */
+void DIO_EnableAHB(void) {
+#if DIO_USE_AHB
+    SYSCTL_GPIOHBCTL_R |= DIO_AHB_PORTS;
+#endif
+}
+
+
 /*
  * DIO_Init
  * Enables the clock for the specified port and configures the pin as input or output.
  * Unlocks special pins if required, disables alternate functions, and enables digital mode.
  */
 void DIO_Init(uint8_t port, uint8_t pin, uint8_t direction) {
-    volatile uint32_t delay;
-    SYSCTL_RCGCGPIO_R |= (1 << port); // Enable clock for port
-    delay = SYSCTL_RCGCGPIO_R;        // Dummy read for delay
-    delay = SYSCTL_RCGCGPIO_R;        // Additional delay for stability
+    if (!DIO_VALID(port, pin)) {
+        return;
+    }
+
+    SYSCTL_RCGCGPIO_R |= (1U << port);                 // Enable clock for port
+    while ((SYSCTL_PRGPIO_R & (1U << port)) == 0);     // Wait until it is ready
 
     // Unlock the port (critical for PD7, PF0)
-    *GET_GPIO_LOCK(port) = GPIO_LOCK_KEY;
-    *GET_GPIO_CR(port) |= (1 << pin); // Unlock this specific pin
-    
+    GPIO_REG(port, DIO_OFFSET_LOCK) = GPIO_LOCK_KEY;
+    GPIO_BIT(port, DIO_OFFSET_CR, pin) = 1;           // Unlock this specific pin
+
     // Disable alternate function and analog mode
-    *GET_GPIO_AFSEL(port) &= ~(1 << pin); // Disable alternate function
-    
-    // Disable analog mode (important for Port C and D)
-    if (port == 2 || port == 3) { // PORTC or PORTD
-        volatile unsigned long *amsel = (port == 2) ? 
-            (volatile unsigned long *)0x40006528 :  // PORTC AMSEL
-            (volatile unsigned long *)0x40007528;   // PORTD AMSEL
-        *amsel &= ~(1 << pin);
-    }
+    GPIO_BIT(port, DIO_OFFSET_AFSEL, pin) = 0;
+    GPIO_BIT(port, DIO_OFFSET_AMSEL, pin) = 0;
 
     // Set direction
-    if (direction) {
-        *GET_GPIO_DIR(port) |= (1 << pin); // Output
-    } else {
-        *GET_GPIO_DIR(port) &= ~(1 << pin); // Input
-    }
-    
-    *GET_GPIO_DEN(port) |= (1 << pin); // Enable digital function
-    *GET_GPIO_LOCK(port) = 0; // Lock again
+    GPIO_BIT(port, DIO_OFFSET_DIR, pin) = direction ? 1U : 0U;
+
+    GPIO_BIT(port, DIO_OFFSET_DEN, pin) = 1;          // Enable digital function
+    GPIO_REG(port, DIO_OFFSET_LOCK) = 0;              // Lock again
 }
 
 
@@ -123,10 +120,8 @@ void DIO_Init(uint8_t port, uint8_t pin, uint8_t direction) {
  * Sets the output value of a GPIO pin (HIGH or LOW).
  */
 void DIO_WritePin(uint8_t port, uint8_t pin, uint8_t value) {
-    if (value) {
-        *GET_GPIO_DATA(port) |= (1 << pin);
-    } else {
-        *GET_GPIO_DATA(port) &= ~(1 << pin);
+    if (DIO_VALID(port, pin)) {
+        DIO_DATA_PIN(port_base[port], pin) = value ? (1UL << pin) : 0UL;
     }
 }
 
@@ -136,7 +131,10 @@ void DIO_WritePin(uint8_t port, uint8_t pin, uint8_t value) {
  * Reads the current value of a GPIO pin (returns HIGH or LOW).
  */
 uint8_t DIO_ReadPin(uint8_t port, uint8_t pin) {
-    return ((*GET_GPIO_DATA(port) & (1 << pin)) != 0);
+    if (!DIO_VALID(port, pin)) {
+        return LOW;
+    }
+    return (DIO_DATA_PIN(port_base[port], pin) != 0UL) ? HIGH : LOW;
 }
 
 
@@ -145,7 +143,9 @@ uint8_t DIO_ReadPin(uint8_t port, uint8_t pin) {
  * Toggles the output value of a GPIO pin.
  */
 void DIO_TogglePin(uint8_t port, uint8_t pin) {
-    *GET_GPIO_DATA(port) ^= (1 << pin);
+    if (DIO_VALID(port, pin)) {
+        DIO_DATA_PIN(port_base[port], pin) ^= (1UL << pin);
+    }
 }
 
 
@@ -154,10 +154,8 @@ void DIO_TogglePin(uint8_t port, uint8_t pin) {
  * Enables or disables the internal pull-up resistor on a GPIO pin.
  */
 void DIO_SetPUR(uint8_t port, uint8_t pin, uint8_t enable) {
-    if (enable) {
-        *GET_GPIO_PUR(port) |= (1 << pin);
-    } else {
-        *GET_GPIO_PUR(port) &= ~(1 << pin);
+    if (DIO_VALID(port, pin)) {
+        GPIO_BIT(port, DIO_OFFSET_PUR, pin) = enable ? 1U : 0U;
     }
 }
 
@@ -166,9 +164,51 @@ void DIO_SetPUR(uint8_t port, uint8_t pin, uint8_t enable) {
  * Enables or disables the internal pull-down resistor on a GPIO pin.
  */
 void DIO_SetPDR(uint8_t port, uint8_t pin, uint8_t enable) {
-    if (enable) {
-        *GET_GPIO_PDR(port) |= (1 << pin);
-    } else {
-        *GET_GPIO_PDR(port) &= ~(1 << pin);
+    if (DIO_VALID(port, pin)) {
+        GPIO_BIT(port, DIO_OFFSET_PDR, pin) = enable ? 1U : 0U;
     }
 }
+
+
+/*
+ * DIO_AttachInterrupt
+ * The pin is masked while its sense is changed, and a stale edge is
+ * cleared before it is unmasked.
+ */
+void DIO_AttachInterrupt(uint8_t port, uint8_t pin, uint8_t edge, DIO_Callback callback) {
+    if (!DIO_VALID(port, pin) || callback == 0) {
+        return;
+    }
+
+    GPIO_BIT(port, DIO_OFFSET_IM, pin) = 0;
+    callbacks[port][pin] = callback;
+    GPIO_BIT(port, DIO_OFFSET_IS, pin) = 0;           // Edge, not level
+    GPIO_BIT(port, DIO_OFFSET_IBE, pin) = (edge == DIO_EDGE_BOTH) ? 1U : 0U;
+    GPIO_BIT(port, DIO_OFFSET_IEV, pin) = (edge == DIO_EDGE_RISING) ? 1U : 0U;
+    GPIO_REG(port, DIO_OFFSET_ICR) = (1U << pin);
+    GPIO_BIT(port, DIO_OFFSET_IM, pin) = 1;
+    NVIC_EN0_R |= port_nvic_bit[port];
+}
+
+/*
+ * DIO_DetachInterrupt
+ * The port interrupt stays enabled for the port's other pins.
+ */
+void DIO_DetachInterrupt(uint8_t port, uint8_t pin) {
+    if (DIO_VALID(port, pin)) {
+        GPIO_BIT(port, DIO_OFFSET_IM, pin) = 0;
+        callbacks[port][pin] = 0;
+    }
+}
+
+
+/*
+ * GPIOPortA_Handler .. GPIOPortF_Handler
+ * One entry per port in the vector table.
+ */
+void GPIOPortA_Handler(void) { Dispatch(PORTA); }
+void GPIOPortB_Handler(void) { Dispatch(PORTB); }
+void GPIOPortC_Handler(void) { Dispatch(PORTC); }
+void GPIOPortD_Handler(void) { Dispatch(PORTD); }
+void GPIOPortE_Handler(void) { Dispatch(PORTE); }
+void GPIOPortF_Handler(void) { Dispatch(PORTF); }
@@ -0,0 +1,216 @@
+/*****************************************************************************
+ * File: door.c
+ * Module: DOOR
+ * Description: Source file for the door lock state machines
+ *****************************************************************************/
+
+#include "door.h"
+#include "Servo.h"
+#include "systick.h"
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+typedef struct
+{
+    Door_State state;
+    uint32_t pulse_us;                  /* Pulse the servo is at */
+    uint32_t lock_at;                   /* Auto-lock deadline while opening or open */
+} Door_Lock;
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static Door_Lock doors[DOOR_COUNT];
+static uint32_t moves = 0;              /* Ramps run to the end */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * Step
+ * Moves one door's pulse a frame towards its target.
+ * Returns: 1 once the target is reached
+ */
+static uint8_t Step(uint8_t door, uint32_t target_us)
+{
+    Door_Lock *d = &doors[door];
+
+    if(d->pulse_us + DOOR_RAMP_US <= target_us)
+    {
+        d->pulse_us += DOOR_RAMP_US;
+    }
+    else if(d->pulse_us >= target_us + DOOR_RAMP_US)
+    {
+        d->pulse_us -= DOOR_RAMP_US;
+    }
+    else
+    {
+        d->pulse_us = target_us;
+    }
+    Servo_SetPulse(door, d->pulse_us);
+    return (d->pulse_us == target_us) ? 1U : 0U;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Door_Init
+ * Every door starts closed.
+ */
+void Door_Init(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < DOOR_COUNT; i++)
+    {
+        doors[i].state = DOOR_CLOSED;
+        doors[i].pulse_us = DOOR_CLOSED_US;
+        doors[i].lock_at = 0;
+        Servo_SetPulse(i, DOOR_CLOSED_US);
+    }
+    moves = 0;
+}
+
+/*
+ * Door_Open
+ * An open door just gets a fresh deadline.
+ */
+uint8_t Door_Open(uint8_t door, uint32_t timeout_s)
+{
+    if(door >= DOOR_COUNT)
+    {
+        return DOOR_ERROR;
+    }
+    if(doors[door].state != DOOR_OPEN)
+    {
+        doors[door].state = DOOR_OPENING;
+    }
+    doors[door].lock_at = SysTick_GetTicks() + (timeout_s * 1000U);
+    return DOOR_SUCCESS;
+}
+
+/*
+ * Door_Hold
+ * Adds to the time left rather than restarting it.
+ */
+uint8_t Door_Hold(uint8_t door, uint32_t timeout_s)
+{
+    uint32_t now = SysTick_GetTicks();
+    uint32_t remaining;
+
+    if(door >= DOOR_COUNT || (doors[door].state != DOOR_OPENING && doors[door].state != DOOR_OPEN))
+    {
+        return DOOR_ERROR;
+    }
+
+    remaining = ((int32_t)(doors[door].lock_at - now) > 0) ? (doors[door].lock_at - now) : 0U;
+    remaining += timeout_s * 1000U;
+    if(remaining > (DOOR_HOLD_MAX_S * 1000U))
+    {
+        remaining = DOOR_HOLD_MAX_S * 1000U;
+    }
+    doors[door].lock_at = now + remaining;
+    return DOOR_SUCCESS;
+}
+
+/*
+ * Door_Close
+ * Takes effect at the next Door_Service().
+ */
+uint8_t Door_Close(uint8_t door)
+{
+    if(door >= DOOR_COUNT)
+    {
+        return DOOR_ERROR;
+    }
+    if(doors[door].state != DOOR_CLOSED)
+    {
+        doors[door].state = DOOR_CLOSING;
+    }
+    return DOOR_SUCCESS;
+}
+
+/*
+ * Door_Service
+ * Doors that are not moving cost one comparison each.
+ */
+uint32_t Door_Service(void)
+{
+    uint32_t now = SysTick_GetTicks();
+    uint32_t closed = 0;
+    uint8_t i;
+
+    for(i = 0; i < DOOR_COUNT; i++)
+    {
+        Door_Lock *d = &doors[i];
+
+        if((d->state == DOOR_OPENING || d->state == DOOR_OPEN) && (int32_t)(now - d->lock_at) >= 0)
+        {
+            d->state = DOOR_CLOSING;
+        }
+
+        switch(d->state)
+        {
+        case DOOR_OPENING:
+            if(Step(i, DOOR_OPEN_US) != 0U)
+            {
+                d->state = DOOR_OPEN;
+                moves++;
+            }
+            break;
+        case DOOR_CLOSING:
+            if(Step(i, DOOR_CLOSED_US) != 0U)
+            {
+                d->state = DOOR_CLOSED;
+                closed |= 1UL << i;
+                moves++;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return closed;
+}
+
+/*
+ * Door_GetState
+ * Out-of-range doors read as closed.
+ */
+Door_State Door_GetState(uint8_t door)
+{
+    return (door < DOOR_COUNT) ? doors[door].state : DOOR_CLOSED;
+}
+
+/*
+ * Door_AnyOpen
+ * Opening and closing doors count as open.
+ */
+uint8_t Door_AnyOpen(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < DOOR_COUNT; i++)
+    {
+        if(doors[i].state != DOOR_CLOSED)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Door_GetMoves
+ */
+uint32_t Door_GetMoves(void)
+{
+    return moves;
+}
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * File: door.h
+ * Module: DOOR
+ * Description: Header file for the door lock state machines
+ *
+ * Control drives DOOR_COUNT doors, each on its own servo channel (door d
+ * on channel d, see Servo.h). Every door runs the same state machine:
+ *
+ *     CLOSED          --Door_Open-->             OPENING
+ *     OPENING         --reaches DOOR_OPEN_US-->  OPEN
+ *     OPENING, OPEN   --auto-lock, Door_Close--> CLOSING
+ *     CLOSING         --Door_Open-->             OPENING
+ *     CLOSING         --reaches DOOR_CLOSED_US-> CLOSED
+ *
+ * Moves ramp the pulse by DOOR_RAMP_US per servo frame. The PWM hardware
+ * holds every servo at its current pulse, and Door_Service() only steps
+ * the ones that are moving, so all doors move at once and a move on one
+ * never delays another.
+ *
+ * Each door has its own auto-lock deadline, started by Door_Open() with
+ * the door's timeout and pushed back by Door_Hold(). Door IDs here are
+ * 0-based; commands name them 1..DOOR_COUNT.
+ *****************************************************************************/
+
+#ifndef DOOR_H_
+#define DOOR_H_
+
+#include <stdint.h>
+#include "Servo.h"
+#include "password.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Return codes */
+#define DOOR_SUCCESS            0
+#define DOOR_ERROR              1
+
+/* Limited by the servo outputs and the timeout bytes in the settings record */
+#if (SERVO_COUNT < PASSWORD_DOOR_COUNT)
+#define DOOR_MAX_COUNT          SERVO_COUNT
+#else
+#define DOOR_MAX_COUNT          PASSWORD_DOOR_COUNT
+#endif
+
+#ifndef DOOR_COUNT
+#define DOOR_COUNT              4U
+#endif
+#if (DOOR_COUNT < 1) || (DOOR_COUNT > DOOR_MAX_COUNT)
+#error "DOOR_COUNT must be 1..DOOR_MAX_COUNT"
+#endif
+
+#define DOOR_FRAME_MS           20U     /* Door_Service() period: one servo frame */
+#define DOOR_CLOSED_US          1000U   /* 0 degrees */
+#define DOOR_OPEN_US            1500U   /* 90 degrees */
+#define DOOR_RAMP_US            50U     /* Per frame: a full move takes 200 ms */
+#define DOOR_HOLD_MAX_S         99U     /* Longest auto-lock delay, as on the HMI */
+
+typedef enum
+{
+    DOOR_CLOSED,
+    DOOR_OPENING,
+    DOOR_OPEN,
+    DOOR_CLOSING
+} Door_State;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Door_Init
+ * Puts every door in CLOSED at the closed pulse. Servo_Init() must have
+ * been called.
+ */
+void Door_Init(void);
+
+/*
+ * Door_Open
+ * Starts opening a door (or reverses a close) and sets its auto-lock
+ * deadline timeout_s seconds from now.
+ * Returns: DOOR_SUCCESS, or DOOR_ERROR for a door out of range
+ */
+uint8_t Door_Open(uint8_t door, uint32_t timeout_s);
+
+/*
+ * Door_Hold
+ * Pushes an opening or open door's auto-lock back by timeout_s seconds,
+ * to at most DOOR_HOLD_MAX_S from now.
+ * Returns: DOOR_SUCCESS, or DOOR_ERROR if the door is not open
+ */
+uint8_t Door_Hold(uint8_t door, uint32_t timeout_s);
+
+/*
+ * Door_Close
+ * Starts closing a door now; a closed door is left alone.
+ * Returns: DOOR_SUCCESS, or DOOR_ERROR for a door out of range
+ */
+uint8_t Door_Close(uint8_t door);
+
+/*
+ * Door_Service
+ * Runs the auto-lock deadlines and steps every moving door by one frame.
+ * Call every DOOR_FRAME_MS.
+ * Returns: a mask with bit d set for each door that finished closing
+ */
+uint32_t Door_Service(void);
+
+/*
+ * Door_GetState
+ * Returns: the state of a door (DOOR_CLOSED when out of range)
+ */
+Door_State Door_GetState(uint8_t door);
+
+/*
+ * Door_AnyOpen
+ * Returns: 1 if any door is not CLOSED
+ */
+uint8_t Door_AnyOpen(void);
+
+/*
+ * Door_GetMoves
+ * Returns: servo moves (fully opened or closed) since Door_Init()
+ */
+uint32_t Door_GetMoves(void);
+
+#endif /* DOOR_H_ */
@@ -18,6 +18,7 @@
  *****************************************************************************/
 
 #include "eeprom.h"
+#include "systick.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -27,10 +28,36 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/eeprom.h"
 
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static EEPROM_Stats stats;
+
 /******************************************************************************
  *                          Private Functions                                  *
  ******************************************************************************/
 
+/*
+ * Program
+ * EEPROMProgram(), timed: it waits for the EEPROM controller, so this is
+ * how long the caller was blocked.
+ */
+static uint32_t Program(uint32_t *data, uint32_t address, uint32_t length)
+{
+    uint32_t start = SysTick_GetMicros();
+    uint32_t result = EEPROMProgram(data, address, length);
+    uint32_t elapsed = SysTick_GetMicros() - start;
+
+    stats.writes++;
+    stats.total_us += elapsed;
+    if(elapsed > stats.max_us)
+    {
+        stats.max_us = elapsed;
+    }
+    return result;
+}
+
 /*
  * CalculateAddress
  * Calculates byte address from block and offset.
@@ -92,7 +119,7 @@ uint8_t EEPROM_WriteWord(uint32_t block, uint32_t offset, uint32_t data)
     address = CalculateAddress(block, offset);
     
     /* Write data using TivaWare function */
-    result = EEPROMProgram(&data, address, sizeof(uint32_t));
+    result = Program(&data, address, sizeof(uint32_t));
     
     if(result != 0)
     {
@@ -150,7 +177,7 @@ uint8_t EEPROM_WriteBuffer(uint32_t block, uint32_t offset, const uint8_t *buffe
     
     /* Write buffer using TivaWare function */
     /* Note: EEPROMProgram accepts uint32_t* so we cast, but data must be word-aligned */
-    result = EEPROMProgram((uint32_t*)buffer, address, length);
+    result = Program((uint32_t*)buffer, address, length);
     
     if(result != 0)
     {
@@ -206,3 +233,11 @@ uint8_t EEPROM_MassErase(void)
     
     return EEPROM_SUCCESS;
 }
+
+/*
+ * EEPROM_GetStats
+ */
+void EEPROM_GetStats(EEPROM_Stats *out)
+{
+    *out = stats;
+}
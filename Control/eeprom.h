@@ -46,6 +46,14 @@
 #define EEPROM_TOTAL_BLOCKS     32      /* 32 blocks total */
 #define EEPROM_TOTAL_SIZE       2048    /* 2KB total */
 
+/* Program operations (EEPROM_WriteWord / EEPROM_WriteBuffer) since reset */
+typedef struct
+{
+    uint32_t writes;
+    uint32_t total_us;      /* Sum of their durations */
+    uint32_t max_us;        /* Longest */
+} EEPROM_Stats;
+
 /******************************************************************************
  *                          Function Prototypes                                *
  ******************************************************************************/
@@ -110,4 +118,10 @@ uint8_t EEPROM_ReadBuffer(uint32_t block, uint32_t offset, uint8_t *buffer, uint
  */
 uint8_t EEPROM_MassErase(void);
 
+/*
+ * EEPROM_GetStats
+ * Copies the write counters.
+ */
+void EEPROM_GetStats(EEPROM_Stats *out);
+
 #endif /* EEPROM_H_ */
@@ -0,0 +1,132 @@
+/*****************************************************************************
+ * File: fmt.c
+ * Module: FMT
+ * Description: Source file for allocation-free text formatting
+ *****************************************************************************/
+
+#include "fmt.h"
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * Decimal
+ * Writes value's digits least significant first.
+ * Returns: the number of digits (at least one)
+ */
+static uint8_t Decimal(uint32_t value, char digits[FMT_UINT_DIGITS])
+{
+    uint8_t n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + (value % 10U));
+        value /= 10U;
+    } while(value != 0U);
+    return n;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Fmt_Begin
+ * The terminator is written at once, so an unused buffer reads as "".
+ */
+void Fmt_Begin(Fmt_Buffer *out, char *text, uint32_t size)
+{
+    out->text = text;
+    out->size = size;
+    out->length = 0;
+    out->overflow = 0;
+    text[0] = '\0';
+}
+
+/*
+ * Fmt_Char
+ * The one place that writes to the buffer.
+ */
+void Fmt_Char(Fmt_Buffer *out, char c)
+{
+    if(out->length + 1U >= out->size)
+    {
+        out->overflow = 1;
+        return;
+    }
+    out->text[out->length++] = c;
+    out->text[out->length] = '\0';
+}
+
+/*
+ * Fmt_String
+ * Stops at the first character that does not fit.
+ */
+void Fmt_String(Fmt_Buffer *out, const char *s)
+{
+    while(*s != '\0' && out->overflow == 0U)
+    {
+        Fmt_Char(out, *s++);
+    }
+}
+
+/*
+ * Fmt_Uint
+ * Same as a width of zero.
+ */
+void Fmt_Uint(Fmt_Buffer *out, uint32_t value)
+{
+    Fmt_UintWidth(out, value, 0, ' ');
+}
+
+/*
+ * Fmt_UintWidth
+ * Digits are produced backwards into a scratch array, then copied out.
+ */
+void Fmt_UintWidth(Fmt_Buffer *out, uint32_t value, uint8_t width, char pad)
+{
+    char digits[FMT_UINT_DIGITS];
+    uint8_t n = Decimal(value, digits);
+
+    while(width > n)
+    {
+        Fmt_Char(out, pad);
+        width--;
+    }
+    while(n > 0U)
+    {
+        Fmt_Char(out, digits[--n]);
+    }
+}
+
+/*
+ * Fmt_Hex
+ * Digit counts outside 1..8 are clamped.
+ */
+void Fmt_Hex(Fmt_Buffer *out, uint32_t value, uint8_t digits)
+{
+    uint32_t shift;
+
+    if(digits == 0U)
+    {
+        digits = 1;
+    }
+    if(digits > 8U)
+    {
+        digits = 8;
+    }
+    shift = (uint32_t)digits * 4U;
+    while(shift > 0U)
+    {
+        shift -= 4U;
+        Fmt_Char(out, hex_digits[(value >> shift) & 0x0FU]);
+    }
+}
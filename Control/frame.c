@@ -0,0 +1,84 @@
+/*****************************************************************************
+ * File: frame.c
+ * Module: FRAME
+ * Description: Source file for the incremental command line parser
+ *
+ * The old receive path copied each character into a line buffer, then
+ * cleared all of it with memset after every line, and measured the line
+ * again with strlen before each prefix. Here the length is kept as the
+ * line grows, so the per-line cost is one store per character plus one
+ * terminator.
+ *****************************************************************************/
+
+#include "frame.h"
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Frame_Init
+ * The buffer is not cleared; it is only ever read up to the terminator.
+ */
+void Frame_Init(Frame_Parser *parser, char *line, uint32_t size)
+{
+    parser->line = line;
+    parser->size = size;
+    Frame_Reset(parser);
+}
+
+/*
+ * Frame_Reset
+ * Only the length goes; stale characters are overwritten by the next line.
+ */
+void Frame_Reset(Frame_Parser *parser)
+{
+    parser->length = 0;
+    parser->discard = 0;
+}
+
+/*
+ * Frame_Push
+ * A discarded line keeps being consumed up to its end so that its tail is
+ * not taken for the next line.
+ */
+uint8_t Frame_Push(Frame_Parser *parser, char c, Frame_View *frame)
+{
+    if(c == FRAME_END)
+    {
+        uint8_t complete = (parser->discard == 0U) ? 1U : 0U;
+
+        if(complete != 0U)
+        {
+            parser->line[parser->length] = '\0';
+            frame->text = parser->line;
+            frame->length = parser->length;
+        }
+        Frame_Reset(parser);
+        return complete;
+    }
+
+    if(c != '\0' && parser->length < parser->size - 1U)
+    {
+        parser->line[parser->length++] = c;
+    }
+    else
+    {
+        parser->discard = 1;
+    }
+    return 0;
+}
+
+/*
+ * Frame_Skip
+ * Never runs past the end of the view.
+ */
+void Frame_Skip(Frame_View *view, uint32_t count)
+{
+    if(count > view->length)
+    {
+        count = view->length;
+    }
+    view->text += count;
+    view->length -= count;
+}
@@ -0,0 +1,106 @@
+/*****************************************************************************
+ * File: frame.h
+ * Module: FRAME
+ * Description: Header file for the incremental command line parser
+ *
+ * Characters are fed in one at a time as they come off the UART ring, and
+ * each completed line is handed back as a view (pointer, length) into the
+ * parser's own line buffer:
+ *
+ *     static char line[64];
+ *     static Frame_Parser parser;
+ *     Frame_View frame;
+ *
+ *     Frame_Init(&parser, line, sizeof(line));
+ *     ...
+ *     if(Frame_Push(&parser, c, &frame) != 0U)
+ *     {
+ *         if(FRAME_STARTS_WITH(frame, "PING:")) ...
+ *     }
+ *
+ * Every character is stored once and never moved again. Prefixes are
+ * taken off by advancing the view, and nothing is cleared between lines:
+ * only the length is reset, and the line is terminated where it ends, so
+ * the tail of a view can also be passed to functions taking a C string.
+ *
+ * A line longer than the buffer, or holding a NUL (which would cut short
+ * any argument used as a C string), is dropped as a whole at its '\n'; it
+ * is never handed over cut short.
+ *****************************************************************************/
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define FRAME_END               '\n'
+
+/*
+ * Frame_View
+ * Part of a received line. text[length] is always '\0'.
+ */
+typedef struct
+{
+    const char *text;
+    uint32_t    length;
+} Frame_View;
+
+/*
+ * Frame_Parser
+ * Line assembly state; the buffer is supplied by the owner.
+ */
+typedef struct
+{
+    char    *line;
+    uint32_t size;                      /* Longest line is size - 1 */
+    uint32_t length;
+    uint8_t  discard;                   /* Current line is too long or has a NUL */
+} Frame_Parser;
+
+/* Views against string literals, without a strlen at run time */
+#define FRAME_LITERAL_LENGTH(lit)       (sizeof(lit) - 1U)
+#define FRAME_EQUALS(view, lit)         ((view).length == FRAME_LITERAL_LENGTH(lit) && \
+                                         memcmp((view).text, (lit), FRAME_LITERAL_LENGTH(lit)) == 0)
+#define FRAME_STARTS_WITH(view, lit)    ((view).length >= FRAME_LITERAL_LENGTH(lit) && \
+                                         memcmp((view).text, (lit), FRAME_LITERAL_LENGTH(lit)) == 0)
+
+/* Nothing of a line received yet */
+#define FRAME_IDLE(parser)              ((parser)->length == 0U && (parser)->discard == 0U)
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Frame_Init
+ * Attaches a line buffer (at least 2 bytes) to a parser.
+ */
+void Frame_Init(Frame_Parser *parser, char *line, uint32_t size);
+
+/*
+ * Frame_Reset
+ * Forgets a partly received line.
+ */
+void Frame_Reset(Frame_Parser *parser);
+
+/*
+ * Frame_Push
+ * Adds one received character. On FRAME_END, sets *frame to the line
+ * (without the '\n') and returns 1. The view stays valid until the next
+ * call for this parser.
+ * Returns: 1 when a line is complete, otherwise 0
+ */
+uint8_t Frame_Push(Frame_Parser *parser, char c, Frame_View *frame);
+
+/*
+ * Frame_Skip
+ * Takes count characters off the front of a view.
+ */
+void Frame_Skip(Frame_View *view, uint32_t count);
+
+#endif /* FRAME_H_ */
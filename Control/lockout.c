@@ -0,0 +1,170 @@
+/*****************************************************************************
+ * File: lockout.c
+ * Module: LOCKOUT
+ * Description: Source file for the persistent failed-attempt counter
+ *****************************************************************************/
+
+#include "lockout.h"
+#include "eeprom.h"
+#include "systick.h"
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static uint32_t failures = 0;
+static uint32_t window_start = 0;   /* SysTick time the window opened */
+static uint32_t window_ms = 0;      /* Length of the current window */
+static uint8_t unsaved = 0;         /* failures differs from the EEPROM word */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * WindowFor
+ * Exponential backoff length for a given failure count.
+ */
+static uint32_t WindowFor(uint32_t count)
+{
+    uint32_t shift;
+
+    if(count < LOCKOUT_FREE_ATTEMPTS)
+    {
+        return 0;
+    }
+
+    shift = count - LOCKOUT_FREE_ATTEMPTS;
+    if(shift >= 8U || (LOCKOUT_BASE_MS << shift) > LOCKOUT_MAX_MS)
+    {
+        return LOCKOUT_MAX_MS;
+    }
+    return LOCKOUT_BASE_MS << shift;
+}
+
+/*
+ * OpenWindow
+ * Starts the window for the current failure count at the present tick.
+ */
+static void OpenWindow(void)
+{
+    window_start = SysTick_GetTicks();
+    window_ms = WindowFor(failures);
+}
+
+/*
+ * Store
+ * Writes the counter. On failure keeps a window of at least
+ * LOCKOUT_BASE_MS open, so no password is checked until it is stored.
+ */
+static uint8_t Store(void)
+{
+    if(EEPROM_WriteWord(LOCKOUT_EEPROM_BLOCK, LOCKOUT_EEPROM_OFFSET, failures) != EEPROM_SUCCESS)
+    {
+        unsaved = 1;
+        window_start = SysTick_GetTicks();
+        if(window_ms < LOCKOUT_BASE_MS)
+        {
+            window_ms = LOCKOUT_BASE_MS;
+        }
+        return LOCKOUT_ERROR;
+    }
+    unsaved = 0;
+    return LOCKOUT_SUCCESS;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Lockout_Init
+ * A blank EEPROM word (0xFFFFFFFF) counts as no failures.
+ */
+uint8_t Lockout_Init(void)
+{
+    uint32_t stored = 0;
+
+    if(EEPROM_ReadWord(LOCKOUT_EEPROM_BLOCK, LOCKOUT_EEPROM_OFFSET, &stored) != EEPROM_SUCCESS)
+    {
+        return LOCKOUT_ERROR;
+    }
+
+    failures = (stored == 0xFFFFFFFFU) ? 0U : stored;
+    OpenWindow();
+    return LOCKOUT_SUCCESS;
+}
+
+/*
+ * Lockout_RemainingMs
+ * Wrap-safe elapsed-time check against the open window.
+ */
+uint32_t Lockout_RemainingMs(void)
+{
+    uint32_t elapsed;
+
+    if(window_ms == 0U)
+    {
+        return 0;
+    }
+
+    elapsed = SysTick_GetTicks() - window_start;
+    if(elapsed >= window_ms)
+    {
+        window_ms = 0;      /* Window over, skip the subtraction next time */
+        if(unsaved != 0U && Store() != LOCKOUT_SUCCESS)
+        {
+            return window_ms;
+        }
+        return 0;
+    }
+    return window_ms - elapsed;
+}
+
+/*
+ * Lockout_RemainingSeconds
+ * Rounded up so a reply never says 0 while still locked.
+ */
+uint32_t Lockout_RemainingSeconds(void)
+{
+    return (Lockout_RemainingMs() + 999U) / 1000U;
+}
+
+/*
+ * Lockout_RecordFailure
+ * Saturates instead of wrapping back to zero.
+ */
+uint8_t Lockout_RecordFailure(void)
+{
+    if(failures < 0xFFFFFFFEU)
+    {
+        failures++;
+    }
+    OpenWindow();
+    return Store();
+}
+
+/*
+ * Lockout_RecordSuccess
+ * Only touches the EEPROM when there is something to clear.
+ */
+uint8_t Lockout_RecordSuccess(void)
+{
+    window_ms = 0;
+    if(failures == 0U && unsaved == 0U)
+    {
+        return LOCKOUT_SUCCESS;
+    }
+    failures = 0;
+    return Store();
+}
+
+/*
+ * Lockout_GetFailures
+ * Consecutive failures since the last correct password.
+ */
+uint32_t Lockout_GetFailures(void)
+{
+    return failures;
+}
@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * File: lockout.h
+ * Module: LOCKOUT
+ * Description: Header file for the persistent failed-attempt counter
+ *
+ * The Control ECU is the authority on failed password attempts. The counter
+ * lives in EEPROM so neither an HMI reboot nor a Control reboot clears it.
+ * After LOCKOUT_FREE_ATTEMPTS failures every further failure opens a
+ * lockout window that doubles each time:
+ *
+ *     window(n) = LOCKOUT_BASE_MS << (n - LOCKOUT_FREE_ATTEMPTS)
+ *
+ * capped at LOCKOUT_MAX_MS. Windows are measured on the SysTick tick, so
+ * nothing blocks while one is running. A reboot during a window restarts
+ * the full window rather than shortening it.
+ *
+ * A counter that only lives in RAM would be cleared by a reset, so a
+ * failed EEPROM write fails closed: a window of at least LOCKOUT_BASE_MS
+ * opens, and the write is retried each time one ends.
+ *****************************************************************************/
+
+#ifndef LOCKOUT_H_
+#define LOCKOUT_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Return codes */
+#define LOCKOUT_SUCCESS         0
+#define LOCKOUT_ERROR           1
+
+/* EEPROM placement of the failure counter (one word) */
+#define LOCKOUT_EEPROM_BLOCK    2
+#define LOCKOUT_EEPROM_OFFSET   0
+
+/* Backoff policy */
+#define LOCKOUT_FREE_ATTEMPTS   3U          /* Failures before the first window */
+#define LOCKOUT_BASE_MS         5000U       /* First window */
+#define LOCKOUT_MAX_MS          600000U     /* Cap: 10 minutes */
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Lockout_Init
+ * Loads the failure counter from EEPROM and re-arms the window if the
+ * counter is already past the free attempts. Requires the SysTick tick.
+ * Returns: LOCKOUT_SUCCESS or LOCKOUT_ERROR
+ */
+uint8_t Lockout_Init(void);
+
+/*
+ * Lockout_RemainingMs
+ * Milliseconds until password attempts are accepted again (0 = open).
+ * Retries an unsaved counter once its window has run out.
+ */
+uint32_t Lockout_RemainingMs(void);
+
+/*
+ * Lockout_RemainingSeconds
+ * Lockout_RemainingMs() rounded up to whole seconds, for replies.
+ */
+uint32_t Lockout_RemainingSeconds(void);
+
+/*
+ * Lockout_RecordFailure
+ * Counts a wrong password, persists the counter and opens the next window.
+ * Returns: LOCKOUT_SUCCESS, or LOCKOUT_ERROR if the counter was not stored
+ */
+uint8_t Lockout_RecordFailure(void);
+
+/*
+ * Lockout_RecordSuccess
+ * Clears the counter after a correct password.
+ * Returns: LOCKOUT_SUCCESS, or LOCKOUT_ERROR if the counter was not stored
+ *          (treat the password as refused)
+ */
+uint8_t Lockout_RecordSuccess(void);
+
+/*
+ * Lockout_GetFailures
+ * Consecutive failures since the last correct password.
+ */
+uint32_t Lockout_GetFailures(void);
+
+#endif /* LOCKOUT_H_ */
@@ -1,6 +1,5 @@
 #include <stdint.h>
 #include <string.h>
-#include <stdio.h>
 #include "tm4c123gh6pm.h"
 #include "uart.h"      // Must contain UART0_Init (which maps to UART2)
 #include "dio.h"
@@ -8,31 +7,100 @@
 #include "eeprom.h"
 #include "buzzer.h"
 #include "Servo.h"
-
-/* --- DEFINES --- */
-#define PASSWORD_MAX_LENGTH     20
-#define EEPROM_PASSWORD_BLOCK   0
-#define EEPROM_PASSWORD_OFFSET  0
-#define EEPROM_TIMEOUT_BLOCK    1
-#define EEPROM_TIMEOUT_OFFSET   0
+#include "password.h"
+#include "lockout.h"
+#include "auditlog.h"
+#include "sched.h"
+#include "crc16.h"
+#include "bus.h"
+#include "door.h"
+#include "fmt.h"
+#include "pattern.h"
+#include "frame.h"
+#include "command.h"
+#include "trace.h"
+#include "boot.h"
+#include "stats.h"
+#include "wdt.h"
 
 /* --- MAGIC NUMBER CONSTANTS (VIOLATION FIX #3) --- */
-#define GPIO_RED_LED            0x02U
-#define GPIO_GREEN_LED          0x08U
 #define GPIO_LED_ALL            0x0EU
 #define GPIO_PORTD_UART_MASK    0xC0U
-#define GPIO_PORTB_SERVO_MASK   0x40U
-#define RX_BUFFER_SIZE          50U
-#define RX_BUFFER_MAX_INDEX     49U
+#define RX_BUFFER_SIZE          COMMAND_LINE_SIZE
+#define AUDIT_LINE_SIZE         17U     /* 16 hex digits, terminator */
+#define AUDIT_DUMP_RECORDS      2U      /* Per CommTask pass: ~4 ms of line at 115200 */
+#define REPLY_PREFIX_SIZE       (BUS_ADDRESS_LENGTH + COMMAND_SEQ_LENGTH + 1U)
 #define SYSCTL_GPIO_ENABLE_MASK 0x2AU
 #define DELAY_CALIBRATION_MS    3180U
 #define DELAY_CALIBRATION_US    3U
-#define SERVO_PULSE_90DEG       1500U
-#define SERVO_PULSE_0DEG        1000U
-#define SERVO_PERIOD_HIGH_90    18500U
-#define SERVO_PERIOD_HIGH_0     19000U  
 
+/* --- SCHEDULER TASKS AND EVENTS --- */
+#define COMM_PERIOD_MS          1U      /* Command latency; UART2_Handler buffers between polls */
+#define DOOR_PERIOD_MS          DOOR_FRAME_MS   /* One ramp step per servo frame */
+#define AUDIT_PERIOD_MS         100U
+#define STATS_PERIOD_MS         STATS_SAMPLE_MS
+
+/* --- WATCHDOG (see wdt.h): the longest a watched task may go unrun --- */
+#define COMM_DEADLINE_MS        250U    /* SETPWD hashes for ~80 ms in one slice */
+#define DOOR_DEADLINE_MS        250U
+#define AUDIT_DEADLINE_MS       1000U
+
+/* --- LINK RATE (see "BAUD:" and "PING:" in ProcessCommand) --- */
+#define BAUD_PROBE_WINDOW_MS    500U    /* New rate must be committed within this */
+#define UART_ERROR_LIMIT        4U      /* Receive errors in a row before falling back */
+
+/* --- LINK HEALTH (see "HB:" in ProcessCommand) --- */
+#define PEER_TIMEOUT_MS         500U    /* Silence after which a beating panel is gone */
+
+#define DOOR_EVENT_OPEN             (SCHED_EVENT_USER + 0U)
+#define DOOR_EVENT_CLOSE            (SCHED_EVENT_USER + 1U)
+#define DOOR_EVENT_HOLD             (SCHED_EVENT_USER + 2U)
+
+/* --- FEEDBACK (played from the Timer1A interrupt by pattern.c) --- */
+#define TRACK_ALARM             0U      /* Lowest track: its buzzer pitch wins */
+#define TRACK_STATUS            1U      /* Command results */
+#define TRACK_DOOR              2U      /* Green while any door is open */
+
+/* --- ON-TARGET SELF TEST --- */
+/* SELF_TEST=1 links test_unit.c and runs it once the scheduler is idle, after
+   boot (needs the PD6-PD7 wire). Testing/Host runs the same suite on a PC. */
+#ifndef SELF_TEST
+#define SELF_TEST               0
+#endif
+
+#if SELF_TEST
 extern void Run_Unit_Tests(void);
+void SelfTestTask(const Sched_Event *event);
+#endif
+
+/* WDT_ENABLE=1 supervises the scheduler with Watchdog Timer 0. SELF_TEST
+   builds leave it off: the suite runs for seconds in a single slice. */
+#ifndef WDT_ENABLE
+#define WDT_ENABLE              (!SELF_TEST)
+#endif
+
+/* --- CLOCKS (all of them at once, see boot.h) --- */
+static const Boot_Clocks clocks =
+{
+    (TRACE_ENABLE ? 0x01U : 0U) | 0x3AU,        /* GPIO A (trace), B, D, E, F */
+    (TRACE_ENABLE ? 0x01U : 0U) | 0x04U,        /* UART0 (trace), UART2 */
+    SYSCTL_RCGCTIMER_R1,                        /* Pattern player */
+    SYSCTL_RCGCPWM_R0 | (BUZZER_PWM ? SYSCTL_RCGCPWM_R1 : 0U),
+    0U,
+    SYSCTL_RCGCEEPROM_R0
+};
+
+/* Per-sender state. Index BUS_NODE_NONE is the point-to-point link, the
+   others are the panels on the RS-485 bus. The lockout counter stays
+   global: it protects the doors, whichever panel is used. */
+typedef struct
+{
+    uint8_t authenticated;              /* Verified for a settings change */
+    uint8_t door;                       /* ... of this door */
+    uint8_t online;                     /* Heartbeats arriving */
+    uint32_t heard_at;                  /* SysTick_GetTicks() of the last one */
+    uint32_t peer_uptime;               /* Panel uptime it carried (ms) */
+} Session;
 
 /* --- FUNCTION PROTOTYPES --- */
 void System_Init(void);
@@ -45,230 +113,671 @@ int  UART2_Available(void);
 
 void Delay_ms(uint32_t ms);
 void Delay_us(uint32_t us);
-int  stringToInt(const char* str);
-void Servo_Update(int open);
+void SendReply(const char *reply);
+void SendReplyParts(const char *head, const char *tail);
+void SendReplyWithNumber(const char *reply, uint32_t value);
+void SendLogRecord(const AuditLog_Record *record);
+uint8_t ContinueAuditDump(void);
+void HandleLine(Frame_View line);
+void ProcessCommand(const Command *command);
+uint8_t CheckPassword(const char *candidate);
+void StartLockoutAlarm(void);
+void EndDoorSessions(uint8_t closed_door);
+void ExpireSessions(void);
+void FallBackToDefaultBaud(void);
+void CommTask(const Sched_Event *event);
+void DoorTask(const Sched_Event *event);
+void AuditTask(const Sched_Event *event);
+void TraceTask(const Sched_Event *event);
+void StatsTask(const Sched_Event *event);
+void WatchdogTask(const Sched_Event *event);
 
 /* --- GLOBAL VARIABLES --- */
-char master_password[PASSWORD_MAX_LENGTH];
-uint32_t auto_lock_timeout = 5;
-int servo_open = 0; // 0 = Closed (0 deg), 1 = Open (90 deg)
-int authenticated = 0; // 0 = Not authenticated, 1 = Authenticated for settings changes
+
+/* Sessions, and the one of the sender whose command is being processed */
+static Session sessions[BUS_NODE_COUNT + 1U];
+static Session *session = &sessions[BUS_NODE_NONE];
+
+/* Door (0-based) the command being processed is for; door 1 unless named */
+static uint8_t door = 0;
+
+/* Command line being received; handlers get views into rx_line */
+static char rx_line[RX_BUFFER_SIZE];
+static Frame_Parser rx_frame;
+
+/* "#NN" (bus) and "@SS " of the request being processed, echoed on its
+   reply; empty for legacy unprefixed commands */
+static char reply_prefix[REPLY_PREFIX_SIZE] = "";
+
+/* "AUDIT?" dump under way: a few records go out per CommTask pass, each
+   behind the prefix of the request */
+static uint8_t dumping = 0;
+static AuditLog_Cursor dump_cursor;
+static uint32_t dump_sent = 0;
+static char dump_prefix[REPLY_PREFIX_SIZE] = "";
+
+/* Link rate bring-up: a rate switched to by "BAUD:" stays only once the
+   HMI commits it; receive errors count towards a fallback to 115200 */
+static uint8_t baud_probing = 0;
+static uint32_t baud_probe_until = 0;
+static uint32_t rx_errors = 0;
+
+/* Scheduler handles */
+static uint8_t comm_task = SCHED_INVALID;
+static uint8_t door_task = SCHED_INVALID;
+static uint8_t audit_task = SCHED_INVALID;
+
+/* Feedback patterns; a new one on a track replaces the one playing */
+static const Pattern_Step pattern_saved[] = {
+    PATTERN_STEP(PATTERN_GREEN, 1000U),
+    PATTERN_END
+};
+static const Pattern_Step pattern_error[] = {
+    PATTERN_STEP(PATTERN_RED, 1000U),
+    PATTERN_END
+};
+static const Pattern_Step pattern_denied[] = {
+    PATTERN_STEP(PATTERN_RED, 500U),
+    PATTERN_END
+};
+static const Pattern_Step pattern_door_open[] = {
+    PATTERN_STEP(PATTERN_GREEN, 1000U),
+    PATTERN_REPEAT
+};
+static const Pattern_Step pattern_alarm[] = {   /* 1 s two-tone siren */
+    PATTERN_TONE(PATTERN_RED | PATTERN_BUZZER, 2500U, 125U),
+    PATTERN_TONE(PATTERN_RED | PATTERN_BUZZER, 2000U, 125U),
+    PATTERN_TONE(PATTERN_RED | PATTERN_BUZZER, 2500U, 125U),
+    PATTERN_TONE(PATTERN_RED | PATTERN_BUZZER, 2000U, 125U),
+    PATTERN_TONE(PATTERN_RED | PATTERN_BUZZER, 2500U, 125U),
+    PATTERN_TONE(PATTERN_RED | PATTERN_BUZZER, 2000U, 125U),
+    PATTERN_TONE(PATTERN_RED | PATTERN_BUZZER, 2500U, 125U),
+    PATTERN_TONE(PATTERN_RED | PATTERN_BUZZER, 2000U, 125U),
+    PATTERN_END
+};
 
 int main(void)
 {
-    // 1. Initialize Hardware
+    // 0. A watchdog reset left a record of what hung; logged once EEPROM is up
+    uint8_t watchdog_reset = Wdt_Init();
+
+    // 1. Initialize Hardware, every clock first; the EEPROM powers up meanwhile
+    SysTick_Init(SYSTICK_RELOAD_1MS, SYSTICK_INT); // 1 ms tick for lockout windows
+    Boot_EnableClocks(&clocks);
+#if WDT_ENABLE
+    Wdt_Start(); // From here a hang, the EEPROM_ERROR stops included, resets the unit
+#endif
+    Boot_Mark("clocks");
     System_Init();
     Buzzer_Init();
-    Servo_Init();
+    Pattern_Init(); // LED and buzzer feedback runs from Timer1A
+    Servo_Init();  // PWM keeps every servo pulsed from here on
     // 2. Initialize UART FIRST before anything else
+    Trace_Init("CONTROL"); // Link capture on UART0 (TRACE_ENABLE builds)
     UART2_Init(); // Initializes UART2 (PD6/PD7)
-    
-    // Send startup message to verify UART is working
-    UART2_SendString("CONTROL_READY\n");
+    Frame_Init(&rx_frame, rx_line, sizeof(rx_line));
+    Boot_Mark("drivers");
 
     // 3. Initialize EEPROM
     if(EEPROM_Init() != EEPROM_SUCCESS) {
         // Fatal Error: Turn on Red LED and signal via UART
         GPIO_PORTF_DATA_R |= 0x02;  // Red LED
         UART2_SendString("EEPROM_ERROR\n");
-        while(1); 
+        while(1); // WDT_ENABLE builds: the watchdog resets the unit to retry
     }
 
-    /* --- VIOLATION FIX #1 (MISRA C 2012 Rule 21.3) --- */
-    /* BEFORE: Used strncpy without null termination guarantee */
-    /* AFTER: Added explicit buffer zeroing and null termination */
-    uint8_t read_buffer[PASSWORD_MAX_LENGTH];
-    memset(read_buffer, 0, PASSWORD_MAX_LENGTH);
-
-    if(EEPROM_ReadBuffer(EEPROM_PASSWORD_BLOCK, EEPROM_PASSWORD_OFFSET, read_buffer, PASSWORD_MAX_LENGTH) == EEPROM_SUCCESS) {
-        /* Safe string copy with explicit null termination */
-        strncpy(master_password, (char*)read_buffer, PASSWORD_MAX_LENGTH - 1U);
-        master_password[PASSWORD_MAX_LENGTH - 1U] = '\0'; /* Ensure null termination */
+    // 4. Load the password record (converts a legacy plaintext block, or
+    //    programs the default "12345" into a blank EEPROM)
+    if(Password_Init() != PASSWORD_SUCCESS) {
+        GPIO_PORTF_DATA_R |= 0x02;  // Red LED
+        UART2_SendString("EEPROM_ERROR\n");
+        while(1);
     }
-    
-    // Set default "12345" if EEPROM is empty (0xFF) or null
-    if(master_password[0] == '\0' || (unsigned char)master_password[0] == 0xFF) {
-        strcpy(master_password, "12345");
+
+    // Restore the failed-attempt counter (survives reboots of either ECU)
+    if(Lockout_Init() != LOCKOUT_SUCCESS) {
+        GPIO_PORTF_DATA_R |= 0x02;  // Red LED
+        UART2_SendString("EEPROM_ERROR\n");
+        while(1);
     }
 
-    // 5. Load Timeout from EEPROM
-    EEPROM_ReadWord(EEPROM_TIMEOUT_BLOCK, EEPROM_TIMEOUT_OFFSET, &auto_lock_timeout);
-    // Sanity check: if invalid, set default 5 seconds
-    if(auto_lock_timeout == 0xFFFFFFFF || auto_lock_timeout > 60) {
-        auto_lock_timeout = 5;
+    // Locate the audit log write position (a failure only disables logging)
+    AuditLog_Init();
+    AuditLog_Append(AUDIT_EVENT_BOOT, watchdog_reset ? AUDIT_RESULT_WATCHDOG : AUDIT_RESULT_OK);
+    Boot_Mark("eeprom");
+
+    // 5. All doors closed; their timeouts are read from the password record
+    //    each time one opens
+    Door_Init();
+
+#if UART2_RS485
+    Bus_Init(); // CommTask polls the panels from here on
+#endif
+
+    // 6. Hand over to the scheduler: UART commands first, then the door,
+    //    then EEPROM housekeeping
+    Sched_Init();
+    comm_task = Sched_AddTask(CommTask, SCHED_PRIORITY_HIGH, COMM_PERIOD_MS);
+    door_task = Sched_AddTask(DoorTask, SCHED_PRIORITY_NORMAL, DOOR_PERIOD_MS);
+    audit_task = Sched_AddTask(AuditTask, SCHED_PRIORITY_LOW, AUDIT_PERIOD_MS);
+    Sched_AddTask(StatsTask, SCHED_PRIORITY_LOW, STATS_PERIOD_MS);
+    // Lowest priority, so starving it stops the reloads as well
+    Sched_AddTask(WatchdogTask, SCHED_PRIORITY_LOW, WDT_SERVICE_MS);
+#if WDT_ENABLE
+    // Not in SELF_TEST builds: SelfTestTask starves these for seconds, and
+    // the suite's own watchdog test would find them late
+    Wdt_Watch(comm_task, COMM_DEADLINE_MS);
+    Wdt_Watch(door_task, DOOR_DEADLINE_MS);
+    Wdt_Watch(audit_task, AUDIT_DEADLINE_MS);
+#endif
+#if TRACE_ENABLE
+    Sched_AddTask(TraceTask, SCHED_PRIORITY_LOW, TRACE_SERVICE_MS);
+#endif
+#if SELF_TEST
+    // Once nothing else is ready; the unit is fully up by then
+    Sched_Post(Sched_AddTask(SelfTestTask, SCHED_PRIORITY_LOW, 0), SCHED_EVENT_USER, 0);
+#endif
+
+    // Tell the HMI once commands can be answered
+    UART2_SendString("CONTROL_READY\n");
+    Boot_Mark("ready");
+    Sched_Run();
+}
+
+/* --- SCHEDULER TASKS --- */
+
+/* Drains UART2 and runs at most one complete command per slice. On the
+   RS-485 bus it also keeps the panel polling going. */
+void CommTask(const Sched_Event *event)
+{
+    (void)event;
+    Wdt_CheckIn(comm_task);
+
+    /* A dump holds the link until LOG_END: no other reply or poll goes
+       out between its lines */
+    if(ContinueAuditDump() != 0U)
+    {
+        return;
     }
 
-    /* UART Buffer with proper sized constant (VIOLATION FIX #3) */
-    char rx_buffer[RX_BUFFER_SIZE];
-    int rx_index = 0;
+#if UART2_RS485
+    Bus_Service();
+#endif
 
-    Run_Unit_Tests();
+    /* An uncommitted rate expires: the HMI gave up on it or never got here */
+    if(baud_probing != 0U && (int32_t)(SysTick_GetTicks() - baud_probe_until) >= 0)
+    {
+        FallBackToDefaultBaud();
+    }
+    ExpireSessions();
+
+    while(UART2_Available())
+    {
+        char c;
+        Frame_View line;
+        uint32_t rx_status = UART2_ReadCharStatus(&c);
 
-    while(1)
+        // 0. Receive errors: the HMI sends a break when it abandons a rate;
+        //    repeated framing/overrun errors mean the rate is not holding.
+        //    Either way the partial line is dropped.
+        if(rx_status != 0U)
         {
-            // --- 1. NON-BLOCKING UART RECEIVE ---
-            while(UART2_Available())
+            rx_errors++;
+            if((rx_status & UART2_RX_BREAK) != 0U || rx_errors >= UART_ERROR_LIMIT)
             {
-                char c = UART2_ReadChar(); 
-                
-                // --- SINGLE CHARACTER COMMANDS ---
-                
-                // 1. Lockout Signal
-                if (c == 'L') 
-                {
-                    GPIO_PORTF_DATA_R |= GPIO_RED_LED;    /* Red LED On (VIOLATION FIX #3) */
-                    Buzzer_Beep(1000);                    /* Beep 1s */
-                    GPIO_PORTF_DATA_R &= ~GPIO_RED_LED;   /* Red LED Off (VIOLATION FIX #3) */
-                    rx_index = 0;
-                    memset(rx_buffer, 0, sizeof(rx_buffer));
-                    continue; 
-                }
-                
+                FallBackToDefaultBaud();
+            }
+            Frame_Reset(&rx_frame);
+            continue;
+        }
+        
+#if !UART2_RS485
+        // --- SINGLE CHARACTER COMMANDS ---
+        
+        // 1. Lockout Signal: alarm for 1s without blocking the link.
+        //    Only between lines, so the 'L' in "CLOSE" is just a character.
+        //    (On the bus it arrives as the line "#NNL", see HandleLine.)
+        if (c == 'L' && FRAME_IDLE(&rx_frame)) 
+        {
+            StartLockoutAlarm();
+            continue; 
+        }
+#endif
+
+        if(Frame_Push(&rx_frame, c, &line) != 0U) // End of command
+        {
+            rx_errors = 0;
+            HandleLine(line);
+#if UART2_RS485
+            Bus_Service(); /* Poll the next panel at once */
+#endif
+            return; /* One command per slice keeps slices short */
+        }
+    }
+}
+
+/* Opens, holds and closes the doors (event param = door). Each period
+   moves every moving door one step and runs the auto-lock deadlines. */
+void DoorTask(const Sched_Event *event)
+{
+    uint8_t target = (uint8_t)event->param;
+    uint32_t closed;
+    uint8_t i;
 
-            
-            if(c == '\n') // End of command
+    Wdt_CheckIn(door_task);
+    if(event->code == DOOR_EVENT_OPEN)
+    {
+        (void)Door_Open(target, Password_GetTimeout(target));
+        Pattern_Play(TRACK_DOOR, pattern_door_open); /* Green LED ON while any door is open */
+    }
+    else if(event->code == DOOR_EVENT_CLOSE)
+    {
+        (void)Door_Close(target);
+    }
+    else if(event->code == DOOR_EVENT_HOLD)
+    {
+        (void)Door_Hold(target, Password_GetTimeout(target));
+    }
+    else
+    {
+        closed = Door_Service();
+        for(i = 0; i < DOOR_COUNT; i++)
+        {
+            if((closed & (1UL << i)) != 0U)
             {
-                rx_buffer[rx_index] = '\0'; // Null terminate
-                
-                // --- PARSE COMMAND ---
-                
-                /* A. SET NEW PASSWORD */
-                if(strncmp(rx_buffer, "SETPWD:", 7) == 0) 
-                {
-                    char *new_pass = rx_buffer + 7;
-                    if(strlen(new_pass) < PASSWORD_MAX_LENGTH) {
-                        /* VIOLATION FIX #1 (MISRA C 2012 Rule 21.3): Replace unsafe strcpy with strncpy and explicit null termination */
-                        strncpy(master_password, new_pass, PASSWORD_MAX_LENGTH - 1U);
-                        master_password[PASSWORD_MAX_LENGTH - 1U] = '\0'; /* Ensure null termination */
-                        
-                        /* Prepare buffer for EEPROM with safe copy */
-                        memset(read_buffer, 0, PASSWORD_MAX_LENGTH);
-                        strncpy((char*)read_buffer, master_password, PASSWORD_MAX_LENGTH - 1U);
-                        ((char*)read_buffer)[PASSWORD_MAX_LENGTH - 1U] = '\0';
-                        
-                        /* Write to EEPROM */
-                        if(EEPROM_WriteBuffer(EEPROM_PASSWORD_BLOCK, EEPROM_PASSWORD_OFFSET, read_buffer, PASSWORD_MAX_LENGTH) == EEPROM_SUCCESS) {
-                            UART2_SendString("PWD_SAVED\n");
-                            /* Success Signal: Green LED Flash (VIOLATION FIX #3) */
-                            GPIO_PORTF_DATA_R |= GPIO_GREEN_LED; 
-                            Delay_ms(1000); 
-                            GPIO_PORTF_DATA_R &= ~GPIO_GREEN_LED;
-                        } else {
-                            UART2_SendString("PWD_ERROR\n");
-                            /* Error Signal: Red LED Flash (VIOLATION FIX #3) */
-                            GPIO_PORTF_DATA_R |= GPIO_RED_LED; 
-                            Delay_ms(1000); 
-                            GPIO_PORTF_DATA_R &= ~GPIO_RED_LED;
-                        }
-                    } else {
-                        UART2_SendString("PWD_TOO_LONG\n");
-                    }
-                }
-                /* B. SET TIMEOUT (only accept if authenticated) */
-                else if(strncmp(rx_buffer, "TIMEOUT:", 8) == 0)
-                {
-                    /* VIOLATION FIX #4 (CERT C DCL04-C): Add explicit comparison against enumerated value */
-                    if(authenticated != 0) /* Only allow if user has verified password */
-                    {
-                        auto_lock_timeout = stringToInt(rx_buffer + 8);
-                        if(EEPROM_WriteWord(EEPROM_TIMEOUT_BLOCK, EEPROM_TIMEOUT_OFFSET, auto_lock_timeout) == EEPROM_SUCCESS) {
-                            UART2_SendString("TIMEOUT_SAVED\n");
-                        } else {
-                            UART2_SendString("TIMEOUT_ERROR\n");
-                        }
-                        authenticated = 0; // Clear authentication flag after use
-                    }
-                    else
-                    {
-                        UART2_SendString("TIMEOUT_DENIED\n"); // User not authenticated
-                    }
-                }
-                /* C. AUTHENTICATE PASSWORD FOR SETTINGS (no door open) */
-                else if(strncmp(rx_buffer, "VERIFYPWD:", 10) == 0)
-                {
-                    /* Check against current master password */
-                    if(strcmp(master_password, rx_buffer + 10) == 0) {
-                        UART2_SendString("AUTH_OK\n");
-                        authenticated = 1; /* Set authentication flag for settings changes */
-                        // Note: No door open, just authenticate for settings
-                    } else {
-                        UART2_SendString("AUTH_FAILED\n");
-                        authenticated = 0;
-                    }
-                }
-                /* D. VERIFY PASSWORD (opens door) */
-                else if(strncmp(rx_buffer, "VERIFY:", 7) == 0)
-                {
-                    /* Check against current master password */
-                    if(strcmp(master_password, rx_buffer + 7) == 0) {
-                        UART2_SendString("ALLOW\n");
-                        GPIO_PORTF_DATA_R |= GPIO_GREEN_LED; /* Green LED ON (VIOLATION FIX #3) */
-                        authenticated = 1; /* Set authentication flag for settings changes */
-                        
-                        /* 1. Clear buffer immediately to ensure we catch the fresh "CLOSE" command */
-                        rx_index = 0;
-                        memset(rx_buffer, 0, sizeof(rx_buffer));
-
-                        /* 2. DOOR OPEN LOOP - Stay here until "CLOSE" is received */
-                        while(1) 
-                        {
-                             /* Keep energizing the Servo to hold it Open (90 deg) */
-                             Servo_SetAngle(90); 
-                             
-                             /* Check UART for "CLOSE" command */
-                             if(UART2_Available()) 
-                             {
-                                 char c = UART2_ReadChar();
-                                 if(c == '\n') 
-                                 {
-                                     rx_buffer[rx_index] = '\0'; /* Null terminate */
-                                     
-                                     /* Check for CLOSE command */
-                                     if(strncmp(rx_buffer, "CLOSE", 5) == 0) 
-                                     {
-                                         Servo_SetAngle(0);                    /* Lock Door */
-                                         GPIO_PORTF_DATA_R &= ~GPIO_GREEN_LED; /* Green LED OFF (VIOLATION FIX #3) */
-                                         authenticated = 0; /* Clear authentication flag when exiting door open state */
-                                         
-                                         /* Clear buffer and break the loop to return to main idle state */
-                                         rx_index = 0;
-                                         memset(rx_buffer, 0, sizeof(rx_buffer));
-                                         break; 
-                                     }
-                                     
-                                     /* Reset buffer if message was not CLOSE */
-                                     rx_index = 0; 
-                                     memset(rx_buffer, 0, sizeof(rx_buffer));
-                                 }
-                                 else if(rx_index < RX_BUFFER_MAX_INDEX) { /* VIOLATION FIX #3: Use constant instead of magic 49 */
-                                     rx_buffer[rx_index++] = c;
-                                 }
-                             }
-                        }
-                    } else {
-                        UART2_SendString("DENY\n");
-                        authenticated = 0; /* Clear authentication flag on failed password */
-                        GPIO_PORTF_DATA_R |= GPIO_RED_LED;   /* Red LED ON (VIOLATION FIX #3) */
-                        Delay_ms(500);
-                        GPIO_PORTF_DATA_R &= ~GPIO_RED_LED;  /* VIOLATION FIX #3 */
-                    }
+                AuditLog_Append(AUDIT_EVENT_FOR_DOOR(AUDIT_EVENT_DOOR_CLOSE, i), AUDIT_RESULT_OK);
+                EndDoorSessions(i); /* Clear authentication flags when the door closes */
+            }
+        }
+        if(closed != 0U && Door_AnyOpen() == 0U)
+        {
+            Pattern_Stop(TRACK_DOOR); /* Green LED OFF (VIOLATION FIX #3) */
+        }
+    }
+}
+
+/* Batch-writes staged audit records */
+void AuditTask(const Sched_Event *event)
+{
+    (void)event;
+    Wdt_CheckIn(audit_task);
+    AuditLog_Service();
+}
+
+/* Closes the idle-time window reported by "STATS?" */
+void StatsTask(const Sched_Event *event)
+{
+    (void)event;
+    Stats_Sample();
+}
+
+/* Reloads the watchdog while the watched tasks keep running */
+void WatchdogTask(const Sched_Event *event)
+{
+    (void)event;
+    (void)Wdt_Service();
+}
+
+/* Sends a requested link trace dump out of UART0 */
+void TraceTask(const Sched_Event *event)
+{
+    (void)event;
+    Trace_Service();
+}
+
+#if SELF_TEST
+/* Runs the unit suite once, in place of everything else for its duration */
+void SelfTestTask(const Sched_Event *event)
+{
+    (void)event;
+    Run_Unit_Tests();
+}
+#endif
+
+/* --- COMMAND HANDLERS --- */
+
+/* Strips the "#NN" bus address (RS-485 builds), selects the sender's
+   session and runs the command parsed from the rest of the line. The
+   "@SS " sequence prefix is echoed on the reply. */
+void HandleLine(Frame_View line)
+{
+    const char *body = line.text;
+    uint8_t node = BUS_NODE_NONE;
+    Command command;
+
+#if UART2_RS485
+    node = Bus_Accept(line.text, &body);
+    if(node == BUS_NODE_NONE) {
+        return; /* Only the polled panel may speak */
+    }
+    Bus_FormatAddress(node, reply_prefix);
+#endif
+    session = &sessions[node];
+    Frame_Skip(&line, (uint32_t)(body - line.text));
+
+    Command_Parse(line, &command);
+    Stats_CountCommand(command.code);
+    strncat(reply_prefix, command.sequence.text, command.sequence.length);
+    door = command.door;
+    ProcessCommand(&command);
+    reply_prefix[0] = '\0';
+}
+
+/* Runs one parsed command. Arguments are views into the receive line,
+   which ends in a terminator, so they go to the handlers in place. */
+void ProcessCommand(const Command *command)
+{
+    const char *argument = command->argument.text;
+    uint8_t verdict;
+
+    switch(command->code)
+    {
+    case COMMAND_BAD_DOOR:
+        SendReply("DOOR_ERROR");
+        break;
+
+    case COMMAND_ALARM:
+        StartLockoutAlarm(); /* Addressed form of the alarm byte */
+        break;
+
+    /* A. SET NEW PASSWORD */
+    case COMMAND_SET_PASSWORD:
+        if(command->valid != 0U) {
+            /* Salt, hash and store; the plaintext is never written */
+            if(Password_Set(argument) == PASSWORD_SUCCESS) {
+                SendReply("PWD_SAVED");
+                AuditLog_Append(AUDIT_EVENT_PASSWORD_CHANGE, AUDIT_RESULT_OK);
+                /* Success Signal: Green LED Flash (VIOLATION FIX #3) */
+                Pattern_Play(TRACK_STATUS, pattern_saved);
+            } else {
+                SendReply("PWD_ERROR");
+                AuditLog_Append(AUDIT_EVENT_PASSWORD_CHANGE, AUDIT_RESULT_ERROR);
+                /* Error Signal: Red LED Flash (VIOLATION FIX #3) */
+                Pattern_Play(TRACK_STATUS, pattern_error);
+            }
+        } else {
+            SendReply("PWD_TOO_LONG");
+        }
+        break;
+
+    /* B. SET TIMEOUT (only accept if authenticated); no digits, or too
+       many, is an error rather than a timeout of 0 */
+    case COMMAND_TIMEOUT:
+        /* VIOLATION FIX #4 (CERT C DCL04-C): Add explicit comparison against enumerated value */
+        /* Only allow if user has verified password, at this door */
+        if(session->authenticated != 0U && session->door == door)
+        {
+            if(command->valid != 0U &&
+               Password_Commit(PASSWORD_KEEP, door, command->number) == PASSWORD_SUCCESS) {
+                SendReply("TIMEOUT_SAVED");
+                AuditLog_Append(AUDIT_EVENT_FOR_DOOR(AUDIT_EVENT_TIMEOUT_CHANGE, door), AUDIT_RESULT_OK);
+            } else {
+                SendReply("TIMEOUT_ERROR");
+                AuditLog_Append(AUDIT_EVENT_FOR_DOOR(AUDIT_EVENT_TIMEOUT_CHANGE, door), AUDIT_RESULT_ERROR);
+            }
+            session->authenticated = 0; // Clear authentication flag after use
+        }
+        else
+        {
+            SendReply("TIMEOUT_DENIED"); // User not authenticated
+            AuditLog_Append(AUDIT_EVENT_FOR_DOOR(AUDIT_EVENT_TIMEOUT_CHANGE, door), AUDIT_RESULT_DENIED);
+        }
+        break;
+
+    /* C. AUTHENTICATE PASSWORD FOR SETTINGS (no door open) */
+    case COMMAND_VERIFY_SETTINGS:
+        /* Refuse without checking while a lockout window is open */
+        if(Lockout_RemainingMs() != 0U) {
+            SendReplyWithNumber("AUTH_FAILED", Lockout_RemainingSeconds());
+            AuditLog_Append(AUDIT_EVENT_AUTH, AUDIT_RESULT_LOCKED);
+            session->authenticated = 0;
+        }
+        /* Constant-time check against the stored digest */
+        else if((verdict = CheckPassword(argument)) == AUDIT_RESULT_OK) {
+            SendReply("AUTH_OK");
+            AuditLog_Append(AUDIT_EVENT_AUTH, AUDIT_RESULT_OK);
+            session->authenticated = 1; /* Set authentication flag for settings changes */
+            session->door = door;
+            // Note: No door open, just authenticate for settings
+        } else {
+            SendReplyWithNumber("AUTH_FAILED", Lockout_RemainingSeconds());
+            AuditLog_Append(AUDIT_EVENT_AUTH, verdict);
+            session->authenticated = 0;
+        }
+        break;
+
+    /* D. VERIFY PASSWORD (opens door) */
+    case COMMAND_VERIFY:
+        /* Refuse without checking while a lockout window is open;
+           DENY:<s> tells the HMI how long to wait */
+        if(Lockout_RemainingMs() != 0U) {
+            SendReplyWithNumber("DENY", Lockout_RemainingSeconds());
+            AuditLog_Append(AUDIT_EVENT_FOR_DOOR(AUDIT_EVENT_DOOR_OPEN, door), AUDIT_RESULT_LOCKED);
+            session->authenticated = 0;
+        }
+        /* Constant-time check against the stored digest */
+        else if((verdict = CheckPassword(argument)) == AUDIT_RESULT_OK) {
+            SendReply("ALLOW");
+            AuditLog_Append(AUDIT_EVENT_FOR_DOOR(AUDIT_EVENT_DOOR_OPEN, door), AUDIT_RESULT_OK);  /* RAM only, no EEPROM wait */
+            session->authenticated = 1; /* Set authentication flag for settings changes */
+            session->door = door;
+            Sched_Post(door_task, DOOR_EVENT_OPEN, door); /* Open until "CLOSE" or its auto-lock */
+        } else {
+            SendReplyWithNumber("DENY", Lockout_RemainingSeconds());
+            AuditLog_Append(AUDIT_EVENT_FOR_DOOR(AUDIT_EVENT_DOOR_OPEN, door), verdict);
+            session->authenticated = 0; /* Clear authentication flag on failed password */
+            Pattern_Play(TRACK_STATUS, pattern_denied);
+        }
+        break;
+
+    /* E. CLOSE DOOR (sent by the HMI when its auto-lock countdown ends or
+       '#' is pressed) and HOLD IT OPEN ('*' adds another timeout). Control
+       runs the same countdown, so a door locks even if CLOSE is lost. */
+    case COMMAND_CLOSE:
+        Sched_Post(door_task, DOOR_EVENT_CLOSE, door);
+        break;
+
+    case COMMAND_HOLD:
+        Sched_Post(door_task, DOOR_EVENT_HOLD, door);
+        break;
+
+    /* F. DUMP AUDIT LOG: LOG_BEGIN, one hex line per record, LOG_END:<count>.
+       The records follow in later CommTask passes (ContinueAuditDump). */
+    case COMMAND_AUDIT:
+        SendReply("LOG_BEGIN");
+        AuditLog_Begin(&dump_cursor);
+        dump_sent = 0;
+        strcpy(dump_prefix, reply_prefix);
+        dumping = 1;
+        break;
+
+    /* G. AUTHENTICATED SETTINGS UPDATE: "CFG:<pwd>;PWD=<new>;TMO=<s>", either
+       field optional. Credential and settings travel in one frame and are
+       applied with one record write, or not at all. */
+    case COMMAND_CONFIG:
+    {
+        Config_Request request;
+
+        if(Command_ParseConfig(command->argument, &request) == 0U) {
+            SendReply("CFG_ERROR");
+        }
+        else if(Lockout_RemainingMs() != 0U) {
+            SendReplyWithNumber("CFG_DENIED", Lockout_RemainingSeconds());
+            AuditLog_Append(AUDIT_EVENT_AUTH, AUDIT_RESULT_LOCKED);
+        }
+        else if((verdict = CheckPassword(request.credential)) != AUDIT_RESULT_OK) {
+            SendReplyWithNumber("CFG_DENIED", Lockout_RemainingSeconds());
+            AuditLog_Append(AUDIT_EVENT_AUTH, verdict);
+        }
+        else {
+            uint8_t result;
+
+            result = Password_Commit((request.has_password != 0U) ? request.password : PASSWORD_KEEP, door,
+                                     (request.has_timeout != 0U) ? request.timeout : Password_GetTimeout(door));
+            if(result == PASSWORD_SUCCESS) {
+                SendReply("CFG_OK");
+                Pattern_Play(TRACK_STATUS, pattern_saved);
+            } else {
+                SendReply("CFG_ERROR");
+            }
+            if(request.has_password != 0U) {
+                AuditLog_Append(AUDIT_EVENT_PASSWORD_CHANGE, (result == PASSWORD_SUCCESS) ? AUDIT_RESULT_OK : AUDIT_RESULT_ERROR);
+            }
+            if(request.has_timeout != 0U) {
+                AuditLog_Append(AUDIT_EVENT_FOR_DOOR(AUDIT_EVENT_TIMEOUT_CHANGE, door),
+                                (result == PASSWORD_SUCCESS) ? AUDIT_RESULT_OK : AUDIT_RESULT_ERROR);
+            }
+        }
+        memset(&request, 0, sizeof(request)); /* Do not leave passwords on the stack */
+        break;
+    }
+
+    /* H. LINK RATE: "BAUD:<rate>" answers BAUD_OK at the old rate, then
+       switches. The HMI probes with PING and sends "BAUD:COMMIT" at the new
+       rate within BAUD_PROBE_WINDOW_MS, otherwise CommTask falls back. */
+    case COMMAND_BAUD_COMMIT:
+        if(baud_probing != 0U) {
+            baud_probing = 0;
+            SendReply("BAUD_OK");
+        } else {
+            SendReply("BAUD_ERROR");
+        }
+        break;
+
+    case COMMAND_BAUD:
+        /* One panel cannot change the rate of a shared bus */
+        if(UART2_RS485 == 0 && command->valid != 0U && UART2_CheckBaud(command->number) != 0) {
+            SendReply("BAUD_OK");
+            (void)UART2_SetBaud(command->number); /* Waits for BAUD_OK to leave the shifter */
+            baud_probing = 1;
+            baud_probe_until = SysTick_GetTicks() + BAUD_PROBE_WINDOW_MS;
+        } else {
+            SendReply("BAUD_ERROR");
+        }
+        break;
+
+    /* I. LINK PROBE: "PING:<text><crc>" is echoed as "PONG:<text><crc>" when
+       the CRC-16 of <text> matches its four hex digits */
+    case COMMAND_PING:
+        if(CRC16_CheckText(argument) != 0U) {
+            SendReplyParts("PONG:", argument); /* Echoed from the line, not copied */
+        } else {
+            SendReply("PONG_ERROR");
+        }
+        break;
+
+    /* J. HEARTBEAT: "HB:<uptime>" from a panel every 100 ms, answered with
+       Control's own uptime so each side sees the other restart. A panel
+       that is new, or whose uptime went backwards, has rebooted: nothing it
+       verified before still holds. */
+    case COMMAND_HEARTBEAT:
+        if(command->valid != 0U) {
+            if(session->online == 0U || command->number < session->peer_uptime) {
+                session->authenticated = 0;
+            }
+            session->online = 1;
+            session->heard_at = SysTick_GetTicks();
+            session->peer_uptime = command->number;
+            SendReplyWithNumber("HB", SysTick_GetTicks());
+        }
+        break;
+
+    /* K. RUNTIME COUNTERS: "STATS?" streams every field between
+       STATS_BEGIN and STATS_END:<count>; "STATS?<n>" answers field n
+       alone (the HMI service page), or STATS_END past the last one.
+       All fields come from one snapshot. */
+    case COMMAND_STATS:
+        if(command->valid != 0U) {
+            Stats_Snapshot snapshot;
+            char field[STATS_FIELD_SIZE];
+            uint32_t i;
+
+            Stats_Get(&snapshot);
+            if(command->argument.length != 0U) {
+                SendReply((Stats_FormatField(&snapshot, command->number, field) != 0U) ? field : "STATS_END");
+            } else {
+                SendReply("STATS_BEGIN");
+                for(i = 0; Stats_FormatField(&snapshot, i, field) != 0U; i++) {
+                    SendReply(field);
                 }
-                
-                rx_index = 0; /* Reset buffer after processing */
-                memset(rx_buffer, 0, sizeof(rx_buffer));
+                SendReplyWithNumber("STATS_END", i);
             }
-            else if(rx_index < RX_BUFFER_MAX_INDEX) /* VIOLATION FIX #3: Use constant instead of magic 49 */
-            {
-                rx_buffer[rx_index++] = c;
+        } else {
+            SendReply("STATS_ERROR");
+        }
+        break;
+
+    default:
+        break; /* Empty or unknown: no reply, as before */
+    }
+}
+
+/* Checks a password against the stored digest and stores the outcome in
+   the failed-attempt counter. Fails closed: if the counter cannot be
+   written, even the right password is refused.
+   Returns: the audit result, AUDIT_RESULT_OK only for a stored match */
+uint8_t CheckPassword(const char *candidate) {
+    uint8_t matched = (Password_Verify(candidate) == PASSWORD_MATCH) ? 1U : 0U;
+    uint8_t stored = (matched != 0U) ? Lockout_RecordSuccess() : Lockout_RecordFailure();
+
+    Stats_CountAuth(matched);
+    if(stored != LOCKOUT_SUCCESS) {
+        return AUDIT_RESULT_ERROR;
+    }
+    return (matched != 0U) ? AUDIT_RESULT_OK : AUDIT_RESULT_FAILED;
+}
+
+/* Alarm for 1 s without blocking the link: red LED and a siren on the
+   buzzer, played by the pattern timer */
+void StartLockoutAlarm(void) {
+    AuditLog_Append(AUDIT_EVENT_LOCKOUT_ALARM, AUDIT_RESULT_OK);
+    Pattern_Play(TRACK_ALARM, pattern_alarm); /* Red LED On (VIOLATION FIX #3) */
+}
+
+/* Withdraws the settings authorization of every sender (link and all
+   panels) that verified at a door that has now closed */
+void EndDoorSessions(uint8_t closed_door) {
+    uint32_t i;
+
+    for(i = 0; i <= BUS_NODE_COUNT; i++) {
+        if(sessions[i].door == closed_door) {
+            sessions[i].authenticated = 0;
+        }
+    }
+}
+
+/* A panel that stopped beating has lost power, rebooted or been unplugged:
+   its authorization ends, and point to point the link drops back to
+   UART2_BAUD_DEFAULT, where a restarted HMI looks for Control. Senders
+   that never beat (legacy commands, the test suites) are left alone. */
+void ExpireSessions(void) {
+    uint32_t now = SysTick_GetTicks();
+    uint32_t i;
+
+    for(i = 0; i <= BUS_NODE_COUNT; i++) {
+        if(sessions[i].online != 0U && (now - sessions[i].heard_at) >= PEER_TIMEOUT_MS) {
+            sessions[i].online = 0;
+            sessions[i].authenticated = 0;
+            if(UART2_RS485 == 0 && baud_probing == 0U) {
+                FallBackToDefaultBaud();
             }
         }
+    }
+}
 
-        
+/* Returns the link to UART2_BAUD_DEFAULT, where the HMI looks for Control
+   after any failure, and forgets a half-received command */
+void FallBackToDefaultBaud(void) {
+    baud_probing = 0;
+    rx_errors = 0;
+    if(UART2_GetBaud() != UART2_BAUD_DEFAULT) {
+        (void)UART2_SetBaud(UART2_BAUD_DEFAULT);
     }
+    Frame_Reset(&rx_frame);
 }
 
 void System_Init(void) {
-    /* Enable GPIO Port B (Servo), D (UART2), and F (LEDs/Buzzer) */
+    /* Enable GPIO Port B (Servos, set up by Servo_Init), D (UART2), and F (LEDs/Buzzer) */
     SYSCTL_RCGCGPIO_R |= SYSCTL_GPIO_ENABLE_MASK;  /* VIOLATION FIX #3: Ports B,D,F enable */
     while((SYSCTL_PRGPIO_R & SYSCTL_GPIO_ENABLE_MASK) == 0);
 
@@ -276,10 +785,6 @@ void System_Init(void) {
     GPIO_PORTD_DIR_R &= ~GPIO_PORTD_UART_MASK;  /* PD6/PD7 as inputs (UART RX/TX are inputs to the GPIO) */
     GPIO_PORTD_DEN_R |= GPIO_PORTD_UART_MASK;   /* Enable digital for PD6/PD7 */
 
-    /* PB6 - Servo (Output) */
-    GPIO_PORTB_DIR_R |= GPIO_PORTB_SERVO_MASK;
-    GPIO_PORTB_DEN_R |= GPIO_PORTB_SERVO_MASK;
-
     /* PF1 (Red/Buzzer), PF2 (Blue), PF3 (Green) */
     GPIO_PORTF_DIR_R |= GPIO_LED_ALL;
     GPIO_PORTF_DEN_R |= GPIO_LED_ALL;
@@ -304,31 +809,79 @@ void Delay_us(uint32_t us) {
         for(j = 0; j < DELAY_CALIBRATION_US; j++);
 }
 
-/* VIOLATION FIX #2: Helper function already declared in function prototypes section */
-/* Moved prototype to the top of file to comply with CERT C EXP05-C */
-int stringToInt(const char* str) {
-    int res = 0;
-    while(*str >= '0' && *str <= '9') {
-        res = (res * 10) + (*str - '0'); /* VIOLATION FIX #6: Added parentheses for clarity (MISRA C 2012 Rule 12.1) */
-        str++;
-    }
-    return res;
+/* Sends "<reply>\n", behind the sequence prefix of the current request */
+void SendReply(const char *reply) {
+    SendReplyParts(reply, "");
 }
 
-/* VIOLATION FIX #3: Replace magic constants with named constants */
-void Servo_Update(int open) {
-    /* Standard Servo: 50Hz (20ms period) */
-    GPIO_PORTB_DATA_R |= GPIO_PORTB_SERVO_MASK; /* High */
-    if(open) {
-        Delay_us(SERVO_PULSE_90DEG);     /* 90 degrees (~1.5ms) */
-        GPIO_PORTB_DATA_R &= ~GPIO_PORTB_SERVO_MASK; /* Low */
-        Delay_us(SERVO_PERIOD_HIGH_90);
-    } else {
-        Delay_us(SERVO_PULSE_0DEG);      /* 0 degrees (~1.0ms) */
-        GPIO_PORTB_DATA_R &= ~GPIO_PORTB_SERVO_MASK; /* Low */
-        Delay_us(SERVO_PERIOD_HIGH_0);
+/* Sends "<head><tail>\n" behind the sequence prefix, e.g. a fixed reply
+   name followed by text still in the receive line */
+void SendReplyParts(const char *head, const char *tail) {
+    UART2_SendString(reply_prefix);
+    UART2_SendString((char *)head);
+    UART2_SendString((char *)tail);
+    UART2_SendChar('\n');
+}
+
+/* Sends "<reply>:<value>\n", e.g. "DENY:40", behind the sequence prefix */
+void SendReplyWithNumber(const char *reply, uint32_t value) {
+    char message[RX_BUFFER_SIZE];
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, message, sizeof(message) - 1U); /* Room kept for the newline */
+    Fmt_String(&out, reply);
+    Fmt_Char(&out, ':');
+    Fmt_Uint(&out, value);
+    message[out.length++] = '\n';
+    message[out.length] = '\0';
+
+    UART2_SendString(reply_prefix);
+    UART2_SendString(message);
+}
+
+/* Sends one audit record as "TTTTTTTTSSSSEERR\n" (timestamp, sequence, event,
+   result) behind the sequence prefix */
+void SendLogRecord(const AuditLog_Record *record) {
+    char line[AUDIT_LINE_SIZE];
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, line, sizeof(line));
+    Fmt_Hex(&out, record->timestamp, 8);
+    Fmt_Hex(&out, record->sequence, 4);
+    Fmt_Hex(&out, record->event, 2);
+    Fmt_Hex(&out, record->result, 2);
+    SendReplyParts(line, "");
+}
+
+/* Sends up to AUDIT_DUMP_RECORDS more records of an "AUDIT?" dump, and
+   LOG_END with the number actually sent once none are left.
+   Returns: 1 while the dump goes on */
+uint8_t ContinueAuditDump(void) {
+    AuditLog_Record record;
+    uint8_t result;
+    uint32_t n;
+
+    if(dumping == 0U) {
+        return 0;
     }
+
+    strcpy(reply_prefix, dump_prefix);
+    for(n = 0; n < AUDIT_DUMP_RECORDS; n++) {
+        result = AuditLog_Next(&dump_cursor, &record);
+        if(result == AUDITLOG_END) {
+            SendReplyWithNumber("LOG_END", dump_sent);
+            dumping = 0;
+            break;
+        }
+        if(result == AUDITLOG_SUCCESS) {
+            SendLogRecord(&record);
+            dump_sent++;
+        }
+    }
+    reply_prefix[0] = '\0';
+    return dumping;
 }
+
 /* Wrapper function to satisfy the linker requirements from uart.c */
 void delayMs(uint32_t n)
 {
@@ -0,0 +1,383 @@
+/*****************************************************************************
+ * File: password.c
+ * Module: PASSWORD
+ * Description: Source file for salted, iterated password storage
+ *
+ * The TM4C123 has no hardware RNG. New salts hash the previous salt with
+ * the free-running SysTick counter and a change counter, which is enough to
+ * make every stored digest unique; a salt does not need to be secret.
+ *****************************************************************************/
+
+#include "password.h"
+#include "sha256.h"
+#include "eeprom.h"
+#include "tm4c123gh6pm.h"
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Door d's timeout is byte d of Password_Record.timeout */
+#define TIMEOUT_SHIFT(door)     (8U * (uint32_t)(door))
+#define TIMEOUT_FIELD_MASK      0xFFU
+
+/******************************************************************************
+ *                              Types                                          *
+ ******************************************************************************/
+
+/* EEPROM image of the stored record (word-aligned for EEPROMProgram).
+   The first 14 words match the PWH1 layout; generation must stay last. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t iterations;
+    uint32_t salt[PASSWORD_SALT_WORDS];
+    uint32_t digest[SHA256_DIGEST_WORDS];
+    uint32_t timeout;
+    uint32_t generation;
+} Password_Record;
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static Password_Record record;
+static uint32_t active_block = PASSWORD_EEPROM_BLOCK_B;  /* First write goes to block 0 */
+static uint32_t salt_generation = 0;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * DeriveDigest
+ * Computes the iterated digest of length bytes of password under salt.
+ * Iterations 2..n reuse one pre-padded block: the previous digest in words
+ * 0-7, the salt in 8-11 and the fixed SHA-256 padding for a 48-byte message.
+ * The first iteration hashes the salt in the same big-endian byte order.
+ */
+static void DeriveDigest(const char *password, uint32_t length, const uint32_t salt[PASSWORD_SALT_WORDS],
+                         uint32_t iterations, uint32_t digest[SHA256_DIGEST_WORDS])
+{
+    SHA256_Context ctx;
+    uint8_t first[SHA256_DIGEST_SIZE];
+    uint8_t salt_bytes[PASSWORD_SALT_WORDS * 4U];
+    uint32_t block[SHA256_BLOCK_WORDS];
+    uint32_t i;
+
+    for(i = 0; i < PASSWORD_SALT_WORDS; i++)
+    {
+        salt_bytes[i * 4U] = (uint8_t)(salt[i] >> 24);
+        salt_bytes[(i * 4U) + 1U] = (uint8_t)(salt[i] >> 16);
+        salt_bytes[(i * 4U) + 2U] = (uint8_t)(salt[i] >> 8);
+        salt_bytes[(i * 4U) + 3U] = (uint8_t)salt[i];
+    }
+
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, salt_bytes, sizeof(salt_bytes));
+    SHA256_Update(&ctx, (const uint8_t *)password, length);
+    SHA256_Final(&ctx, first);
+
+    for(i = 0; i < SHA256_DIGEST_WORDS; i++)
+    {
+        block[i] = ((uint32_t)first[i * 4U] << 24) | ((uint32_t)first[(i * 4U) + 1U] << 16) |
+                   ((uint32_t)first[(i * 4U) + 2U] << 8) | (uint32_t)first[(i * 4U) + 3U];
+    }
+    for(i = 0; i < PASSWORD_SALT_WORDS; i++)
+    {
+        block[SHA256_DIGEST_WORDS + i] = salt[i];
+    }
+    block[12] = 0x80000000U;                    /* Terminator bit */
+    block[13] = 0;
+    block[14] = 0;
+    block[15] = (SHA256_DIGEST_SIZE + (PASSWORD_SALT_WORDS * 4U)) * 8U; /* 384 bits */
+
+    for(i = 1; i < iterations; i++)
+    {
+        SHA256_Init(&ctx);
+        SHA256_Transform(ctx.state, block);
+        memcpy(block, ctx.state, SHA256_DIGEST_SIZE);
+    }
+
+    memcpy(digest, block, SHA256_DIGEST_SIZE);
+    memset(first, 0, sizeof(first));
+}
+
+/*
+ * NewSalt
+ * Derives the next salt from the previous one plus timing noise.
+ */
+static void NewSalt(uint32_t salt[PASSWORD_SALT_WORDS])
+{
+    SHA256_Context ctx;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint32_t noise[2];
+
+    noise[0] = NVIC_ST_CURRENT_R;
+    noise[1] = salt_generation++;
+
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, (const uint8_t *)salt, PASSWORD_SALT_WORDS * 4U);
+    SHA256_Update(&ctx, (const uint8_t *)noise, sizeof(noise));
+    SHA256_Final(&ctx, digest);
+
+    memcpy(salt, digest, PASSWORD_SALT_WORDS * 4U);
+}
+
+/*
+ * IsValid
+ * Checks the fields a record needs before it can be used.
+ */
+static uint8_t IsValid(const Password_Record *r, uint32_t magic)
+{
+    return (r->magic == magic &&
+            r->iterations != 0U && r->iterations <= PASSWORD_MAX_ITERATIONS) ? 1U : 0U;
+}
+
+/*
+ * ReadLegacyTimeout
+ * Timeout from block 1, as stored before it moved into the record.
+ */
+static uint32_t ReadLegacyTimeout(void)
+{
+    uint32_t timeout = PASSWORD_TIMEOUT_DEFAULT;
+
+    if(EEPROM_ReadWord(PASSWORD_LEGACY_TIMEOUT_BLOCK, PASSWORD_LEGACY_TIMEOUT_OFFSET,
+                       &timeout) != EEPROM_SUCCESS ||
+       timeout == 0U || timeout > PASSWORD_TIMEOUT_MAX)
+    {
+        timeout = PASSWORD_TIMEOUT_DEFAULT;
+    }
+    return timeout;
+}
+
+/*
+ * IsBlank
+ * Checks for a slot that reads as erased EEPROM.
+ */
+static uint8_t IsBlank(const Password_Record *r)
+{
+    const uint32_t *word = (const uint32_t *)r;
+    uint32_t i;
+
+    for(i = 0; i < sizeof(*r) / sizeof(uint32_t); i++)
+    {
+        if(word[i] != 0xFFFFFFFFU)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * BlankLegacy
+ * Overwrites block 0 as if erased, so no older layout (a plaintext
+ * password in particular) outlives its conversion.
+ */
+static uint8_t BlankLegacy(void)
+{
+    Password_Record blank;
+
+    memset(&blank, 0xFF, sizeof(blank));
+    if(EEPROM_WriteBuffer(PASSWORD_EEPROM_BLOCK, PASSWORD_EEPROM_OFFSET,
+                          (const uint8_t *)&blank, sizeof(blank)) != EEPROM_SUCCESS)
+    {
+        return PASSWORD_ERROR;
+    }
+    return PASSWORD_SUCCESS;
+}
+
+/*
+ * WriteRecord
+ * Writes to the slot not holding the current record. EEPROMProgram writes
+ * words in order, so generation, the last word, only changes once the rest
+ * of the record is in place.
+ */
+static uint8_t WriteRecord(Password_Record *updated)
+{
+    uint32_t block = (active_block == PASSWORD_EEPROM_BLOCK) ? PASSWORD_EEPROM_BLOCK_B
+                                                             : PASSWORD_EEPROM_BLOCK;
+
+    updated->generation = record.generation + 1U;
+    if(EEPROM_WriteBuffer(block, PASSWORD_EEPROM_OFFSET,
+                          (const uint8_t *)updated, sizeof(*updated)) != EEPROM_SUCCESS)
+    {
+        return PASSWORD_ERROR;
+    }
+
+    record = *updated;
+    active_block = block;
+    return PASSWORD_SUCCESS;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Password_Init
+ * Reads both slots and keeps the newest valid record in RAM.
+ */
+uint8_t Password_Init(void)
+{
+    Password_Record slot_b;
+    char legacy[PASSWORD_MAX_LENGTH];
+    uint8_t valid_a;
+    uint8_t valid_b;
+    uint8_t result;
+
+    if(EEPROM_ReadBuffer(PASSWORD_EEPROM_BLOCK, PASSWORD_EEPROM_OFFSET,
+                         (uint8_t *)&record, sizeof(record)) != EEPROM_SUCCESS ||
+       EEPROM_ReadBuffer(PASSWORD_EEPROM_BLOCK_B, PASSWORD_EEPROM_OFFSET,
+                         (uint8_t *)&slot_b, sizeof(slot_b)) != EEPROM_SUCCESS)
+    {
+        return PASSWORD_ERROR;
+    }
+
+    valid_a = IsValid(&record, PASSWORD_RECORD_MAGIC);
+    valid_b = IsValid(&slot_b, PASSWORD_RECORD_MAGIC);
+
+    if(valid_b != 0U && (valid_a == 0U || (int32_t)(slot_b.generation - record.generation) > 0))
+    {
+        /* Block 0 left over from a conversion cut short before it was
+           blanked, or from a torn write: either way nothing to keep */
+        result = (valid_a == 0U && IsBlank(&record) == 0U) ? BlankLegacy() : PASSWORD_SUCCESS;
+        record = slot_b;
+        active_block = PASSWORD_EEPROM_BLOCK_B;
+        return result;
+    }
+    if(valid_a != 0U)
+    {
+        active_block = PASSWORD_EEPROM_BLOCK;
+        return PASSWORD_SUCCESS;
+    }
+
+    /* Older layouts live in block 0; the converted record goes to block B,
+       so block 0 stays intact until the new record is safely written, and
+       is blanked after */
+    active_block = PASSWORD_EEPROM_BLOCK;
+    if(IsValid(&record, PASSWORD_RECORD_MAGIC_V1) != 0U)
+    {
+        record.magic = PASSWORD_RECORD_MAGIC;
+        record.timeout = ReadLegacyTimeout();
+        record.generation = 0;
+        slot_b = record;
+        result = WriteRecord(&slot_b);
+    }
+    else
+    {
+        /* Plaintext layout: the first PASSWORD_MAX_LENGTH bytes are the password */
+        memcpy(legacy, &record, PASSWORD_MAX_LENGTH);
+        legacy[PASSWORD_MAX_LENGTH - 1U] = '\0';
+
+        if(legacy[0] == '\0' || (unsigned char)legacy[0] == 0xFFU)
+        {
+            strcpy(legacy, PASSWORD_DEFAULT);
+        }
+
+        record.generation = 0;
+        record.timeout = 0;     /* Not a timeout word; Commit fills in door 0 */
+        result = Password_Commit(legacy, 0U, ReadLegacyTimeout());
+        memset(legacy, 0, sizeof(legacy));
+    }
+
+    if(result != PASSWORD_SUCCESS)
+    {
+        return PASSWORD_ERROR;
+    }
+    return BlankLegacy();
+}
+
+/*
+ * Password_Commit
+ * Validates everything first, then writes one record. The other doors'
+ * bytes are copied unchanged.
+ */
+uint8_t Password_Commit(const char *password, uint8_t door, uint32_t timeout)
+{
+    Password_Record updated = record;
+
+    if(door >= PASSWORD_DOOR_COUNT || timeout == 0U || timeout > PASSWORD_TIMEOUT_MAX)
+    {
+        return PASSWORD_ERROR;
+    }
+
+    if(password != PASSWORD_KEEP)
+    {
+        uint32_t length = strlen(password);
+
+        if(length == 0U || length >= PASSWORD_MAX_LENGTH)
+        {
+            return PASSWORD_ERROR;
+        }
+
+        NewSalt(updated.salt);
+        updated.iterations = PASSWORD_HASH_ITERATIONS;
+        DeriveDigest(password, length, updated.salt, updated.iterations, updated.digest);
+    }
+
+    updated.magic = PASSWORD_RECORD_MAGIC;
+    updated.timeout = (updated.timeout & ~(TIMEOUT_FIELD_MASK << TIMEOUT_SHIFT(door))) |
+                      (timeout << TIMEOUT_SHIFT(door));
+    return WriteRecord(&updated);
+}
+
+/*
+ * Password_Set
+ * Salts, hashes and stores a new password; the timeouts are kept.
+ */
+uint8_t Password_Set(const char *password)
+{
+    return Password_Commit(password, 0U, Password_GetTimeout(0U));
+}
+
+/*
+ * Password_GetTimeout
+ * Timeout from the record in RAM. Door 0 always has its own.
+ */
+uint32_t Password_GetTimeout(uint8_t door)
+{
+    uint32_t timeout = 0;
+
+    if(door < PASSWORD_DOOR_COUNT)
+    {
+        timeout = (record.timeout >> TIMEOUT_SHIFT(door)) & TIMEOUT_FIELD_MASK;
+    }
+    if(timeout == 0U || timeout > PASSWORD_TIMEOUT_MAX)
+    {
+        timeout = record.timeout & TIMEOUT_FIELD_MASK;
+    }
+    return timeout;
+}
+
+/*
+ * Password_Verify
+ * Constant-time check: the digest is always derived and all words are
+ * folded into one difference value before anything is decided.
+ */
+uint8_t Password_Verify(const char *candidate)
+{
+    uint32_t digest[SHA256_DIGEST_WORDS];
+    uint32_t length = strlen(candidate);
+    uint32_t diff = 0;
+    uint32_t i;
+
+    if(length >= PASSWORD_MAX_LENGTH)
+    {
+        /* Still pay the full cost so length is not observable */
+        diff = 1U;
+        length = PASSWORD_MAX_LENGTH - 1U;
+    }
+
+    DeriveDigest(candidate, length, record.salt, record.iterations, digest);
+
+    for(i = 0; i < SHA256_DIGEST_WORDS; i++)
+    {
+        diff |= digest[i] ^ record.digest[i];
+    }
+
+    return (diff == 0U) ? PASSWORD_MATCH : PASSWORD_MISMATCH;
+}
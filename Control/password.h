@@ -0,0 +1,136 @@
+/*****************************************************************************
+ * File: password.h
+ * Module: PASSWORD
+ * Description: Header file for salted, iterated password storage
+ *
+ * The master password is never stored. The EEPROM holds a record with a
+ * random salt and an iterated SHA-256 digest:
+ *
+ *     d(1) = SHA256(salt || password)
+ *     d(i) = SHA256(d(i-1) || salt)        for i = 2 .. iterations
+ *
+ * The salt and each d(i) are hashed as their 32-bit words, most
+ * significant byte first, in every iteration; the record holds d(n) as
+ * eight such words. Every d(i) for i >= 2 is exactly one compression
+ * block, so verification cost is fixed by the iteration count and
+ * independent of the input. Digests are compared in constant time.
+ *
+ * The same record carries the auto-lock timeout of each door, one byte per
+ * door in the timeout word, so a password and a timeout change are one
+ * EEPROM write. A zero byte (records from before multi-door support) means
+ * "same as door 0". Records alternate between two
+ * blocks; each write goes to the block not holding the current record and
+ * ends with a generation counter, so a write torn by a reset leaves a slot
+ * with an older generation and the previous record stays in force.
+ *
+ * Older layouts are converted by Password_Init(): the "PWH1" record
+ * without a timeout and the plaintext layout, both in block 0 with the
+ * timeout in block 1. Block 0 is blanked once the converted record is
+ * written, so a plaintext password does not stay behind.
+ *****************************************************************************/
+
+#ifndef PASSWORD_H_
+#define PASSWORD_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Return codes */
+#define PASSWORD_SUCCESS        0
+#define PASSWORD_ERROR          1
+
+/* Password_Verify results */
+#define PASSWORD_MISMATCH       0
+#define PASSWORD_MATCH          1
+
+/* Longest accepted password including the terminator */
+#define PASSWORD_MAX_LENGTH     20
+
+/* Used when the EEPROM has never been programmed */
+#define PASSWORD_DEFAULT        "12345"
+
+/* EEPROM placement of the two record slots (16 words, one block each) */
+#define PASSWORD_EEPROM_BLOCK   0
+#define PASSWORD_EEPROM_BLOCK_B 3
+#define PASSWORD_EEPROM_OFFSET  0
+
+/* Where older layouts kept the timeout */
+#define PASSWORD_LEGACY_TIMEOUT_BLOCK   1
+#define PASSWORD_LEGACY_TIMEOUT_OFFSET  0
+
+#define PASSWORD_RECORD_MAGIC   0x32485750U   /* "PWH2" */
+#define PASSWORD_RECORD_MAGIC_V1 0x31485750U  /* "PWH1": no timeout, block 0 only */
+#define PASSWORD_SALT_WORDS     4             /* 128-bit salt */
+
+/* Auto-lock timeouts stored with the password (seconds) */
+#define PASSWORD_TIMEOUT_DEFAULT    5U
+#define PASSWORD_TIMEOUT_MAX        60U
+#define PASSWORD_DOOR_COUNT         4U      /* One byte each in the timeout word */
+
+/* Password_Commit: leave the password unchanged */
+#define PASSWORD_KEEP           0
+
+/*
+ * Iteration count for new records. One iteration is one SHA256_Transform()
+ * (~2.5k cycles on the M4), so 256 iterations verify in about 40 ms at the
+ * current 16 MHz clock and about 8 ms once the PLL runs at 80 MHz, inside
+ * the 50 ms unlock budget either way. Stored per record so it can be raised.
+ */
+#define PASSWORD_HASH_ITERATIONS    256U
+#define PASSWORD_MAX_ITERATIONS     65536U
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Password_Init
+ * Loads the newest valid record from the two slots. Converts an older
+ * layout (or programs PASSWORD_DEFAULT into a blank EEPROM) first.
+ * EEPROM_Init() must have succeeded first.
+ * Returns: PASSWORD_SUCCESS, or PASSWORD_ERROR if the EEPROM write failed
+ */
+uint8_t Password_Init(void);
+
+/*
+ * Password_Commit
+ * Applies a new password and/or one door's timeout with a single record
+ * write. Nothing changes unless every value is valid and the write succeeds.
+ * Parameters:
+ *   password - new password (1 to PASSWORD_MAX_LENGTH - 1 characters), or
+ *              PASSWORD_KEEP
+ *   door     - 0 to PASSWORD_DOOR_COUNT - 1
+ *   timeout  - its auto-lock timeout, 1 to PASSWORD_TIMEOUT_MAX seconds
+ * Returns: PASSWORD_SUCCESS, or PASSWORD_ERROR on bad values / EEPROM failure
+ */
+uint8_t Password_Commit(const char *password, uint8_t door, uint32_t timeout);
+
+/*
+ * Password_Set
+ * Replaces the master password with a freshly salted digest and stores it.
+ * Every timeout is kept.
+ * Parameters:
+ *   password - NUL-terminated, 1 to PASSWORD_MAX_LENGTH - 1 characters
+ * Returns: PASSWORD_SUCCESS, or PASSWORD_ERROR on bad length / EEPROM failure
+ */
+uint8_t Password_Set(const char *password);
+
+/*
+ * Password_GetTimeout
+ * Returns: the stored auto-lock timeout of a door in seconds (door 0's for
+ *          a door without its own, or out of range)
+ */
+uint32_t Password_GetTimeout(uint8_t door);
+
+/*
+ * Password_Verify
+ * Checks a candidate against the stored digest. Always runs the full
+ * iteration count and compares every digest word.
+ * Returns: PASSWORD_MATCH or PASSWORD_MISMATCH
+ */
+uint8_t Password_Verify(const char *candidate);
+
+#endif /* PASSWORD_H_ */
@@ -0,0 +1,223 @@
+/*****************************************************************************
+ * File: pattern.c
+ * Module: PATTERN
+ * Description: Source file for the LED / buzzer pattern sequencer
+ *
+ * Tracks are only changed with interrupts masked, and the LEDs are written
+ * through the masked GPIODATA addresses, so task code elsewhere can still
+ * touch other Port F pins without a read-modify-write race.
+ *****************************************************************************/
+
+#include "pattern.h"
+#include "buzzer.h"
+#include "systick.h"
+#include "tm4c123gh6pm.h"
+#include <intrinsics.h>
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define PATTERN_TIMER_RELOAD    ((SYSTEM_CLOCK_HZ / 1000U) * PATTERN_TICK_MS)
+#define PATTERN_NVIC_BIT        0x00200000U     /* Interrupt 21 = NVIC_EN0 bit 21 */
+#define PATTERN_LED_RED_PIN     0x02U           /* PF1 */
+#define PATTERN_LED_GREEN_PIN   0x08U           /* PF3 */
+
+#define PATTERN_ENTER_CRITICAL()    uint32_t primask = __get_PRIMASK(); __disable_interrupt()
+#define PATTERN_EXIT_CRITICAL()     __set_PRIMASK(primask)
+
+typedef struct
+{
+    const Pattern_Step *pattern;        /* 0 = idle */
+    const Pattern_Step *step;
+    uint32_t ticks_left;
+} Pattern_Track;
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static Pattern_Track tracks[PATTERN_TRACKS];
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * TicksFor
+ * Step length in timer ticks, at least one.
+ */
+static uint32_t TicksFor(const Pattern_Step *step)
+{
+    uint32_t ticks = ((uint32_t)step->ms + PATTERN_TICK_MS - 1U) / PATTERN_TICK_MS;
+
+    return (ticks == 0U) ? 1U : ticks;
+}
+
+/*
+ * Begin
+ * Enters a step; a terminating step loops back or idles the track.
+ */
+static void Begin(Pattern_Track *t, const Pattern_Step *step)
+{
+    if(step->ms == 0U)
+    {
+        if((step->outputs & PATTERN_LOOP) == 0U || t->pattern->ms == 0U)
+        {
+            t->pattern = 0;
+            return;
+        }
+        step = t->pattern;
+    }
+    t->step = step;
+    t->ticks_left = TicksFor(step);
+}
+
+/*
+ * Apply
+ * Drives the outputs from the current steps and runs the timer only while
+ * something is playing.
+ */
+static void Apply(void)
+{
+    uint8_t outputs = 0;
+    uint32_t tone_hz = 0;
+    uint8_t playing = 0;
+    uint8_t i;
+
+    for(i = 0; i < PATTERN_TRACKS; i++)
+    {
+        const Pattern_Track *t = &tracks[i];
+
+        if(t->pattern == 0)
+        {
+            continue;
+        }
+        playing = 1;
+        outputs |= t->step->outputs;
+        if(tone_hz == 0U && (t->step->outputs & PATTERN_BUZZER) != 0U)
+        {
+            tone_hz = (t->step->tone != 0U) ? ((uint32_t)t->step->tone * 100U) : BUZZER_TONE_DEFAULT_HZ;
+        }
+    }
+
+    GPIO_PORTF_DATA_BITS_R[PATTERN_LED_RED_PIN] = ((outputs & PATTERN_RED) != 0U) ? PATTERN_LED_RED_PIN : 0U;
+    GPIO_PORTF_DATA_BITS_R[PATTERN_LED_GREEN_PIN] = ((outputs & PATTERN_GREEN) != 0U) ? PATTERN_LED_GREEN_PIN : 0U;
+    Buzzer_Tone(tone_hz);
+
+    if(playing != 0U)
+    {
+        TIMER1_CTL_R |= TIMER_CTL_TAEN;
+    }
+    else
+    {
+        TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Pattern_Init
+ * The timer is configured but left stopped.
+ */
+void Pattern_Init(void)
+{
+    uint8_t i;
+
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
+    while((SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R1) == 0);
+
+    TIMER1_CTL_R = 0;
+    TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER1_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+    TIMER1_TAILR_R = PATTERN_TIMER_RELOAD - 1U;
+    TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+    TIMER1_IMR_R = TIMER_IMR_TATOIM;
+
+    for(i = 0; i < PATTERN_TRACKS; i++)
+    {
+        tracks[i].pattern = 0;
+    }
+    Apply();
+    NVIC_EN0_R |= PATTERN_NVIC_BIT;
+}
+
+/*
+ * Pattern_Play
+ * The new first step shows at once.
+ */
+void Pattern_Play(uint8_t track, const Pattern_Step *pattern)
+{
+    if(track >= PATTERN_TRACKS)
+    {
+        return;
+    }
+
+    {
+        PATTERN_ENTER_CRITICAL();
+        tracks[track].pattern = pattern;
+        Begin(&tracks[track], pattern);
+        Apply();
+        PATTERN_EXIT_CRITICAL();
+    }
+}
+
+/*
+ * Pattern_Stop
+ * Other tracks keep playing.
+ */
+void Pattern_Stop(uint8_t track)
+{
+    if(track >= PATTERN_TRACKS)
+    {
+        return;
+    }
+
+    {
+        PATTERN_ENTER_CRITICAL();
+        tracks[track].pattern = 0;
+        Apply();
+        PATTERN_EXIT_CRITICAL();
+    }
+}
+
+/*
+ * Pattern_IsPlaying
+ * One read of the track pointer.
+ */
+uint8_t Pattern_IsPlaying(uint8_t track)
+{
+    return (track < PATTERN_TRACKS && tracks[track].pattern != 0) ? 1U : 0U;
+}
+
+/*
+ * Timer1A_Handler
+ * Outputs are only rewritten when some track changes step.
+ */
+void Timer1A_Handler(void)
+{
+    uint8_t changed = 0;
+    uint8_t i;
+
+    TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+
+    for(i = 0; i < PATTERN_TRACKS; i++)
+    {
+        Pattern_Track *t = &tracks[i];
+
+        if(t->pattern != 0 && --t->ticks_left == 0U)
+        {
+            Begin(t, t->step + 1);
+            changed = 1;
+        }
+    }
+
+    if(changed != 0U)
+    {
+        Apply();
+    }
+}
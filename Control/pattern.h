@@ -0,0 +1,98 @@
+/*****************************************************************************
+ * File: pattern.h
+ * Module: PATTERN
+ * Description: Header file for the LED / buzzer pattern sequencer
+ *
+ * Feedback is described as step tables and played back from the Timer1A
+ * interrupt, so a blink or a beep never holds up a task:
+ *
+ *     static const Pattern_Step beep_twice[] = {
+ *         PATTERN_STEP(PATTERN_BUZZER, 100U),
+ *         PATTERN_STEP(0U, 100U),
+ *         PATTERN_STEP(PATTERN_BUZZER, 100U),
+ *         PATTERN_END
+ *     };
+ *     Pattern_Play(track, beep_twice);
+ *
+ * There are PATTERN_TRACKS independent tracks; the outputs lit are those
+ * of the current step of every playing track, so a door indicator and a
+ * status flash can overlap. Only the lowest-numbered track sounding the
+ * buzzer sets its pitch. Step lengths are rounded up to PATTERN_TICK_MS,
+ * and the first step of a pattern can end up to one tick early.
+ *
+ * The timer runs only while a track is playing; each tick costs one
+ * decrement per playing track, and nothing at all when idle.
+ *****************************************************************************/
+
+#ifndef PATTERN_H_
+#define PATTERN_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define PATTERN_TRACKS          3U
+#define PATTERN_TICK_MS         10U
+
+/* Outputs */
+#define PATTERN_RED             0x01U   /* PF1 */
+#define PATTERN_GREEN           0x02U   /* PF3 */
+#define PATTERN_BUZZER          0x04U   /* PE4, see buzzer.h */
+#define PATTERN_LOOP            0x80U   /* In a terminating step: start over */
+
+/*
+ * Pattern_Step
+ * One step: which outputs are on, and for how long. A step with ms 0 ends
+ * the table.
+ */
+typedef struct
+{
+    uint8_t  outputs;                   /* PATTERN_RED | PATTERN_GREEN | PATTERN_BUZZER */
+    uint8_t  tone;                      /* Buzzer pitch / 100 Hz, 0 = BUZZER_TONE_DEFAULT_HZ */
+    uint16_t ms;
+} Pattern_Step;
+
+#define PATTERN_STEP(outputs, ms)           { (uint8_t)(outputs), 0U, (uint16_t)(ms) }
+#define PATTERN_TONE(outputs, hz, ms)       { (uint8_t)(outputs), (uint8_t)((hz) / 100U), (uint16_t)(ms) }
+#define PATTERN_END                         { 0U, 0U, 0U }
+#define PATTERN_REPEAT                      { PATTERN_LOOP, 0U, 0U }
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Pattern_Init
+ * Sets up Timer1A and turns every output off. The LED pins (System_Init)
+ * and the buzzer (Buzzer_Init) must be configured first.
+ */
+void Pattern_Init(void);
+
+/*
+ * Pattern_Play
+ * Starts a step table on a track, replacing whatever the track was
+ * playing. The table must stay valid while it plays (use const data).
+ */
+void Pattern_Play(uint8_t track, const Pattern_Step *pattern);
+
+/*
+ * Pattern_Stop
+ * Silences a track at once.
+ */
+void Pattern_Stop(uint8_t track);
+
+/*
+ * Pattern_IsPlaying
+ * Returns: 1 while the track has a pattern (looping ones never finish)
+ */
+uint8_t Pattern_IsPlaying(uint8_t track);
+
+/*
+ * Timer1A_Handler
+ * Step timer interrupt (vector table entry).
+ */
+void Timer1A_Handler(void);
+
+#endif /* PATTERN_H_ */
@@ -0,0 +1,150 @@
+/*****************************************************************************
+ * File: sched.h
+ * Module: SCHED
+ * Description: Header file for the cooperative run-to-completion scheduler
+ *
+ * Tasks are plain functions that run to completion and return. Each task
+ * has a priority, an optional period and a small event queue. On every
+ * pass the scheduler fires due timers, then runs exactly one slice: the
+ * highest-priority task that has a queued event or whose period is due.
+ * Worst-case response is therefore the longest single slice, not the
+ * longest delay anywhere in the program.
+ *
+ * Every slice is timed on the SysTick clock, giving per-task run counts,
+ * total and worst-case CPU time, plus idle time for the whole loop.
+ *
+ * Sched_Post() may be called from interrupt handlers, and
+ * Sched_GetRunning() tells one which task it interrupted.
+ *****************************************************************************/
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Capacities */
+#define SCHED_MAX_TASKS         8
+#define SCHED_QUEUE_DEPTH       4       /* Events per task */
+#define SCHED_MAX_TIMERS        8
+
+/* Priorities (lower value runs first) */
+#define SCHED_PRIORITY_HIGH     0
+#define SCHED_PRIORITY_NORMAL   1
+#define SCHED_PRIORITY_LOW      2
+
+/* Reserved event codes; application events start at SCHED_EVENT_USER */
+#define SCHED_EVENT_PERIODIC    0x00U   /* Period elapsed */
+#define SCHED_EVENT_USER        0x10U
+
+/* Invalid task / timer handle */
+#define SCHED_INVALID           0xFFU
+
+/* Return codes */
+#define SCHED_SUCCESS           0
+#define SCHED_ERROR             1
+
+/*
+ * Sched_Event
+ * Delivered to a task for each slice.
+ */
+typedef struct
+{
+    uint8_t  code;
+    uint32_t param;
+} Sched_Event;
+
+typedef void (*Sched_TaskFn)(const Sched_Event *event);
+
+/*
+ * Sched_TaskStats
+ * CPU-time accounting for one task.
+ */
+typedef struct
+{
+    uint32_t runs;          /* Slices executed */
+    uint32_t total_us;      /* Sum of slice durations (wraps after ~71 min busy) */
+    uint32_t max_us;        /* Longest slice */
+    uint32_t dropped;       /* Events lost to a full queue */
+} Sched_TaskStats;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Sched_Init
+ * Clears all tasks, queues and timers. Requires the 1 ms SysTick tick.
+ */
+void Sched_Init(void);
+
+/*
+ * Sched_AddTask
+ * Registers a task.
+ * Parameters:
+ *   fn        - Task body
+ *   priority  - SCHED_PRIORITY_*
+ *   period_ms - Run with SCHED_EVENT_PERIODIC this often (0 = events only)
+ * Returns: task handle, or SCHED_INVALID if the table is full
+ */
+uint8_t Sched_AddTask(Sched_TaskFn fn, uint8_t priority, uint32_t period_ms);
+
+/*
+ * Sched_Post
+ * Queues an event for a task. Safe from interrupt handlers.
+ * Returns: SCHED_SUCCESS, or SCHED_ERROR if the queue is full
+ */
+uint8_t Sched_Post(uint8_t task, uint8_t code, uint32_t param);
+
+/*
+ * Sched_StartTimer
+ * Posts code to task after delay_ms, then every period_ms (0 = one-shot).
+ * Returns: timer handle, or SCHED_INVALID if none is free
+ */
+uint8_t Sched_StartTimer(uint8_t task, uint8_t code, uint32_t delay_ms, uint32_t period_ms);
+
+/*
+ * Sched_StopTimer
+ * Cancels a timer; stopping SCHED_INVALID is harmless. A one-shot's handle
+ * is free for reuse once it fires, so only stop timers known to be pending.
+ */
+void Sched_StopTimer(uint8_t timer);
+
+/*
+ * Sched_RunOnce
+ * Fires due timers and runs at most one task slice.
+ * Returns: 1 if a task ran, 0 if the pass was idle
+ */
+uint8_t Sched_RunOnce(void);
+
+/*
+ * Sched_Run
+ * Calls Sched_RunOnce() forever.
+ */
+void Sched_Run(void);
+
+/*
+ * Sched_GetTaskStats
+ * Copies the accounting for one task.
+ */
+void Sched_GetTaskStats(uint8_t task, Sched_TaskStats *stats);
+
+/*
+ * Sched_GetIdleUs
+ * Total time spent in passes where no task was ready.
+ */
+uint32_t Sched_GetIdleUs(void);
+
+/*
+ * Sched_GetRunning
+ * The task in its slice, for an interrupt handler or fault report.
+ * Parameters:
+ *   slice_us - Set to how long the slice has run (0 between slices)
+ * Returns: its handle, or SCHED_INVALID between slices
+ */
+uint8_t Sched_GetRunning(uint32_t *slice_us);
+
+#endif /* SCHED_H_ */
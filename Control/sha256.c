@@ -0,0 +1,241 @@
+/*****************************************************************************
+ * File: sha256.c
+ * Module: SHA256
+ * Description: Source file for the SHA-256 hash (FIPS 180-4)
+ *
+ * Cost on the Cortex-M4 is dominated by SHA256_Transform(). The working
+ * variables a..h are plain locals that the compiler keeps in registers; each
+ * ROUND() writes only d and h, and the next round is called with the names
+ * rotated, so no register moves are needed between rounds.
+ *****************************************************************************/
+
+#include "sha256.h"
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Macros                                         *
+ ******************************************************************************/
+
+/* Compiles to a single ROR instruction on the Cortex-M4 */
+#define ROTR(x, n)      (((x) >> (n)) | ((x) << (32U - (n))))
+
+#define CH(x, y, z)     ((((y) ^ (z)) & (x)) ^ (z))
+#define MAJ(x, y, z)    (((x) & (y)) | ((z) & ((x) | (y))))
+#define BSIG0(x)        (ROTR((x), 2U) ^ ROTR((x), 13U) ^ ROTR((x), 22U))
+#define BSIG1(x)        (ROTR((x), 6U) ^ ROTR((x), 11U) ^ ROTR((x), 25U))
+#define SSIG0(x)        (ROTR((x), 7U) ^ ROTR((x), 18U) ^ ((x) >> 3U))
+#define SSIG1(x)        (ROTR((x), 17U) ^ ROTR((x), 19U) ^ ((x) >> 10U))
+
+/* Message schedule in a 16-word circular window */
+#define W_NEXT(j)       (w[(j)] += SSIG1(w[((j) + 14U) & 15U]) + w[((j) + 9U) & 15U] + \
+                                   SSIG0(w[((j) + 1U) & 15U]))
+
+#define ROUND(a, b, c, d, e, f, g, h, k, wj)                        \
+    do {                                                            \
+        uint32_t t1 = (h) + BSIG1(e) + CH((e), (f), (g)) + (k) + (wj); \
+        (d) += t1;                                                  \
+        (h) = t1 + BSIG0(a) + MAJ((a), (b), (c));                   \
+    } while(0)
+
+/* Sixteen rounds with the working variables rotated by name */
+#define ROUNDS_16(K, W)                                             \
+    do {                                                            \
+        ROUND(a, b, c, d, e, f, g, h, (K)[0],  W(0U));              \
+        ROUND(h, a, b, c, d, e, f, g, (K)[1],  W(1U));              \
+        ROUND(g, h, a, b, c, d, e, f, (K)[2],  W(2U));              \
+        ROUND(f, g, h, a, b, c, d, e, (K)[3],  W(3U));              \
+        ROUND(e, f, g, h, a, b, c, d, (K)[4],  W(4U));              \
+        ROUND(d, e, f, g, h, a, b, c, (K)[5],  W(5U));              \
+        ROUND(c, d, e, f, g, h, a, b, (K)[6],  W(6U));              \
+        ROUND(b, c, d, e, f, g, h, a, (K)[7],  W(7U));              \
+        ROUND(a, b, c, d, e, f, g, h, (K)[8],  W(8U));              \
+        ROUND(h, a, b, c, d, e, f, g, (K)[9],  W(9U));              \
+        ROUND(g, h, a, b, c, d, e, f, (K)[10], W(10U));             \
+        ROUND(f, g, h, a, b, c, d, e, (K)[11], W(11U));             \
+        ROUND(e, f, g, h, a, b, c, d, (K)[12], W(12U));             \
+        ROUND(d, e, f, g, h, a, b, c, (K)[13], W(13U));             \
+        ROUND(c, d, e, f, g, h, a, b, (K)[14], W(14U));             \
+        ROUND(b, c, d, e, f, g, h, a, (K)[15], W(15U));             \
+    } while(0)
+
+#define W_FIRST(j)      (w[(j)] = block[(j)])
+
+/******************************************************************************
+ *                              Constants                                      *
+ ******************************************************************************/
+
+static const uint32_t K256[64] =
+{
+    0x428A2F98U, 0x71374491U, 0xB5C0FBCFU, 0xE9B5DBA5U, 0x3956C25BU, 0x59F111F1U, 0x923F82A4U, 0xAB1C5ED5U,
+    0xD807AA98U, 0x12835B01U, 0x243185BEU, 0x550C7DC3U, 0x72BE5D74U, 0x80DEB1FEU, 0x9BDC06A7U, 0xC19BF174U,
+    0xE49B69C1U, 0xEFBE4786U, 0x0FC19DC6U, 0x240CA1CCU, 0x2DE92C6FU, 0x4A7484AAU, 0x5CB0A9DCU, 0x76F988DAU,
+    0x983E5152U, 0xA831C66DU, 0xB00327C8U, 0xBF597FC7U, 0xC6E00BF3U, 0xD5A79147U, 0x06CA6351U, 0x14292967U,
+    0x27B70A85U, 0x2E1B2138U, 0x4D2C6DFCU, 0x53380D13U, 0x650A7354U, 0x766A0ABBU, 0x81C2C92EU, 0x92722C85U,
+    0xA2BFE8A1U, 0xA81A664BU, 0xC24B8B70U, 0xC76C51A3U, 0xD192E819U, 0xD6990624U, 0xF40E3585U, 0x106AA070U,
+    0x19A4C116U, 0x1E376C08U, 0x2748774CU, 0x34B0BCB5U, 0x391C0CB3U, 0x4ED8AA4AU, 0x5B9CCA4FU, 0x682E6FF3U,
+    0x748F82EEU, 0x78A5636FU, 0x84C87814U, 0x8CC70208U, 0x90BEFFFAU, 0xA4506CEBU, 0xBEF9A3F7U, 0xC67178F2U
+};
+
+static const uint32_t H256_INIT[SHA256_DIGEST_WORDS] =
+{
+    0x6A09E667U, 0xBB67AE85U, 0x3C6EF372U, 0xA54FF53AU,
+    0x510E527FU, 0x9B05688CU, 0x1F83D9ABU, 0x5BE0CD19U
+};
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * LoadBE32
+ * Decodes a big-endian 32-bit word.
+ */
+static uint32_t LoadBE32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8)  |  (uint32_t)p[3];
+}
+
+/*
+ * StoreBE32
+ * Encodes a 32-bit word as big-endian.
+ */
+static void StoreBE32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/*
+ * CompressBytes
+ * Decodes a 64-byte block and compresses it.
+ */
+static void CompressBytes(uint32_t state[SHA256_DIGEST_WORDS], const uint8_t *data)
+{
+    uint32_t block[SHA256_BLOCK_WORDS];
+    uint32_t i;
+
+    for(i = 0; i < SHA256_BLOCK_WORDS; i++)
+    {
+        block[i] = LoadBE32(&data[i * 4U]);
+    }
+    SHA256_Transform(state, block);
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * SHA256_Transform
+ * Compression function: rounds 0-15 consume the block directly, rounds
+ * 16-63 run as three passes over the circular schedule window.
+ */
+void SHA256_Transform(uint32_t state[SHA256_DIGEST_WORDS], const uint32_t block[SHA256_BLOCK_WORDS])
+{
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+    uint32_t f = state[5];
+    uint32_t g = state[6];
+    uint32_t h = state[7];
+    uint32_t w[SHA256_BLOCK_WORDS];
+    const uint32_t *k;
+
+    ROUNDS_16(K256, W_FIRST);
+
+    for(k = &K256[16]; k < &K256[64]; k += 16)
+    {
+        ROUNDS_16(k, W_NEXT);
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+/*
+ * SHA256_Init
+ * Loads the initial hash value into a context.
+ */
+void SHA256_Init(SHA256_Context *ctx)
+{
+    memcpy(ctx->state, H256_INIT, sizeof(ctx->state));
+    ctx->length = 0;
+}
+
+/*
+ * SHA256_Update
+ * Fills the partial block first, then compresses whole blocks straight
+ * from the caller's buffer.
+ */
+void SHA256_Update(SHA256_Context *ctx, const uint8_t *data, uint32_t length)
+{
+    uint32_t used = ctx->length % SHA256_BLOCK_SIZE;
+
+    ctx->length += length;
+
+    if(used != 0U)
+    {
+        uint32_t fill = SHA256_BLOCK_SIZE - used;
+
+        if(length < fill)
+        {
+            memcpy(&ctx->buffer[used], data, length);
+            return;
+        }
+        memcpy(&ctx->buffer[used], data, fill);
+        CompressBytes(ctx->state, ctx->buffer);
+        data += fill;
+        length -= fill;
+    }
+
+    while(length >= SHA256_BLOCK_SIZE)
+    {
+        CompressBytes(ctx->state, data);
+        data += SHA256_BLOCK_SIZE;
+        length -= SHA256_BLOCK_SIZE;
+    }
+
+    memcpy(ctx->buffer, data, length);
+}
+
+/*
+ * SHA256_Final
+ * Appends the 0x80 terminator and the 64-bit message bit length.
+ */
+void SHA256_Final(SHA256_Context *ctx, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    uint32_t used = ctx->length % SHA256_BLOCK_SIZE;
+    uint32_t i;
+
+    ctx->buffer[used++] = 0x80U;
+
+    if(used > (SHA256_BLOCK_SIZE - 8U))
+    {
+        memset(&ctx->buffer[used], 0, SHA256_BLOCK_SIZE - used);
+        CompressBytes(ctx->state, ctx->buffer);
+        used = 0;
+    }
+    memset(&ctx->buffer[used], 0, (SHA256_BLOCK_SIZE - 8U) - used);
+
+    /* Message length in bits; lengths here never exceed 2^29 bytes */
+    StoreBE32(&ctx->buffer[SHA256_BLOCK_SIZE - 8U], ctx->length >> 29);
+    StoreBE32(&ctx->buffer[SHA256_BLOCK_SIZE - 4U], ctx->length << 3);
+    CompressBytes(ctx->state, ctx->buffer);
+
+    for(i = 0; i < SHA256_DIGEST_WORDS; i++)
+    {
+        StoreBE32(&digest[i * 4U], ctx->state[i]);
+    }
+}
@@ -0,0 +1,69 @@
+/*****************************************************************************
+ * File: sha256.h
+ * Module: SHA256
+ * Description: Header file for the SHA-256 hash (FIPS 180-4)
+ *
+ * The compression function is written for the Cortex-M4: the eight working
+ * variables stay in registers, rounds are unrolled sixteen at a time so the
+ * variables rotate by name instead of being shuffled, and the message
+ * schedule lives in a 16-word circular window.
+ *
+ * SHA256_Transform() works on a block that is already in host word order so
+ * callers hashing fixed-size data (see password.c) can skip the byte packing.
+ *****************************************************************************/
+
+#ifndef SHA256_H_
+#define SHA256_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SHA256_BLOCK_SIZE       64      /* Bytes per compression block */
+#define SHA256_BLOCK_WORDS      16      /* 32-bit words per block */
+#define SHA256_DIGEST_SIZE      32      /* Bytes per digest */
+#define SHA256_DIGEST_WORDS     8       /* 32-bit words per digest */
+
+/*
+ * SHA256_Context
+ * Running state of a streaming hash.
+ */
+typedef struct
+{
+    uint32_t state[SHA256_DIGEST_WORDS];
+    uint32_t length;                    /* Total bytes hashed so far */
+    uint8_t  buffer[SHA256_BLOCK_SIZE]; /* Partial block */
+} SHA256_Context;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * SHA256_Init
+ * Loads the initial hash value into a context.
+ */
+void SHA256_Init(SHA256_Context *ctx);
+
+/*
+ * SHA256_Update
+ * Hashes length bytes of data into the context.
+ */
+void SHA256_Update(SHA256_Context *ctx, const uint8_t *data, uint32_t length);
+
+/*
+ * SHA256_Final
+ * Pads the message and writes the 32-byte digest (big-endian byte order).
+ */
+void SHA256_Final(SHA256_Context *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+/*
+ * SHA256_Transform
+ * Runs the compression function over one block of 16 words that have
+ * already been decoded from big-endian. The block is not modified.
+ */
+void SHA256_Transform(uint32_t state[SHA256_DIGEST_WORDS], const uint32_t block[SHA256_BLOCK_WORDS]);
+
+#endif /* SHA256_H_ */
@@ -0,0 +1,56 @@
+/*****************************************************************************
+ * File: stack.h
+ * Module: STACK
+ * Description: Header file for the main stack's high-water mark
+ *
+ * The stack is startup_ewarm.c's pui32Stack, STACK_WORDS words in .noinit,
+ * shared by main(), every scheduler task and every interrupt. ResetISR
+ * fills it with STACK_PAINT before the C runtime starts, all but the top
+ * STACK_PAINT_SKIP words its own frame sits in. .noinit is not cleared,
+ * so the paint is still there when main() runs.
+ *
+ * A word that no longer holds STACK_PAINT has been used, so the lowest
+ * one is the deepest the stack has been since reset: Stack_GetUsed().
+ * The worst case that can happen is the linker's stack usage analysis
+ * (stack.suc), which fails the link if it does not fit STACK_WORDS.
+ *
+ * The deepest path is SETPWD on Control: Password_Commit, DeriveDigest
+ * and SHA-256 under the command handler, about 1 KB with the scheduler
+ * and an interrupt on top. The 512 bytes the startup file first reserved
+ * were not enough.
+ *****************************************************************************/
+
+#ifndef STACK_H_
+#define STACK_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define STACK_WORDS             384U            /* 1.5 KB; stack.suc checks the same figure */
+#define STACK_PAINT             0xA5A5A5A5U
+#define STACK_PAINT_SKIP        8U              /* Top words left for ResetISR's frame */
+
+/* startup_ewarm.c */
+extern uint32_t pui32Stack[STACK_WORDS];
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Stack_GetUsed
+ * Returns: the most stack used since reset, in bytes (at least the
+ *          STACK_PAINT_SKIP words left unpainted)
+ */
+uint32_t Stack_GetUsed(void);
+
+/*
+ * Stack_GetSize
+ * Returns: the stack's size in bytes
+ */
+uint32_t Stack_GetSize(void);
+
+#endif /* STACK_H_ */
@@ -26,6 +26,8 @@
 #include <stdint.h>
 #include "inc/hw_nvic.h"
 #include "inc/hw_types.h"
+#include "stack.h"
+#include "wdt.h"
 
 //*****************************************************************************
 //
@@ -40,12 +42,20 @@
 //
 //*****************************************************************************
 void ResetISR(void);
-static void NmiSR(void);
+static __stackless void NmiSR(void);
 static void FaultISR(void);
 static void IntDefaultHandler(void);
 
 // Added default SysTick handler
 void SystickHandler(void);
+void UART2_Handler(void);
+void Timer1A_Handler(void);
+void GPIOPortA_Handler(void);
+void GPIOPortB_Handler(void);
+void GPIOPortC_Handler(void);
+void GPIOPortD_Handler(void);
+void GPIOPortE_Handler(void);
+void GPIOPortF_Handler(void);
 
 //*****************************************************************************
 //
@@ -56,10 +66,19 @@ extern void __iar_program_start(void);
 
 //*****************************************************************************
 //
-// Reserve space for the system stack.
+// Reserve space for the system stack.  Its size and the high-water mark
+// painted into it are in stack.h.
 //
 //*****************************************************************************
-static uint32_t pui32Stack[128] @ ".noinit";
+uint32_t pui32Stack[STACK_WORDS] @ ".noinit";
+
+//*****************************************************************************
+//
+// What the last watchdog time-out interrupted (wdt.h).  In .noinit so that
+// it survives the reset that follows.
+//
+//*****************************************************************************
+Wdt_Record wdt_record @ ".noinit";
 
 //*****************************************************************************
 //
@@ -100,11 +119,11 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
     0,                                      // Reserved
     IntDefaultHandler,                      // The PendSV handler
     SystickHandler,                         // The SysTick handler
-    IntDefaultHandler,                      // GPIO Port A
-    IntDefaultHandler,                      // GPIO Port B
-    IntDefaultHandler,                      // GPIO Port C
-    IntDefaultHandler,                      // GPIO Port D
-    IntDefaultHandler,                      // GPIO Port E
+    GPIOPortA_Handler,                    // GPIO Port A
+    GPIOPortB_Handler,                    // GPIO Port B
+    GPIOPortC_Handler,                    // GPIO Port C
+    GPIOPortD_Handler,                    // GPIO Port D
+    GPIOPortE_Handler,                    // GPIO Port E
     IntDefaultHandler,                      // UART0 Rx and Tx
     IntDefaultHandler,                      // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
@@ -121,7 +140,7 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
     IntDefaultHandler,                      // Watchdog timer
     IntDefaultHandler,                      // Timer 0 subtimer A
     IntDefaultHandler,                      // Timer 0 subtimer B
-    IntDefaultHandler,                      // Timer 1 subtimer A
+    Timer1A_Handler,                        // Timer 1 subtimer A
     IntDefaultHandler,                      // Timer 1 subtimer B
     IntDefaultHandler,                      // Timer 2 subtimer A
     IntDefaultHandler,                      // Timer 2 subtimer B
@@ -130,10 +149,10 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
     IntDefaultHandler,                      // Analog Comparator 2
     IntDefaultHandler,                      // System Control (PLL, OSC, BO)
     IntDefaultHandler,                      // FLASH Control
-    IntDefaultHandler,                      // GPIO Port F
+    GPIOPortF_Handler,                    // GPIO Port F
     IntDefaultHandler,                      // GPIO Port G
     IntDefaultHandler,                      // GPIO Port H
-    IntDefaultHandler,                      // UART2 Rx and Tx
+    UART2_Handler,                          // UART2 Rx and Tx
     IntDefaultHandler,                      // SSI1 Rx and Tx
     IntDefaultHandler,                      // Timer 3 subtimer A
     IntDefaultHandler,                      // Timer 3 subtimer B
@@ -249,6 +268,8 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
 void
 ResetISR(void)
 {
+    uint32_t *pui32Word;
+
     //
     // Enable the floating-point unit.
     //
@@ -256,6 +277,16 @@ ResetISR(void)
                          ~(NVIC_CPAC_CP10_M | NVIC_CPAC_CP11_M)) |
                         NVIC_CPAC_CP10_FULL | NVIC_CPAC_CP11_FULL);
 
+    //
+    // Paint the stack for Stack_GetUsed(), up to this function's own frame
+    // at the top.
+    //
+    for(pui32Word = pui32Stack;
+        pui32Word < &pui32Stack[STACK_WORDS - STACK_PAINT_SKIP]; pui32Word++)
+    {
+        *pui32Word = STACK_PAINT;
+    }
+
     //
     // Call the application's entry point.
     //
@@ -264,12 +295,18 @@ ResetISR(void)
 
 //*****************************************************************************
 //
-// NMI handler
+// NMI handler.  The watchdog's first time-out arrives here (wdt.c makes it
+// non-maskable).  Wdt_Expired() records the exception frame the interrupted
+// code left on the stack, then this waits for the second time-out to reset
+// the device.  __stackless keeps the stack pointer on that frame.
 //
 //*****************************************************************************
-static void
+static __stackless void
 NmiSR(void)
 {
+    __asm("MRS R0, MSP\n"
+          "BL Wdt_Expired");
+
     while(1)
     {
     }
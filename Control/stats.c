@@ -0,0 +1,206 @@
+/*****************************************************************************
+ * File: stats.c
+ * Module: STATS
+ * Description: Source file for the Control unit's runtime counters
+ *****************************************************************************/
+
+#include "stats.h"
+#include "sched.h"
+#include "systick.h"
+#include "uart.h"
+#include "eeprom.h"
+#include "door.h"
+#include "stack.h"
+#include "wdt.h"
+#include "fmt.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* A fixed field: its name and where its value sits in Stats_Snapshot */
+typedef struct
+{
+    const char *name;
+    uint8_t     offset;
+} Stats_Field;
+
+#define STATS_FIELD(name, member)   { (name), (uint8_t)offsetof(Stats_Snapshot, member) }
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static const Stats_Field fields[STATS_FIXED_FIELDS] =
+{
+    STATS_FIELD("UPTIME_S",    uptime_s),
+    STATS_FIELD("IDLE_PCT",    idle_percent),
+    STATS_FIELD("LOOP_MAX_US", loop_max_us),
+    STATS_FIELD("AUTH_OK",     auth_ok),
+    STATS_FIELD("AUTH_FAIL",   auth_failed),
+    STATS_FIELD("RX_OVERRUN",  rx_overruns),
+    STATS_FIELD("RX_FRAMING",  rx_framing),
+    STATS_FIELD("EE_WRITES",   eeprom_writes),
+    STATS_FIELD("EE_MAX_US",   eeprom_max_us),
+    STATS_FIELD("EE_MEAN_US",  eeprom_mean_us),
+    STATS_FIELD("SERVO_MOVES", servo_moves),
+    STATS_FIELD("STACK_USED",  stack_used),
+    STATS_FIELD("STACK_SIZE",  stack_size),
+    STATS_FIELD("WDT_PC",      wdt_pc),
+    STATS_FIELD("WDT_TASK",    wdt_task),
+    STATS_FIELD("WDT_RUN_US",  wdt_slice_us),
+    STATS_FIELD("WDT_LATE",    wdt_late)
+};
+
+/* Indexed by COMMAND_* code */
+static const char *const command_names[COMMAND_COUNT] =
+{
+    "C_NONE", "C_UNKNOWN", "C_BAD_DOOR", "C_ALARM", "C_SETPWD", "C_TIMEOUT",
+    "C_VERIFYPWD", "C_VERIFY", "C_CLOSE", "C_HOLD", "C_AUDIT", "C_CFG",
+    "C_BAUD_COMMIT", "C_BAUD", "C_PING", "C_HB", "C_STATS"
+};
+
+static uint32_t commands[COMMAND_COUNT];
+static uint32_t auth_ok = 0;
+static uint32_t auth_failed = 0;
+
+/* Idle-time window */
+static uint32_t sample_at_us = 0;
+static uint32_t sample_idle_us = 0;
+static uint32_t idle_percent = 0;
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Stats_CountCommand
+ */
+void Stats_CountCommand(uint8_t code)
+{
+    if(code < COMMAND_COUNT)
+    {
+        commands[code]++;
+    }
+}
+
+/*
+ * Stats_CountAuth
+ */
+void Stats_CountAuth(uint8_t matched)
+{
+    if(matched != 0U)
+    {
+        auth_ok++;
+    }
+    else
+    {
+        auth_failed++;
+    }
+}
+
+/*
+ * Stats_Sample
+ * Both counters are 32-bit microseconds; a window is far shorter than
+ * their 71 minute wrap, so the differences are exact.
+ */
+void Stats_Sample(void)
+{
+    uint32_t now = SysTick_GetMicros();
+    uint32_t idle = Sched_GetIdleUs();
+    uint32_t span = now - sample_at_us;
+
+    if(span >= 100U)
+    {
+        idle_percent = (idle - sample_idle_us) / (span / 100U);
+        if(idle_percent > 100U)
+        {
+            idle_percent = 100U;
+        }
+    }
+    sample_at_us = now;
+    sample_idle_us = idle;
+}
+
+/*
+ * Stats_Get
+ * Tasks that do not exist leave their Sched_TaskStats untouched, so each
+ * one starts from zero.
+ */
+void Stats_Get(Stats_Snapshot *snapshot)
+{
+    UART2_Stats uart;
+    EEPROM_Stats eeprom;
+    Wdt_Record wdt = { 0, 0, 0, 0, 0, SCHED_INVALID, SCHED_INVALID, 0 };
+    uint8_t i;
+
+    UART2_GetStats(&uart);
+    EEPROM_GetStats(&eeprom);
+    (void)Wdt_GetLastReset(&wdt);
+
+    snapshot->uptime_s = SysTick_GetTicks() / 1000U;
+    snapshot->idle_percent = idle_percent;
+    snapshot->loop_max_us = 0;
+    for(i = 0; i < SCHED_MAX_TASKS; i++)
+    {
+        Sched_TaskStats task = { 0, 0, 0, 0 };
+
+        Sched_GetTaskStats(i, &task);
+        if(task.max_us > snapshot->loop_max_us)
+        {
+            snapshot->loop_max_us = task.max_us;
+        }
+    }
+    snapshot->auth_ok = auth_ok;
+    snapshot->auth_failed = auth_failed;
+    snapshot->rx_overruns = uart.rx_overruns;
+    snapshot->rx_framing = uart.rx_framing;
+    snapshot->eeprom_writes = eeprom.writes;
+    snapshot->eeprom_max_us = eeprom.max_us;
+    snapshot->eeprom_mean_us = (eeprom.writes != 0U) ? (eeprom.total_us / eeprom.writes) : 0U;
+    snapshot->servo_moves = Door_GetMoves();
+    snapshot->stack_used = Stack_GetUsed();
+    snapshot->stack_size = Stack_GetSize();
+    snapshot->wdt_pc = wdt.pc;
+    snapshot->wdt_task = wdt.task;
+    snapshot->wdt_slice_us = wdt.slice_us;
+    snapshot->wdt_late = wdt.late;
+    for(i = 0; i < COMMAND_COUNT; i++)
+    {
+        snapshot->commands[i] = commands[i];
+    }
+}
+
+/*
+ * Stats_FormatField
+ * The fixed fields first, then one per command code.
+ */
+uint8_t Stats_FormatField(const Stats_Snapshot *snapshot, uint32_t index, char *line)
+{
+    Fmt_Buffer out;
+    const char *name;
+    uint32_t value;
+
+    if(index < STATS_FIXED_FIELDS)
+    {
+        name = fields[index].name;
+        value = *(const uint32_t *)((const uint8_t *)snapshot + fields[index].offset);
+    }
+    else if(index < STATS_FIELD_COUNT)
+    {
+        name = command_names[index - STATS_FIXED_FIELDS];
+        value = snapshot->commands[index - STATS_FIXED_FIELDS];
+    }
+    else
+    {
+        return 0;
+    }
+
+    Fmt_Begin(&out, line, STATS_FIELD_SIZE);
+    Fmt_String(&out, name);
+    Fmt_Char(&out, '=');
+    Fmt_Uint(&out, value);
+    return 1;
+}
@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * File: stats.h
+ * Module: STATS
+ * Description: Header file for the Control unit's runtime counters
+ *
+ * Answers "STATS?". Each counter is kept where its work is done, as a
+ * plain increment, and read only when asked for:
+ *
+ *     commands per code, password checks    Stats_CountCommand, Stats_CountAuth
+ *     UART2 receive overruns, framing       UART2_GetStats
+ *     EEPROM writes and their duration      EEPROM_GetStats
+ *     servo moves                           Door_GetMoves
+ *     longest task slice                    Sched_GetTaskStats
+ *     idle time                             Sched_GetIdleUs, via Stats_Sample
+ *     stack high-water mark                 Stack_GetUsed
+ *     what the last watchdog reset hit      Wdt_GetLastReset
+ *
+ * Stats_Get() gathers them into one fixed Stats_Snapshot. Text is only
+ * produced by Stats_FormatField(), one "<NAME>=<value>" field at a time,
+ * for the reply; nothing on the command or door path formats anything.
+ *
+ * The longest task slice is the main loop's worst latency: the longest
+ * time the scheduler could not start anything else. Idle is the share of
+ * the last STATS_SAMPLE_MS the scheduler found nothing ready.
+ *****************************************************************************/
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <stdint.h>
+#include "command.h"    /* COMMAND_COUNT */
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define STATS_SAMPLE_MS         1000U   /* Idle percentage window */
+#define STATS_FIXED_FIELDS      17U     /* Stats_Snapshot fields before commands[] */
+#define STATS_FIELD_COUNT       (STATS_FIXED_FIELDS + COMMAND_COUNT)
+#define STATS_FIELD_SIZE        26U     /* "C_BAUD_COMMIT=4294967295" and terminator */
+
+typedef struct
+{
+    uint32_t uptime_s;
+    uint32_t idle_percent;              /* Over the last STATS_SAMPLE_MS */
+    uint32_t loop_max_us;               /* Longest task slice */
+    uint32_t auth_ok;                   /* Password checks that matched */
+    uint32_t auth_failed;               /* ... and that did not */
+    uint32_t rx_overruns;
+    uint32_t rx_framing;
+    uint32_t eeprom_writes;
+    uint32_t eeprom_max_us;
+    uint32_t eeprom_mean_us;
+    uint32_t servo_moves;
+    uint32_t stack_used;                /* Most stack used since reset, bytes */
+    uint32_t stack_size;
+    uint32_t wdt_pc;                    /* Last watchdog reset: 0 if none since power-on */
+    uint32_t wdt_task;                  /* ... task in its slice (SCHED_INVALID = none) */
+    uint32_t wdt_slice_us;              /* ... and how long it had run */
+    uint32_t wdt_late;                  /* ... watched task past its deadline */
+    uint32_t commands[COMMAND_COUNT];   /* Lines received, per COMMAND_* code */
+} Stats_Snapshot;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Stats_CountCommand
+ * Counts one received line of the given COMMAND_* code.
+ */
+void Stats_CountCommand(uint8_t code);
+
+/*
+ * Stats_CountAuth
+ * Counts one password check; matched = 1 if it succeeded.
+ */
+void Stats_CountAuth(uint8_t matched);
+
+/*
+ * Stats_Sample
+ * Closes an idle-time window. Call every STATS_SAMPLE_MS.
+ */
+void Stats_Sample(void);
+
+/*
+ * Stats_Get
+ * Gathers every counter.
+ */
+void Stats_Get(Stats_Snapshot *snapshot);
+
+/*
+ * Stats_FormatField
+ * Writes field index of the snapshot as "<NAME>=<value>" into line
+ * (STATS_FIELD_SIZE bytes).
+ * Returns: 1, or 0 if index >= STATS_FIELD_COUNT (nothing written)
+ */
+uint8_t Stats_FormatField(const Stats_Snapshot *snapshot, uint32_t index, char *line);
+
+#endif /* STATS_H_ */
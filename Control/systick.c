@@ -37,31 +37,62 @@ void DelayMs(uint32_t ms)
             NVIC_ST_CURRENT_R = 0;
         }
     }
+    else
+    {
+        // INTERRUPT MODE - wait on the tick counter, SysTick keeps running
+        uint32_t start = msTicks;
+        while ((msTicks - start) < ms);
+    }
 }
 
 void delayUs(uint32_t ui32Us) {
-    // 1. Configure SysTick for 1 microsecond reload
-    // Formula: (SystemClock / 1,000,000) - 1
-    // Note: This assumes you have already set the system clock
-    uint32_t period = SysCtlClockGet() / 1000000;
-    
-    SysTickPeriodSet(period);
-    SysTickEnable();
+    // Busy-wait on the SysTick down-counter without reprogramming it, so the
+    // 1 ms tick keeps running while the servo generates its pulses.
+    if ((NVIC_ST_CTRL_R & NVIC_ST_CTRL_ENABLE) == 0)
+    {
+        SysTick_Init(SYSTICK_RELOAD_1MS, SYSTICK_NOINT);
+    }
 
-    // 2. Loop for the requested number of microseconds
-    for (uint32_t i = 0; i < ui32Us; i++) {
-        // Wait for the COUNTFLAG to be set (indicates timer rolled over)
-        while ((NVIC_ST_CTRL_R & NVIC_ST_CTRL_COUNT) == 0);
+    uint32_t period = NVIC_ST_RELOAD_R + 1;
+    uint32_t remaining = ui32Us * SYSTICK_CYCLES_PER_US;
+    uint32_t last = NVIC_ST_CURRENT_R;
+
+    while (remaining > 0)
+    {
+        uint32_t now = NVIC_ST_CURRENT_R;
+        uint32_t elapsed = (last >= now) ? (last - now) : (last + period - now);
+
+        if (elapsed >= remaining)
+        {
+            break;
+        }
+        remaining -= elapsed;
+        last = now;
     }
-    
-    SysTickDisable();
 }
 
-/* SysTick Interrupt Handler */
+uint32_t SysTick_GetTicks(void)
+{
+    return msTicks;
+}
+
+uint32_t SysTick_GetMicros(void)
+{
+    uint32_t ms;
+    uint32_t current;
+
+    // Re-read if the tick interrupt landed between the two reads
+    do
+    {
+        ms = msTicks;
+        current = NVIC_ST_CURRENT_R;
+    } while (ms != msTicks);
+
+    return (ms * 1000U) + ((SYSTICK_RELOAD_1MS - 1U - current) / SYSTICK_CYCLES_PER_US);
+}
+
+/* SysTick Interrupt Handler: 1 ms system tick */
 void SystickHandler(void)
 {
-    /* Toggle Green LED every SysTick interrupt */
-    DIO_TogglePin(PORTF, PIN3);
-    DIO_TogglePin(PORTF, PIN3);
-    DIO_TogglePin(PORTF, PIN3);
+    msTicks++;
 }
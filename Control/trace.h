@@ -0,0 +1,80 @@
+/*****************************************************************************
+ * File: trace.h
+ * Module: TRACE
+ * Description: Header file for the inter-ECU link trace
+ *
+ * With TRACE_ENABLE set, every byte sent or received on UART2 is stored
+ * with a microsecond timestamp in a RAM ring, and the ring is dumped as
+ * text on UART0 (PA0/PA1, the debugger's virtual COM port, 115200 8N1)
+ * when a 'D' arrives there:
+ *
+ *     TRACE <name> <entries> <lost>
+ *     <micros> <R|T|E> <hex byte>         R = received, T = sent,
+ *     ...                                 E = received with a UART error
+ *     END
+ *
+ * The ring keeps the newest TRACE_ENTRIES bytes; <lost> counts the older
+ * ones overwritten since the previous dump. Recording pauses while a dump
+ * is in progress and the ring is emptied after it, so each dump is one
+ * consistent capture. The dump is sent a FIFO-full at a time from
+ * Trace_Service and never blocks a task. Testing/Trace/trace_replay.py
+ * reads dumps, reports per-command latency and can replay them.
+ *
+ * Without TRACE_ENABLE (the default) the calls compile to nothing.
+ *****************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE            0
+#endif
+
+#define TRACE_ENTRIES           256U    /* Power of two; 8 bytes each */
+#define TRACE_SERVICE_MS        1U      /* Keeps the UART0 FIFO fed during a dump */
+#define TRACE_DUMP_REQUEST      'D'
+
+/* Trace_Record directions */
+#define TRACE_RX                0U
+#define TRACE_TX                1U
+#define TRACE_RX_ERROR          2U
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+#if TRACE_ENABLE
+
+/*
+ * Trace_Init
+ * Sets up UART0 and empties the ring. name heads every dump (e.g. "CONTROL").
+ */
+void Trace_Init(const char *name);
+
+/*
+ * Trace_Record
+ * Stores one byte; safe from interrupts and tasks.
+ */
+void Trace_Record(uint8_t direction, char c);
+
+/*
+ * Trace_Service
+ * Starts a dump on request and sends as much of it as UART0 takes.
+ */
+void Trace_Service(void);
+
+#else
+
+#define Trace_Init(name)                ((void)0)
+#define Trace_Record(direction, c)      ((void)0)
+#define Trace_Service()                 ((void)0)
+
+#endif /* TRACE_ENABLE */
+
+#endif /* TRACE_H_ */
@@ -1,8 +1,97 @@
 #include "tm4c123gh6pm.h"
 #include "uart.h"
+#include "systick.h"   // SYSTEM_CLOCK_HZ, SysTick_GetTicks()
+#include "trace.h"     // Every byte in and out, with TRACE_ENABLE
+#include <intrinsics.h>
 
 void delayMs(int ms);  // Forward declaration
 
+// Baud divisor in 1/64ths: IBRD = upper bits, FBRD = low 6 bits.
+// SYSTEM_CLOCK_HZ / (16 * baud) * 64, rounded to nearest.
+#define UART2_DIVISOR_64(baud)  (((SYSTEM_CLOCK_HZ * 4U) + ((baud) / 2U)) / (baud))
+
+#define UART2_FR_BUSY   0x08U
+#define UART2_FR_RXFE   0x10U
+#define UART2_LCRH_BRK  0x01U
+#define UART2_FR_TXFF  0x20U
+#define UART2_FR_TXFE  0x80U
+#define UART2_CTL_EOT  0x10U            // TX interrupt at end of transmission
+#define UART2_LCRH_8N1_FIFO 0x70U
+#define UART2_RX_ERRORS (UART2_RX_FRAMING | UART2_RX_PARITY | UART2_RX_BREAK | UART2_RX_OVERRUN)
+#define UART2_RX_MASK   (UART2_RX_BUFFER_SIZE - 1U)
+#define UART2_NVIC_BIT  0x02U           // Interrupt 33 = NVIC_EN1 bit 1
+
+// The ring indices and flow state are shared with UART2_Handler
+#define UART2_ENTER_CRITICAL()  uint32_t primask = __get_PRIMASK(); __disable_interrupt()
+#define UART2_EXIT_CRITICAL()   __set_PRIMASK(primask)
+
+static uint32_t current_baud = UART2_BAUD_DEFAULT;
+
+// Receive ring: UART2_Handler writes rx_head, the read functions rx_tail.
+// Both run freely; head - tail is the fill level. Each entry is the
+// character in bits 0..7 plus its UART2_RX_* error flags.
+static volatile uint16_t rx_ring[UART2_RX_BUFFER_SIZE];
+static volatile uint32_t rx_head = 0;
+static volatile uint32_t rx_tail = 0;
+
+static volatile UART2_Stats stats;
+
+#if UART2_FLOW_XONXOFF
+static volatile uint8_t tx_paused = 0;      // Peer sent XOFF
+static volatile uint32_t tx_paused_at = 0;
+static volatile uint8_t rx_throttled = 0;   // We sent XOFF
+static volatile char tx_control = 0;        // XON/XOFF waiting for TX FIFO room
+
+// Queues XON/XOFF ahead of any later character. If the TX FIFO is full
+// it goes out from the TX interrupt instead. Interrupts must be masked.
+static void SendControl(char c)
+{
+    if((UART2_FR_R & UART2_FR_TXFF) == 0) {
+        UART2_DR_R = c;
+        Trace_Record(TRACE_TX, c);
+    } else {
+        tx_control = c;
+        UART2_IM_R |= UART_IM_TXIM;
+    }
+}
+#endif
+
+// Removes the oldest ring entry; XON once the reader has caught up
+static uint16_t Pop(void)
+{
+    uint16_t entry;
+
+    if(rx_head == rx_tail) {
+        return 0;
+    }
+    entry = rx_ring[rx_tail & UART2_RX_MASK];
+    rx_tail++;
+
+#if UART2_FLOW_XONXOFF
+    if(rx_throttled != 0 && (rx_head - rx_tail) <= UART2_RX_LOW_WATER) {
+        UART2_ENTER_CRITICAL();
+        rx_throttled = 0;
+        SendControl(UART2_XON);
+        UART2_EXIT_CRITICAL();
+    }
+#endif
+    return entry;
+}
+
+// Forgets everything received so far and any flow-control state
+static void ResetRx(void)
+{
+    UART2_ENTER_CRITICAL();
+    rx_tail = rx_head;
+#if UART2_FLOW_XONXOFF
+    tx_paused = 0;
+    rx_throttled = 0;
+    tx_control = 0;
+    UART2_IM_R &= ~UART_IM_TXIM;
+#endif
+    UART2_EXIT_CRITICAL();
+}
+
 // NOTE: Function named UART0 but initializes UART2 (PD6/PD7)
 void UART2_Init(void) // Renamed from UART0_Init to match the actual hardware
 {
@@ -25,8 +114,9 @@ void UART2_Init(void) // Renamed from UART0_Init to match the actual hardware
 
     // 3. Configure Baud Rate: 115200 @ 16MHz
     // IBRD = 8, FBRD = 44 (Calculations are correct)
-    UART2_IBRD_R = 8;              
-    UART2_FBRD_R = 44;              
+    UART2_IBRD_R = UART2_DIVISOR_64(UART2_BAUD_DEFAULT) >> 6;
+    UART2_FBRD_R = UART2_DIVISOR_64(UART2_BAUD_DEFAULT) & 0x3F;
+    current_baud = UART2_BAUD_DEFAULT;
 
     // 4. Configure Line Control: 8-bit, no parity, 1 stop, FIFOs
     UART2_LCRH_R = 0x70;
@@ -38,6 +128,22 @@ void UART2_Init(void) // Renamed from UART0_Init to match the actual hardware
     // Enable UART (Bit 0), TX (Bit 9), RX (Bit 8) -> 0x301
     UART2_CTL_R = 0x301;            
 
+    // 6b. Receive by interrupt: RX FIFO half full, or idle for 32 bit times
+    UART2_IFLS_R = UART_IFLS_RX4_8;
+    UART2_ICR_R = 0x7F2;
+    UART2_IM_R = UART_IM_RXIM | UART_IM_RTIM;
+    ResetRx();
+    NVIC_EN1_R |= UART2_NVIC_BIT;
+
+#if UART2_RS485
+    // 6c. Driver enable on PD2, low = listening. The TX interrupt (end of
+    //     transmission) drops it again after each burst.
+    UART2_CTL_R |= UART2_CTL_EOT;
+    GPIO_PORTD_DATA_R &= ~UART2_DE_PIN;
+    GPIO_PORTD_DIR_R |= UART2_DE_PIN;
+    GPIO_PORTD_DEN_R |= UART2_DE_PIN;
+#endif
+
     // 7. Configure GPIO Pins (PD6=Rx, PD7=Tx)
     GPIO_PORTD_AFSEL_R |= 0xC0;     // Enable Alt Function on PD6, PD7
     
@@ -48,16 +154,107 @@ void UART2_Init(void) // Renamed from UART0_Init to match the actual hardware
     GPIO_PORTD_DEN_R |= 0xC0;       // Enable Digital on PD6, PD7
 }
 
+// Drains the RX FIFO into the ring (dropping and counting on overflow),
+// acts on XON/XOFF from the peer and sends XOFF at the high-water mark
+void UART2_Handler(void)
+{
+    UART2_ICR_R = UART2_MIS_R;
+
+    while((UART2_FR_R & UART2_FR_RXFE) == 0) {
+        uint32_t data = UART2_DR_R;
+        uint32_t errors = data & UART2_RX_ERRORS;
+
+        Trace_Record((errors != 0) ? TRACE_RX_ERROR : TRACE_RX, (char)(data & 0xFF));
+        if(errors != 0) {
+            stats.rx_errors++;
+            if((errors & UART2_RX_OVERRUN) != 0) {
+                stats.rx_overruns++;
+            }
+            if((errors & UART2_RX_FRAMING) != 0) {
+                stats.rx_framing++;
+            }
+        }
+#if UART2_FLOW_XONXOFF
+        else if((data & 0xFF) == UART2_XOFF) {
+            tx_paused = 1;
+            tx_paused_at = SysTick_GetTicks();
+            continue;
+        }
+        else if((data & 0xFF) == UART2_XON) {
+            tx_paused = 0;
+            continue;
+        }
+#endif
+
+        if((rx_head - rx_tail) >= UART2_RX_BUFFER_SIZE) {
+            stats.rx_dropped++;
+            continue;
+        }
+        rx_ring[rx_head & UART2_RX_MASK] = (uint16_t)(data & (0xFFU | UART2_RX_ERRORS));
+        rx_head++;
+
+#if UART2_FLOW_XONXOFF
+        if(rx_throttled == 0 && (rx_head - rx_tail) >= UART2_RX_HIGH_WATER) {
+            rx_throttled = 1;
+            stats.xoff_sent++;
+            SendControl(UART2_XOFF);
+        }
+#endif
+    }
+
+#if UART2_FLOW_XONXOFF
+    if(tx_control != 0 && (UART2_FR_R & UART2_FR_TXFF) == 0) {
+        UART2_DR_R = tx_control;
+        Trace_Record(TRACE_TX, tx_control);
+        tx_control = 0;
+        UART2_IM_R &= ~UART_IM_TXIM;
+    }
+#endif
+
+#if UART2_RS485
+    // Release the bus once the shifter is empty; a character queued since
+    // the interrupt keeps it
+    if((UART2_FR_R & (UART2_FR_BUSY | UART2_FR_TXFE)) == UART2_FR_TXFE) {
+        GPIO_PORTD_DATA_R &= ~UART2_DE_PIN;
+        UART2_IM_R &= ~UART_IM_TXIM;
+    }
+#endif
+}
+
 void UART2_SendChar(char c)
 {
-    while((UART2_FR_R & 0x20) != 0); // Wait if TX FIFO is Full
-    UART2_DR_R = c;
+    uint8_t sent = 0;
+
+#if UART2_FLOW_XONXOFF
+    // Hold back while the peer has sent XOFF, but not forever: if both
+    // sides throttled each other at once neither reader would ever run
+    while(tx_paused != 0) {
+        if((SysTick_GetTicks() - tx_paused_at) >= UART2_XOFF_TIMEOUT_MS) {
+            tx_paused = 0;
+            stats.xoff_timeouts++;
+        }
+    }
+#endif
+    while(sent == 0) {
+        while((UART2_FR_R & UART2_FR_TXFF) != 0); // Wait for room, interrupts on
+        UART2_ENTER_CRITICAL();              // The handler also writes DR,
+        if((UART2_FR_R & UART2_FR_TXFF) == 0) { // so the room may be gone
+#if UART2_RS485
+            GPIO_PORTD_DATA_R |= UART2_DE_PIN;   // Drive the bus
+            UART2_IM_R |= UART_IM_TXIM;
+#endif
+            UART2_DR_R = c;
+            Trace_Record(TRACE_TX, c);
+            sent = 1;
+        }
+        UART2_EXIT_CRITICAL();
+    }
 }
 
 char UART2_ReceiveChar(void)
 {
-    while((UART2_FR_R & 0x10) != 0); // Wait if RX FIFO is Empty
-    return (char)(UART2_DR_R & 0xFF);
+    while(!UART2_Available());       // Wait for the handler to store one
+    return UART2_ReadChar();
 }
 
 void UART2_SendString(char *str)
@@ -65,38 +262,103 @@ void UART2_SendString(char *str)
     while(*str) {
         UART2_SendChar(*str++);
     }
-    // Small delay after sending string to ensure transmission
-    delayMs(10);
+    // No trailing delay: SendChar already waits for room in the TX FIFO
 }
 
 // Returns 1 if char received, 0 if timeout
 int UART2_ReceiveCharTimeout(char *result, int timeout_ms)
 {
     int elapsed = 0;
-    // Check RX FIFO Empty bit (0x10). If set, FIFO is empty.
-    while((UART2_FR_R & 0x10) != 0 && elapsed < timeout_ms) {
+    while(!UART2_Available() && elapsed < timeout_ms) {
         delayMs(1); 
         elapsed++;
     }
     
-    if((UART2_FR_R & 0x10) != 0) {
+    if(!UART2_Available()) {
         return 0; // Timeout
     }
     
-    *result = (char)(UART2_DR_R & 0xFF);
+    *result = UART2_ReadChar();
     return 1; // Success
 }
 
-// Check if data is available in RX FIFO (for non-blocking reads)
+// Check if the ring holds data (for non-blocking reads)
 int UART2_Available(void)
 {
-    // Return 1 if RX FIFO is NOT empty (data available)
-    // Bit 4 of FR register: 1 = FIFO empty, 0 = FIFO has data
-    return ((UART2_FR_R & 0x10) == 0) ? 1 : 0;
+    return (rx_head != rx_tail) ? 1 : 0;
 }
 
-// Non-blocking read from UART
+// Non-blocking read from the ring
 char UART2_ReadChar(void)
 {
-    return (char)(UART2_DR_R & 0xFF);
-}
\ No newline at end of file
+    return (char)(Pop() & 0xFF);
+}
+
+// Non-blocking read with the error bits the hardware stored alongside
+uint32_t UART2_ReadCharStatus(char *c)
+{
+    uint16_t entry = Pop();
+
+    *c = (char)(entry & 0xFF);
+    return entry & UART2_RX_ERRORS;
+}
+
+// Snapshot of the drop and flow-control counters
+void UART2_GetStats(UART2_Stats *out)
+{
+    UART2_ENTER_CRITICAL();
+    out->rx_dropped = stats.rx_dropped;
+    out->rx_overruns = stats.rx_overruns;
+    out->rx_errors = stats.rx_errors;
+    out->rx_framing = stats.rx_framing;
+    out->xoff_sent = stats.xoff_sent;
+    out->xoff_timeouts = stats.xoff_timeouts;
+    UART2_EXIT_CRITICAL();
+}
+
+// The divisor needs IBRD >= 1 (baud <= clock / 16); the rounding error of
+// the 1/64 fraction must stay within UART2_BAUD_TOLERANCE_PERMILLE
+int UART2_CheckBaud(uint32_t baud)
+{
+    uint32_t actual;
+    uint32_t error;
+
+    if(baud == 0U || baud > (SYSTEM_CLOCK_HZ / 16U)) {
+        return 0;
+    }
+    actual = (SYSTEM_CLOCK_HZ * 4U) / UART2_DIVISOR_64(baud);
+    error = (actual > baud) ? (actual - baud) : (baud - actual);
+    return ((error * 1000U) <= (baud * UART2_BAUD_TOLERANCE_PERMILLE)) ? 1 : 0;
+}
+
+int UART2_SetBaud(uint32_t baud)
+{
+    if(!UART2_CheckBaud(baud)) {
+        return 0;
+    }
+
+    while((UART2_FR_R & UART2_FR_BUSY) != 0); // Let the last character finish
+
+    UART2_CTL_R &= ~0x01;                      // Disable while reprogramming
+    UART2_IBRD_R = UART2_DIVISOR_64(baud) >> 6;
+    UART2_FBRD_R = UART2_DIVISOR_64(baud) & 0x3F;
+    UART2_LCRH_R = UART2_LCRH_8N1_FIFO;        // An LCRH write latches the divisors
+    UART2_CTL_R |= 0x01;
+
+    ResetRx();                                 // Drop bytes received at the old rate
+    current_baud = baud;
+    return 1;
+}
+
+uint32_t UART2_GetBaud(void)
+{
+    return current_baud;
+}
+
+void UART2_SendBreak(void)
+{
+    while((UART2_FR_R & UART2_FR_BUSY) != 0);
+    UART2_LCRH_R |= UART2_LCRH_BRK;
+    delayMs(UART2_BREAK_MS);
+    UART2_LCRH_R &= ~UART2_LCRH_BRK;
+}
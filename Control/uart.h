@@ -1,9 +1,89 @@
 #ifndef UART_H
 #define UART_H
 
-// UART initialization function
+#include <stdint.h>
+
+// Rate after UART2_Init(), and the one both ECUs return to on a fallback
+#define UART2_BAUD_DEFAULT          115200U
+
+// Largest divisor rounding error accepted by UART2_SetBaud(), in 1/1000.
+// Both ECUs use the same divisor, so this only bounds the error against
+// the nominal rate; a mismatch between the two clocks adds to it.
+#define UART2_BAUD_TOLERANCE_PERMILLE   15U
+
+// Receive error flags returned by UART2_ReadCharStatus() (UARTDR bits 8..11)
+#define UART2_RX_FRAMING            0x100U
+#define UART2_RX_PARITY             0x200U
+#define UART2_RX_BREAK              0x400U
+#define UART2_RX_OVERRUN            0x800U
+
+// Length of the break sent by UART2_SendBreak(); longer than a frame at any rate
+#define UART2_BREAK_MS              2
+
+// Reception is interrupt driven (UART2_Handler): characters wait in a ring
+// of this many entries (a power of two) until read
+#define UART2_RX_BUFFER_SIZE        128U
+
+// RS-485 half-duplex mode for the multi-drop bus (see bus.h / link.h).
+// The transceiver's DE and /RE pins are tied together on PD2: high while
+// this node transmits, released after the last stop bit has left.
+#ifndef UART2_RS485
+#define UART2_RS485                 0
+#endif
+#define UART2_DE_PIN                0x04U   // PD2
+
+// Software flow control, 0 to build without. The receiver sends XOFF when
+// the ring reaches the high-water mark and XON once it has drained to the
+// low-water mark. The headroom above the mark covers what is already in
+// flight: our TX FIFO ahead of the XOFF plus the peer's TX FIFO (16 each).
+// XON/XOFF bytes never reach the ring, so the link must carry text only.
+// On the bus the master's polling is the flow control, so it is off there.
+#ifndef UART2_FLOW_XONXOFF
+#if UART2_RS485
+#define UART2_FLOW_XONXOFF          0
+#else
+#define UART2_FLOW_XONXOFF          1
+#endif
+#endif
+#if UART2_RS485 && UART2_FLOW_XONXOFF
+#error "XON/XOFF cannot be used on the shared RS-485 bus"
+#endif
+#define UART2_XON                   0x11
+#define UART2_XOFF                  0x13
+#define UART2_RX_HIGH_WATER         (UART2_RX_BUFFER_SIZE - 48U)
+#define UART2_RX_LOW_WATER          (UART2_RX_BUFFER_SIZE / 4U)
+// Sending resumes without XON after this long, so two ECUs that throttle
+// each other at the same moment cannot deadlock
+#define UART2_XOFF_TIMEOUT_MS       100U
+
+// Drop and flow-control counters since UART2_Init()
+typedef struct
+{
+    uint32_t rx_dropped;            // Ring full: characters lost
+    uint32_t rx_overruns;           // Hardware FIFO overrun: handler was late
+    uint32_t rx_errors;             // Characters with any UART2_RX_* flag
+    uint32_t rx_framing;            // ... of which framing errors (rate mismatch, noise)
+    uint32_t xoff_sent;
+    uint32_t xoff_timeouts;         // Sending resumed without XON
+} UART2_Stats;
+
+// UART initialization function (UART2_BAUD_DEFAULT)
 void UART2_Init(void);
 
+// Returns 1 if the system clock can generate baud within the tolerance
+int UART2_CheckBaud(uint32_t baud);
+
+// Switches to a new rate once the last TX character has left the shifter,
+// then drops anything received at the old rate. Returns 1 on success.
+int UART2_SetBaud(uint32_t baud);
+
+// Rate currently programmed
+uint32_t UART2_GetBaud(void);
+
+// Holds TX low for UART2_BREAK_MS. The other side reads a break error
+// whatever rate it is set to.
+void UART2_SendBreak(void);
+
 // Send a single character via UART
 void UART2_SendChar(char c);
 
@@ -16,4 +96,18 @@ void UART2_SendString(char *str);
 // Receive a single character with timeout to prevent deadlock
 int UART2_ReceiveCharTimeout(char *result, int timeout_ms);
 
+// Non-blocking receive: check the ring, then read one character
+int UART2_Available(void);
+char UART2_ReadChar(void);
+
+// Non-blocking read that also returns the receive error flags of the
+// character (0 = received cleanly)
+uint32_t UART2_ReadCharStatus(char *c);
+
+// Copies the counters
+void UART2_GetStats(UART2_Stats *out);
+
+// UART2 interrupt handler (vector table entry in startup_ewarm.c)
+void UART2_Handler(void);
+
 #endif // UART_H
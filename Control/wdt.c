@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * File: wdt.c
+ * Module: WDT
+ * Description: Source file for the Watchdog Timer 0 supervision of the
+ *              scheduler
+ *****************************************************************************/
+
+#include "wdt.h"
+#include "sched.h"
+#include "systick.h"
+#include "crc16.h"
+#include "tm4c123gh6pm.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define WDT_LOAD                (WDT_TIMEOUT_MS * (SYSTEM_CLOCK_HZ / 1000U))
+
+/* The CRC covers pc .. late */
+#define WDT_CHECK_START         offsetof(Wdt_Record, pc)
+#define WDT_CHECK_LENGTH        (offsetof(Wdt_Record, check) - WDT_CHECK_START)
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static uint32_t deadlines[SCHED_MAX_TASKS];     /* ms, 0 = not watched */
+static uint32_t seen_at[SCHED_MAX_TASKS];       /* SysTick_GetTicks() of the last check-in */
+static volatile uint8_t late = SCHED_INVALID;   /* Read by Wdt_Expired() */
+static uint8_t started = 0;
+
+static Wdt_Record last;                         /* Taken from wdt_record at boot */
+static uint8_t have_last = 0;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * Check
+ * CRC16 of the record's fields.
+ */
+static uint16_t Check(const Wdt_Record *record)
+{
+    return CRC16_Update(CRC16_INIT, (const uint8_t *)record + WDT_CHECK_START, WDT_CHECK_LENGTH);
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Wdt_Init
+ * The record is invalidated whether or not it was valid, so power-on
+ * garbage that happened to pass is not found again either.
+ */
+uint8_t Wdt_Init(void)
+{
+    have_last = (wdt_record.magic == WDT_RECORD_MAGIC && wdt_record.check == Check(&wdt_record)) ? 1U : 0U;
+    if(have_last != 0U)
+    {
+        last = wdt_record;
+    }
+    wdt_record.magic = 0;
+    return have_last;
+}
+
+/*
+ * Wdt_Start
+ * INTTYPE makes the first time-out an NMI instead of interrupt 18.
+ */
+void Wdt_Start(void)
+{
+    SYSCTL_RCGCWD_R |= SYSCTL_RCGCWD_R0;
+    while((SYSCTL_PRWD_R & SYSCTL_PRWD_R0) == 0U) {}
+
+    WATCHDOG0_LOAD_R = WDT_LOAD;
+    WATCHDOG0_TEST_R |= WDT_TEST_STALL;
+    WATCHDOG0_CTL_R |= WDT_CTL_INTTYPE | WDT_CTL_RESEN | WDT_CTL_INTEN;
+    started = 1;
+}
+
+/*
+ * Wdt_Watch
+ */
+void Wdt_Watch(uint8_t task, uint32_t deadline_ms)
+{
+    if(task < SCHED_MAX_TASKS)
+    {
+        seen_at[task] = SysTick_GetTicks();
+        deadlines[task] = deadline_ms;
+    }
+}
+
+/*
+ * Wdt_CheckIn
+ */
+void Wdt_CheckIn(uint8_t task)
+{
+    if(task < SCHED_MAX_TASKS)
+    {
+        seen_at[task] = SysTick_GetTicks();
+    }
+}
+
+/*
+ * Wdt_Service
+ * Writing WDTLOAD reloads the counter at once. The first late task is
+ * kept for the record.
+ */
+uint8_t Wdt_Service(void)
+{
+    uint32_t now = SysTick_GetTicks();
+    uint8_t i;
+
+    for(i = 0; i < SCHED_MAX_TASKS; i++)
+    {
+        if(deadlines[i] != 0U && (now - seen_at[i]) > deadlines[i])
+        {
+            late = i;
+            return 0;
+        }
+    }
+
+    late = SCHED_INVALID;
+    if(started != 0U)
+    {
+        WATCHDOG0_LOAD_R = WDT_LOAD;
+    }
+    return 1;
+}
+
+/*
+ * Wdt_GetLastReset
+ */
+uint8_t Wdt_GetLastReset(Wdt_Record *record)
+{
+    if(have_last != 0U)
+    {
+        *record = last;
+    }
+    return have_last;
+}
+
+/*
+ * Wdt_Expired
+ * Runs in the NMI handler: besides the record it only reads, and nothing
+ * here may wait on an interrupt or a lock the interrupted code holds.
+ */
+void Wdt_Expired(const uint32_t *frame)
+{
+    wdt_record.pc = frame[6];
+    wdt_record.lr = frame[5];
+    wdt_record.uptime_ms = SysTick_GetTicks();
+    wdt_record.task = Sched_GetRunning(&wdt_record.slice_us);
+    wdt_record.late = late;
+    wdt_record.check = Check(&wdt_record);
+    wdt_record.magic = WDT_RECORD_MAGIC;
+}
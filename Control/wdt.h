@@ -0,0 +1,113 @@
+/*****************************************************************************
+ * File: wdt.h
+ * Module: WDT
+ * Description: Header file for the Watchdog Timer 0 supervision of the
+ *              scheduler
+ *
+ * Tasks under watch check in each time they run: Wdt_CheckIn(). A low
+ * priority task calls Wdt_Service() every WDT_SERVICE_MS, which reloads
+ * the watchdog only while every watched task has checked in within its
+ * deadline. So a task stuck in its slice, a busy loop anywhere (main()'s
+ * EEPROM_ERROR stops included), an interrupt storm or a task starved by
+ * higher priorities all stop the reloads.
+ *
+ * The first time-out, WDT_TIMEOUT_MS after the last reload, is a
+ * non-maskable interrupt: it is taken even with interrupts masked or an
+ * interrupt handler stuck. startup_ewarm.c's NMI handler passes the
+ * interrupted code's exception frame to Wdt_Expired(), which writes a
+ * Wdt_Record into .noinit RAM. The second time-out resets the device.
+ *
+ * .noinit survives the reset. Wdt_Init() takes the record at the next
+ * boot and invalidates it, so a record is only reported once and only
+ * after a watchdog reset; power-on leaves RAM random, which the magic
+ * and CRC16 reject. main() adds it to the audit log and STATS? shows it.
+ *****************************************************************************/
+
+#ifndef WDT_H_
+#define WDT_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define WDT_TIMEOUT_MS          500U    /* Reload to NMI; the reset follows as long again */
+#define WDT_SERVICE_MS          100U    /* Wdt_Service() period */
+#define WDT_RECORD_MAGIC        0x57445430U     /* "WDT0" */
+
+/*
+ * Wdt_Record
+ * What the first time-out interrupted.
+ */
+typedef struct
+{
+    uint32_t magic;             /* WDT_RECORD_MAGIC while valid */
+    uint32_t pc;                /* Interrupted instruction */
+    uint32_t lr;                /* ... and its return address */
+    uint32_t uptime_ms;         /* SysTick_GetTicks() at the time-out */
+    uint32_t slice_us;          /* How long task's slice had run */
+    uint8_t  task;              /* Scheduler task in its slice, SCHED_INVALID if none */
+    uint8_t  late;              /* Watched task past its deadline, SCHED_INVALID if none */
+    uint16_t check;             /* CRC16 of pc .. late */
+} Wdt_Record;
+
+/* startup_ewarm.c, in .noinit */
+extern Wdt_Record wdt_record;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Wdt_Init
+ * Takes the record a watchdog reset left behind, if any. Call first in
+ * main(). Does not start the watchdog.
+ * Returns: 1 if the last reset was the watchdog's, 0 otherwise
+ */
+uint8_t Wdt_Init(void);
+
+/*
+ * Wdt_Start
+ * Clocks Watchdog Timer 0 and starts it: NMI after WDT_TIMEOUT_MS without
+ * a reload, reset after as long again. It cannot be stopped until reset;
+ * it stalls while the debugger halts the core.
+ */
+void Wdt_Start(void);
+
+/*
+ * Wdt_Watch
+ * Puts a scheduler task under watch: it must check in at least every
+ * deadline_ms (0 = stop watching).
+ */
+void Wdt_Watch(uint8_t task, uint32_t deadline_ms);
+
+/*
+ * Wdt_CheckIn
+ * Called by a watched task each time it runs.
+ */
+void Wdt_CheckIn(uint8_t task);
+
+/*
+ * Wdt_Service
+ * Reloads the watchdog (once started) unless a watched task is late.
+ * Call every WDT_SERVICE_MS.
+ * Returns: 1 if every watched task was on time, 0 if one was late
+ */
+uint8_t Wdt_Service(void);
+
+/*
+ * Wdt_GetLastReset
+ * Copies the record Wdt_Init() took.
+ * Returns: 1, or 0 if the last reset was not the watchdog's (nothing copied)
+ */
+uint8_t Wdt_GetLastReset(Wdt_Record *record);
+
+/*
+ * Wdt_Expired
+ * Writes the record. Called by the NMI handler at the first time-out with
+ * the stacked exception frame: R0-R3, R12, LR, PC, xPSR.
+ */
+void Wdt_Expired(const uint32_t *frame);
+
+#endif /* WDT_H_ */
@@ -0,0 +1,67 @@
+/*****************************************************************************
+ * File: boot.c
+ * Module: BOOT
+ * Description: Source file for peripheral clock bring-up and the boot timeline
+ *****************************************************************************/
+
+#include "boot.h"
+#include "systick.h"
+#include "tm4c123gh6pm.h"
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static Boot_Phase boot_phases[BOOT_MAX_PHASES];
+static uint8_t boot_phase_count = 0;
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Boot_EnableClocks
+ * A peripheral's registers must not be touched until its PR bit is set,
+ * which takes a few cycles after its RCGC bit; waiting once for all of
+ * them replaces a wait in every driver.
+ */
+void Boot_EnableClocks(const Boot_Clocks *clocks)
+{
+    SYSCTL_RCGCGPIO_R |= clocks->gpio;
+    SYSCTL_RCGCUART_R |= clocks->uart;
+    SYSCTL_RCGCTIMER_R |= clocks->timer;
+    SYSCTL_RCGCPWM_R |= clocks->pwm;
+    SYSCTL_RCGCADC_R |= clocks->adc;
+    SYSCTL_RCGCEEPROM_R |= clocks->eeprom;
+
+    while(((SYSCTL_PRGPIO_R & clocks->gpio) != clocks->gpio) ||
+          ((SYSCTL_PRUART_R & clocks->uart) != clocks->uart) ||
+          ((SYSCTL_PRTIMER_R & clocks->timer) != clocks->timer) ||
+          ((SYSCTL_PRPWM_R & clocks->pwm) != clocks->pwm) ||
+          ((SYSCTL_PRADC_R & clocks->adc) != clocks->adc))
+    {
+    }
+}
+
+/*
+ * Boot_Mark
+ */
+void Boot_Mark(const char *name)
+{
+    if(boot_phase_count < BOOT_MAX_PHASES)
+    {
+        boot_phases[boot_phase_count].name = name;
+        boot_phases[boot_phase_count].us = SysTick_GetMicros();
+        boot_phase_count++;
+    }
+}
+
+/*
+ * Boot_GetTimeline
+ */
+uint8_t Boot_GetTimeline(const Boot_Phase **phases)
+{
+    *phases = boot_phases;
+    return boot_phase_count;
+}
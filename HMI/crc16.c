@@ -0,0 +1,111 @@
+/*****************************************************************************
+ * File: crc16.c
+ * Module: CRC16
+ * Description: Source file for the CRC-16/CCITT-FALSE checksum
+ *
+ * Works a nibble at a time from a 16-entry table: two lookups per byte,
+ * 32 bytes of flash instead of the 512 a byte-wide table would need.
+ *****************************************************************************/
+
+#include "crc16.h"
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+/* CRC of each 4-bit value shifted through the top of the register */
+static const uint16_t crc_nibble_table[16] =
+{
+    0x0000U, 0x1021U, 0x2042U, 0x3063U, 0x4084U, 0x50A5U, 0x60C6U, 0x70E7U,
+    0x8108U, 0x9129U, 0xA14AU, 0xB16BU, 0xC18CU, 0xD1ADU, 0xE1CEU, 0xF1EFU
+};
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * HexValue
+ * Returns the value of an upper-case hex digit, or -1.
+ */
+static int HexValue(char c)
+{
+    if(c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if(c >= 'A' && c <= 'F')
+    {
+        return (c - 'A') + 10;
+    }
+    return -1;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * CRC16_Update
+ * Feeds each byte high nibble first.
+ */
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+    while(length > 0U)
+    {
+        crc = (uint16_t)((crc << 4) ^ crc_nibble_table[(crc >> 12) ^ (*data >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crc_nibble_table[(crc >> 12) ^ (*data & 0x0FU)]);
+        data++;
+        length--;
+    }
+    return crc;
+}
+
+/*
+ * CRC16_FormatHex
+ * Most significant digit first.
+ */
+void CRC16_FormatHex(uint16_t crc, char hex[CRC16_HEX_DIGITS + 1])
+{
+    uint8_t i;
+
+    for(i = 0; i < CRC16_HEX_DIGITS; i++)
+    {
+        hex[i] = hex_digits[(crc >> (12U - (4U * i))) & 0x0FU];
+    }
+    hex[CRC16_HEX_DIGITS] = '\0';
+}
+
+/*
+ * CRC16_CheckText
+ * Decodes the trailing digits and compares them with the CRC of the rest.
+ */
+uint8_t CRC16_CheckText(const char *text)
+{
+    uint32_t length = (uint32_t)strlen(text);
+    uint16_t expected = 0;
+    uint8_t i;
+
+    if(length < CRC16_HEX_DIGITS)
+    {
+        return 0;
+    }
+    length -= CRC16_HEX_DIGITS;
+
+    for(i = 0; i < CRC16_HEX_DIGITS; i++)
+    {
+        int digit = HexValue(text[length + i]);
+
+        if(digit < 0)
+        {
+            return 0;
+        }
+        expected = (uint16_t)((expected << 4) | (uint16_t)digit);
+    }
+
+    return (CRC16_Update(CRC16_INIT, (const uint8_t *)text, length) == expected) ? 1U : 0U;
+}
@@ -0,0 +1,49 @@
+/*****************************************************************************
+ * File: crc16.h
+ * Module: CRC16
+ * Description: Header file for the CRC-16/CCITT-FALSE checksum
+ *
+ * Polynomial 0x1021, initial value 0xFFFF, no reflection, no final XOR.
+ * The check value of "123456789" is 0x29B1.
+ *
+ * Used by the UART link bring-up (PING/PONG probes) on both ECUs, which
+ * carry the CRC as four upper-case hex digits at the end of a text line.
+ *****************************************************************************/
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define CRC16_INIT              0xFFFFU
+#define CRC16_HEX_DIGITS        4       /* Text form of a CRC */
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * CRC16_Update
+ * Continues a CRC over length more bytes. Start with CRC16_INIT.
+ */
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint32_t length);
+
+/*
+ * CRC16_FormatHex
+ * Writes crc as four upper-case hex digits plus a terminator.
+ */
+void CRC16_FormatHex(uint16_t crc, char hex[CRC16_HEX_DIGITS + 1]);
+
+/*
+ * CRC16_CheckText
+ * Checks a string that ends in the four hex digits of the CRC of the
+ * characters before them.
+ * Returns: 1 if the CRC matches, 0 otherwise (including too short)
+ */
+uint8_t CRC16_CheckText(const char *text);
+
+#endif /* CRC16_H_ */
@@ -61,6 +61,104 @@
 #define ENABLE      1
 #define DISABLE     0
 
+/*
+ * Edge Definitions
+ * Used to select the edge that raises a pin interrupt.
+ */
+#define DIO_EDGE_FALLING    0
+#define DIO_EDGE_RISING     1
+#define DIO_EDGE_BOTH       2
+
+/*
+ * Register Access
+ * Every port has the same register layout at its own base address, so a
+ * register is found with one table load (or, for a constant port, at
+ * compile time). The DATA register is reached through its masked aperture:
+ * address bits [9:2] select the pins a read or write touches, so a pin is
+ * written with a single store and the other pins of the port are never
+ * disturbed. Configuration registers are changed one bit at a time through
+ * the bit-band alias, which is a single store as well.
+ */
+#define DIO_PORT_COUNT      6U
+
+#define DIO_OFFSET_DIR      0x400U
+#define DIO_OFFSET_IS       0x404U
+#define DIO_OFFSET_IBE      0x408U
+#define DIO_OFFSET_IEV      0x40CU
+#define DIO_OFFSET_IM       0x410U
+#define DIO_OFFSET_MIS      0x418U
+#define DIO_OFFSET_ICR      0x41CU
+#define DIO_OFFSET_AFSEL    0x420U
+#define DIO_OFFSET_PUR      0x510U
+#define DIO_OFFSET_PDR      0x514U
+#define DIO_OFFSET_DEN      0x51CU
+#define DIO_OFFSET_LOCK     0x520U
+#define DIO_OFFSET_CR       0x524U
+#define DIO_OFFSET_AMSEL    0x528U
+#define DIO_OFFSET_PCTL     0x52CU
+
+/*
+ * Bus Aperture
+ * Build with DIO_USE_AHB=1 to move the ports in DIO_AHB_PORTS (bit n =
+ * port n) onto the Advanced High-performance Bus, which takes a GPIO
+ * access in one cycle instead of the two or more the legacy APB needs.
+ * DIO_EnableAHB() must then run before any of those ports is touched, and
+ * from then on they only answer at their AHB addresses: every access has
+ * to go through the macros below, not the GPIO_PORTx_*_R names. The
+ * default set is the keypad (A, C) and LCD (B) ports of the HMI.
+ */
+#ifndef DIO_USE_AHB
+#define DIO_USE_AHB         0
+#endif
+#ifndef DIO_AHB_PORTS
+#define DIO_AHB_PORTS       ((1U << PORTA) | (1U << PORTB) | (1U << PORTC))
+#endif
+
+#if DIO_USE_AHB
+#define DIO_ON_AHB(port)    ((((uint32_t)DIO_AHB_PORTS) >> (port)) & 1U)
+#else
+#define DIO_ON_AHB(port)    0U
+#endif
+
+#define DIO_APB_BASE(port)  ((uint32_t)(port) < PORTE ? \
+                             0x40004000UL + ((uint32_t)(port) << 12) : \
+                             0x40024000UL + (((uint32_t)(port) - PORTE) << 12))
+#define DIO_AHB_BASE(port)  (0x40058000UL + ((uint32_t)(port) << 12))
+
+#define DIO_PORT_BASE(port) (DIO_ON_AHB(port) ? DIO_AHB_BASE(port) : DIO_APB_BASE(port))
+
+#define DIO_PORT_REG(port, offset) \
+    (*((volatile uint32_t *)(DIO_PORT_BASE(port) + (offset))))
+
+#define DIO_PORT_DATA(port, mask) \
+    (*((volatile uint32_t *)(DIO_PORT_BASE(port) + ((uint32_t)(mask) << 2))))
+
+#define DIO_DATA_PIN(base, pin) \
+    (*((volatile uint32_t *)((base) + (1UL << ((pin) + 2U)))))
+
+#define DIO_BITBAND(addr, bit) \
+    (*((volatile uint32_t *)(0x42000000UL + (((addr) - 0x40000000UL) << 5) + ((uint32_t)(bit) << 2))))
+
+/*
+ * Constant-Pin Access
+ * For port and pin known at compile time these reduce to a single load or
+ * store to a fixed address, with no call and no table lookup.
+ */
+#define DIO_WRITE(port, pin, value) \
+    (DIO_DATA_PIN(DIO_PORT_BASE(port), (pin)) = (value) ? (1UL << (pin)) : 0UL)
+
+#define DIO_READ(port, pin) \
+    ((DIO_DATA_PIN(DIO_PORT_BASE(port), (pin)) != 0UL) ? HIGH : LOW)
+
+#define DIO_TOGGLE(port, pin) \
+    (DIO_DATA_PIN(DIO_PORT_BASE(port), (pin)) ^= (1UL << (pin)))
+
+/*
+ * DIO_Callback
+ * Called from the port interrupt with the pin that saw its edge.
+ */
+typedef void (*DIO_Callback)(uint8_t port, uint8_t pin);
+
 
 /******************************************************************************
  * Function Prototypes
@@ -68,6 +166,13 @@
  ******************************************************************************/
 
 
+/*
+ * DIO_EnableAHB
+ * Switches the DIO_AHB_PORTS to the AHB aperture (no-op unless DIO_USE_AHB).
+ * Call first thing in main().
+ */
+void DIO_EnableAHB(void);
+
 /*
  * DIO_Init
  * Initializes a GPIO pin as input or output.
@@ -104,4 +209,28 @@ void DIO_SetPUR(uint8_t port, uint8_t pin, uint8_t enable);
  */
 void DIO_SetPDR(uint8_t port, uint8_t pin, uint8_t enable);
 
+/*
+ * DIO_AttachInterrupt
+ * Calls callback from the port interrupt on each DIO_EDGE_* edge of an
+ * initialized pin. Replaces any callback the pin already had.
+ */
+void DIO_AttachInterrupt(uint8_t port, uint8_t pin, uint8_t edge, DIO_Callback callback);
+
+/*
+ * DIO_DetachInterrupt
+ * Masks the pin's interrupt and forgets its callback.
+ */
+void DIO_DetachInterrupt(uint8_t port, uint8_t pin);
+
+/*
+ * GPIOPortA_Handler .. GPIOPortF_Handler
+ * Port interrupts (vector table entries); dispatch to the pin callbacks.
+ */
+void GPIOPortA_Handler(void);
+void GPIOPortB_Handler(void);
+void GPIOPortC_Handler(void);
+void GPIOPortD_Handler(void);
+void GPIOPortE_Handler(void);
+void GPIOPortF_Handler(void);
+
 #endif /* DIO_H_ */
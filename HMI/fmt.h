@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * File: fmt.h
+ * Module: FMT
+ * Description: Header file for allocation-free text formatting
+ *
+ * Builds replies, commands and LCD lines into caller-owned buffers:
+ *
+ *     char line[HMI_LCD_COLUMNS + 1];
+ *     Fmt_Buffer out;
+ *
+ *     Fmt_Begin(&out, line, sizeof(line));
+ *     Fmt_String(&out, "Retry in ");
+ *     Fmt_Uint(&out, seconds);
+ *     Fmt_Char(&out, 's');
+ *
+ * The buffer is NUL-terminated after every call, and text that does not
+ * fit is dropped (out.overflow is then set) rather than written past the
+ * end. Decimal output costs one division by ten per digit; nothing
+ * here parses a format string.
+ *
+ * Neither image links the printf family, which would add several KB of
+ * library code. Including this header turns any printf/sprintf/snprintf
+ * call in the file into an undefined-symbol link error.
+ *****************************************************************************/
+
+#ifndef FMT_H_
+#define FMT_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define FMT_UINT_DIGITS         10U     /* Longest uint32_t in decimal */
+
+#define printf                  fmt_printf_is_not_linked
+#define sprintf                 fmt_sprintf_is_not_linked
+#define snprintf                fmt_snprintf_is_not_linked
+
+typedef struct
+{
+    char    *text;
+    uint32_t size;                      /* Including the terminator */
+    uint32_t length;                    /* Characters written so far */
+    uint8_t  overflow;                  /* Something was dropped */
+} Fmt_Buffer;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Fmt_Begin
+ * Starts an empty string in text[size]; size must be at least 1.
+ */
+void Fmt_Begin(Fmt_Buffer *out, char *text, uint32_t size);
+
+/*
+ * Fmt_Char / Fmt_String
+ * Appends one character / a NUL-terminated string.
+ */
+void Fmt_Char(Fmt_Buffer *out, char c);
+void Fmt_String(Fmt_Buffer *out, const char *s);
+
+/*
+ * Fmt_Uint
+ * Appends value in decimal, as many digits as it needs.
+ */
+void Fmt_Uint(Fmt_Buffer *out, uint32_t value);
+
+/*
+ * Fmt_UintWidth
+ * Appends value in decimal right-aligned in width characters, padded on
+ * the left with pad (' ' or '0'). Wider values are not cut.
+ */
+void Fmt_UintWidth(Fmt_Buffer *out, uint32_t value, uint8_t width, char pad);
+
+/*
+ * Fmt_Hex
+ * Appends the low digits nibbles of value as upper-case hex (1..8).
+ */
+void Fmt_Hex(Fmt_Buffer *out, uint32_t value, uint8_t digits);
+
+#endif /* FMT_H_ */
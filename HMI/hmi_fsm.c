@@ -0,0 +1,1055 @@
+/*****************************************************************************
+ * File: hmi_fsm.c
+ * Module: HMI_FSM
+ * Description: Source file for the table-driven HMI menu / password state
+ *              machine
+ *****************************************************************************/
+
+#include "hmi_fsm.h"
+#include "fmt.h"
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Action return value: take the next state from the transition table */
+#define NEXT_FROM_TABLE         0xFFU
+
+/* Screen flags */
+#define SCREEN_ENTRY            0x01U   /* Password field on line 2 */
+#define SCREEN_MASKED           0x02U   /* Echo '*' instead of the digit */
+
+/* Flows, for per-flow attempt counters */
+#define FLOW_NONE               0
+#define FLOW_OPEN               1
+#define FLOW_CHANGE             2
+#define FLOW_TIMEOUT            3
+#define FLOW_RESET              4
+
+/* Message durations (ms) */
+#define MSG_SHORT_MS            1500U
+#define MSG_NORMAL_MS           2000U
+#define MSG_LOCKOUT_MS          5000U
+
+/* Position of the timeout value on the TMO_ADJUST screen */
+#define TMO_VALUE_COLUMN        7
+
+/* Door countdown: "Closing in NNs", redrawn from the seconds column only */
+#define DOOR_TICK_MS            1000U
+#define DOOR_SECONDS_COLUMN     11
+
+/* Actions */
+typedef enum
+{
+    ACT_NONE = 0,
+    ACT_DIGIT,
+    ACT_BACKSPACE,
+    ACT_CREATE_STORE,
+    ACT_CREATE_CHECK,
+    ACT_CREATE_SAVED,
+    ACT_CREATE_FAILED,
+    ACT_CREATE_NO_REPLY,
+    ACT_MENU_SELECT,
+    ACT_UNLOCK,
+    ACT_OPEN_REQUEST,
+    ACT_OPEN_GRANTED,
+    ACT_OPEN_DENIED,
+    ACT_DOOR_SHOW,
+    ACT_DOOR_TICK,
+    ACT_DOOR_EXTEND,
+    ACT_DOOR_CLOSE,
+    ACT_CHECK_OLD,
+    ACT_STORE_NEW,
+    ACT_CONFIRM_NEW,
+    ACT_CHANGE_SAVED,
+    ACT_SAVE_FAILED,
+    ACT_TMO_SAMPLE,
+    ACT_TMO_CHECK,
+    ACT_TMO_SAVED,
+    ACT_TMO_SAVE_FAILED,
+    ACT_RESET_SAVED,
+    ACT_SERVICE_OPEN,
+    ACT_SERVICE_NEXT,
+    ACT_SERVICE_SHOW,
+    ACT_MESSAGE_SHOW,
+    ACT_MESSAGE_DONE,
+    ACT_LEDS_OFF,
+    ACT_LINK_DOWN,
+    ACT_LINK_UP,
+    ACT_COUNT
+} Hmi_Action;
+
+/******************************************************************************
+ *                              Types                                          *
+ ******************************************************************************/
+
+typedef uint8_t (*Hmi_ActionFn)(Hmi_Fsm *fsm, const Hmi_Event *event);
+
+/*
+ * Hmi_Screen
+ * What a state draws and runs when it is entered and left.
+ */
+typedef struct
+{
+    const char *line1;
+    const char *line2;
+    uint8_t flags;
+    uint8_t flow;
+    uint8_t on_entry;               /* Hmi_Action, may pick a further state */
+    uint8_t on_exit;                /* Hmi_Action */
+} Hmi_Screen;
+
+typedef struct
+{
+    uint8_t action;                 /* Hmi_Action */
+    uint8_t next;                   /* Hmi_State, HMI_STAY = no transition */
+} Hmi_Transition;
+
+/******************************************************************************
+ *                              Tables                                         *
+ ******************************************************************************/
+
+static const Hmi_Screen screens[HMI_STATE_COUNT] =
+{
+    [HMI_STATE_CREATE]          = { "CreatePass:",      0, SCREEN_ENTRY, FLOW_NONE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_CREATE_CONFIRM]  = { "Confirm:",         0, SCREEN_ENTRY, FLOW_NONE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_CREATE_SAVING]   = { "Saving PWD...",    0, 0,            FLOW_NONE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_MENU]            = { "Menu>A:Opn B:PWD", " C:TMO  D:Reset", 0, FLOW_NONE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_LOCKED_NOTICE]   = { "SYSTEM LOCKED",    "Press * for Menu", 0, FLOW_NONE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_OPEN_PWD]        = { "Enter Pwd:",       0, SCREEN_ENTRY | SCREEN_MASKED, FLOW_OPEN, ACT_NONE, ACT_NONE },
+    [HMI_STATE_OPEN_WAIT]       = { "Verifying...",     0, 0,            FLOW_OPEN, ACT_NONE, ACT_NONE },
+    [HMI_STATE_DOOR_OPEN]       = { "#:Lock *:Extend",  "Closing in", 0,     FLOW_OPEN, ACT_DOOR_SHOW, ACT_LEDS_OFF },
+    [HMI_STATE_CHANGE_OLD]      = { "Enter Old Pwd:",   0, SCREEN_ENTRY, FLOW_CHANGE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_CHANGE_NEW]      = { "Enter New Pwd:",   0, SCREEN_ENTRY, FLOW_CHANGE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_CHANGE_CONFIRM]  = { "Confirm New Pwd:", 0, SCREEN_ENTRY, FLOW_CHANGE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_CHANGE_SAVING]   = { "Saving to EEPROM", 0, 0,            FLOW_CHANGE, ACT_NONE, ACT_NONE },
+    [HMI_STATE_TMO_ADJUST]      = { "Adjust Timeout:",  "Value:", 0,     FLOW_TIMEOUT, ACT_TMO_SAMPLE, ACT_NONE },
+    [HMI_STATE_TMO_PWD]         = { "Enter Pwd:",       0, SCREEN_ENTRY | SCREEN_MASKED, FLOW_TIMEOUT, ACT_NONE, ACT_NONE },
+    [HMI_STATE_TMO_SAVING]      = { "Saving Timeout",   0, 0,            FLOW_TIMEOUT, ACT_NONE, ACT_NONE },
+    [HMI_STATE_RESET_OLD]       = { "Verify Old Pwd:",  0, SCREEN_ENTRY, FLOW_RESET, ACT_NONE, ACT_NONE },
+    [HMI_STATE_RESET_NEW]       = { "Enter New Pwd:",   0, SCREEN_ENTRY, FLOW_RESET, ACT_NONE, ACT_NONE },
+    [HMI_STATE_RESET_CONFIRM]   = { "Confirm New Pwd:", 0, SCREEN_ENTRY, FLOW_RESET, ACT_NONE, ACT_NONE },
+    [HMI_STATE_RESET_SAVING]    = { "Saving to EEPROM", 0, 0,            FLOW_RESET, ACT_NONE, ACT_NONE },
+    [HMI_STATE_SERVICE]         = { "Service",          "Reading...", 0, FLOW_NONE, ACT_SERVICE_OPEN, ACT_NONE },
+    [HMI_STATE_MESSAGE]         = { 0,                  0, 0,            FLOW_NONE, ACT_MESSAGE_SHOW, ACT_LEDS_OFF },
+    [HMI_STATE_OFFLINE]         = { "Control Offline",  "Reconnecting...", 0, FLOW_NONE, ACT_NONE, ACT_NONE },
+};
+
+/* Shared password-entry rows: digits and '*' edit the field, '#' completes it */
+#define PASSWORD_ENTRY(enter_action, enter_next)                    \
+    [HMI_EV_DIGIT]  = { ACT_DIGIT, HMI_STAY },                      \
+    [HMI_EV_CANCEL] = { ACT_BACKSPACE, HMI_STAY },                  \
+    [HMI_EV_ENTER]  = { (enter_action), (enter_next) }
+
+/* Any reply other than OK */
+#define REPLY_NOT_OK(action)                                        \
+    [HMI_EV_REPLY_FAIL]    = { (action), HMI_STAY },                \
+    [HMI_EV_REPLY_LOCKED]  = { (action), HMI_STAY },                \
+    [HMI_EV_REPLY_TIMEOUT] = { (action), HMI_STAY }
+
+static const Hmi_Transition transitions[HMI_STATE_COUNT][HMI_EV_COUNT] =
+{
+    [HMI_STATE_CREATE]          = { PASSWORD_ENTRY(ACT_CREATE_STORE, HMI_STATE_CREATE_CONFIRM) },
+    [HMI_STATE_CREATE_CONFIRM]  = { PASSWORD_ENTRY(ACT_CREATE_CHECK, HMI_STATE_CREATE_SAVING) },
+    [HMI_STATE_CREATE_SAVING]   = { [HMI_EV_REPLY_OK]      = { ACT_CREATE_SAVED, HMI_STAY },
+                                    [HMI_EV_REPLY_FAIL]    = { ACT_CREATE_FAILED, HMI_STAY },
+                                    [HMI_EV_REPLY_LOCKED]  = { ACT_CREATE_FAILED, HMI_STAY },
+                                    [HMI_EV_REPLY_TIMEOUT] = { ACT_CREATE_NO_REPLY, HMI_STAY } },
+
+    [HMI_STATE_MENU]            = { [HMI_EV_MENU_A] = { ACT_MENU_SELECT, HMI_STATE_OPEN_PWD },
+                                    [HMI_EV_MENU_B] = { ACT_MENU_SELECT, HMI_STATE_CHANGE_OLD },
+                                    [HMI_EV_MENU_C] = { ACT_MENU_SELECT, HMI_STATE_TMO_ADJUST },
+                                    [HMI_EV_MENU_D] = { ACT_MENU_SELECT, HMI_STATE_RESET_OLD },
+                                    [HMI_EV_ENTER]  = { ACT_NONE, HMI_STATE_SERVICE },
+                                    [HMI_EV_CANCEL] = { ACT_UNLOCK, HMI_STAY } },
+    [HMI_STATE_LOCKED_NOTICE]   = { [HMI_EV_CANCEL] = { ACT_UNLOCK, HMI_STATE_MENU } },
+
+    [HMI_STATE_OPEN_PWD]        = { PASSWORD_ENTRY(ACT_OPEN_REQUEST, HMI_STATE_OPEN_WAIT) },
+    [HMI_STATE_OPEN_WAIT]       = { [HMI_EV_REPLY_OK] = { ACT_OPEN_GRANTED, HMI_STATE_DOOR_OPEN },
+                                    REPLY_NOT_OK(ACT_OPEN_DENIED) },
+    [HMI_STATE_DOOR_OPEN]       = { [HMI_EV_TIMER]  = { ACT_DOOR_TICK, HMI_STAY },
+                                    [HMI_EV_CANCEL] = { ACT_DOOR_EXTEND, HMI_STAY },
+                                    [HMI_EV_ENTER]  = { ACT_DOOR_CLOSE, HMI_STATE_MENU } },
+
+    [HMI_STATE_CHANGE_OLD]      = { PASSWORD_ENTRY(ACT_CHECK_OLD, HMI_STATE_CHANGE_NEW) },
+    [HMI_STATE_CHANGE_NEW]      = { PASSWORD_ENTRY(ACT_STORE_NEW, HMI_STATE_CHANGE_CONFIRM) },
+    [HMI_STATE_CHANGE_CONFIRM]  = { PASSWORD_ENTRY(ACT_CONFIRM_NEW, HMI_STATE_CHANGE_SAVING) },
+    [HMI_STATE_CHANGE_SAVING]   = { [HMI_EV_REPLY_OK] = { ACT_CHANGE_SAVED, HMI_STAY },
+                                    REPLY_NOT_OK(ACT_SAVE_FAILED) },
+
+    [HMI_STATE_TMO_ADJUST]      = { [HMI_EV_TICK]   = { ACT_TMO_SAMPLE, HMI_STAY },
+                                    [HMI_EV_ENTER]  = { ACT_NONE, HMI_STATE_TMO_PWD },
+                                    [HMI_EV_CANCEL] = { ACT_NONE, HMI_STATE_MENU } },
+    [HMI_STATE_TMO_PWD]         = { PASSWORD_ENTRY(ACT_TMO_CHECK, HMI_STATE_TMO_SAVING) },
+    [HMI_STATE_TMO_SAVING]      = { [HMI_EV_REPLY_OK] = { ACT_TMO_SAVED, HMI_STAY },
+                                    REPLY_NOT_OK(ACT_TMO_SAVE_FAILED) },
+
+    [HMI_STATE_RESET_OLD]       = { PASSWORD_ENTRY(ACT_CHECK_OLD, HMI_STATE_RESET_NEW) },
+    [HMI_STATE_RESET_NEW]       = { PASSWORD_ENTRY(ACT_STORE_NEW, HMI_STATE_RESET_CONFIRM) },
+    [HMI_STATE_RESET_CONFIRM]   = { PASSWORD_ENTRY(ACT_CONFIRM_NEW, HMI_STATE_RESET_SAVING) },
+    [HMI_STATE_RESET_SAVING]    = { [HMI_EV_REPLY_OK] = { ACT_RESET_SAVED, HMI_STAY },
+                                    REPLY_NOT_OK(ACT_SAVE_FAILED) },
+
+    [HMI_STATE_SERVICE]         = { [HMI_EV_ENTER]  = { ACT_SERVICE_NEXT, HMI_STAY },
+                                    [HMI_EV_CANCEL] = { ACT_NONE, HMI_STATE_MENU },
+                                    REPLY_NOT_OK(ACT_SERVICE_SHOW) },
+
+    [HMI_STATE_MESSAGE]         = { [HMI_EV_TIMER] = { ACT_MESSAGE_DONE, HMI_STAY } },
+    [HMI_STATE_OFFLINE]         = { [HMI_EV_LINK_UP] = { ACT_LINK_UP, HMI_STAY } },
+};
+
+/* For events a screen's own row leaves out: the link events, which the
+   heartbeat can report on any screen */
+static const Hmi_Transition any_screen[HMI_EV_COUNT] =
+{
+    [HMI_EV_LINK_DOWN]  = { ACT_LINK_DOWN, HMI_STATE_OFFLINE },
+    [HMI_EV_LINK_UP]    = { ACT_LINK_UP, HMI_STAY },
+};
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * SendRequest
+ * Issues a complete command; the next screen waits for the reply to it.
+ * Nothing blocks: the reply arrives as an event. Returns 0 if the link had
+ * no free slot.
+ */
+static uint8_t SendRequest(Hmi_Fsm *fsm, const char *command)
+{
+    fsm->reply_seq = fsm->io->request(command);
+    return (fsm->reply_seq != 0U) ? 1U : 0U;
+}
+
+/*
+ * Request
+ * Sends "<prefix><arg>".
+ */
+static uint8_t Request(Hmi_Fsm *fsm, const char *prefix, const char *arg)
+{
+    char command[HMI_REQUEST_SIZE];
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, command, sizeof(command));
+    Fmt_String(&out, prefix);
+    Fmt_String(&out, arg);
+    return SendRequest(fsm, command);
+}
+
+/*
+ * RequestConfig
+ * One authenticated "CFG:<pwd>;PWD=<new>;TMO=<s>" frame; Control applies
+ * every setting in it with a single EEPROM write, or none. new_pass 0 or
+ * timeout 0 leaves that setting out.
+ */
+static uint8_t RequestConfig(Hmi_Fsm *fsm, const char *new_pass, uint32_t timeout)
+{
+    char command[HMI_REQUEST_SIZE];
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, command, sizeof(command));
+    Fmt_String(&out, "CFG:");
+    Fmt_String(&out, fsm->pass);
+    if(new_pass != 0)
+    {
+        Fmt_String(&out, ";PWD=");
+        Fmt_String(&out, new_pass);
+    }
+    if(timeout != 0U)
+    {
+        Fmt_String(&out, ";TMO=");
+        Fmt_Uint(&out, timeout);
+    }
+    return SendRequest(fsm, command);
+}
+
+/*
+ * StartTimer
+ * Starts the single screen timer; any earlier timer becomes stale. One
+ * the platform cannot arm expires once the current event is handled.
+ */
+static void StartTimer(Hmi_Fsm *fsm, uint32_t ms)
+{
+    fsm->timer_tag++;
+    if(fsm->io->start_timer(ms, fsm->timer_tag) == 0U)
+    {
+        fsm->unarmed_tag = fsm->timer_tag;
+    }
+}
+
+/*
+ * ShowMessage
+ * Prepares HMI_STATE_MESSAGE; the caller returns the result as next state.
+ */
+static uint8_t ShowMessage(Hmi_Fsm *fsm, const char *line1, const char *line2,
+                           uint32_t ms, uint8_t led, uint8_t next)
+{
+    strncpy(fsm->msg_line1, line1, HMI_LCD_COLUMNS);
+    fsm->msg_line1[HMI_LCD_COLUMNS] = '\0';
+    strncpy(fsm->msg_line2, line2, HMI_LCD_COLUMNS);
+    fsm->msg_line2[HMI_LCD_COLUMNS] = '\0';
+    fsm->msg_ms = ms;
+    fsm->msg_led = led;
+    fsm->msg_next = next;
+    return HMI_STATE_MESSAGE;
+}
+
+/*
+ * LinkBusy
+ * A request could not be queued on the link.
+ */
+static uint8_t LinkBusy(Hmi_Fsm *fsm)
+{
+    return ShowMessage(fsm, "Link Busy", "Please Retry", MSG_NORMAL_MS, HMI_LED_RED, HMI_STATE_MENU);
+}
+
+/*
+ * Lockout
+ * Third failure (or a lockout reported by Control). The open flow keeps the
+ * menu locked until '*'; the other flows only show the notice.
+ */
+static uint8_t Lockout(Hmi_Fsm *fsm, uint8_t flow, uint32_t seconds)
+{
+    char line2[HMI_LCD_COLUMNS + 1];
+    Fmt_Buffer out;
+
+    fsm->io->lockout_alarm();
+    Fmt_Begin(&out, line2, sizeof(line2));
+
+    if(flow == FLOW_OPEN)
+    {
+        fsm->locked = 1;
+        if(seconds > 0U)
+        {
+            Fmt_String(&out, "Retry in ");
+            Fmt_Uint(&out, seconds);
+            Fmt_Char(&out, 's');
+        }
+        else
+        {
+            Fmt_String(&out, "Press * for Menu");
+        }
+        return ShowMessage(fsm, "SYSTEM LOCKED!", line2, MSG_LOCKOUT_MS, HMI_LED_NONE, HMI_STATE_MENU);
+    }
+
+    fsm->attempts[flow] = 0;
+    return ShowMessage(fsm, "3 Failed Tries", "SYSTEM LOCKED!", MSG_LOCKOUT_MS, HMI_LED_NONE, HMI_STATE_MENU);
+}
+
+/*
+ * Failure
+ * Counts a wrong password for the flow and either retries or locks out.
+ */
+static uint8_t Failure(Hmi_Fsm *fsm, const char *title, uint8_t retry)
+{
+    uint8_t flow = screens[fsm->state].flow;
+    char line2[HMI_LCD_COLUMNS + 1];
+    Fmt_Buffer out;
+
+    fsm->attempts[flow]++;
+    if(fsm->attempts[flow] >= HMI_MAX_ATTEMPTS)
+    {
+        return Lockout(fsm, flow, 0);
+    }
+
+    Fmt_Begin(&out, line2, sizeof(line2));
+    Fmt_String(&out, "Attempts Left: ");
+    Fmt_Uint(&out, (uint32_t)(HMI_MAX_ATTEMPTS - fsm->attempts[flow]));
+    return ShowMessage(fsm, title, line2, MSG_NORMAL_MS, HMI_LED_NONE, retry);
+}
+
+/******************************************************************************
+ *                              Actions                                        *
+ ******************************************************************************/
+
+/* Password entry sub-machine */
+static uint8_t ActDigit(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    char echo[2];
+
+    if(fsm->entry_len < HMI_PASSWORD_LENGTH)
+    {
+        echo[0] = ((screens[fsm->state].flags & SCREEN_MASKED) != 0U) ? '*' : event->key;
+        echo[1] = '\0';
+        fsm->io->put(2, fsm->entry_len, echo);
+        fsm->entry[fsm->entry_len++] = event->key;
+        fsm->entry[fsm->entry_len] = '\0';
+    }
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActBackspace(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(fsm->entry_len > 0U)
+    {
+        fsm->entry[--fsm->entry_len] = '\0';
+        fsm->io->put(2, fsm->entry_len, " ");
+    }
+    return NEXT_FROM_TABLE;
+}
+
+/* Initial password setup */
+static uint8_t ActCreateStore(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    strcpy(fsm->pass, fsm->entry);
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActCreateCheck(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(strcmp(fsm->pass, fsm->entry) != 0)
+    {
+        return ShowMessage(fsm, "Mismatch! Retry", "", MSG_NORMAL_MS, HMI_LED_NONE, HMI_STATE_CREATE);
+    }
+    if(Request(fsm, "SETPWD:", fsm->pass) == 0U)
+    {
+        return LinkBusy(fsm);
+    }
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActCreateSaved(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    return ShowMessage(fsm, "Password Created", "", MSG_NORMAL_MS, HMI_LED_GREEN, HMI_STATE_MENU);
+}
+
+static uint8_t ActCreateFailed(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    return ShowMessage(fsm, "Error Saving PWD", "", MSG_NORMAL_MS, HMI_LED_NONE, HMI_STATE_CREATE);
+}
+
+static uint8_t ActCreateNoReply(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    return ShowMessage(fsm, "No Response", "from Control", MSG_NORMAL_MS, HMI_LED_NONE, HMI_STATE_CREATE);
+}
+
+/* Main menu */
+static uint8_t ActMenuSelect(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    if(fsm->locked != 0U)
+    {
+        return HMI_STATE_LOCKED_NOTICE;
+    }
+    if(event->id == HMI_EV_MENU_B)
+    {
+        fsm->attempts[FLOW_CHANGE] = 0;
+    }
+    else if(event->id == HMI_EV_MENU_D)
+    {
+        fsm->attempts[FLOW_RESET] = 0;
+    }
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActUnlock(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(fsm->locked == 0U)
+    {
+        return NEXT_FROM_TABLE;
+    }
+    fsm->locked = 0;
+    fsm->attempts[FLOW_OPEN] = 0;
+    fsm->attempts[FLOW_CHANGE] = 0;
+    return HMI_STATE_MENU;
+}
+
+/* A: open the door */
+static uint8_t ActOpenRequest(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(Request(fsm, "VERIFY:", fsm->entry) == 0U)
+    {
+        return LinkBusy(fsm);
+    }
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActOpenGranted(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->attempts[FLOW_OPEN] = 0;
+    return NEXT_FROM_TABLE;
+}
+
+/* Control owns the real failure counter and reports the lockout it enforces */
+static uint8_t ActOpenDenied(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    uint32_t seconds = (event->id == HMI_EV_REPLY_LOCKED) ? event->value : 0U;
+
+    if(seconds > 0U || (fsm->attempts[FLOW_OPEN] + 1U) >= HMI_MAX_ATTEMPTS)
+    {
+        fsm->attempts[FLOW_OPEN]++;
+        return Lockout(fsm, FLOW_OPEN, seconds);
+    }
+    return Failure(fsm, "Incorrect PWD.", HMI_STATE_OPEN_PWD);
+}
+
+/*
+ * ShowDoorSeconds
+ * Partial redraw: only the seconds field of "Closing in NNs" is rewritten.
+ */
+static void ShowDoorSeconds(Hmi_Fsm *fsm)
+{
+    char field[8];
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, field, sizeof(field));
+    Fmt_Uint(&out, fsm->door_remaining);
+    Fmt_String(&out, "s ");
+    fsm->io->put(2, DOOR_SECONDS_COLUMN, field);
+}
+
+/* One-second timer per step, so the keypad and the link stay live throughout */
+static uint8_t ActDoorShow(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->door_remaining = fsm->auto_lock_timeout;
+    ShowDoorSeconds(fsm);
+    fsm->io->led(HMI_LED_GREEN, 1);
+    StartTimer(fsm, DOOR_TICK_MS);
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActDoorTick(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(fsm->door_remaining > 0U)
+    {
+        fsm->door_remaining--;
+    }
+    if(fsm->door_remaining == 0U)
+    {
+        fsm->io->send("CLOSE");
+        return HMI_STATE_MENU;
+    }
+    ShowDoorSeconds(fsm);
+    StartTimer(fsm, DOOR_TICK_MS);
+    return NEXT_FROM_TABLE;
+}
+
+/* '*' adds another timeout period; the running one-second timer is kept.
+   Control runs its own auto-lock and extends it the same way on HOLD. */
+static uint8_t ActDoorExtend(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->io->send("HOLD");
+    fsm->door_remaining += fsm->auto_lock_timeout;
+    if(fsm->door_remaining > HMI_DOOR_MAX_S)
+    {
+        fsm->door_remaining = HMI_DOOR_MAX_S;
+    }
+    ShowDoorSeconds(fsm);
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActDoorClose(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->io->send("CLOSE");
+    return NEXT_FROM_TABLE;
+}
+
+/* B / D: change or reset the password */
+static uint8_t ActCheckOld(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(strcmp(fsm->pass, fsm->entry) != 0)
+    {
+        return Failure(fsm, "Wrong Old PWD", fsm->state);
+    }
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActStoreNew(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    strcpy(fsm->new_pass, fsm->entry);
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActConfirmNew(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(strcmp(fsm->new_pass, fsm->entry) != 0)
+    {
+        uint8_t retry = (screens[fsm->state].flow == FLOW_CHANGE) ? HMI_STATE_CHANGE_NEW : HMI_STATE_RESET_NEW;
+        return ShowMessage(fsm, "Mismatch! Retry", "", MSG_NORMAL_MS, HMI_LED_NONE, retry);
+    }
+    /* B changes the password only; D also restores the default timeout */
+    if(RequestConfig(fsm, fsm->new_pass,
+                     (screens[fsm->state].flow == FLOW_RESET) ? HMI_TIMEOUT_RESET_S : 0U) == 0U)
+    {
+        return LinkBusy(fsm);
+    }
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActChangeSaved(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    strcpy(fsm->pass, fsm->new_pass);
+    return ShowMessage(fsm, "Password Changed", "Saved to EEPROM", MSG_NORMAL_MS, HMI_LED_GREEN, HMI_STATE_MENU);
+}
+
+static uint8_t ActSaveFailed(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    return ShowMessage(fsm, "Error Saving PWD", "Please Retry", MSG_NORMAL_MS, HMI_LED_RED, HMI_STATE_MENU);
+}
+
+/* C: auto-lock timeout */
+static uint8_t ActTmoSample(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    char value[8];
+    Fmt_Buffer out;
+    uint32_t seconds;
+
+    (void)event;
+    seconds = (((HMI_TIMEOUT_MAX_S - HMI_TIMEOUT_MIN_S) * fsm->io->read_pot()) / HMI_POT_FULL_SCALE) + HMI_TIMEOUT_MIN_S;
+    if(seconds > HMI_TIMEOUT_MAX_S)
+    {
+        seconds = HMI_TIMEOUT_MAX_S;
+    }
+    fsm->adjusted_timeout = seconds;
+
+    Fmt_Begin(&out, value, sizeof(value));
+    Fmt_Uint(&out, seconds);
+    Fmt_String(&out, "s ");
+    fsm->io->put(2, TMO_VALUE_COLUMN, value);
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActTmoCheck(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(strcmp(fsm->pass, fsm->entry) != 0)
+    {
+        return Failure(fsm, "TMO NOT Saved", HMI_STATE_TMO_PWD);
+    }
+    fsm->attempts[FLOW_TIMEOUT] = 0;
+    if(RequestConfig(fsm, 0, fsm->adjusted_timeout) == 0U)
+    {
+        return LinkBusy(fsm);
+    }
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActTmoSaved(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->auto_lock_timeout = fsm->adjusted_timeout;
+    return ShowMessage(fsm, "Timeout Saved!", "", MSG_SHORT_MS, HMI_LED_GREEN, HMI_STATE_MENU);
+}
+
+static uint8_t ActTmoSaveFailed(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    return ShowMessage(fsm, "TMO NOT Saved", "Please Retry", MSG_SHORT_MS, HMI_LED_RED, HMI_STATE_MENU);
+}
+
+/* D: new password and default timeout were stored together */
+static uint8_t ActResetSaved(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    strcpy(fsm->pass, fsm->new_pass);
+    fsm->auto_lock_timeout = HMI_TIMEOUT_RESET_S;
+    return ShowMessage(fsm, "Password Reset!", "TMO Reset to 10s", MSG_SHORT_MS, HMI_LED_GREEN, HMI_STATE_MENU);
+}
+
+/* '#': service page, one "STATS?<n>" field at a time */
+static uint8_t RequestField(Hmi_Fsm *fsm)
+{
+    char field[4];
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, field, sizeof(field));
+    Fmt_Uint(&out, fsm->service_field);
+    return (Request(fsm, "STATS?", field) != 0U) ? NEXT_FROM_TABLE : LinkBusy(fsm);
+}
+
+static uint8_t ActServiceOpen(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->service_field = 0;
+    return RequestField(fsm);
+}
+
+static uint8_t ActServiceNext(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(fsm->reply_seq != 0U)
+    {
+        return NEXT_FROM_TABLE;         /* Still reading the last one */
+    }
+    fsm->service_field++;
+    return RequestField(fsm);
+}
+
+/* "<NAME>=<value>", or STATS_END past the last field (start over) */
+static uint8_t ActServiceShow(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    char name[HMI_LCD_COLUMNS + 1];
+    const char *value;
+
+    if(event->id == HMI_EV_REPLY_TIMEOUT)
+    {
+        return ShowMessage(fsm, "No Response", "from Control", MSG_NORMAL_MS, HMI_LED_NONE, HMI_STATE_MENU);
+    }
+    if(strcmp(event->text, "STATS_END") == 0 && fsm->service_field != 0U)
+    {
+        fsm->service_field = 0;
+        return RequestField(fsm);
+    }
+
+    value = strchr(event->text, '=');
+    if(value == 0)
+    {
+        return ShowMessage(fsm, "Service", event->text, MSG_NORMAL_MS, HMI_LED_NONE, HMI_STATE_MENU);
+    }
+    memset(name, 0, sizeof(name));
+    strncpy(name, event->text, ((uint32_t)(value - event->text) < HMI_LCD_COLUMNS) ?
+                               (uint32_t)(value - event->text) : HMI_LCD_COLUMNS);
+    fsm->io->clear();
+    fsm->io->put(1, 0, name);
+    fsm->io->put(2, 0, value + 1);
+    return NEXT_FROM_TABLE;
+}
+
+/* Timed messages */
+static uint8_t ActMessageShow(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->io->put(1, 0, fsm->msg_line1);
+    fsm->io->put(2, 0, fsm->msg_line2);
+    if(fsm->msg_led != HMI_LED_NONE)
+    {
+        fsm->io->led(fsm->msg_led, 1);
+    }
+    StartTimer(fsm, fsm->msg_ms);
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActMessageDone(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    return fsm->msg_next;
+}
+
+static uint8_t ActLedsOff(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->io->led(HMI_LED_GREEN, 0);
+    fsm->io->led(HMI_LED_RED, 0);
+    return NEXT_FROM_TABLE;
+}
+
+/* Control lost and found again */
+static uint8_t LinkHome(const Hmi_Fsm *fsm)
+{
+    uint8_t state = (fsm->state == HMI_STATE_MESSAGE) ? fsm->msg_next : fsm->state;
+
+    if(state == HMI_STATE_CREATE || state == HMI_STATE_CREATE_CONFIRM || state == HMI_STATE_CREATE_SAVING)
+    {
+        return HMI_STATE_CREATE;
+    }
+    return HMI_STATE_MENU;
+}
+
+static uint8_t ActLinkDown(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    if(fsm->state == HMI_STATE_OFFLINE)
+    {
+        return HMI_STAY;
+    }
+    fsm->link_home = LinkHome(fsm);
+    fsm->reply_seq = 0;                 /* Whatever was asked is void now */
+    return NEXT_FROM_TABLE;
+}
+
+static uint8_t ActLinkUp(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    (void)event;
+    fsm->reply_seq = 0;
+    return (fsm->state == HMI_STATE_OFFLINE) ? fsm->link_home : LinkHome(fsm);
+}
+
+static const Hmi_ActionFn actions[ACT_COUNT] =
+{
+    [ACT_NONE]                = 0,
+    [ACT_DIGIT]               = ActDigit,
+    [ACT_BACKSPACE]           = ActBackspace,
+    [ACT_CREATE_STORE]        = ActCreateStore,
+    [ACT_CREATE_CHECK]        = ActCreateCheck,
+    [ACT_CREATE_SAVED]        = ActCreateSaved,
+    [ACT_CREATE_FAILED]       = ActCreateFailed,
+    [ACT_CREATE_NO_REPLY]     = ActCreateNoReply,
+    [ACT_MENU_SELECT]         = ActMenuSelect,
+    [ACT_UNLOCK]              = ActUnlock,
+    [ACT_OPEN_REQUEST]        = ActOpenRequest,
+    [ACT_OPEN_GRANTED]        = ActOpenGranted,
+    [ACT_OPEN_DENIED]         = ActOpenDenied,
+    [ACT_DOOR_SHOW]           = ActDoorShow,
+    [ACT_DOOR_TICK]           = ActDoorTick,
+    [ACT_DOOR_EXTEND]         = ActDoorExtend,
+    [ACT_DOOR_CLOSE]          = ActDoorClose,
+    [ACT_CHECK_OLD]           = ActCheckOld,
+    [ACT_STORE_NEW]           = ActStoreNew,
+    [ACT_CONFIRM_NEW]         = ActConfirmNew,
+    [ACT_CHANGE_SAVED]        = ActChangeSaved,
+    [ACT_SAVE_FAILED]         = ActSaveFailed,
+    [ACT_TMO_SAMPLE]          = ActTmoSample,
+    [ACT_TMO_CHECK]           = ActTmoCheck,
+    [ACT_TMO_SAVED]           = ActTmoSaved,
+    [ACT_TMO_SAVE_FAILED]     = ActTmoSaveFailed,
+    [ACT_RESET_SAVED]         = ActResetSaved,
+    [ACT_SERVICE_OPEN]        = ActServiceOpen,
+    [ACT_SERVICE_NEXT]        = ActServiceNext,
+    [ACT_SERVICE_SHOW]        = ActServiceShow,
+    [ACT_MESSAGE_SHOW]        = ActMessageShow,
+    [ACT_MESSAGE_DONE]        = ActMessageDone,
+    [ACT_LEDS_OFF]            = ActLedsOff,
+    [ACT_LINK_DOWN]           = ActLinkDown,
+    [ACT_LINK_UP]             = ActLinkUp,
+};
+
+/*
+ * RunAction
+ * Returns the state chosen by the action, or NEXT_FROM_TABLE.
+ */
+static uint8_t RunAction(Hmi_Fsm *fsm, uint8_t action, const Hmi_Event *event)
+{
+    if(action == ACT_NONE || action >= ACT_COUNT)
+    {
+        return NEXT_FROM_TABLE;
+    }
+    return actions[action](fsm, event);
+}
+
+/*
+ * EnterState
+ * Exit action of the old screen, draw the new one, then its entry action,
+ * which may chain to a further state.
+ */
+static void EnterState(Hmi_Fsm *fsm, uint8_t next)
+{
+    static const Hmi_Event none = { HMI_EV_COUNT, 0, 0, 0, 0 };
+
+    while(next != HMI_STAY && next < HMI_STATE_COUNT)
+    {
+        const Hmi_Screen *screen = &screens[next];
+
+        RunAction(fsm, screens[fsm->state].on_exit, &none);
+
+        fsm->state = next;
+        fsm->timer_tag++;               /* Drop timers armed by the old screen */
+        fsm->entry_len = 0;
+        fsm->entry[0] = '\0';
+
+        fsm->io->clear();
+        if(screen->line1 != 0)
+        {
+            fsm->io->put(1, 0, screen->line1);
+        }
+        if(screen->line2 != 0)
+        {
+            fsm->io->put(2, 0, screen->line2);
+        }
+
+        next = RunAction(fsm, screen->on_entry, &none);
+    }
+}
+
+/*
+ * Dispatch
+ * Stale timers, replies to other requests and incomplete password entries
+ * are filtered before the table lookup; everything else is one
+ * [state][event] lookup, or an any_screen one where that row is empty.
+ */
+static void Dispatch(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    const Hmi_Transition *t;
+    uint8_t next;
+
+    if(event->id >= HMI_EV_COUNT || fsm->state >= HMI_STATE_COUNT)
+    {
+        return;
+    }
+    if(event->id == HMI_EV_TIMER && event->value != fsm->timer_tag)
+    {
+        return;
+    }
+    if(event->id >= HMI_EV_REPLY_OK && event->id <= HMI_EV_REPLY_TIMEOUT)
+    {
+        /* Only the reply the current screen waits for, and only once */
+        if(event->seq == 0U || event->seq != fsm->reply_seq)
+        {
+            return;
+        }
+        fsm->reply_seq = 0;
+    }
+    if(event->id == HMI_EV_ENTER && (screens[fsm->state].flags & SCREEN_ENTRY) != 0U &&
+       fsm->entry_len != HMI_PASSWORD_LENGTH)
+    {
+        return;
+    }
+
+    t = &transitions[fsm->state][event->id];
+    if(t->action == ACT_NONE && t->next == HMI_STAY)
+    {
+        t = &any_screen[event->id];
+    }
+    next = RunAction(fsm, t->action, event);
+    if(next == NEXT_FROM_TABLE)
+    {
+        next = t->next;
+    }
+    EnterState(fsm, next);
+}
+
+/*
+ * ExpireUnarmed
+ * Delivers the timer StartTimer() could not arm, and any the screen it
+ * leads to could not arm either.
+ */
+static void ExpireUnarmed(Hmi_Fsm *fsm)
+{
+    Hmi_Event timer = { HMI_EV_TIMER, 0, 0, 0, 0 };
+
+    while(fsm->unarmed_tag != 0U)
+    {
+        timer.value = fsm->unarmed_tag;
+        fsm->unarmed_tag = 0;
+        Dispatch(fsm, &timer);
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Hmi_Fsm_Init
+ * Binds the platform and enters the password creation screen.
+ */
+void Hmi_Fsm_Init(Hmi_Fsm *fsm, const Hmi_Platform *io)
+{
+    memset(fsm, 0, sizeof(*fsm));
+    fsm->io = io;
+    fsm->state = HMI_STAY;
+    fsm->auto_lock_timeout = HMI_TIMEOUT_RESET_S;
+    EnterState(fsm, HMI_STATE_CREATE);
+    ExpireUnarmed(fsm);
+}
+
+/*
+ * Hmi_Fsm_Dispatch
+ * One event, then any timer that could not be armed meanwhile.
+ */
+void Hmi_Fsm_Dispatch(Hmi_Fsm *fsm, const Hmi_Event *event)
+{
+    Dispatch(fsm, event);
+    ExpireUnarmed(fsm);
+}
+
+/*
+ * Hmi_Fsm_HandleKey
+ * Maps a keypad character to its event and dispatches it.
+ */
+void Hmi_Fsm_HandleKey(Hmi_Fsm *fsm, char key)
+{
+    Hmi_Event event;
+
+    event.key = key;
+    event.value = 0;
+    event.seq = 0;
+    event.text = 0;
+
+    if(key >= '0' && key <= '9')
+    {
+        event.id = HMI_EV_DIGIT;
+    }
+    else if(key == '#')
+    {
+        event.id = HMI_EV_ENTER;
+    }
+    else if(key == '*')
+    {
+        event.id = HMI_EV_CANCEL;
+    }
+    else if(key >= 'A' && key <= 'D')
+    {
+        event.id = (uint8_t)(HMI_EV_MENU_A + (key - 'A'));
+    }
+    else
+    {
+        return;
+    }
+
+    Hmi_Fsm_Dispatch(fsm, &event);
+}
+
+/*
+ * Hmi_Fsm_ParseReply
+ * "DENY:<s>" / "AUTH_FAILED:<s>" / "CFG_DENIED:<s>" with s > 0 means Control
+ * has opened a lockout window of s seconds.
+ */
+void Hmi_Fsm_ParseReply(const char *reply, Hmi_Event *event)
+{
+    event->key = 0;
+    event->value = 0;
+    event->seq = 0;
+    event->text = reply;
+
+    if(strcmp(reply, "ALLOW") == 0 || strcmp(reply, "PWD_SAVED") == 0 ||
+       strcmp(reply, "AUTH_OK") == 0 || strcmp(reply, "TIMEOUT_SAVED") == 0 ||
+       strcmp(reply, "CFG_OK") == 0)
+    {
+        event->id = HMI_EV_REPLY_OK;
+    }
+    else if(strcmp(reply, "TIMEOUT") == 0)
+    {
+        event->id = HMI_EV_REPLY_TIMEOUT;
+    }
+    else
+    {
+        const char *p = strchr(reply, ':');
+
+        event->id = HMI_EV_REPLY_FAIL;
+        if(p != 0 && (strncmp(reply, "DENY:", 5) == 0 || strncmp(reply, "AUTH_FAILED:", 12) == 0 ||
+                      strncmp(reply, "CFG_DENIED:", 11) == 0))
+        {
+            for(p++; *p >= '0' && *p <= '9'; p++)
+            {
+                event->value = (event->value * 10U) + (uint32_t)(*p - '0');
+            }
+            if(event->value > 0U)
+            {
+                event->id = HMI_EV_REPLY_LOCKED;
+            }
+        }
+    }
+}
+
+/*
+ * Hmi_Fsm_HandleReply
+ * Classifies a reply line from Control and dispatches it.
+ */
+void Hmi_Fsm_HandleReply(Hmi_Fsm *fsm, uint8_t seq, const char *reply)
+{
+    Hmi_Event event;
+
+    Hmi_Fsm_ParseReply(reply, &event);
+    event.seq = seq;
+    Hmi_Fsm_Dispatch(fsm, &event);
+}
@@ -0,0 +1,204 @@
+/*****************************************************************************
+ * File: hmi_fsm.h
+ * Module: HMI_FSM
+ * Description: Header file for the table-driven HMI menu / password state
+ *              machine
+ *
+ * Every screen is a state. Behaviour is declared in two constant tables in
+ * hmi_fsm.c: a screen table (what to draw, entry/exit actions, which flow
+ * the screen belongs to) and a transition table indexed by
+ * [state][event] -> (action, next state). Dispatch is one table lookup.
+ *
+ * All password prompts share one entry sub-machine: digits append (echoed
+ * or masked), '*' erases the last digit, '#' completes the entry once it
+ * holds HMI_PASSWORD_LENGTH digits and only then reaches the table.
+ *
+ * The module touches no hardware. The LCD, the Control ECU link, LEDs, the
+ * pot and the message timer are reached through an Hmi_Platform supplied
+ * by the caller, so the whole flow runs unchanged against fakes on a host.
+ * Requests to Control never wait: each one returns a sequence ID and the
+ * caller feeds the matching reply back with Hmi_Fsm_HandleReply() whenever
+ * it arrives. A screen only accepts the reply to the request it is waiting
+ * for, so independent requests can be pipelined. A timer the platform
+ * cannot arm expires at once, so a screen never waits on it forever.
+ *
+ * '#' on the menu opens the service page: Control's "STATS?" counters, one
+ * per screen, name above value; '#' shows the next, '*' goes back.
+ *
+ * HMI_EV_LINK_DOWN and HMI_EV_LINK_UP, from the link heartbeat, apply on
+ * every screen: down shows HMI_STATE_OFFLINE at once, up returns to the
+ * menu (or to password creation, if that was not finished), also when
+ * Control restarted without the link going down.
+ *****************************************************************************/
+
+#ifndef HMI_FSM_H_
+#define HMI_FSM_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define HMI_PASSWORD_LENGTH     5       /* Digits per password */
+#define HMI_MAX_ATTEMPTS        3       /* Local failures before lockout */
+#define HMI_LCD_COLUMNS         16
+#define HMI_REQUEST_SIZE        32      /* Longest request ("CFG:...") incl. terminator */
+
+#define HMI_TIMEOUT_MIN_S       5       /* Pot range for the auto-lock time */
+#define HMI_TIMEOUT_MAX_S       30
+#define HMI_TIMEOUT_RESET_S     10      /* Restored by the D (reset) flow */
+#define HMI_DOOR_MAX_S          99      /* Countdown cap when '*' extends it (DOOR_HOLD_MAX_S on Control) */
+#define HMI_POT_FULL_SCALE      4095
+
+/* LEDs driven through Hmi_Platform.led */
+#define HMI_LED_NONE            0
+#define HMI_LED_GREEN           1
+#define HMI_LED_RED             2
+
+/*
+ * States (screens). HMI_STAY is not a state: in the transition table it
+ * means "no transition".
+ */
+typedef enum
+{
+    HMI_STAY = 0,
+    HMI_STATE_CREATE,           /* First boot: enter password */
+    HMI_STATE_CREATE_CONFIRM,
+    HMI_STATE_CREATE_SAVING,
+    HMI_STATE_MENU,
+    HMI_STATE_LOCKED_NOTICE,    /* Menu key pressed while locked out */
+    HMI_STATE_OPEN_PWD,         /* A: open the door */
+    HMI_STATE_OPEN_WAIT,
+    HMI_STATE_DOOR_OPEN,        /* Countdown: '#' locks now, '*' extends */
+    HMI_STATE_CHANGE_OLD,       /* B: change password */
+    HMI_STATE_CHANGE_NEW,
+    HMI_STATE_CHANGE_CONFIRM,
+    HMI_STATE_CHANGE_SAVING,
+    HMI_STATE_TMO_ADJUST,       /* C: auto-lock timeout */
+    HMI_STATE_TMO_PWD,
+    HMI_STATE_TMO_SAVING,
+    HMI_STATE_RESET_OLD,        /* D: reset password and timeout */
+    HMI_STATE_RESET_NEW,
+    HMI_STATE_RESET_CONFIRM,
+    HMI_STATE_RESET_SAVING,
+    HMI_STATE_SERVICE,          /* '#': Control's counters */
+    HMI_STATE_MESSAGE,          /* Timed message, then Hmi_Fsm.msg_next */
+    HMI_STATE_OFFLINE,          /* Control not answering heartbeats */
+    HMI_STATE_COUNT
+} Hmi_State;
+
+/* Events */
+typedef enum
+{
+    HMI_EV_DIGIT = 0,           /* key = '0'..'9' */
+    HMI_EV_ENTER,               /* '#' */
+    HMI_EV_CANCEL,              /* '*' */
+    HMI_EV_MENU_A,
+    HMI_EV_MENU_B,
+    HMI_EV_MENU_C,
+    HMI_EV_MENU_D,
+    HMI_EV_TICK,                /* Periodic, drives the pot screen */
+    HMI_EV_TIMER,               /* value = tag passed to start_timer */
+    HMI_EV_REPLY_OK,            /* ALLOW, PWD_SAVED, AUTH_OK, TIMEOUT_SAVED, CFG_OK */
+    HMI_EV_REPLY_FAIL,          /* DENY / AUTH_FAILED / CFG_DENIED without lockout, errors */
+    HMI_EV_REPLY_LOCKED,        /* DENY:<s> / AUTH_FAILED:<s> / CFG_DENIED:<s>, value = s */
+    HMI_EV_REPLY_TIMEOUT,       /* Control did not answer */
+    HMI_EV_LINK_DOWN,           /* Heartbeats unanswered */
+    HMI_EV_LINK_UP,             /* Answered again, or Control restarted */
+    HMI_EV_COUNT
+} Hmi_EventId;
+
+typedef struct
+{
+    uint8_t  id;                /* Hmi_EventId */
+    char     key;
+    uint32_t value;
+    uint8_t  seq;               /* HMI_EV_REPLY_*: ID returned by request */
+    const char *text;           /* HMI_EV_REPLY_*: the reply, during dispatch only */
+} Hmi_Event;
+
+/*
+ * Hmi_Platform
+ * Everything the state machine needs from the outside world.
+ */
+typedef struct
+{
+    void (*clear)(void);
+    void (*put)(uint8_t row, uint8_t col, const char *text);   /* row 1 or 2 */
+    uint8_t (*request)(const char *command);    /* Returns a non-zero sequence ID, 0 if not sent */
+    void (*send)(const char *command);      /* Send "<command>\n", no reply */
+    void (*lockout_alarm)(void);            /* Single 'L' to Control */
+    void (*led)(uint8_t led, uint8_t on);
+    uint8_t (*start_timer)(uint32_t ms, uint32_t tag); /* One-shot HMI_EV_TIMER; 0 if not armed */
+    uint32_t (*read_pot)(void);             /* 0 .. HMI_POT_FULL_SCALE */
+} Hmi_Platform;
+
+/*
+ * Hmi_Fsm
+ * State machine instance. Fields are private to hmi_fsm.c except where
+ * noted; they are visible so tests can inspect them.
+ */
+typedef struct
+{
+    const Hmi_Platform *io;
+    uint8_t  state;
+    uint8_t  locked;                        /* A-flow lockout until '*' */
+    uint8_t  attempts[5];                   /* Failed attempts per flow */
+    uint8_t  entry_len;
+    char     entry[HMI_PASSWORD_LENGTH + 1];
+    char     pass[HMI_PASSWORD_LENGTH + 1]; /* Copy for local old-password checks */
+    char     new_pass[HMI_PASSWORD_LENGTH + 1];
+    uint32_t auto_lock_timeout;             /* Seconds, as last saved on Control */
+    uint32_t adjusted_timeout;              /* Pot value awaiting password */
+    uint32_t door_remaining;                /* Seconds until the door re-locks */
+    uint32_t timer_tag;                     /* Only the newest timer is honoured */
+    uint32_t unarmed_tag;                   /* Timer start_timer refused, 0 = none */
+    uint8_t  reply_seq;                     /* Reply the current screen waits for */
+    /* HMI_STATE_MESSAGE contents */
+    char     msg_line1[HMI_LCD_COLUMNS + 1];
+    char     msg_line2[HMI_LCD_COLUMNS + 1];
+    uint32_t msg_ms;
+    uint8_t  msg_led;
+    uint8_t  msg_next;
+    uint8_t  link_home;                     /* Screen to return to from HMI_STATE_OFFLINE */
+    uint8_t  service_field;                 /* "STATS?" field on the service page */
+} Hmi_Fsm;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Hmi_Fsm_Init
+ * Binds the platform and enters the password creation screen.
+ */
+void Hmi_Fsm_Init(Hmi_Fsm *fsm, const Hmi_Platform *io);
+
+/*
+ * Hmi_Fsm_Dispatch
+ * Runs one event through the transition table, then expires any timer
+ * start_timer refused meanwhile.
+ */
+void Hmi_Fsm_Dispatch(Hmi_Fsm *fsm, const Hmi_Event *event);
+
+/*
+ * Hmi_Fsm_HandleKey
+ * Maps a keypad character to its event and dispatches it.
+ */
+void Hmi_Fsm_HandleKey(Hmi_Fsm *fsm, char key);
+
+/*
+ * Hmi_Fsm_HandleReply
+ * Classifies the reply to request seq (text without prefix or '\n', or
+ * "TIMEOUT" when none came) and dispatches it.
+ */
+void Hmi_Fsm_HandleReply(Hmi_Fsm *fsm, uint8_t seq, const char *reply);
+
+/*
+ * Hmi_Fsm_ParseReply
+ * Classifies a reply line into an HMI_EV_REPLY_* event.
+ */
+void Hmi_Fsm_ParseReply(const char *reply, Hmi_Event *event);
+
+#endif /* HMI_FSM_H_ */
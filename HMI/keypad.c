@@ -1,7 +1,13 @@
 #include "tm4c123gh6pm.h"
 #include "keypad.h"
+#include "dio.h"
 #include <stdint.h>
 
+// Ports A and C through dio.h, so the scan follows DIO_USE_AHB; the masked
+// DATA apertures drive only the row pins and read only the column pins.
+#define ROWS 0xF0  // PC4-PC7
+#define COLS 0x3C  // PA2-PA5
+
 const char KEYS[4][4] = {
     {'1','2','3','A'},
     {'4','5','6','B'},
@@ -12,32 +18,77 @@ const char KEYS[4][4] = {
 void Keypad_Init(void)
 {
     SYSCTL_RCGCGPIO_R |= 0x05;
+    while((SYSCTL_PRGPIO_R & 0x05) != 0x05);
 
     // PORTC rows PC4-PC7 = outputs
-    GPIO_PORTC_DIR_R |= 0xF0;
-    GPIO_PORTC_DEN_R |= 0xF0;
+    DIO_PORT_REG(PORTC, DIO_OFFSET_DIR) |= ROWS;
+    DIO_PORT_REG(PORTC, DIO_OFFSET_DEN) |= ROWS;
 
     // PORTA columns PA2-PA5 = inputs + pullups
-    GPIO_PORTA_DIR_R &= ~0x3C;
-    GPIO_PORTA_DEN_R |= 0x3C;
-    GPIO_PORTA_PUR_R |= 0x3C;
+    DIO_PORT_REG(PORTA, DIO_OFFSET_DIR) &= ~COLS;
+    DIO_PORT_REG(PORTA, DIO_OFFSET_DEN) |= COLS;
+    DIO_PORT_REG(PORTA, DIO_OFFSET_PUR) |= COLS;
+}
+
+// Returns the key currently held down (first found), or 0 - does not wait
+static char Keypad_ReadRaw(void)
+{
+    for(int row = 0; row < 4; row++)
+    {
+        DIO_PORT_DATA(PORTC, ROWS) = ~(1 << (row + 4)) & ROWS;
+
+        uint32_t col = DIO_PORT_DATA(PORTA, COLS);
+
+        if(col != COLS)
+        {
+            for(int c = 0; c < 4; c++)
+            {
+                if(!(col & (1 << (c + 2))))
+                {
+                    return KEYS[row][3-c];
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Non-blocking scan for periodic callers: a key is reported once, after it
+// reads the same on two consecutive scans, and not again until released
+char Keypad_Scan(void)
+{
+    static char candidate = 0;
+    static char reported = 0;
+    char key = Keypad_ReadRaw();
+
+    if(key != candidate)
+    {
+        candidate = key;            // Changed since last scan: wait for it to settle
+        return 0;
+    }
+    if(key == reported)
+    {
+        return 0;                   // Still held, or still released
+    }
+    reported = key;
+    return key;                     // 0 on release, the key on a new press
 }
 
 char Keypad_GetKey(void)
 {
     for(int row = 0; row < 4; row++)
     {
-        GPIO_PORTC_DATA_R = ~(1 << (row + 4)) & 0xF0;
+        DIO_PORT_DATA(PORTC, ROWS) = ~(1 << (row + 4)) & ROWS;
 
-        uint32_t col = GPIO_PORTA_DATA_R & 0x3C;
+        uint32_t col = DIO_PORT_DATA(PORTA, COLS);
         
-        if(col != 0x3C)
+        if(col != COLS)
         {
             for(int c = 0; c < 4; c++)
             {
                 if(!(col & (1 << (c + 2))))
                 {
-                    while(!(GPIO_PORTA_DATA_R & (1 << (c + 2))));
+                    while(!DIO_PORT_DATA(PORTA, 1 << (c + 2)));
                     return KEYS[row][3-c];
                 }
             }
@@ -3,5 +3,6 @@
 
 void Keypad_Init(void);
 char Keypad_GetKey(void);
+char Keypad_Scan(void);
 
 #endif
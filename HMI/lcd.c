@@ -1,9 +1,19 @@
 #include "tm4c123gh6pm.h"
 #include "lcd.h"
+#include "dio.h"
+#include "systick.h"
 #include <stdint.h>
 
+// Port B through dio.h, so the LCD follows DIO_USE_AHB. Each write below
+// is one store to the masked DATA aperture: only the named pins change.
 #define RS 0x01  // PB0
 #define EN 0x02  // PB1
+#define DB 0x3C  // PB2-PB5 = D4-D7
+
+// HD44780 timing, with margin
+#define LCD_POWER_ON_MS 20U  // Supply up to first command (15 ms)
+#define LCD_EXEC_US     50U  // Most commands and characters (37 us)
+#define LCD_CLEAR_MS    2U   // Clear display, return home (1.52 ms)
 
 void delayMs(int n);
 void delayUs(int n);
@@ -13,10 +23,12 @@ void LCD_Init(void)
     SYSCTL_RCGCGPIO_R |= 0x02;  
     while((SYSCTL_PRGPIO_R & 0x02) == 0);
 
-    GPIO_PORTB_DIR_R |= 0x3F;  
-    GPIO_PORTB_DEN_R |= 0x3F;
+    DIO_PORT_REG(PORTB, DIO_OFFSET_DIR) |= 0x3F;  
+    DIO_PORT_REG(PORTB, DIO_OFFSET_DEN) |= 0x3F;
 
-    delayMs(20);
+    // Counted from SysTick_Init at reset: the other drivers' bring-up
+    // has used part of it already
+    while(SysTick_GetTicks() < LCD_POWER_ON_MS);
     LCD_Command(0x28);
     LCD_Command(0x0C);
     LCD_Command(0x06);
@@ -26,34 +38,38 @@ void LCD_Init(void)
 
 void LCD_Command(unsigned char cmd)
 {
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & ~0x3C) | ((cmd >> 2) & 0x3C);
-    GPIO_PORTB_DATA_R &= ~RS;
-    GPIO_PORTB_DATA_R |= EN;
+    DIO_PORT_DATA(PORTB, DB) = (cmd >> 2) & DB;
+    DIO_PORT_DATA(PORTB, RS) = 0;
+    DIO_PORT_DATA(PORTB, EN) = EN;
     delayUs(1);
-    GPIO_PORTB_DATA_R &= ~EN;
+    DIO_PORT_DATA(PORTB, EN) = 0;
 
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & ~0x3C) | ((cmd << 2) & 0x3C);
-    GPIO_PORTB_DATA_R |= EN;
+    DIO_PORT_DATA(PORTB, DB) = (cmd << 2) & DB;
+    DIO_PORT_DATA(PORTB, EN) = EN;
     delayUs(1);
-    GPIO_PORTB_DATA_R &= ~EN;
+    DIO_PORT_DATA(PORTB, EN) = 0;
 
-    delayMs(2);
+    if(cmd <= 0x03) {
+        delayMs(LCD_CLEAR_MS);
+    } else {
+        delayUs(LCD_EXEC_US);
+    }
 }
 
 void LCD_Char(unsigned char data)
 {
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & ~0x3C) | ((data >> 2) & 0x3C);
-    GPIO_PORTB_DATA_R |= RS;
-    GPIO_PORTB_DATA_R |= EN;
+    DIO_PORT_DATA(PORTB, DB) = (data >> 2) & DB;
+    DIO_PORT_DATA(PORTB, RS) = RS;
+    DIO_PORT_DATA(PORTB, EN) = EN;
     delayUs(1);
-    GPIO_PORTB_DATA_R &= ~EN;
+    DIO_PORT_DATA(PORTB, EN) = 0;
 
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & ~0x3C) | ((data << 2) & 0x3C);
-    GPIO_PORTB_DATA_R |= EN;
+    DIO_PORT_DATA(PORTB, DB) = (data << 2) & DB;
+    DIO_PORT_DATA(PORTB, EN) = EN;
     delayUs(1);
-    GPIO_PORTB_DATA_R &= ~EN;
+    DIO_PORT_DATA(PORTB, EN) = 0;
 
-    delayMs(2);
+    delayUs(LCD_EXEC_US);
 }
 
 void LCD_String(char *str)
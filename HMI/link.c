@@ -0,0 +1,918 @@
+/*****************************************************************************
+ * File: link.c
+ * Module: LINK
+ * Description: Source file for the HMI side of the UART2 transaction layer
+ *****************************************************************************/
+
+#include "link.h"
+#include "uart.h"
+#include "systick.h"
+#include "crc16.h"
+#include "fmt.h"
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define LINK_PREFIX_LENGTH      4       /* "@SS " */
+#define LINK_ADDRESS_LENGTH     3       /* "#NN" on the RS-485 bus */
+#define LINK_RATE_COMMAND_SIZE  16U     /* "BAUD:" and up to 10 digits */
+#define LINK_BEAT_COMMAND_SIZE  14U     /* "HB:" and up to 10 digits */
+#define LINK_BEAT_NAME_LENGTH   3       /* "HB:" */
+
+#define LINK_TEXT(x)            #x
+#define LINK_DIGITS(x)          LINK_TEXT(x)
+#if LINK_DOOR_ID == 0
+#define LINK_DOOR_PREFIX        ""
+#else
+#define LINK_DOOR_PREFIX        "D" LINK_DIGITS(LINK_DOOR_ID) "/"
+#endif
+
+typedef struct
+{
+    uint8_t  seq;                       /* LINK_NO_SEQ = free slot */
+    uint32_t sent_at;                   /* SysTick_GetTicks() */
+} Link_Transaction;
+
+/* Rate negotiation, one step per Link_Poll() */
+typedef enum
+{
+    NEGOTIATE_IDLE,
+    NEGOTIATE_RATE,                     /* "BAUD:<rate>" sent */
+    NEGOTIATE_SWITCH,                   /* BAUD_OK: both sides switch after a delay */
+    NEGOTIATE_PROBE,                    /* PING sent at the new rate */
+    NEGOTIATE_COMMIT,                   /* "BAUD:COMMIT" sent */
+    NEGOTIATE_SETTLE,                   /* Fell back: Control settles before the next rate */
+    NEGOTIATE_FALLBACK                  /* Link_FallBack(): Control settles, then traffic resumes */
+} Link_Negotiation;
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static Link_Transaction pending[LINK_MAX_PENDING];
+static Link_ReplyFn reply_fn = 0;
+static uint8_t next_seq = 1;
+static char line[LINK_LINE_SIZE];
+static uint8_t line_length = 0;
+static uint8_t timeouts_in_row = 0;
+static uint8_t errors_in_row = 0;
+
+/* Heartbeat: at most one beat outstanding */
+static uint8_t beat_seq = LINK_NO_SEQ;
+static uint32_t beat_sent_us = 0;       /* SysTick_GetMicros() */
+static uint8_t beats_missed = 0;        /* In a row */
+static uint8_t online = 1;              /* main() has just heard CONTROL_READY */
+static uint8_t resync = 0;              /* Renegotiate once the link is quiet */
+static uint32_t peer_uptime = 0;        /* From Control's last answer */
+static Link_Stats stats;
+
+static const uint32_t probe_rates[] = LINK_PROBE_RATES;
+
+/* Rate negotiation in progress */
+static Link_Negotiation negotiation = NEGOTIATE_IDLE;
+static uint8_t probe_rate = 0;          /* Index into probe_rates */
+static uint8_t probes = 0;              /* Round trips answered at that rate */
+static uint32_t step_at = 0;            /* SysTick_GetTicks() when the step began */
+static char ping[LINK_PROBE_LINE_SIZE];
+static char probe_line[LINK_PROBE_LINE_SIZE];
+static uint8_t probe_length = 0;
+
+#if UART2_RS485
+/* Lines waiting for this panel's poll, oldest at tx_head */
+static char tx_queue[LINK_TX_QUEUE][LINK_TX_LINE_SIZE];
+static uint8_t tx_head = 0;
+static uint8_t tx_count = 0;
+static char address[LINK_ADDRESS_LENGTH + 1];   /* "#NN" of LINK_NODE_ID */
+#endif
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * HexValue
+ * Returns the value of an upper-case hex digit, or -1.
+ */
+static int HexValue(char c)
+{
+    if(c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if(c >= 'A' && c <= 'F')
+    {
+        return (c - 'A') + 10;
+    }
+    return -1;
+}
+
+/*
+ * Complete
+ * Frees the slot before calling back, so the callback may issue the next
+ * request straight away.
+ */
+static void Complete(Link_Transaction *t, const char *reply)
+{
+    uint8_t seq = t->seq;
+
+    t->seq = LINK_NO_SEQ;
+    if(reply_fn != 0)
+    {
+        reply_fn(seq, reply);
+    }
+}
+
+/*
+ * NextSeq
+ * Takes the next sequence ID, skipping LINK_NO_SEQ.
+ */
+static uint8_t NextSeq(void)
+{
+    uint8_t seq = next_seq;
+
+    next_seq++;
+    if(next_seq == LINK_NO_SEQ)
+    {
+        next_seq = 1;
+    }
+    return seq;
+}
+
+/*
+ * Absolute
+ * Distance between two microsecond counts.
+ */
+static uint32_t Absolute(uint32_t a, uint32_t b)
+{
+    return (a > b) ? (a - b) : (b - a);
+}
+
+/*
+ * UpdateRtt
+ * Moving mean and RFC 3550 jitter in shifts, so a beat costs no division.
+ */
+static void UpdateRtt(uint32_t rtt)
+{
+    if(stats.answered == 0U)
+    {
+        stats.rtt_min_us = rtt;
+        stats.rtt_max_us = rtt;
+        stats.rtt_mean_us = rtt;
+    }
+    else
+    {
+        uint32_t change = Absolute(rtt, stats.rtt_us);
+
+        if(rtt < stats.rtt_min_us)
+        {
+            stats.rtt_min_us = rtt;
+        }
+        if(rtt > stats.rtt_max_us)
+        {
+            stats.rtt_max_us = rtt;
+        }
+        if(rtt >= stats.rtt_mean_us)
+        {
+            stats.rtt_mean_us += (rtt - stats.rtt_mean_us) >> LINK_RTT_MEAN_SHIFT;
+        }
+        else
+        {
+            stats.rtt_mean_us -= (stats.rtt_mean_us - rtt) >> LINK_RTT_MEAN_SHIFT;
+        }
+        if(change >= stats.jitter_us)
+        {
+            stats.jitter_us += (change - stats.jitter_us) >> LINK_JITTER_SHIFT;
+        }
+        else
+        {
+            stats.jitter_us -= (stats.jitter_us - change) >> LINK_JITTER_SHIFT;
+        }
+    }
+    stats.rtt_us = rtt;
+    stats.answered++;
+}
+
+/*
+ * Beat
+ * Control's answer to the outstanding beat, "HB:<uptime>". An uptime
+ * lower than the last one means Control restarted in between.
+ */
+static void Beat(const char *reply)
+{
+    uint32_t rtt = SysTick_GetMicros() - beat_sent_us;
+    uint32_t uptime = 0;
+    const char *p;
+
+    beat_seq = LINK_NO_SEQ;
+    if(strncmp(reply, "HB:", LINK_BEAT_NAME_LENGTH) != 0)
+    {
+        return;
+    }
+    for(p = &reply[LINK_BEAT_NAME_LENGTH]; *p >= '0' && *p <= '9'; p++)
+    {
+        uptime = (uptime * 10U) + (uint32_t)(*p - '0');
+    }
+
+    UpdateRtt(rtt);
+    beats_missed = 0;
+    if(online == 0U || uptime < peer_uptime)
+    {
+        online = 1;
+        resync = 1;
+        stats.reconnects++;
+    }
+    peer_uptime = uptime;
+}
+
+/*
+ * MatchLine
+ * Completes the request (or beat) named by a "@SS " prefix. Returns 1 if
+ * it did.
+ */
+static uint8_t MatchLine(const char *text)
+{
+    int high;
+    int low;
+    uint8_t seq;
+    uint8_t i;
+
+    if(strlen(text) < LINK_PREFIX_LENGTH || text[0] != '@' || text[3] != ' ')
+    {
+        return 0;
+    }
+    high = HexValue(text[1]);
+    low = HexValue(text[2]);
+    if(high < 0 || low < 0)
+    {
+        return 0;
+    }
+
+    seq = (uint8_t)((high << 4) | low);
+    if(seq == beat_seq && seq != LINK_NO_SEQ)
+    {
+        Beat(&text[LINK_PREFIX_LENGTH]);
+        return 1;
+    }
+    for(i = 0; i < LINK_MAX_PENDING; i++)
+    {
+        if(pending[i].seq == seq && seq != LINK_NO_SEQ)
+        {
+            Complete(&pending[i], &text[LINK_PREFIX_LENGTH]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * SendText
+ * Characters only; the TX FIFO paces them.
+ */
+static void SendText(const char *text)
+{
+    while(*text != '\0')
+    {
+        UART2_SendChar(*text++);
+    }
+}
+
+/*
+ * Transmit
+ * Point to point, "<prefix><door><command>\n" goes out at once. On the bus
+ * it waits in the queue for this panel's poll. Returns 0 if it could not be
+ * queued.
+ */
+static uint8_t Transmit(const char *prefix, const char *command)
+{
+#if UART2_RS485
+    char *slot;
+
+    if(tx_count >= LINK_TX_QUEUE ||
+       (strlen(prefix) + strlen(LINK_DOOR_PREFIX) + strlen(command)) >= LINK_TX_LINE_SIZE)
+    {
+        return 0;
+    }
+    slot = tx_queue[(tx_head + tx_count) % LINK_TX_QUEUE];
+    strcpy(slot, prefix);
+    strcat(slot, LINK_DOOR_PREFIX);
+    strcat(slot, command);
+    tx_count++;
+#else
+    SendText(prefix);
+    SendText(LINK_DOOR_PREFIX);
+    SendText(command);
+    UART2_SendChar('\n');
+#endif
+    return 1;
+}
+
+#if UART2_RS485
+/*
+ * AnswerPoll
+ * Every poll gets exactly one line back, empty if nothing is queued, so
+ * Control can move on to the next panel without waiting.
+ */
+static void AnswerPoll(void)
+{
+    SendText(address);
+    if(tx_count != 0U)
+    {
+        SendText(tx_queue[tx_head]);
+        tx_head = (uint8_t)((tx_head + 1U) % LINK_TX_QUEUE);
+        tx_count--;
+    }
+    UART2_SendChar('\n');
+}
+
+/*
+ * AcceptLine
+ * Lines for other panels are dropped; a poll for this one is answered.
+ * Returns the text after the address, or 0 if there is nothing more to do.
+ */
+static const char *AcceptLine(const char *text)
+{
+    if(strncmp(text, address, LINK_ADDRESS_LENGTH) != 0)
+    {
+        return 0;
+    }
+    text += LINK_ADDRESS_LENGTH;
+    if(strcmp(text, "?") == 0)
+    {
+        AnswerPoll();
+        return 0;
+    }
+    return text;
+}
+#endif
+
+/*
+ * FallBackIfFast
+ * At the default rate there is nothing slower to try.
+ */
+static void FallBackIfFast(void)
+{
+    if(UART2_GetBaud() != UART2_BAUD_DEFAULT)
+    {
+        Link_FallBack();
+    }
+    timeouts_in_row = 0;
+    errors_in_row = 0;
+}
+
+/*
+ * FormatPrefix
+ * Writes "@SS ".
+ */
+static void FormatPrefix(char *prefix, uint8_t seq)
+{
+    prefix[0] = '@';
+    prefix[1] = hex_digits[seq >> 4];
+    prefix[2] = hex_digits[seq & 0x0FU];
+    prefix[3] = ' ';
+    prefix[4] = '\0';
+}
+
+/*
+ * FormatRateCommand
+ * Writes "BAUD:<rate>".
+ */
+static void FormatRateCommand(char *command, uint32_t rate)
+{
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, command, LINK_RATE_COMMAND_SIZE);
+    Fmt_String(&out, "BAUD:");
+    Fmt_Uint(&out, rate);
+}
+
+/*
+ * NegotiateEnd
+ * Back to normal traffic at whatever rate was reached.
+ */
+static void NegotiateEnd(void)
+{
+    negotiation = NEGOTIATE_IDLE;
+    timeouts_in_row = 0;
+    errors_in_row = 0;
+    line_length = 0;
+}
+
+/*
+ * NegotiateRate
+ * Offers the current rate, or the next one this UART can generate; no
+ * rate left ends the negotiation.
+ */
+static void NegotiateRate(uint32_t now)
+{
+    char command[LINK_RATE_COMMAND_SIZE];
+
+    while(probe_rate < (sizeof(probe_rates) / sizeof(probe_rates[0])) &&
+          UART2_CheckBaud(probe_rates[probe_rate]) == 0)
+    {
+        probe_rate++;
+    }
+    if(probe_rate >= (sizeof(probe_rates) / sizeof(probe_rates[0])))
+    {
+        NegotiateEnd();
+        return;
+    }
+
+    FormatRateCommand(command, probe_rates[probe_rate]);
+    Link_Send(command);
+    probe_length = 0;
+    negotiation = NEGOTIATE_RATE;
+    step_at = now;
+}
+
+/*
+ * NegotiateStart
+ * Builds the probe line and offers the fastest rate.
+ */
+static void NegotiateStart(uint32_t now)
+{
+    strcpy(ping, "PING:" LINK_PROBE_PATTERN);
+    CRC16_FormatHex(CRC16_Update(CRC16_INIT, (const uint8_t *)LINK_PROBE_PATTERN,
+                                 (uint32_t)(sizeof(LINK_PROBE_PATTERN) - 1U)),
+                    &ping[strlen(ping)]);
+    probe_rate = 0;
+    NegotiateRate(now);
+}
+
+/*
+ * BreakToDefault
+ * The break reaches Control whatever rate it is on. Nothing may follow it
+ * until Control's 1 ms poll has seen it, so the delay is the next step.
+ */
+static void BreakToDefault(Link_Negotiation next, uint32_t now)
+{
+    UART2_SendBreak();
+    (void)UART2_SetBaud(UART2_BAUD_DEFAULT);
+    negotiation = next;
+    step_at = now;
+}
+
+/*
+ * NegotiateFail
+ * A rate that did not hold: back to the default, then the next rate.
+ */
+static void NegotiateFail(uint32_t now)
+{
+    probe_rate++;
+    BreakToDefault(NEGOTIATE_SETTLE, now);
+}
+
+/*
+ * NegotiateSend
+ * Sends a bring-up line and waits for the reply to it.
+ */
+static void NegotiateSend(const char *command, Link_Negotiation next, uint32_t now)
+{
+    Link_Send(command);
+    probe_length = 0;
+    negotiation = next;
+    step_at = now;
+}
+
+/*
+ * NegotiateReply
+ * A whole line while a reply is awaited. Anything but the expected reply
+ * fails the step; a refused rate moves on to the next one.
+ */
+static void NegotiateReply(const char *reply, uint32_t now)
+{
+    switch(negotiation)
+    {
+    case NEGOTIATE_RATE:
+        if(strcmp(reply, "BAUD_OK") == 0)
+        {
+            negotiation = NEGOTIATE_SWITCH;
+            step_at = now;
+        }
+        else
+        {
+            probe_rate++;
+            NegotiateRate(now);
+        }
+        break;
+    case NEGOTIATE_PROBE:
+        /* The PONG is the PING with 'O' for 'I' */
+        if(reply[0] == 'P' && reply[1] == 'O' && strcmp(&reply[2], &ping[2]) == 0)
+        {
+            if(++probes < LINK_PROBE_COUNT)
+            {
+                NegotiateSend(ping, NEGOTIATE_PROBE, now);
+            }
+            else
+            {
+                NegotiateSend("BAUD:COMMIT", NEGOTIATE_COMMIT, now);
+            }
+        }
+        else
+        {
+            NegotiateFail(now);
+        }
+        break;
+    case NEGOTIATE_COMMIT:
+        if(strcmp(reply, "BAUD_OK") == 0)
+        {
+            NegotiateEnd();
+        }
+        else
+        {
+            NegotiateFail(now);
+        }
+        break;
+    default:
+        break;                          /* Nothing asked: stray line */
+    }
+}
+
+/*
+ * NegotiateNoReply
+ * A timeout or receive error. No answer to the rate offer means Control
+ * is not listening, which ends the negotiation where it is.
+ */
+static void NegotiateNoReply(uint32_t now)
+{
+    if(negotiation == NEGOTIATE_RATE)
+    {
+        NegotiateEnd();
+    }
+    else if(negotiation == NEGOTIATE_PROBE || negotiation == NEGOTIATE_COMMIT)
+    {
+        NegotiateFail(now);
+    }
+}
+
+/*
+ * Negotiate
+ * One step: collects reply characters, then acts on a whole line, an
+ * error, a timeout or the end of a delay. Never waits.
+ */
+static void Negotiate(uint32_t now)
+{
+    while(UART2_Available() && negotiation != NEGOTIATE_IDLE)
+    {
+        char c;
+
+        if(UART2_ReadCharStatus(&c) != 0U)
+        {
+            probe_length = 0;
+            NegotiateNoReply(now);
+            return;
+        }
+        if(c == '\n')
+        {
+            probe_line[probe_length] = '\0';
+            probe_length = 0;
+            NegotiateReply(probe_line, now);
+            return;
+        }
+        if(probe_length < (LINK_PROBE_LINE_SIZE - 1U))
+        {
+            probe_line[probe_length++] = c;
+        }
+    }
+
+    switch(negotiation)
+    {
+    case NEGOTIATE_SWITCH:
+        if((now - step_at) >= LINK_SWITCH_DELAY_MS)
+        {
+            (void)UART2_SetBaud(probe_rates[probe_rate]);
+            probes = 0;
+            NegotiateSend(ping, NEGOTIATE_PROBE, now);
+        }
+        break;
+    case NEGOTIATE_SETTLE:
+        if((now - step_at) >= LINK_SWITCH_DELAY_MS)
+        {
+            NegotiateRate(now);
+        }
+        break;
+    case NEGOTIATE_FALLBACK:
+        if((now - step_at) >= LINK_SWITCH_DELAY_MS)
+        {
+            NegotiateEnd();
+        }
+        break;
+    case NEGOTIATE_RATE:
+    case NEGOTIATE_PROBE:
+    case NEGOTIATE_COMMIT:
+        if((now - step_at) >= LINK_PROBE_TIMEOUT_MS)
+        {
+            NegotiateNoReply(now);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Link_Init
+ * Clears all transactions and sets the completion callback.
+ */
+void Link_Init(Link_ReplyFn on_reply)
+{
+    uint8_t i;
+
+    for(i = 0; i < LINK_MAX_PENDING; i++)
+    {
+        pending[i].seq = LINK_NO_SEQ;
+    }
+    reply_fn = on_reply;
+    line_length = 0;
+    beat_seq = LINK_NO_SEQ;
+    beats_missed = 0;
+    online = 1;
+    resync = 0;
+    negotiation = NEGOTIATE_IDLE;
+    peer_uptime = 0;
+    memset(&stats, 0, sizeof(stats));
+#if UART2_RS485
+    tx_head = 0;
+    tx_count = 0;
+    address[0] = '#';
+    address[1] = hex_digits[(LINK_NODE_ID >> 4) & 0x0FU];
+    address[2] = hex_digits[LINK_NODE_ID & 0x0FU];
+    address[3] = '\0';
+#endif
+}
+
+/*
+ * Link_Request
+ * Takes a free slot and the next sequence ID, then sends the prefixed line.
+ */
+uint8_t Link_Request(const char *command)
+{
+    Link_Transaction *t = 0;
+    char prefix[LINK_PREFIX_LENGTH + 1];
+    uint8_t i;
+
+    if(negotiation != NEGOTIATE_IDLE)
+    {
+        return LINK_NO_SEQ;             /* Would land in the middle of it */
+    }
+    for(i = 0; i < LINK_MAX_PENDING; i++)
+    {
+        if(pending[i].seq == LINK_NO_SEQ)
+        {
+            t = &pending[i];
+            break;
+        }
+    }
+    if(t == 0)
+    {
+        return LINK_NO_SEQ;
+    }
+
+    t->seq = NextSeq();
+    t->sent_at = SysTick_GetTicks();
+
+    FormatPrefix(prefix, t->seq);
+    if(Transmit(prefix, command) == 0U)
+    {
+        t->seq = LINK_NO_SEQ;
+        return LINK_NO_SEQ;
+    }
+    return t->seq;
+}
+
+/*
+ * Link_Send
+ * Sends (or queues) "<command>\n".
+ */
+void Link_Send(const char *command)
+{
+    (void)Transmit("", command);
+}
+
+/*
+ * Link_SendAlarm
+ * Point to point the alarm is the single byte 'L'; on the bus it needs an
+ * address like any other line.
+ */
+void Link_SendAlarm(void)
+{
+#if UART2_RS485
+    (void)Transmit("", "L");
+#else
+    UART2_SendChar('L');
+#endif
+}
+
+/*
+ * Link_Poll
+ * Completes at most one request per call so each callback runs in its own
+ * short slice. During a renegotiation it takes that one step instead.
+ */
+void Link_Poll(void)
+{
+    uint32_t now = SysTick_GetTicks();
+    uint8_t i;
+
+    if(negotiation != NEGOTIATE_IDLE)
+    {
+        Negotiate(now);
+        return;
+    }
+
+    while(UART2_Available())
+    {
+        char c;
+
+        if(UART2_ReadCharStatus(&c) != 0U)
+        {
+            line_length = 0;
+            if(++errors_in_row >= LINK_ERROR_LIMIT)
+            {
+                FallBackIfFast();
+                if(negotiation != NEGOTIATE_IDLE)
+                {
+                    return;             /* Settling at the default rate */
+                }
+            }
+            continue;
+        }
+
+        if(c == '\n')
+        {
+            const char *text = line;
+            uint8_t matched = 0;
+
+            line[line_length] = '\0';
+#if UART2_RS485
+            text = AcceptLine(line);
+            if(text != 0)
+#endif
+            {
+                matched = MatchLine(text);
+            }
+            line_length = 0;
+            if(matched != 0U)
+            {
+                timeouts_in_row = 0;
+                errors_in_row = 0;
+                return;
+            }
+        }
+        else if(line_length < (LINK_LINE_SIZE - 1U))
+        {
+            line[line_length++] = c;
+        }
+    }
+
+    for(i = 0; i < LINK_MAX_PENDING; i++)
+    {
+        if(pending[i].seq != LINK_NO_SEQ && (now - pending[i].sent_at) >= LINK_REPLY_TIMEOUT_MS)
+        {
+            if(++timeouts_in_row >= LINK_FALLBACK_TIMEOUTS)
+            {
+                FallBackIfFast();
+            }
+            Complete(&pending[i], "TIMEOUT");
+            return;
+        }
+    }
+}
+
+/*
+ * Link_Negotiate
+ * The steps Link_Poll() takes after a reconnect, run back to back. The
+ * first rate Control refuses or cannot hold moves on to the next one; no
+ * answer at all at the default rate ends the bring-up there.
+ */
+uint32_t Link_Negotiate(void)
+{
+    if(UART2_RS485 != 0)
+    {
+        return UART2_GetBaud();         /* One rate for the whole bus */
+    }
+
+    NegotiateStart(SysTick_GetTicks());
+    while(negotiation != NEGOTIATE_IDLE)
+    {
+        DelayMs(1);                     /* As often as LinkTask would */
+        Negotiate(SysTick_GetTicks());
+    }
+    return UART2_GetBaud();
+}
+
+/*
+ * Link_FallBack
+ * Returns once the break is out; Link_Poll() waits out the settling delay
+ * like any other bring-up step.
+ */
+void Link_FallBack(void)
+{
+    timeouts_in_row = 0;
+    errors_in_row = 0;
+    BreakToDefault(NEGOTIATE_FALLBACK, SysTick_GetTicks());
+}
+
+/*
+ * Link_Heartbeat
+ * Going offline sends the break even at the default rate: it is the
+ * quickest way to bring a Control still on a faster rate (after this
+ * HMI restarted) back to the default one. The renegotiation only starts
+ * here; Link_Poll() runs it, and beats pause until it ends.
+ */
+void Link_Heartbeat(void)
+{
+    char prefix[LINK_PREFIX_LENGTH + 1];
+    char command[LINK_BEAT_COMMAND_SIZE];
+    Fmt_Buffer out;
+
+    if(negotiation != NEGOTIATE_IDLE)
+    {
+        return;
+    }
+
+    if(beat_seq != LINK_NO_SEQ)
+    {
+        beat_seq = LINK_NO_SEQ;
+        stats.missed++;
+        if(beats_missed < LINK_HEARTBEAT_MISSES)
+        {
+            beats_missed++;
+        }
+        if(beats_missed >= LINK_HEARTBEAT_MISSES && online != 0U)
+        {
+            online = 0;
+            if(UART2_RS485 == 0)
+            {
+                Link_FallBack();
+                return;                 /* Beats resume once Control settles */
+            }
+        }
+    }
+
+    if(resync != 0U && Link_Pending() == 0U)
+    {
+        resync = 0;
+        if(UART2_RS485 == 0 && UART2_GetBaud() == UART2_BAUD_DEFAULT)
+        {
+            NegotiateStart(SysTick_GetTicks());
+            return;                     /* The next beat goes at the new rate */
+        }
+    }
+
+    Fmt_Begin(&out, command, sizeof(command));
+    Fmt_String(&out, "HB:");
+    Fmt_Uint(&out, SysTick_GetTicks());
+
+    beat_seq = NextSeq();
+    FormatPrefix(prefix, beat_seq);
+    beat_sent_us = SysTick_GetMicros();
+    if(Transmit(prefix, command) == 0U)
+    {
+        beat_seq = LINK_NO_SEQ;
+        return;
+    }
+    stats.beats++;
+}
+
+/*
+ * Link_IsOnline
+ */
+uint8_t Link_IsOnline(void)
+{
+    return online;
+}
+
+/*
+ * Link_GetStats
+ */
+void Link_GetStats(Link_Stats *copy)
+{
+    *copy = stats;
+}
+
+/*
+ * Link_Pending
+ * Counts the occupied slots.
+ */
+uint8_t Link_Pending(void)
+{
+    uint8_t count = 0;
+    uint8_t i;
+
+    for(i = 0; i < LINK_MAX_PENDING; i++)
+    {
+        if(pending[i].seq != LINK_NO_SEQ)
+        {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * File: link.h
+ * Module: LINK
+ * Description: Header file for the HMI side of the UART2 transaction layer
+ *
+ * Every request to Control carries a sequence ID and Control echoes it on
+ * the reply:
+ *
+ *     HMI -> Control    "@SS <command>\n"
+ *     Control -> HMI    "@SS <reply>\n"
+ *
+ * SS is two upper-case hex digits, 01..FF (00 is never used). Replies are
+ * matched to their request by ID, not by arrival order, so several
+ * requests may be outstanding at once and a late reply can never be taken
+ * for the answer to a newer request. A request that gets no reply within
+ * LINK_REPLY_TIMEOUT_MS completes with the reply text "TIMEOUT".
+ *
+ * Control still accepts unprefixed commands and answers them unprefixed;
+ * such lines (and replies to unknown IDs) are dropped here.
+ *
+ * Control buffers received characters in an interrupt-driven ring and
+ * throttles the HMI with XOFF when it falls behind (see uart.h), so a burst
+ * of LINK_MAX_PENDING requests is not lost while it handles the first.
+ *
+ * Link rate. Both ECUs start at UART2_BAUD_DEFAULT. Link_Negotiate() then
+ * tries the rates in LINK_PROBE_RATES, fastest first:
+ *
+ *     HMI -> Control    "BAUD:<rate>\n"          at the current rate
+ *     Control -> HMI    "BAUD_OK\n"              both sides switch
+ *     HMI -> Control    "PING:<pattern><crc>\n"  LINK_PROBE_COUNT times,
+ *     Control -> HMI    "PONG:<pattern><crc>\n"  CRC-16 as 4 hex digits
+ *     HMI -> Control    "BAUD:COMMIT\n"
+ *     Control -> HMI    "BAUD_OK\n"
+ *
+ * Any failed step ends with a break from the HMI and both sides back at
+ * the default rate; Control also falls back by itself if the commit does
+ * not arrive. At boot Link_Negotiate() runs the steps back to back; after
+ * a reconnect Link_Poll() takes them one per call, so no slice waits on a
+ * reply, and requests and beats are held off until the last one.
+ *
+ * Above the default rate, LINK_FALLBACK_TIMEOUTS timeouts in a row or
+ * LINK_ERROR_LIMIT receive errors in a row drop both sides back the same
+ * way, and Link_Poll() holds traffic off until Control has settled.
+ *
+ * Heartbeat. Link_Heartbeat(), every LINK_HEARTBEAT_MS, sends
+ *
+ *     HMI -> Control    "@SS HB:<HMI uptime ms>\n"
+ *     Control -> HMI    "@SS HB:<Control uptime ms>\n"
+ *
+ * with a sequence ID like any request but outside the LINK_MAX_PENDING
+ * slots. The round trip of each answer feeds Link_Stats. A beat still
+ * unanswered when the next is due is missed; LINK_HEARTBEAT_MISSES in a
+ * row put the link offline, and point to point it falls back to the
+ * default rate, where a restarted Control is found. Either side sees the
+ * other restart as an uptime that went backwards: Control then ends the
+ * panel's settings authorization, and the HMI counts a reconnect, as it
+ * does when an offline link answers again, and renegotiates the rate.
+ *
+ * Multi-door Control. A panel built with LINK_DOOR_ID n puts "D<n>/" in
+ * front of every command ("@SS D2/VERIFY:..."), so Control applies it to
+ * door n; with the default 0 nothing is added and Control uses door 1.
+ *
+ * RS-485 multi-drop (UART2_RS485). Several panels share the bus and Control
+ * polls them in turn (see Control/bus.h). Here every line is queued until
+ * Control polls LINK_NODE_ID ("#NN?"), then sent as "#NN<line>", one line
+ * per poll; an empty "#NN" answers a poll with nothing queued. Replies
+ * carry the same "#NN" and lines for other panels are dropped. The rate is
+ * not negotiated on the bus, and LINK_REPLY_TIMEOUT_MS includes the wait
+ * for the poll.
+ *****************************************************************************/
+
+#ifndef LINK_H_
+#define LINK_H_
+
+#include <stdint.h>
+#include "uart.h"       /* UART2_RS485 */
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define LINK_MAX_PENDING        4       /* Outstanding requests */
+#define LINK_LINE_SIZE          32      /* Longest reply line ("STATS?" field) incl. address and prefix */
+#define LINK_REPLY_TIMEOUT_MS   1000U   /* Covers a 40 ms verify plus EEPROM writes */
+
+#define LINK_PROBE_RATES        { 1000000U, 921600U, 460800U }
+#define LINK_PROBE_PATTERN      "U*U*U*U*3<3<3<3<~!~!~!~!"  /* Alternating bits, as long as a CFG: request */
+#define LINK_PROBE_COUNT        4       /* PING/PONG round trips per rate */
+#define LINK_PROBE_TIMEOUT_MS   50U     /* Per bring-up reply */
+#define LINK_PROBE_LINE_SIZE    40      /* "PONG:" + pattern + CRC + terminator */
+#define LINK_SWITCH_DELAY_MS    5U      /* Lets Control finish a switch or fallback */
+#define LINK_FALLBACK_TIMEOUTS  2U
+#define LINK_ERROR_LIMIT        4U
+
+#define LINK_HEARTBEAT_MS       100U    /* Beat period; Control drops a panel after 500 ms */
+#define LINK_HEARTBEAT_MISSES   3U      /* Unanswered beats in a row before offline */
+#define LINK_RTT_MEAN_SHIFT     3       /* Mean moves 1/8 of the way per beat */
+#define LINK_JITTER_SHIFT       4       /* Jitter 1/16, as RFC 3550 */
+
+/* RS-485 bus (UART2_RS485): this panel's ID, 1..BUS_NODE_COUNT on Control */
+#ifndef LINK_NODE_ID
+#define LINK_NODE_ID            1
+#endif
+#define LINK_TX_QUEUE           (LINK_MAX_PENDING + 3)  /* Requests plus CLOSE, the alarm and a beat */
+#define LINK_TX_LINE_SIZE       40      /* "@SS " + door + longest request + terminator */
+
+/* Door on Control this panel operates (1..DOOR_COUNT); 0 = Control's default */
+#ifndef LINK_DOOR_ID
+#define LINK_DOOR_ID            0
+#endif
+
+/* Sequence ID that is never issued: "no request" / "not sent" */
+#define LINK_NO_SEQ             0U
+
+/*
+ * Link_ReplyFn
+ * Called from Link_Poll() once per completed request, with the reply text
+ * without prefix or '\n' ("TIMEOUT" when none came).
+ */
+typedef void (*Link_ReplyFn)(uint8_t seq, const char *reply);
+
+/*
+ * Link_Stats
+ * Heartbeat counters and round-trip times, from the last Link_Init().
+ */
+typedef struct
+{
+    uint32_t beats;                     /* Sent */
+    uint32_t answered;
+    uint32_t missed;
+    uint32_t reconnects;                /* Back online, or Control restarted */
+    uint32_t rtt_us;                    /* Last round trip */
+    uint32_t rtt_min_us;
+    uint32_t rtt_max_us;
+    uint32_t rtt_mean_us;               /* Moving average */
+    uint32_t jitter_us;                 /* Mean change between round trips */
+} Link_Stats;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Link_Init
+ * Clears all transactions and sets the completion callback.
+ * UART2_Init() must have been called.
+ */
+void Link_Init(Link_ReplyFn on_reply);
+
+/*
+ * Link_Request
+ * Sends "@SS <command>\n" without waiting for the reply.
+ * Returns: the sequence ID, or LINK_NO_SEQ if LINK_MAX_PENDING requests
+ *          are already outstanding or the rate is being renegotiated
+ *          (nothing is sent)
+ */
+uint8_t Link_Request(const char *command);
+
+/*
+ * Link_Send
+ * Sends "<command>\n" for commands Control does not answer (e.g. CLOSE).
+ */
+void Link_Send(const char *command);
+
+/*
+ * Link_SendAlarm
+ * Sends the lockout alarm ('L').
+ */
+void Link_SendAlarm(void);
+
+/*
+ * Link_Poll
+ * Drains the RX FIFO, completes matched requests and expires old ones,
+ * or takes the next step of a renegotiation. Call at least once per
+ * millisecond.
+ */
+void Link_Poll(void);
+
+/*
+ * Link_Negotiate
+ * Blocking link-rate bring-up; run once after CONTROL_READY, before
+ * Link_Init(). Returns: the rate in use afterwards
+ */
+uint32_t Link_Negotiate(void);
+
+/*
+ * Link_FallBack
+ * Sends a break and returns both sides to UART2_BAUD_DEFAULT. Does not
+ * wait: requests and beats resume once Link_Poll() has let Control settle.
+ */
+void Link_FallBack(void);
+
+/*
+ * Link_Heartbeat
+ * Counts the last beat as missed if it is still unanswered, then sends
+ * the next beat. After a reconnect, once no request is outstanding, it
+ * starts a renegotiation instead, and does nothing until that ends. Call
+ * every LINK_HEARTBEAT_MS.
+ */
+void Link_Heartbeat(void);
+
+/*
+ * Link_IsOnline
+ * Returns: 1 until LINK_HEARTBEAT_MISSES beats in a row go unanswered,
+ *          then 0 until one is answered
+ */
+uint8_t Link_IsOnline(void);
+
+/*
+ * Link_GetStats
+ * Copies the heartbeat counters.
+ */
+void Link_GetStats(Link_Stats *copy);
+
+/*
+ * Link_Pending
+ * Returns: number of outstanding requests
+ */
+uint8_t Link_Pending(void);
+
+#endif /* LINK_H_ */
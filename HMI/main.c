@@ -3,98 +3,174 @@
 #include "uart.h"
 #include "dio.h"
 #include <string.h>
-#include <stdbool.h> 
-#include <stdio.h>   // Added for sprintf (used in displaying timeout value)
 #include "adc.h" // <-- NEW: Include the ADC Header
+#include "systick.h"
+#include "sched.h"
+#include "hmi_fsm.h"
+#include "link.h"
+#include "trace.h"
+#include "boot.h"
 #include <tm4c123gh6pm.h>
 
+// SELF_TEST=1 links test_integration.c and runs it against a live Control
+// board once the scheduler is idle after boot; Testing/Host runs the same
+// suite on a PC instead
+#ifndef SELF_TEST
+#define SELF_TEST 0
+#endif
+
+#if SELF_TEST
 extern void Run_Integration_Tests(void);
+void SelfTestTask(const Sched_Event *event);
+#endif
+
+// BOOT_FAST=1 (default) keeps boot within BOOT_BUDGET_MS: no "System Ready!"
+// pause, and Control gets BOOT_CONTROL_WAIT_MS to announce itself (it
+// boots in a few ms; if it was already running, the link probe finds it).
+// BOOT_FAST=0 shows the splash and waits up to 5 s as before.
+#ifndef BOOT_FAST
+#define BOOT_FAST 1
+#endif
+
+#if BOOT_FAST
+#define BOOT_CONTROL_WAIT_MS    40U
+#define BOOT_SPLASH_MS          0U
+#else
+#define BOOT_CONTROL_WAIT_MS    5000U
+#define BOOT_SPLASH_MS          1500U
+#endif
+
+// Every clock at once (see boot.h): keypad A/C, LCD B, UART2 D, pot E, LEDs F
+static const Boot_Clocks clocks = {
+    0x3FU,
+    (TRACE_ENABLE ? 0x01U : 0U) | 0x04U,    // UART0 (trace), UART2
+    0U,
+    0U,
+    0x01U,                                  // ADC0
+    0U
+};
 
 // Helper function prototype (defined in lcd.c)
 void delayMs(int n);
 
-// ========== NEW: Function to send password to TIVA 1 (Control ECU) ==========
-void SendPasswordToControl(char *password, char *command_type)
+// Scheduler task handles and application events
+#define APP_EVENT_KEY       (SCHED_EVENT_USER + 0U)   // param = key character
+#define APP_EVENT_TIMER     (SCHED_EVENT_USER + 1U)   // param = scheduler timer handle
+#define APP_EVENT_LINK      (SCHED_EVENT_USER + 2U)   // param = HMI_EV_LINK_DOWN / HMI_EV_LINK_UP
+#define APP_PERIOD_MS       100U                      // HMI_EV_TICK rate (pot sampling)
+#define KEYPAD_PERIOD_MS    20U                       // Scan rate, two scans debounce a press
+#define LINK_PERIOD_MS      1U                        // Reply latency; UART2_Handler buffers between polls
+#define HEARTBEAT_PERIOD_MS LINK_HEARTBEAT_MS
+
+static uint8_t app_task = SCHED_INVALID;
+
+void KeypadTask(const Sched_Event *event);
+void LinkTask(const Sched_Event *event);
+void HeartbeatTask(const Sched_Event *event);
+void AppTask(const Sched_Event *event);
+void TraceTask(const Sched_Event *event);
+
+// ========== Platform bindings for the menu state machine (hmi_fsm.c) ==========
+static Hmi_Fsm fsm;
+// The FSM honours only its newest timer, so it gets one scheduler timer,
+// replaced on every start
+static uint8_t app_timer = SCHED_INVALID;
+static uint32_t app_timer_due = 0;
+static uint32_t app_timer_tag = 0;
+
+static void Hmi_Clear(void)
 {
-    // Send command in format: "SETPWD:xxxxx\n" (for password creation)
-    // or "VERIFY:xxxxx\n" (for password verification)
-    UART2_SendString(command_type);
-    UART2_SendString(":");
-    UART2_SendString(password);
-    UART2_SendChar('\n');
-    
-    // Delay to ensure all data is transmitted and Control ECU can process
-    delayMs(100);
+    LCD_Clear();
 }
 
-// Function to receive response from Control ECU with timeout protection
-char* ReceiveResponseFromControl()
+static void Hmi_Put(uint8_t row, uint8_t col, const char *text)
 {
-    static char response[20];
-    int buffer_index = 0;
-    char received_char;
-    int timeout_count = 0;
-    int max_timeout = 10000;  // 10 second timeout (increased from 5s)
-    
-    memset(response, 0, sizeof(response));
-    
-    // Wait for response from Control ECU with timeout
-    while(buffer_index < 19 && timeout_count < max_timeout) {
-        if(UART2_ReceiveCharTimeout(&received_char, 1)) {
-            if(received_char == '\n') { 
-                response[buffer_index] = '\0';
-                break;
-            }
-            response[buffer_index++] = received_char;
-            timeout_count = 0;  // Reset timeout counter on successful receive
-        } else {
-            timeout_count++;  // Increment if no character received
-        }
-    }
-    
-    // If we timed out, mark response as error
-    if(timeout_count >= max_timeout) {
-        strcpy(response, "TIMEOUT");
+    LCD_SetCursor(row, col);
+    LCD_String((char *)text);
+}
+
+static void Hmi_Send(const char *command)
+{
+    Link_Send(command);
+}
+
+// Returns at once; link.c matches the reply by sequence ID and hands it
+// to Hmi_OnReply (or reports "TIMEOUT")
+static uint8_t Hmi_Request(const char *command)
+{
+    return Link_Request(command);
+}
+
+static void Hmi_OnReply(uint8_t seq, const char *reply)
+{
+    Hmi_Fsm_HandleReply(&fsm, seq, reply);
+}
+
+static void Hmi_LockoutAlarm(void)
+{
+    Link_SendAlarm(); // Lockout signal to Control
+}
+
+static void Hmi_Led(uint8_t led, uint8_t on)
+{
+    // PF3 = Green (success), PF1 = Red (error)
+    DIO_WritePin(PORTF, (led == HMI_LED_GREEN) ? PIN3 : PIN1, on ? HIGH : LOW);
+}
+
+// Timers fire between slices once due, so one not due yet is still
+// pending and its handle safe to stop. A fired one whose event is still
+// queued is told apart in AppTask by its handle and due time.
+static uint8_t Hmi_StartTimer(uint32_t ms, uint32_t tag)
+{
+    uint32_t now = SysTick_GetTicks();
+
+    if(app_timer != SCHED_INVALID && (int32_t)(app_timer_due - now) > 0) {
+        Sched_StopTimer(app_timer);
     }
-    
-    return response;
+    app_timer = Sched_StartTimer(app_task, APP_EVENT_TIMER, ms, 0);
+    app_timer_due = now + ms;
+    app_timer_tag = tag;
+    return (app_timer != SCHED_INVALID) ? 1U : 0U;
 }
-// ========== END OF NEW PASSWORD COMMUNICATION FUNCTIONS ==========
 
-// NOTE: The placeholder 'int UART0_ReadADC(void) { ... }' has been REMOVED
-// to fix the duplicate definition error (Error[Li006]), as the actual
-// implementation is now assumed to be in the separate adc.c file as ADC_ReadValue().
+static uint32_t Hmi_ReadPot(void)
+{
+    return (uint32_t)ADC_ReadValue();
+}
 
-// 1. Define all States for the system
-typedef enum {
-    STATE_CREATE_PASS,          // Initial setup: Enter password
-    STATE_CONFIRM_PASS,         // Initial setup: Confirm password
-    STATE_MAIN_MENU,            // Main operational menu (A, B, C, D)
-    STATE_VERIFY_PASS_A,        // Verify password for Action 'A' (Open)
-    STATE_LOCKOUT,              // System Lockout state (for 3 failures on 'A', 'B', 'C', or 'D')
-    // States for Password Change (B)
-    STATE_CHANGE_PASS_VERIFY,   // Step 1: Verify the old password
-    STATE_CHANGE_PASS_NEW,      // Step 2: Enter the new password
-    STATE_CHANGE_PASS_CONFIRM,  // Step 3: Confirm the new password
-    // States for Timeout Adjustment (C)
-    STATE_ADJUST_TIMEOUT,       // Reading Potentiometer/ADC value
-    STATE_VERIFY_PASS_C,        // Final password verification for saving
-    // States for Reset/Logout (D)
-    STATE_RESET_PASS_VERIFY,    // Verify old password before reset
-    STATE_RESET_CREATE_PASS,    // Enter new password after reset verification
-    STATE_RESET_CONFIRM_PASS    // Confirm new password after reset
-} PasswordState;
+static const Hmi_Platform platform = {
+    Hmi_Clear,
+    Hmi_Put,
+    Hmi_Request,
+    Hmi_Send,
+    Hmi_LockoutAlarm,
+    Hmi_Led,
+    Hmi_StartTimer,
+    Hmi_ReadPot
+};
+// ========== END OF PLATFORM BINDINGS ==========
 
 int main(void)
 {
-    LCD_Init();
+    SysTick_Init(SYSTICK_RELOAD_1MS, SYSTICK_INT); // 1 ms tick for the scheduler
+    Boot_EnableClocks(&clocks);
+    DIO_EnableAHB(); // Before any keypad/LCD port access (DIO_USE_AHB builds)
+    Boot_Mark("clocks");
     Keypad_Init();
+    Trace_Init("HMI"); // Link capture on UART0 (TRACE_ENABLE builds)
     UART2_Init();
     ADC_Pot_Init(); // <-- Call the new ADC initialization
 
-    // Initialize LED for status (PF3 - Green LED)
+    // Initialize LEDs for status (PF3 - Green LED, PF1 - Red LED)
     DIO_Init(PORTF, PIN3, OUTPUT);
     DIO_WritePin(PORTF, PIN3, LOW);
+    DIO_Init(PORTF, PIN1, OUTPUT);
+    DIO_WritePin(PORTF, PIN1, LOW);
+    Boot_Mark("drivers");
+
+    // Last, so the display's power-up time has run alongside the rest
+    LCD_Init();
+    Boot_Mark("lcd");
     
     // Wait for Control ECU to be ready
     LCD_Clear();
@@ -104,983 +180,158 @@ int main(void)
     
     char startup_check[20] = "";
     int check_index = 0;
-    int startup_timeout = 0;
+    uint32_t quiet_since = SysTick_GetTicks();
     
-    // Listen for "CONTROL_READY" message
-    while(startup_timeout < 5000) {
+    // Listen for "CONTROL_READY" message, until the line has been quiet
+    // for BOOT_CONTROL_WAIT_MS
+    while((SysTick_GetTicks() - quiet_since) < BOOT_CONTROL_WAIT_MS) {
         char received_char;
-        if(UART2_ReceiveCharTimeout(&received_char, 1)) {
-            if(received_char == '\n') {
-                startup_check[check_index] = '\0';
-                if(strstr(startup_check, "CONTROL_READY")) {
-                    // Control ECU is ready!
-                    break;
-                }
-                check_index = 0;
-                memset(startup_check, 0, sizeof(startup_check));
-            } else {
-                if(check_index < 19) {
-                    startup_check[check_index++] = received_char;
-                }
+        if(!UART2_Available()) {
+            continue;
+        }
+        received_char = UART2_ReadChar();
+        quiet_since = SysTick_GetTicks();
+        if(received_char == '\n') {
+            startup_check[check_index] = '\0';
+            if(strstr(startup_check, "CONTROL_READY")) {
+                // Control ECU is ready!
+                break;
             }
-            startup_timeout = 0;
+            check_index = 0;
+            memset(startup_check, 0, sizeof(startup_check));
         } else {
-            startup_timeout++;
+            if(check_index < 19) {
+                startup_check[check_index++] = received_char;
+            }
         }
-        delayMs(1);
     }
+    Boot_Mark("control");
     
+#if BOOT_SPLASH_MS
     // Display ready message
     LCD_Clear();
     LCD_String("System Ready!");
-    delayMs(1500);
-    Run_Integration_Tests();
-
-    PasswordState state = STATE_CREATE_PASS;
-    char pass[6] = "";              // Stores the master password (5 digits + '\0')
-    char Confirmpass[6] = "";       // Used for confirming master pass or verifying any attempt
-    int index = 0;
-    
-    // Variables for 'A' verification
-    int attempts_A = 0;             // Tracks incorrect attempts for 'A'
-    bool lock_system = false;       // Flag: system is locked (A key disabled)
-
-    // Variables for 'B' (Password Change)
-    int attempts_B = 0;             // Tracks incorrect attempts for 'B'
-    char new_pass[6] = "";          // Buffer for the new password input
-
-    // Variables for 'C' (Timeout)
-    int auto_lock_timeout = 10;     // Default timeout value (e.g., 10 seconds)
-    int pot_value = 0;              // <-- FIX: Declared here to resolve Error[Pe020]
-    int adjusted_timeout = 0;       // Temporary timeout value during adjustment (not saved until password verified)
-    int attempts_C = 0;             // Tracks incorrect attempts for timeout verification
-
-    // Variables for 'D' (Reset/Logout)
-    int attempts_D = 0;             // Tracks incorrect attempts for 'D' password verification
-    
-    // ========== NEW: Variables for receiving password from TIVA 1 ==========
-    char received_password[6] = "";      // Buffer to store password from TIVA 1
-    bool password_received = false;      // Flag to indicate password was received
-    bool password_matches = false;       // Flag to indicate password verification
-    bool password_created = false;       // FIXED: Track if password has been created
-    // ========== END OF NEW PASSWORD VARIABLES ==========
-
-    LCD_Clear();
-    LCD_String("CreatePass:"); 
-
-    while(1)
-    {
-        char key = Keypad_GetKey();
-
-        // --- 0. Handle Lockout Recovery via '*' ---
-        if (lock_system && key == '*') {
-            lock_system = false;
-            attempts_A = 0;
-            attempts_B = 0;
-            state = STATE_MAIN_MENU;
-            LCD_Clear();
-            LCD_SetCursor(1, 0);
-            LCD_String("Menu>A:Ope B:PWD");
-            LCD_SetCursor(2, 0);
-            LCD_String(" C:TMO  D:Reset");
-            continue;
-        }
-
-        if(!key) 
-        {
-            // The timeout adjustment state must continue reading the pot even if no key is pressed
-            if (state == STATE_ADJUST_TIMEOUT) {
-                // FALL THROUGH to the STATE_ADJUST_TIMEOUT logic below
-            } else {
-                continue; // Skip the rest if no key and not in adjustment state
-            }
-        }
-        
-        // ====================================================
-        // PHASE 1: MAIN MENU HANDLING
-        // ====================================================
-        if (state == STATE_MAIN_MENU)
-        {
-            // --- Action 'A': Open / Access ---
-            if (key == 'A') {
-                if (lock_system) {
-                    LCD_Clear();
-                    LCD_String("SYSTEM LOCKED");
-                    LCD_SetCursor(2, 0);
-                    LCD_String("Press '*' to Menu");
-                } else {
-                    index = 0; 
-                    state = STATE_VERIFY_PASS_A;
-                    LCD_Clear();
-                    LCD_SetCursor(1, 0);
-                    LCD_String("Enter Pwd:");
-                }
-            }
-            // --- Action 'B': Change Password ---
-            else if (key == 'B') {
-                if (lock_system) {
-                    LCD_Clear();
-                    LCD_String("SYSTEM LOCKED");
-                    LCD_SetCursor(2, 0);
-                    LCD_String("Press '*' to Menu");
-                } else {
-                    index = 0; 
-                    attempts_B = 0; 
-                    state = STATE_CHANGE_PASS_VERIFY;
-                    LCD_Clear();
-                    LCD_SetCursor(1, 0);
-                    LCD_String("Enter Old Pwd:");
-                    LCD_SetCursor(2, 0);
-                    index = 0;
-                }
-            }
-            // --- Action 'C': Set Auto-Lock Timeout (TMO) ---
-            else if (key == 'C') {
-                if (lock_system) {
-                    LCD_Clear();
-                    LCD_String("SYSTEM LOCKED");
-                    LCD_SetCursor(2, 0);
-                    LCD_String("Press '*' to Menu");
-                } else {
-                    state = STATE_ADJUST_TIMEOUT;
-                    LCD_Clear();
-                    LCD_String("Adjust Timeout:");
-                    LCD_SetCursor(2, 0);
-                    LCD_String("Value: "); // Prepare to display the value
-                }
-            }
-            // --- Action 'D': Lock System (Logout) / Reset Password ---
-            else if (key == 'D') {
-                if (lock_system) {
-                    LCD_Clear();
-                    LCD_String("SYSTEM LOCKED");
-                    LCD_SetCursor(2, 0);
-                    LCD_String("Press '*' to Menu");
-                } else {
-                    index = 0;
-                    attempts_D = 0;
-                    state = STATE_RESET_PASS_VERIFY;
-                    LCD_Clear();
-                    LCD_SetCursor(1, 0);
-                    LCD_String("Verify Old Pwd:");
-                    LCD_SetCursor(2, 0);
-                }
-            }
-            
-            continue;
-        }
-        
-        // ====================================================
-        // PHASE 2: TIMEOUT ADJUSTMENT LOGIC (C)
-        // ====================================================
-        if (state == STATE_ADJUST_TIMEOUT)
-        {
-            // pot_value declaration REMOVED from here to solve scope error.
-            
-            // Read ADC and scale the value
-            pot_value = ADC_ReadValue(); // <-- USE NEW ADC FUNCTION NAME
-            // Map the ADC range (e.g., 0-4095) to the required range (5-30)
-            int raw_timeout = (25 * pot_value) / 4095 + 5;
-            
-            if (raw_timeout < 5) raw_timeout = 5;
-            if (raw_timeout > 30) raw_timeout = 30;
-            
-            // Update the TEMPORARY adjusted_timeout variable (NOT the global auto_lock_timeout)
-            adjusted_timeout = raw_timeout;
-            
-            // Update display: Line 2 - "Value: XXs"
-            LCD_SetCursor(2, 7); 
-            LCD_String("  "); // Clear previous value
-            LCD_SetCursor(2, 7);
-            
-            char timeout_str[4];
-            sprintf(timeout_str, "%d", adjusted_timeout); 
-            LCD_String(timeout_str);
-            LCD_Char('s');
+    delayMs(BOOT_SPLASH_MS);
+#endif
 
-            // Handle Keypad input
-            if(key == '#') // '#' is used to confirm the timeout value ("Save")
-            {
-                index = 0;
-                state = STATE_VERIFY_PASS_C; // Move to password verification
-                LCD_Clear();
-                LCD_SetCursor(1, 0);
-                LCD_String("Enter Pwd:");
-                LCD_SetCursor(2, 0);
-            }
-            else if(key == '*') // '*' is used to cancel and return to menu
-            {
-                adjusted_timeout = 0; // Clear the temporary timeout value
-                state = STATE_MAIN_MENU; 
-                LCD_Clear();
-                LCD_SetCursor(1, 0);
-                LCD_String("Menu>A:Opn B:PWD");
-                LCD_SetCursor(2, 0);
-                LCD_String(" C:TMO  D:Reset"); 
-            }
-            
-            continue; 
-        }
-        
-        // ====================================================
-        // PHASE 3: PASSWORD VERIFICATION FOR TIMEOUT (C)
-        // ====================================================
-        if (state == STATE_VERIFY_PASS_C)
-        {
-            // A. Handle input characters ('0' to '9')
-            if(key >= '0' && key <= '9')
-            {
-                if(index < 5)
-                {
-                    Confirmpass[index++] = key;
-                    LCD_Char('*');
-                }
-            }
-            // B. Handle '#' (Confirm)
-            else if(key == '#' && index == 5)
-            {
-                Confirmpass[index] = '\0';
-                index = 0; 
-                
-                if(strcmp(pass, Confirmpass) == 0) // Correct Password
-                {
-                    attempts_C = 0; // Reset attempts on success
-                    // Password is correct - NOW update the global auto_lock_timeout with the adjusted value
-                    auto_lock_timeout = adjusted_timeout;
-                    
-                    LCD_Clear();
-                    LCD_String("Saving Timeout...");
-                    
-                    // First, authenticate with Control ECU using VERIFYPWD
-                    char verify_cmd[20];
-                    sprintf(verify_cmd, "VERIFYPWD:%s", pass);
-                    UART2_SendString(verify_cmd);
-                    UART2_SendChar('\n');
-                    delayMs(100);
-                    
-                    // Wait for AUTH_OK response
-                    char* auth_response = ReceiveResponseFromControl();
-                    
-                    if(strcmp(auth_response, "AUTH_OK") == 0)
-                    {
-                        // Now send TIMEOUT command with authenticated session
-                        char timeout_cmd[20];
-                        sprintf(timeout_cmd, "TIMEOUT:%d", auto_lock_timeout);
-                        UART2_SendString(timeout_cmd);
-                        UART2_SendChar('\n');
-                        delayMs(100);
-                        
-                        // Wait for response from Control ECU
-                        char* timeout_response = ReceiveResponseFromControl();
-                        
-                        if(strcmp(timeout_response, "TIMEOUT_SAVED") == 0)
-                        {
-                            LCD_Clear();
-                            LCD_String("Timeout Saved!");
-                            DIO_WritePin(PORTF, PIN3, HIGH); // Green LED for success
-                            delayMs(1500);
-                            DIO_WritePin(PORTF, PIN3, LOW);
-                        }
-                        else
-                        {
-                            LCD_Clear();
-                            LCD_String("Error Saving TMO");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("Please Retry");
-                            DIO_WritePin(PORTF, PIN1, HIGH); // Red LED for error
-                            delayMs(1500);
-                            DIO_WritePin(PORTF, PIN1, LOW);
-                        }
-                    }
-                    else
-                    {
-                        // Authentication failed on Control side
-                        LCD_Clear();
-                        LCD_String("Auth Failed!");
-                        LCD_SetCursor(2, 0);
-                        LCD_String("Timeout NOT Saved");
-                        DIO_WritePin(PORTF, PIN1, HIGH); // Red LED for error
-                        delayMs(1500);
-                        DIO_WritePin(PORTF, PIN1, LOW);
-                    }
-
-                    adjusted_timeout = 0; // Clear temporary timeout after save attempt
-                    state = STATE_MAIN_MENU;
-                    LCD_Clear();
-                    LCD_SetCursor(1, 0);
-                    LCD_String("Menu>A:Opn B:PWD");
-                    LCD_SetCursor(2, 0);
-                    LCD_String(" C:TMO  D:Reset");
-                }
-                else // Incorrect Password
-                {
-                    attempts_C++;
-                    
-                    if (attempts_C >= 3)
-                    {
-                        // 3 failed attempts - System lockout
-                        adjusted_timeout = 0; // Clear the temporary timeout
-                        state = STATE_LOCKOUT;
-                        UART2_SendChar('L'); // Send lockout signal to Control
-                        
-                        LCD_Clear();
-                        LCD_String("3 Failed Attempts");
-                        LCD_SetCursor(2, 0);
-                        LCD_String("SYSTEM LOCKED!");
-                        delayMs(5000);
-                        
-                        // Reset after lockout
-                        attempts_C = 0;
-                        lock_system = false;
-                        state = STATE_MAIN_MENU;
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Menu>A:Opn B:PWD");
-                        LCD_SetCursor(2, 0);
-                        LCD_String(" C:TMO  D:Reset");
-                    }
-                    else
-                    {
-                        // Show retry message with remaining attempts
-                        LCD_Clear();
-                        LCD_String("TMO NOT Saved");
-                        LCD_SetCursor(2, 0);
-                        LCD_String("Attempts Left: ");
-                        LCD_Char('3' - attempts_C); // Display remaining attempts (e.g., '2', '1')
-                        delayMs(2000);
-                        
-                        // Ask for password again
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Enter Pwd:");
-                        LCD_SetCursor(2, 0);
-                        index = 0;
-                        memset(Confirmpass, 0, sizeof(Confirmpass));
-                    }
-                }
-            }
-            // C. Handle '*' (Clear/Cancel)
-            else if(key == '*')
-            {
-                index = 0; 
-                LCD_Clear();
-                LCD_SetCursor(1, 0);
-                LCD_String("Enter Pwd: ");
-                LCD_SetCursor(2, 0);
-            }
-            
-            continue;
-        }
+    // Move the link to the fastest rate both ECUs hold (stays at 115200 otherwise)
+    Link_Negotiate();
+    Boot_Mark("link");
 
-        // ====================================================
-        // PHASE 4: PASSWORD CHANGE LOGIC (B)
-        // ====================================================
-        if (state == STATE_CHANGE_PASS_VERIFY || 
-            state == STATE_CHANGE_PASS_NEW || 
-            state == STATE_CHANGE_PASS_CONFIRM)
-        {
-            char* active_buffer; 
+    // Keypad scanning and the menu state machine run as scheduler tasks
+    Sched_Init();
+    app_task = Sched_AddTask(AppTask, SCHED_PRIORITY_NORMAL, APP_PERIOD_MS);
+    Sched_AddTask(KeypadTask, SCHED_PRIORITY_HIGH, KEYPAD_PERIOD_MS);
+    Sched_AddTask(LinkTask, SCHED_PRIORITY_HIGH, LINK_PERIOD_MS);
+    Sched_AddTask(HeartbeatTask, SCHED_PRIORITY_NORMAL, HEARTBEAT_PERIOD_MS);
+#if TRACE_ENABLE
+    Sched_AddTask(TraceTask, SCHED_PRIORITY_LOW, TRACE_SERVICE_MS);
+#endif
+#if SELF_TEST
+    // Once nothing else is ready, after boot
+    Sched_Post(Sched_AddTask(SelfTestTask, SCHED_PRIORITY_LOW, 0), SCHED_EVENT_USER, 0);
+#endif
+    Link_Init(Hmi_OnReply);
+    Hmi_Fsm_Init(&fsm, &platform); // Shows "CreatePass:"
+    Boot_Mark("ready");
+    Sched_Run();
+}
 
-            if (state == STATE_CHANGE_PASS_VERIFY) {
-                active_buffer = Confirmpass; // Verify old password
-            } else if (state == STATE_CHANGE_PASS_NEW) {
-                active_buffer = new_pass;    // Enter new password
-            } else { // STATE_CHANGE_PASS_CONFIRM
-                active_buffer = Confirmpass; // Confirm new password
-            }
+// Scans the keypad without blocking and hands each new press to AppTask
+void KeypadTask(const Sched_Event *event)
+{
+    char key = Keypad_Scan();
 
-            // A. Handle input characters ('0' to '9')
-            if(key >= '0' && key <= '9')
-            {
-                if(index < 5)
-                {
-                    active_buffer[index++] = key;
-                    LCD_Char(key);
-                }
-            }
-            // B. Handle '#' (Confirm)
-            else if(key == '#' && index == 5)
-            {
-                active_buffer[index] = '\0';
-                index = 0;
-                
-                // --- 1. VERIFY OLD PASSWORD ---
-                if (state == STATE_CHANGE_PASS_VERIFY)
-                {
-                    if (strcmp(pass, Confirmpass) == 0) // Correct Old Password
-                    {
-                        attempts_B = 0; 
-                        state = STATE_CHANGE_PASS_NEW; 
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Enter New Pwd:");
-                        LCD_SetCursor(2, 0);
-                    }
-                    else // Incorrect Old Password
-                    {
-                        attempts_B++;
-                        if (attempts_B >= 3) {
-                            lock_system = true;
-                            state = STATE_LOCKOUT;
-                            UART2_SendChar('L');
-                            LCD_Clear();
-                            LCD_String("3 Failed Attempts");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("SYSTEM LOCKED!");
-                            delayMs(5000); 
+    (void)event;
+    if(key) {
+        Sched_Post(app_task, APP_EVENT_KEY, (uint32_t)key);
+    }
+}
 
-                            lock_system = false; // Reset lock after delay
-                            attempts_B = 0;
-                            state = STATE_MAIN_MENU;
-                            LCD_Clear();
-                            LCD_SetCursor(1, 0);
-                            LCD_String("Menu>A:Opn B:PWD");
-                            LCD_SetCursor(2, 0);
-                            LCD_String(" C:TMO  D:Reset");
-                        } else {
-                            LCD_Clear();
-                            LCD_String("Old PWD Incorrect");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("Attempts Left: ");
-                            // '3' - attempts_B will result in a char value, e.g., '1' for 2 attempts left
-                            LCD_Char('3' - attempts_B); 
-                            delayMs(2000);
-                            
-                            index = 0;
-                            LCD_Clear();
-                            LCD_SetCursor(1, 0);
-                            LCD_String("Enter Old Pwd: ");
-                            LCD_SetCursor(2, 0);
-                        }
-                    }
-                }
-                // --- 2. ENTER NEW PASSWORD ---
-                else if (state == STATE_CHANGE_PASS_NEW)
-                {
-                    state = STATE_CHANGE_PASS_CONFIRM; 
-                    LCD_Clear();
-                    LCD_SetCursor(1, 0);
-                    LCD_String("Confirm New Pwd: ");
-                    LCD_SetCursor(2, 0);
-                }
-                // --- 3. CONFIRM NEW PASSWORD ---
-                else if (state == STATE_CHANGE_PASS_CONFIRM)
-                {
-                    if (strcmp(new_pass, Confirmpass) == 0) // New Password confirmed
-                    {
-                        strcpy(pass, new_pass);
-                        
-                        // Send the new password to Control ECU to update EEPROM
-                        LCD_Clear();
-                        LCD_String("Saving to EEPROM...");
-                        SendPasswordToControl(new_pass, "SETPWD");
-                        
-                        // Receive response from Control ECU
-                        char* save_response = ReceiveResponseFromControl();
-                        
-                        if(strcmp(save_response, "PWD_SAVED") == 0) // Password saved successfully
-                        {
-                            LCD_Clear();
-                            LCD_String("Password Changed!");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("Saved to EEPROM");
-                            DIO_WritePin(PORTF, PIN3, HIGH);
-                            delayMs(2000);
-                            DIO_WritePin(PORTF, PIN3, LOW);
-                        }
-                        else // Failed to save password
-                        {
-                            LCD_Clear();
-                            LCD_String("Error Saving PWD");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("Please Retry");
-                            DIO_WritePin(PORTF, PIN1, HIGH);
-                            delayMs(2000);
-                            DIO_WritePin(PORTF, PIN1, LOW);
-                        }
-                        
-                        state = STATE_MAIN_MENU;
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Menu>A:Opn B:PWD");
-                        LCD_SetCursor(2, 0);
-                        LCD_String(" C:TMO  D:Reset");
-                    }
-                    else // New Passwords Mismatch
-                    {
-                        LCD_Clear();
-                        LCD_String("Mismatch! Restart");
-                        delayMs(2000);
-                        
-                        index = 0;
-                        state = STATE_CHANGE_PASS_NEW;
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Enter New Pwd:");
-                        LCD_SetCursor(2, 0);
-                    }
-                }
-            }
-            // C. Handle '*' (Clear/Cancel)
-            else if(key == '*')
-            {
-                index = 0; 
-                LCD_Clear();
-                if (state == STATE_CHANGE_PASS_VERIFY) {
-                    LCD_SetCursor(1, 0); 
-                    LCD_String("Enter Old Pwd:"); 
-                    LCD_SetCursor(2, 0);
-                } else if (state == STATE_CHANGE_PASS_NEW) {
-                    LCD_SetCursor(1, 0); 
-                    LCD_String("Enter New Pwd:"); 
-                    LCD_SetCursor(2, 0);
-                } else if (state == STATE_CHANGE_PASS_CONFIRM) {
-                    LCD_SetCursor(1, 0); 
-                    LCD_String("Confirm New Pwd:"); 
-                    LCD_SetCursor(2, 0);
-                }
-            }
-            continue; 
-        }
-        
-        // ====================================================
-        // PHASE 4.5: RESET PASSWORD LOGIC (D)
-        // ====================================================
-        if (state == STATE_RESET_PASS_VERIFY || 
-            state == STATE_RESET_CREATE_PASS || 
-            state == STATE_RESET_CONFIRM_PASS)
-        {
-            char* active_buffer; 
+// Services the link every millisecond: drains UART2, matches replies to
+// their requests and expires unanswered ones, so nothing ever waits on Control
+void LinkTask(const Sched_Event *event)
+{
+    (void)event;
+    Link_Poll();
+}
 
-            if (state == STATE_RESET_PASS_VERIFY) {
-                active_buffer = Confirmpass; // Verify old password
-            } else if (state == STATE_RESET_CREATE_PASS) {
-                active_buffer = new_pass;    // Enter new password
-            } else { // STATE_RESET_CONFIRM_PASS
-                active_buffer = Confirmpass; // Confirm new password
-            }
+// Beats to Control and tells the state machine when the link goes down,
+// comes back or finds Control restarted (a new reconnect count)
+void HeartbeatTask(const Sched_Event *event)
+{
+    static uint8_t link_up = 1;
+    static uint32_t reconnects = 0;
+    Link_Stats stats;
 
-            // A. Handle input characters ('0' to '9')
-            if(key >= '0' && key <= '9')
-            {
-                if(index < 5)
-                {
-                    active_buffer[index++] = key;
-                    LCD_Char(key);
-                }
-            }
-            // B. Handle '#' (Confirm)
-            else if(key == '#' && index == 5)
-            {
-                active_buffer[index] = '\0';
-                index = 0;
-                
-                // --- 1. VERIFY OLD PASSWORD (Reset) ---
-                if (state == STATE_RESET_PASS_VERIFY)
-                {
-                    if (strcmp(pass, Confirmpass) == 0) // Correct Old Password
-                    {
-                        attempts_D = 0;
-                        state = STATE_RESET_CREATE_PASS; 
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Enter New Pwd:");
-                        LCD_SetCursor(2, 0);
-                    }
-                    else // Incorrect Old Password
-                    {
-                        attempts_D++;
-                        if (attempts_D >= 3) {
-                            lock_system = true;
-                            state = STATE_LOCKOUT;
-                            UART2_SendChar('L');
-                            LCD_Clear();
-                            LCD_String("3 Failed Attempts");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("SYSTEM LOCKED!");
-                            delayMs(5000); 
+    (void)event;
+    Link_Heartbeat();
+    Link_GetStats(&stats);
 
-                            lock_system = false; // Reset lock after delay
-                            attempts_D = 0;
-                            state = STATE_MAIN_MENU;
-                            LCD_Clear();
-                            LCD_SetCursor(1, 0);
-                            LCD_String("Menu>A:Opn B:PWD");
-                            LCD_SetCursor(2, 0);
-                            LCD_String(" C:TMO  D:Reset");
-                        } else {
-                            LCD_Clear();
-                            LCD_String("Old PWD Incorrect");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("Attempts Left: ");
-                            LCD_Char('3' - attempts_D); 
-                            delayMs(2000);
-                            
-                            index = 0;
-                            LCD_Clear();
-                            LCD_SetCursor(1, 0);
-                            LCD_String("Verify Old Pwd: ");
-                            LCD_SetCursor(2, 0);
-                            memset(Confirmpass, 0, sizeof(Confirmpass));
-                        }
-                    }
-                }
-                // --- 2. ENTER NEW PASSWORD (Reset) ---
-                else if (state == STATE_RESET_CREATE_PASS)
-                {
-                    state = STATE_RESET_CONFIRM_PASS; 
-                    LCD_Clear();
-                    LCD_SetCursor(1, 0);
-                    LCD_String("Confirm New Pwd: ");
-                    LCD_SetCursor(2, 0);
-                }
-                // --- 3. CONFIRM NEW PASSWORD (Reset) ---
-                else if (state == STATE_RESET_CONFIRM_PASS)
-                {
-                    if (strcmp(new_pass, Confirmpass) == 0) // New Password confirmed
-                    {
-                        strcpy(pass, new_pass);
-                        
-                        // Send the new password to Control ECU to update EEPROM
-                        LCD_Clear();
-                        LCD_String("Saving to EEPROM...");
-                        SendPasswordToControl(new_pass, "SETPWD");
-                        
-                        // Receive response from Control ECU
-                        char* save_response = ReceiveResponseFromControl();
-                        
-                        if(strcmp(save_response, "PWD_SAVED") == 0) // Password saved successfully
-                        {
-                            LCD_Clear();
-                            LCD_String("Password Reset!");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("Saved to EEPROM");
-                            DIO_WritePin(PORTF, PIN3, HIGH);
-                            delayMs(1500);
-                            DIO_WritePin(PORTF, PIN3, LOW);
-                            
-                            // Now reset timeout to 10 seconds
-                            LCD_Clear();
-                            LCD_String("Resetting TMO...");
-                            
-                            // Authenticate with VERIFYPWD for timeout reset
-                            char verify_cmd[20];
-                            sprintf(verify_cmd, "VERIFYPWD:%s", new_pass);
-                            UART2_SendString(verify_cmd);
-                            UART2_SendChar('\n');
-                            delayMs(100);
-                            
-                            char* auth_response = ReceiveResponseFromControl();
-                            
-                            if(strcmp(auth_response, "AUTH_OK") == 0)
-                            {
-                                // Send timeout reset command
-                                char timeout_cmd[20];
-                                sprintf(timeout_cmd, "TIMEOUT:10");
-                                UART2_SendString(timeout_cmd);
-                                UART2_SendChar('\n');
-                                delayMs(100);
-                                
-                                char* timeout_response = ReceiveResponseFromControl();
-                                
-                                if(strcmp(timeout_response, "TIMEOUT_SAVED") == 0)
-                                {
-                                    auto_lock_timeout = 10; // Update local variable
-                                    LCD_Clear();
-                                    LCD_String("Complete!");
-                                    LCD_SetCursor(2, 0);
-                                    LCD_String("TMO Reset to 10s");
-                                    DIO_WritePin(PORTF, PIN3, HIGH);
-                                    delayMs(1500);
-                                    DIO_WritePin(PORTF, PIN3, LOW);
-                                }
-                                else
-                                {
-                                    LCD_Clear();
-                                    LCD_String("Warning: TMO");
-                                    LCD_SetCursor(2, 0);
-                                    LCD_String("reset failed");
-                                    delayMs(1500);
-                                }
-                            }
-                            else
-                            {
-                                LCD_Clear();
-                                LCD_String("Warning: TMO");
-                                LCD_SetCursor(2, 0);
-                                LCD_String("reset failed");
-                                delayMs(1500);
-                            }
-                        }
-                        else // Failed to save password
-                        {
-                            LCD_Clear();
-                            LCD_String("Error Saving PWD");
-                            LCD_SetCursor(2, 0);
-                            LCD_String("Please Retry");
-                            DIO_WritePin(PORTF, PIN1, HIGH);
-                            delayMs(2000);
-                            DIO_WritePin(PORTF, PIN1, LOW);
-                        }
-                        
-                        state = STATE_MAIN_MENU;
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Menu>A:Opn B:PWD");
-                        LCD_SetCursor(2, 0);
-                        LCD_String(" C:TMO  D:Reset");
-                    }
-                    else // New Passwords Mismatch
-                    {
-                        LCD_Clear();
-                        LCD_String("Mismatch! Restart");
-                        delayMs(2000);
-                        
-                        index = 0;
-                        state = STATE_RESET_CREATE_PASS;
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Enter New Pwd:");
-                        LCD_SetCursor(2, 0);
-                    }
-                }
-            }
-            // C. Handle '*' (Clear/Cancel)
-            else if(key == '*')
-            {
-                index = 0; 
-                LCD_Clear();
-                if (state == STATE_RESET_PASS_VERIFY) {
-                    LCD_SetCursor(1, 0); 
-                    LCD_String("Verify Old Pwd:"); 
-                    LCD_SetCursor(2, 0);
-                } else if (state == STATE_RESET_CREATE_PASS) {
-                    LCD_SetCursor(1, 0); 
-                    LCD_String("Enter New Pwd:"); 
-                    LCD_SetCursor(2, 0);
-                } else if (state == STATE_RESET_CONFIRM_PASS) {
-                    LCD_SetCursor(1, 0); 
-                    LCD_String("Confirm New Pwd:"); 
-                    LCD_SetCursor(2, 0);
-                }
-            }
-            continue; 
+    if(!Link_IsOnline()) {
+        if(link_up) {
+            link_up = 0;
+            Sched_Post(app_task, APP_EVENT_LINK, HMI_EV_LINK_DOWN);
         }
-        if (state == STATE_VERIFY_PASS_A)
-        {
-            // A. Handle input characters ('0' to '9')
-            if(key >= '0' && key <= '9')
-            {
-                if(index < 5)
-                {
-                    Confirmpass[index++] = key; 
-                    LCD_Char('*');              
-                }
-            }
-            // B. Handle '#' (Confirm)
-            else if(key == '#' && index == 5)
-            {
-                Confirmpass[index] = '\0';
-                index = 0; 
-                
-                LCD_Clear();
-                LCD_String("Verifying..."); // Tell user we are verifying with Control
-                
-                // Send the entered password to Control ECU for verification
-                SendPasswordToControl(Confirmpass, "VERIFY");
-                
-                // Receive response from Control ECU
-                char* control_response = ReceiveResponseFromControl();
-                
-                if(strcmp(control_response, "ALLOW") == 0) // Correct Password
-                {
-                    attempts_A = 0; 
-                    
-                    LCD_Clear();
-                    LCD_String("Access Granted");
-                    LCD_SetCursor(2, 0);
-                    LCD_String("Closing in ");
-                    
-                    // Display the dynamic timeout value
-                    char timeout_display[3];
-                    sprintf(timeout_display, "%d", auto_lock_timeout);
-                    LCD_String(timeout_display);
-                    LCD_String("s...");
+    } else if(!link_up || stats.reconnects != reconnects) {
+        link_up = 1;
+        reconnects = stats.reconnects;
+        Sched_Post(app_task, APP_EVENT_LINK, HMI_EV_LINK_UP);
+    }
+}
 
-                    DIO_WritePin(PORTF, PIN3, HIGH); 
-                    delayMs(auto_lock_timeout * 1000); 
-                    UART2_SendString("CLOSE\n");
-                    DIO_WritePin(PORTF, PIN3, LOW); 
-                    
-                    state = STATE_MAIN_MENU;
-                    LCD_Clear();
-                    LCD_SetCursor(1, 0);
-                    LCD_String("Menu>A:Opn B:PWD");
-                    LCD_SetCursor(2, 0);
-                    LCD_String(" C:TMO  D:Reset");
-                }
-                else // Incorrect Password (DENY)
-                {
-                    attempts_A++;
-                    
-                    if (attempts_A >= 3) 
-                    {
-                        lock_system = true;
-                        state = STATE_LOCKOUT;
-                        UART2_SendChar('L');
-                        LCD_Clear();
-                        LCD_String("3 Failed Attempts");
-                        LCD_SetCursor(2, 0);
-                        LCD_String("SYSTEM LOCKED!");
-                        delayMs(5000); 
+// Sends a requested link trace dump out of UART0
+void TraceTask(const Sched_Event *event)
+{
+    (void)event;
+    Trace_Service();
+}
 
-                        state = STATE_MAIN_MENU; 
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Menu>A:Opn B:PWD");
-                        LCD_SetCursor(2, 0);
-                        LCD_String(" C:TMO  D:Reset");
-                    }
-                    else 
-                    {
-                        LCD_Clear();
-                        LCD_String("Incorrect PWD.");
-                        LCD_SetCursor(2, 0);
-                        LCD_String("Attempts Left: ");
-                        LCD_Char('3' - attempts_A); 
-                        delayMs(2000);
-                        
-                        index = 0;
-                        LCD_Clear();
-                        LCD_SetCursor(1, 0);
-                        LCD_String("Enter Pwd:");
-                    }
-                }
-            }
-            // C. Handle '*' (Clear/Cancel)
-            else if(key == '*')
-            {
-                index = 0; 
-                LCD_Clear();
-                LCD_SetCursor(1, 0);
-                LCD_String("Enter Pwd:");
-            }
-            continue; 
-        }
-        
-        // ====================================================
-        // PHASE 6: INITIAL PASSWORD SETUP & CONFIRMATION
-        // ====================================================
-        if (state == STATE_CREATE_PASS || state == STATE_CONFIRM_PASS)
-        {
-            // A. Handle input characters ('0' to '9')
-            if(key >= '0' && key <= '9')
-            {
-                if(index < 5)
-                {
-                    if (state == STATE_CREATE_PASS) {
-                        pass[index++] = key;
-                    } else if (state == STATE_CONFIRM_PASS) {
-                        Confirmpass[index++] = key;
-                    }
-                    LCD_Char(key); // Show key during initial setup
-                }
-            }
-            // B. Handle '#' (Enter/Confirm)
-            else if(key == '#' && index == 5)
-            {
-                if (state == STATE_CREATE_PASS) 
-                {
-                    pass[index] = '\0'; 
-                    index = 0; 
-                    state = STATE_CONFIRM_PASS;
+#if SELF_TEST
+// Runs the integration suite once, in place of everything else meanwhile
+void SelfTestTask(const Sched_Event *event)
+{
+    (void)event;
+    Run_Integration_Tests();
+}
+#endif
 
-                    LCD_Clear();
-                    LCD_String("Confirm:");
-                } 
-                else if (state == STATE_CONFIRM_PASS) 
-                {
-                    Confirmpass[index] = '\0';
-                    index = 0; 
-                    
-                    LCD_Clear();
-                    
-                    // 1. Check if the two local typings match
-                    if(strcmp(pass, Confirmpass) == 0) 
-                    {
-                        LCD_String("Saving PWD..."); // Tell user we are sending password to Control
-                        
-                        // 2. Send password to Control ECU for EEPROM storage
-                        SendPasswordToControl(pass, "SETPWD");
-                        
-                        // 3. Wait for confirmation from Control ECU
-                        char* control_response = ReceiveResponseFromControl();
-                        
-                        if(strcmp(control_response, "PWD_SAVED") == 0) {
-                            // SUCCESS: Password saved in EEPROM
-                            LCD_Clear();
-                            LCD_String("Password Created!");
-                            DIO_WritePin(PORTF, PIN3, HIGH); // Green LED - success
-                            delayMs(2000);
-                            DIO_WritePin(PORTF, PIN3, LOW);
+// Feeds keys, timers, link changes and the periodic tick into the state machine
+void AppTask(const Sched_Event *event)
+{
+    Hmi_Event hmi_event;
 
-                            password_created = true; // Mark password as created
-                            
-                            // Go to Main Menu
-                            state = STATE_MAIN_MENU;
-                            LCD_Clear();
-                            LCD_SetCursor(1, 0);
-                            LCD_String("Menu>A:Opn B:PWD"); 
-                            LCD_SetCursor(2, 0);
-                            LCD_String(" C:TMO  D:Reset");      
-                        } 
-                        else if(strcmp(control_response, "TIMEOUT") == 0) {
-                            // TIMEOUT: No response from Control ECU
-                            LCD_Clear();
-                            LCD_String("No Response"); 
-                            LCD_SetCursor(2, 0);
-                            LCD_String("from Control");
-                            delayMs(2000);
-                            
-                            // Restart password creation
-                            state = STATE_CREATE_PASS;
-                            LCD_Clear();
-                            LCD_String("CreatePass:");
-                        }
-                        else {
-                            // ERROR: Password not saved or unexpected response
-                            LCD_Clear();
-                            LCD_String("Error Saving PWD"); 
-                            delayMs(2000);
-                            
-                            // Restart password creation
-                            state = STATE_CREATE_PASS;
-                            LCD_Clear();
-                            LCD_String("CreatePass:");
-                        }
-                    } 
-                    else 
-                    {
-                        LCD_String("Mismatch! Retry"); // Local typing didn't match
-                        delayMs(2000); 
-                        
-                        state = STATE_CREATE_PASS;
-                        LCD_Clear();
-                        LCD_String("CreatePass:");
-                    }
-                }
-            }
-            // C. Handle '*' (Clear/Cancel)
-            else if(key == '*')
-            {
-                index = 0; 
-                LCD_Clear();
-                if (state == STATE_CREATE_PASS) {
-                     LCD_String("CreatePass:");
-                } else if (state == STATE_CONFIRM_PASS) {
-                     LCD_String("Confirm:");
-                }
-            }
+    switch(event->code) {
+    case APP_EVENT_KEY:
+        Hmi_Fsm_HandleKey(&fsm, (char)event->param);
+        break;
+    case APP_EVENT_TIMER:
+        if(event->param != app_timer || (int32_t)(SysTick_GetTicks() - app_timer_due) < 0) {
+            break;                  // A replaced timer, or its handle reused by a later one
         }
+        app_timer = SCHED_INVALID;
+        hmi_event.id = HMI_EV_TIMER;
+        hmi_event.key = 0;
+        hmi_event.value = app_timer_tag;
+        hmi_event.seq = 0;
+        hmi_event.text = 0;
+        Hmi_Fsm_Dispatch(&fsm, &hmi_event);
+        break;
+    case APP_EVENT_LINK:
+        hmi_event.id = (uint8_t)event->param;
+        hmi_event.key = 0;
+        hmi_event.value = 0;
+        hmi_event.seq = 0;
+        hmi_event.text = 0;
+        Hmi_Fsm_Dispatch(&fsm, &hmi_event);
+        break;
+    default: // SCHED_EVENT_PERIODIC
+        hmi_event.id = HMI_EV_TICK;
+        hmi_event.key = 0;
+        hmi_event.value = 0;
+        hmi_event.seq = 0;
+        hmi_event.text = 0;
+        Hmi_Fsm_Dispatch(&fsm, &hmi_event);
+        break;
     }
-}
\ No newline at end of file
+}
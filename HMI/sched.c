@@ -0,0 +1,365 @@
+/*****************************************************************************
+ * File: sched.c
+ * Module: SCHED
+ * Description: Source file for the cooperative run-to-completion scheduler
+ *****************************************************************************/
+
+#include "sched.h"
+#include "systick.h"
+#include <stdint.h>
+#include <intrinsics.h>
+
+/******************************************************************************
+ *                              Macros                                         *
+ ******************************************************************************/
+
+/* Queues are shared with interrupt handlers: mask interrupts around them */
+#define SCHED_ENTER_CRITICAL()  uint32_t primask = __get_PRIMASK(); __disable_interrupt()
+#define SCHED_EXIT_CRITICAL()   __set_PRIMASK(primask)
+
+/******************************************************************************
+ *                              Types                                          *
+ ******************************************************************************/
+
+typedef struct
+{
+    Sched_TaskFn fn;
+    uint8_t  priority;
+    uint32_t period_ms;
+    uint32_t release;                       /* Tick of the last periodic release */
+    Sched_Event queue[SCHED_QUEUE_DEPTH];
+    uint8_t  head;
+    uint8_t  count;
+    Sched_TaskStats stats;
+} Sched_Task;
+
+typedef struct
+{
+    uint8_t  active;
+    uint8_t  task;
+    uint8_t  code;
+    uint32_t due;
+    uint32_t period_ms;
+} Sched_Timer;
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static Sched_Task tasks[SCHED_MAX_TASKS];
+static uint8_t order[SCHED_MAX_TASKS];      /* Task handles sorted by priority */
+static uint8_t task_count = 0;
+static Sched_Timer timers[SCHED_MAX_TIMERS];
+static uint32_t idle_us = 0;
+static volatile uint8_t running = SCHED_INVALID;    /* Task in its slice */
+static volatile uint32_t running_since = 0;         /* SysTick_GetMicros() at its pass start */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * PopEvent
+ * Takes the oldest queued event. Returns 1 if there was one.
+ */
+static uint8_t PopEvent(Sched_Task *task, Sched_Event *event)
+{
+    uint8_t found = 0;
+    SCHED_ENTER_CRITICAL();
+
+    if(task->count != 0U)
+    {
+        *event = task->queue[task->head];
+        task->head = (uint8_t)((task->head + 1U) % SCHED_QUEUE_DEPTH);
+        task->count--;
+        found = 1;
+    }
+
+    SCHED_EXIT_CRITICAL();
+    return found;
+}
+
+/*
+ * PeriodDue
+ * Checks and consumes one periodic release. A task that fell more than a
+ * period behind is re-phased instead of running back-to-back to catch up.
+ */
+static uint8_t PeriodDue(Sched_Task *task, uint32_t now)
+{
+    uint32_t late;
+
+    if(task->period_ms == 0U)
+    {
+        return 0;
+    }
+
+    late = now - task->release;
+    if(late < task->period_ms)
+    {
+        return 0;
+    }
+
+    task->release = (late >= (2U * task->period_ms)) ? now : (task->release + task->period_ms);
+    return 1;
+}
+
+/*
+ * FireTimers
+ * Posts the event of every expired timer and re-arms periodic ones.
+ */
+static void FireTimers(uint32_t now)
+{
+    uint8_t i;
+
+    for(i = 0; i < SCHED_MAX_TIMERS; i++)
+    {
+        Sched_Timer *timer = &timers[i];
+
+        if(timer->active != 0U && (int32_t)(now - timer->due) >= 0)
+        {
+            Sched_Post(timer->task, timer->code, i);
+
+            if(timer->period_ms != 0U)
+            {
+                timer->due += timer->period_ms;
+            }
+            else
+            {
+                timer->active = 0;
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Sched_Init
+ * Clears all tasks, queues and timers.
+ */
+void Sched_Init(void)
+{
+    uint8_t i;
+
+    task_count = 0;
+    idle_us = 0;
+    running = SCHED_INVALID;
+    for(i = 0; i < SCHED_MAX_TIMERS; i++)
+    {
+        timers[i].active = 0;
+    }
+}
+
+/*
+ * Sched_AddTask
+ * Inserts the task into the priority order after tasks of equal priority,
+ * so registration order breaks ties.
+ */
+uint8_t Sched_AddTask(Sched_TaskFn fn, uint8_t priority, uint32_t period_ms)
+{
+    Sched_Task *task;
+    uint8_t handle;
+    uint8_t pos;
+
+    if(task_count >= SCHED_MAX_TASKS || fn == 0)
+    {
+        return SCHED_INVALID;
+    }
+
+    handle = task_count;
+    task = &tasks[handle];
+    task->fn = fn;
+    task->priority = priority;
+    task->period_ms = period_ms;
+    task->release = SysTick_GetTicks();
+    task->head = 0;
+    task->count = 0;
+    task->stats.runs = 0;
+    task->stats.total_us = 0;
+    task->stats.max_us = 0;
+    task->stats.dropped = 0;
+
+    pos = task_count;
+    while(pos > 0U && tasks[order[pos - 1U]].priority > priority)
+    {
+        order[pos] = order[pos - 1U];
+        pos--;
+    }
+    order[pos] = handle;
+    task_count++;
+
+    return handle;
+}
+
+/*
+ * Sched_Post
+ * Appends to the task's queue; a full queue drops the event.
+ */
+uint8_t Sched_Post(uint8_t task, uint8_t code, uint32_t param)
+{
+    Sched_Task *t;
+    uint8_t result = SCHED_ERROR;
+
+    if(task >= task_count)
+    {
+        return SCHED_ERROR;
+    }
+    t = &tasks[task];
+
+    {
+        SCHED_ENTER_CRITICAL();
+
+        if(t->count < SCHED_QUEUE_DEPTH)
+        {
+            Sched_Event *slot = &t->queue[(t->head + t->count) % SCHED_QUEUE_DEPTH];
+            slot->code = code;
+            slot->param = param;
+            t->count++;
+            result = SCHED_SUCCESS;
+        }
+        else
+        {
+            t->stats.dropped++;
+        }
+
+        SCHED_EXIT_CRITICAL();
+    }
+
+    return result;
+}
+
+/*
+ * Sched_StartTimer
+ * Claims a free timer slot.
+ */
+uint8_t Sched_StartTimer(uint8_t task, uint8_t code, uint32_t delay_ms, uint32_t period_ms)
+{
+    uint8_t i;
+
+    for(i = 0; i < SCHED_MAX_TIMERS; i++)
+    {
+        if(timers[i].active == 0U)
+        {
+            timers[i].task = task;
+            timers[i].code = code;
+            timers[i].due = SysTick_GetTicks() + delay_ms;
+            timers[i].period_ms = period_ms;
+            timers[i].active = 1;
+            return i;
+        }
+    }
+    return SCHED_INVALID;
+}
+
+/*
+ * Sched_StopTimer
+ * Cancels a timer.
+ */
+void Sched_StopTimer(uint8_t timer)
+{
+    if(timer < SCHED_MAX_TIMERS)
+    {
+        timers[timer].active = 0;
+    }
+}
+
+/*
+ * Sched_RunOnce
+ * One scheduling pass: timers, then the first ready task in priority order.
+ * Queued events are served before the periodic release of the same task.
+ * A task may run a nested pass; the running marker is restored after it.
+ */
+uint8_t Sched_RunOnce(void)
+{
+    uint32_t start = SysTick_GetMicros();
+    uint32_t now = SysTick_GetTicks();
+    Sched_Event event;
+    uint8_t i;
+
+    FireTimers(now);
+
+    for(i = 0; i < task_count; i++)
+    {
+        Sched_Task *task = &tasks[order[i]];
+        uint8_t ready = PopEvent(task, &event);
+
+        if(ready == 0U && PeriodDue(task, now) != 0U)
+        {
+            event.code = SCHED_EVENT_PERIODIC;
+            event.param = now;
+            ready = 1;
+        }
+
+        if(ready != 0U)
+        {
+            uint32_t elapsed;
+            uint8_t outer = running;
+            uint32_t outer_since = running_since;
+
+            running_since = start;
+            running = order[i];
+            task->fn(&event);
+            running = outer;
+            running_since = outer_since;
+
+            elapsed = SysTick_GetMicros() - start;
+            task->stats.runs++;
+            task->stats.total_us += elapsed;
+            if(elapsed > task->stats.max_us)
+            {
+                task->stats.max_us = elapsed;
+            }
+            return 1;
+        }
+    }
+
+    idle_us += SysTick_GetMicros() - start;
+    return 0;
+}
+
+/*
+ * Sched_Run
+ * Main loop. Spins without WFI.
+ */
+void Sched_Run(void)
+{
+    while(1)
+    {
+        Sched_RunOnce();
+    }
+}
+
+/*
+ * Sched_GetTaskStats
+ * Copies the accounting for one task.
+ */
+void Sched_GetTaskStats(uint8_t task, Sched_TaskStats *stats)
+{
+    if(task < task_count && stats != 0)
+    {
+        *stats = tasks[task].stats;
+    }
+}
+
+/*
+ * Sched_GetIdleUs
+ * Total time spent in idle passes.
+ */
+uint32_t Sched_GetIdleUs(void)
+{
+    return idle_us;
+}
+
+/*
+ * Sched_GetRunning
+ * Reads the marker Sched_RunOnce() keeps around each slice.
+ */
+uint8_t Sched_GetRunning(uint32_t *slice_us)
+{
+    uint8_t task = running;
+
+    *slice_us = (task != SCHED_INVALID) ? (SysTick_GetMicros() - running_since) : 0U;
+    return task;
+}
@@ -0,0 +1,36 @@
+/*****************************************************************************
+ * File: stack.c
+ * Module: STACK
+ * Description: Source file for the main stack's high-water mark
+ *****************************************************************************/
+
+#include "stack.h"
+#include <stdint.h>
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Stack_GetUsed
+ * The stack grows down from the end of pui32Stack, so the paint is
+ * counted from the start; the first word without it ends the scan.
+ */
+uint32_t Stack_GetUsed(void)
+{
+    uint32_t i = 0;
+
+    while(i < STACK_WORDS && pui32Stack[i] == STACK_PAINT)
+    {
+        i++;
+    }
+    return (STACK_WORDS - i) * 4U;
+}
+
+/*
+ * Stack_GetSize
+ */
+uint32_t Stack_GetSize(void)
+{
+    return STACK_WORDS * 4U;
+}
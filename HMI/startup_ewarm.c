@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include "inc/hw_nvic.h"
 #include "inc/hw_types.h"
+#include "stack.h"
 
 //*****************************************************************************
 //
@@ -44,6 +45,13 @@ static void NmiSR(void);
 static void FaultISR(void);
 static void IntDefaultHandler(void);
 extern void SystickHandler(void);
+extern void UART2_Handler(void);
+extern void GPIOPortA_Handler(void);
+extern void GPIOPortB_Handler(void);
+extern void GPIOPortC_Handler(void);
+extern void GPIOPortD_Handler(void);
+extern void GPIOPortE_Handler(void);
+extern void GPIOPortF_Handler(void);
 
 //*****************************************************************************
 //
@@ -54,10 +62,11 @@ extern void __iar_program_start(void);
 
 //*****************************************************************************
 //
-// Reserve space for the system stack.
+// Reserve space for the system stack.  Its size and the high-water mark
+// painted into it are in stack.h.
 //
 //*****************************************************************************
-static uint32_t pui32Stack[128] @ ".noinit";
+uint32_t pui32Stack[STACK_WORDS] @ ".noinit";
 
 //*****************************************************************************
 //
@@ -98,11 +107,11 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
     0,                                      // Reserved
     IntDefaultHandler,                      // The PendSV handler
     SystickHandler,			      // The SysTick handler
-    IntDefaultHandler,                      // GPIO Port A
-    IntDefaultHandler,                      // GPIO Port B
-    IntDefaultHandler,                      // GPIO Port C
-    IntDefaultHandler,                      // GPIO Port D
-    IntDefaultHandler,                      // GPIO Port E
+    GPIOPortA_Handler,                    // GPIO Port A
+    GPIOPortB_Handler,                    // GPIO Port B
+    GPIOPortC_Handler,                    // GPIO Port C
+    GPIOPortD_Handler,                    // GPIO Port D
+    GPIOPortE_Handler,                    // GPIO Port E
     IntDefaultHandler,                      // UART0 Rx and Tx
     IntDefaultHandler,                      // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
@@ -128,10 +137,10 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
     IntDefaultHandler,                      // Analog Comparator 2
     IntDefaultHandler,                      // System Control (PLL, OSC, BO)
     IntDefaultHandler,                      // FLASH Control
-    IntDefaultHandler,                      // GPIO Port F
+    GPIOPortF_Handler,                    // GPIO Port F
     IntDefaultHandler,                      // GPIO Port G
     IntDefaultHandler,                      // GPIO Port H
-    IntDefaultHandler,                      // UART2 Rx and Tx
+    UART2_Handler,                          // UART2 Rx and Tx
     IntDefaultHandler,                      // SSI1 Rx and Tx
     IntDefaultHandler,                      // Timer 3 subtimer A
     IntDefaultHandler,                      // Timer 3 subtimer B
@@ -252,6 +261,8 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
 void
 ResetISR(void)
 {
+    uint32_t *pui32Word;
+
     //
     // Enable the floating-point unit.  This must be done here to handle the
     // case where main() uses floating-point and the function prologue saves
@@ -266,6 +277,16 @@ ResetISR(void)
                          ~(NVIC_CPAC_CP10_M | NVIC_CPAC_CP11_M)) |
                         NVIC_CPAC_CP10_FULL | NVIC_CPAC_CP11_FULL);
 
+    //
+    // Paint the stack for Stack_GetUsed(), up to this function's own frame
+    // at the top.
+    //
+    for(pui32Word = pui32Stack;
+        pui32Word < &pui32Stack[STACK_WORDS - STACK_PAINT_SKIP]; pui32Word++)
+    {
+        *pui32Word = STACK_PAINT;
+    }
+
     //
     // Call the application's entry point.
     //
@@ -37,13 +37,36 @@ void DelayMs(uint32_t ms)
             NVIC_ST_CURRENT_R = 0;
         }
     }
+    else
+    {
+        // INTERRUPT MODE - wait on the tick counter, SysTick keeps running
+        uint32_t start = msTicks;
+        while ((msTicks - start) < ms);
+    }
+}
+
+uint32_t SysTick_GetTicks(void)
+{
+    return msTicks;
+}
+
+uint32_t SysTick_GetMicros(void)
+{
+    uint32_t ms;
+    uint32_t current;
+
+    // Re-read if the tick interrupt landed between the two reads
+    do
+    {
+        ms = msTicks;
+        current = NVIC_ST_CURRENT_R;
+    } while (ms != msTicks);
+
+    return (ms * 1000U) + ((SYSTICK_RELOAD_1MS - 1U - current) / SYSTICK_CYCLES_PER_US);
 }
 
-/* SysTick Interrupt Handler */
+/* SysTick Interrupt Handler: 1 ms system tick */
 void SystickHandler(void)
 {
-    /* Toggle Green LED every SysTick interrupt */
-    DIO_TogglePin(PORTF, PIN3);
-    DIO_TogglePin(PORTF, PIN3);
-    DIO_TogglePin(PORTF, PIN3);
+    msTicks++;
 }
@@ -6,7 +6,19 @@
 #define SYSTICK_NOINT   0
 #define SYSTICK_INT     1
 
+#define SYSTEM_CLOCK_HZ         16000000U                   // PIOSC, PLL not enabled
+#define SYSTICK_RELOAD_1MS      (SYSTEM_CLOCK_HZ / 1000U)
+#define SYSTICK_CYCLES_PER_US   (SYSTEM_CLOCK_HZ / 1000000U)
+
 void SysTick_Init(uint32_t reload, uint8_t mode);
 void DelayMs(uint32_t ms);
 
+// Milliseconds since SysTick_Init(SYSTICK_RELOAD_1MS, SYSTICK_INT).
+// Wraps after ~49 days; compare with (now - start) arithmetic only.
+uint32_t SysTick_GetTicks(void);
+
+// Microseconds on the same clock (tick * 1000 + SysTick position), for
+// measuring short intervals. Wraps after ~71 minutes.
+uint32_t SysTick_GetMicros(void);
+
 #endif
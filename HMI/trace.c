@@ -0,0 +1,234 @@
+/*****************************************************************************
+ * File: trace.c
+ * Module: TRACE
+ * Description: Source file for the inter-ECU link trace
+ *
+ * Recording costs one timestamp and an 8-byte store per character, inside
+ * a short critical section because both UART2_Handler and task code call
+ * it. UART0 is touched only here and only by Trace_Service.
+ *****************************************************************************/
+
+#include "trace.h"
+
+#if TRACE_ENABLE
+
+#include "dio.h"
+#include "fmt.h"
+#include "systick.h"
+#include "tm4c123gh6pm.h"
+#include <intrinsics.h>
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define TRACE_MASK              (TRACE_ENTRIES - 1U)
+#define TRACE_UART0_PINS        0x03U           /* PA0 RX, PA1 TX */
+#define TRACE_UART0_PCTL        0x00000011U
+#define TRACE_UART0_IBRD        8U              /* 115200 from 16 MHz: 8 + 44/64 */
+#define TRACE_UART0_FBRD        44U
+#define TRACE_LINE_SIZE         40U             /* "TRACE <name> <n> <n>" with a short name */
+
+#define TRACE_ENTER_CRITICAL()  uint32_t primask = __get_PRIMASK(); __disable_interrupt()
+#define TRACE_EXIT_CRITICAL()   __set_PRIMASK(primask)
+
+typedef struct
+{
+    uint32_t micros;
+    char     byte;
+    uint8_t  direction;
+} Trace_Entry;
+
+/* Dump progress: header, then one line per entry, then END */
+#define DUMP_IDLE               0U
+#define DUMP_HEADER             1U
+#define DUMP_ENTRIES            2U
+#define DUMP_END                3U
+
+/******************************************************************************
+ *                              Variables                                      *
+ ******************************************************************************/
+
+static Trace_Entry entries[TRACE_ENTRIES];
+static volatile uint32_t head = 0;              /* Total bytes recorded */
+static volatile uint32_t lost = 0;
+static volatile uint8_t paused = 0;             /* A dump is in progress */
+
+static const char *trace_name = "";
+static uint8_t dump_state = DUMP_IDLE;
+static uint32_t dump_next = 0;                  /* Next entry to send */
+static char line[TRACE_LINE_SIZE];
+static uint32_t line_sent = 0;
+static uint32_t line_length = 0;
+
+static const char direction_codes[] = { 'R', 'T', 'E' };
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * FirstEntry
+ * Oldest entry still in the ring.
+ */
+static uint32_t FirstEntry(void)
+{
+    return (head > TRACE_ENTRIES) ? (head - TRACE_ENTRIES) : 0U;
+}
+
+/*
+ * NextLine
+ * Formats the next line of the dump; 0 once it is complete.
+ */
+static uint8_t NextLine(void)
+{
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, line, sizeof(line));
+    switch(dump_state)
+    {
+    case DUMP_HEADER:
+        Fmt_String(&out, "TRACE ");
+        Fmt_String(&out, trace_name);
+        Fmt_Char(&out, ' ');
+        Fmt_Uint(&out, head - FirstEntry());
+        Fmt_Char(&out, ' ');
+        Fmt_Uint(&out, lost);
+        dump_next = FirstEntry();
+        dump_state = (dump_next != head) ? DUMP_ENTRIES : DUMP_END;
+        break;
+
+    case DUMP_ENTRIES:
+    {
+        const Trace_Entry *e = &entries[dump_next & TRACE_MASK];
+
+        Fmt_Uint(&out, e->micros);
+        Fmt_Char(&out, ' ');
+        Fmt_Char(&out, direction_codes[e->direction]);
+        Fmt_Char(&out, ' ');
+        Fmt_Hex(&out, (uint8_t)e->byte, 2U);
+        if(++dump_next == head)
+        {
+            dump_state = DUMP_END;
+        }
+        break;
+    }
+
+    case DUMP_END:
+        Fmt_String(&out, "END");
+        dump_state = DUMP_IDLE;
+        break;
+
+    default:
+        return 0;
+    }
+
+    Fmt_String(&out, "\r\n");
+    line_length = out.length;
+    line_sent = 0;
+    return 1;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Trace_Init
+ * Port A goes through DIO_PORT_REG, as it may be on the AHB aperture.
+ */
+void Trace_Init(const char *name)
+{
+    trace_name = name;
+    head = 0;
+    lost = 0;
+    paused = 0;
+    dump_state = DUMP_IDLE;
+
+    SYSCTL_RCGCUART_R |= SYSCTL_RCGCUART_R0;
+    SYSCTL_RCGCGPIO_R |= (1U << PORTA);
+    while((SYSCTL_PRUART_R & SYSCTL_PRUART_R0) == 0);
+    while((SYSCTL_PRGPIO_R & (1U << PORTA)) == 0);
+
+    DIO_PORT_REG(PORTA, DIO_OFFSET_AFSEL) |= TRACE_UART0_PINS;
+    DIO_PORT_REG(PORTA, DIO_OFFSET_PCTL) = (DIO_PORT_REG(PORTA, DIO_OFFSET_PCTL) & ~0xFFU) | TRACE_UART0_PCTL;
+    DIO_PORT_REG(PORTA, DIO_OFFSET_DEN) |= TRACE_UART0_PINS;
+    DIO_PORT_REG(PORTA, DIO_OFFSET_AMSEL) &= ~TRACE_UART0_PINS;
+
+    UART0_CTL_R &= ~UART_CTL_UARTEN;
+    UART0_IBRD_R = TRACE_UART0_IBRD;
+    UART0_FBRD_R = TRACE_UART0_FBRD;
+    UART0_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN;
+    UART0_CC_R = 0;
+    UART0_CTL_R |= UART_CTL_RXE | UART_CTL_TXE | UART_CTL_UARTEN;
+}
+
+/*
+ * Trace_Record
+ * Bytes during a dump only count as lost.
+ */
+void Trace_Record(uint8_t direction, char c)
+{
+    uint32_t micros = SysTick_GetMicros();
+    TRACE_ENTER_CRITICAL();
+
+    if(paused != 0U)
+    {
+        lost++;
+    }
+    else
+    {
+        Trace_Entry *e = &entries[head & TRACE_MASK];
+
+        if(head >= TRACE_ENTRIES)
+        {
+            lost++;                     /* Overwrites the oldest */
+        }
+        e->micros = micros;
+        e->byte = c;
+        e->direction = direction;
+        head++;
+    }
+
+    TRACE_EXIT_CRITICAL();
+}
+
+/*
+ * Trace_Service
+ * Requests arriving during a dump are ignored.
+ */
+void Trace_Service(void)
+{
+    while((UART0_FR_R & UART_FR_RXFE) == 0)
+    {
+        if((char)(UART0_DR_R & 0xFFU) == TRACE_DUMP_REQUEST && paused == 0U)
+        {
+            paused = 1;
+            dump_state = DUMP_HEADER;
+            line_sent = 0;
+            line_length = 0;
+        }
+    }
+
+    if(paused == 0U)
+    {
+        return;
+    }
+
+    while((UART0_FR_R & UART_FR_TXFF) == 0)
+    {
+        if(line_sent == line_length && NextLine() == 0U)
+        {
+            TRACE_ENTER_CRITICAL();
+            head = 0;                   /* Next dump starts a new capture */
+            lost = 0;
+            paused = 0;
+            TRACE_EXIT_CRITICAL();
+            return;
+        }
+        UART0_DR_R = (uint32_t)(uint8_t)line[line_sent++];
+    }
+}
+
+#endif /* TRACE_ENABLE */
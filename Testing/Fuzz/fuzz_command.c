@@ -0,0 +1,236 @@
+/*
+ * fuzz_command.c
+ * Fuzz target for the Control command parser (Control/command.c and
+ * Control/frame.c), built for the host.
+ *
+ *   libFuzzer:  make fuzz_command && ./fuzz_command corpus
+ *   AFL:        make afl_command && afl-fuzz -i corpus -o findings -- ./afl_command
+ *
+ * Input is fed byte by byte through a COMMAND_LINE_SIZE line buffer, as
+ * CommTask does on the target. Each line handed over is checked against:
+ *
+ *   1. Framing: it is exactly one input line, shorter than the buffer,
+ *      terminated and without a NUL; lines are never merged or cut short.
+ *   2. Purity: parsing leaves the line as received and writes nothing
+ *      outside its result (guard words around the Command and the CFG
+ *      request), so it cannot reach stored settings.
+ *   3. Shape: known code, door in range, views inside the line.
+ *   4. Numbers: TIMEOUT/BAUD/HB are valid exactly when the argument is 1..10
+ *      digits that fit in 32 bits, and then carry that value.
+ *   5. CFG: strings terminated and shorter than PASSWORD_MAX_LENGTH.
+ *   6. Work: at most FUZZ_STEP_LIMIT parser loop iterations per line.
+ *
+ * A violation aborts, which both fuzzers report as a crash.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz_command.h"
+#include "command.h"
+#include "door.h"
+
+#define GUARD_WORDS     4
+#define GUARD_VALUE     0xA5A5A5A5UL
+
+#define FUZZ_CHECK(cond)                                                    \
+    do {                                                                    \
+        if(!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: property failed: %s\n",                 \
+                    __FILE__, __LINE__, #cond);                             \
+            abort();                                                        \
+        }                                                                   \
+    } while(0)
+
+typedef struct
+{
+    unsigned long before[GUARD_WORDS];
+    Command       command;
+    unsigned long after[GUARD_WORDS];
+} Guarded_Command;
+
+typedef struct
+{
+    unsigned long  before[GUARD_WORDS];
+    Config_Request request;
+    unsigned long  after[GUARD_WORDS];
+} Guarded_Config;
+
+unsigned long fuzz_steps = 0;
+
+static void Guard(unsigned long *before, unsigned long *after)
+{
+    int i;
+
+    for(i = 0; i < GUARD_WORDS; i++)
+    {
+        before[i] = GUARD_VALUE;
+        after[i] = GUARD_VALUE;
+    }
+}
+
+static int Guarded(const unsigned long *before, const unsigned long *after)
+{
+    int i;
+
+    for(i = 0; i < GUARD_WORDS; i++)
+    {
+        if(before[i] != GUARD_VALUE || after[i] != GUARD_VALUE)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int Inside(Frame_View part, Frame_View line)
+{
+    return part.text >= line.text &&
+           part.text + part.length <= line.text + line.length;
+}
+
+/* Reference for property 4, in 64 bits */
+static int ReferenceNumber(Frame_View digits, uint32_t *value)
+{
+    uint64_t result = 0;
+    uint32_t i;
+
+    if(digits.length == 0U || digits.length > COMMAND_NUMBER_DIGITS)
+    {
+        return 0;
+    }
+    for(i = 0; i < digits.length; i++)
+    {
+        if(digits.text[i] < '0' || digits.text[i] > '9')
+        {
+            return 0;
+        }
+        result = (result * 10U) + (uint64_t)(digits.text[i] - '0');
+    }
+    if(result > UINT32_MAX)
+    {
+        return 0;
+    }
+    *value = (uint32_t)result;
+    return 1;
+}
+
+static void CheckConfig(Frame_View line, Frame_View args)
+{
+    Guarded_Config g;
+    uint8_t ok;
+
+    Guard(g.before, g.after);
+    fuzz_steps = 0;
+    ok = Command_ParseConfig(args, &g.request);
+    FUZZ_CHECK(Guarded(g.before, g.after));
+    FUZZ_CHECK(fuzz_steps <= FUZZ_STEP_LIMIT(line.length));
+    FUZZ_CHECK(memchr(g.request.credential, '\0', PASSWORD_MAX_LENGTH) != NULL);
+    FUZZ_CHECK(memchr(g.request.password, '\0', PASSWORD_MAX_LENGTH) != NULL);
+    if(ok != 0U)
+    {
+        FUZZ_CHECK(g.request.credential[0] != '\0');
+        FUZZ_CHECK(g.request.has_password != 0U || g.request.has_timeout != 0U);
+        FUZZ_CHECK(g.request.has_password == 0U || g.request.password[0] != '\0');
+        FUZZ_CHECK(g.request.timeout <= 99999U);
+    }
+}
+
+static void CheckLine(const uint8_t *segment, size_t size, Frame_View line)
+{
+    char copy[COMMAND_LINE_SIZE];
+    Guarded_Command g;
+    const Command *c = &g.command;
+    uint32_t expected;
+
+    /* 1. Framing */
+    FUZZ_CHECK(size < COMMAND_LINE_SIZE);
+    FUZZ_CHECK(line.length == size && memcmp(line.text, segment, size) == 0);
+    FUZZ_CHECK(line.text[line.length] == '\0');
+    FUZZ_CHECK(memchr(line.text, '\0', line.length) == NULL);
+
+    /* 2, 3, 6 */
+    memcpy(copy, line.text, line.length + 1U);
+    Guard(g.before, g.after);
+    fuzz_steps = 0;
+    Command_Parse(line, &g.command);
+    FUZZ_CHECK(fuzz_steps <= FUZZ_STEP_LIMIT(line.length));
+    FUZZ_CHECK(Guarded(g.before, g.after));
+    FUZZ_CHECK(memcmp(copy, line.text, line.length + 1U) == 0);
+    FUZZ_CHECK(c->code < COMMAND_COUNT);
+    FUZZ_CHECK(c->door < DOOR_COUNT);
+    FUZZ_CHECK(c->sequence.length == 0U || c->sequence.length == COMMAND_SEQ_LENGTH);
+    FUZZ_CHECK(Inside(c->sequence, line) && Inside(c->argument, line));
+    FUZZ_CHECK(c->argument.text + c->argument.length == line.text + line.length);
+
+    /* 4, 5 */
+    if(c->code == COMMAND_TIMEOUT || c->code == COMMAND_BAUD || c->code == COMMAND_HEARTBEAT)
+    {
+        int reference = ReferenceNumber(c->argument, &expected);
+
+        FUZZ_CHECK((c->valid != 0U) == (reference != 0));
+        FUZZ_CHECK(c->valid == 0U || c->number == expected);
+    }
+    else if(c->code == COMMAND_SET_PASSWORD)
+    {
+        FUZZ_CHECK((c->valid != 0U) == (c->argument.length < PASSWORD_MAX_LENGTH));
+    }
+    else if(c->code == COMMAND_CONFIG)
+    {
+        CheckConfig(line, c->argument);
+    }
+}
+
+uint32_t Fuzz_Input(const uint8_t *data, size_t size)
+{
+    char buffer[COMMAND_LINE_SIZE];
+    Frame_Parser parser;
+    Frame_View line;
+    size_t start = 0;
+    size_t i;
+    uint32_t lines = 0;
+
+    Frame_Init(&parser, buffer, sizeof(buffer));
+    for(i = 0; i < size; i++)
+    {
+        uint8_t complete = Frame_Push(&parser, (char)data[i], &line);
+
+        if(data[i] == (uint8_t)FRAME_END)
+        {
+            const uint8_t *segment = &data[start];
+            size_t length = i - start;
+            int clean = (length < COMMAND_LINE_SIZE && memchr(segment, '\0', length) == NULL);
+
+            FUZZ_CHECK(complete == (clean ? 1U : 0U));
+            if(complete != 0U)
+            {
+                CheckLine(segment, length, line);
+                lines++;
+            }
+            start = i + 1U;
+        }
+        else
+        {
+            FUZZ_CHECK(complete == 0U);
+        }
+    }
+    return lines;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    (void)Fuzz_Input(data, size);
+    return 0;
+}
+
+#ifdef FUZZ_STDIN_MAIN
+/* AFL (and plain reproduction: ./afl_command < crash) */
+int main(void)
+{
+    static uint8_t data[1U << 16];
+    size_t size = fread(data, 1, sizeof(data), stdin);
+
+    (void)Fuzz_Input(data, size);
+    return 0;
+}
+#endif
@@ -0,0 +1,22 @@
+/*
+ * fuzz_command.h
+ * Shared by the fuzz targets and the property tests.
+ */
+#ifndef FUZZ_COMMAND_H_
+#define FUZZ_COMMAND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Parser loop iterations allowed for one line of the given length */
+#define FUZZ_STEP_LIMIT(length)     (32UL + 2UL * (unsigned long)(length))
+
+/*
+ * Fuzz_Input
+ * Feeds bytes to a Frame_Parser the way CommTask does and checks every
+ * line handed over against the parser properties; aborts on a violation.
+ * Returns: the number of lines handed over
+ */
+uint32_t Fuzz_Input(const uint8_t *data, size_t size);
+
+#endif /* FUZZ_COMMAND_H_ */
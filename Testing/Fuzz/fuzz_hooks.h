@@ -0,0 +1,13 @@
+/*
+ * fuzz_hooks.h
+ * Forced into every host build (-include) so the parser counts its own
+ * loop iterations for the bounded-work property.
+ */
+#ifndef FUZZ_HOOKS_H_
+#define FUZZ_HOOKS_H_
+
+extern unsigned long fuzz_steps;
+
+#define COMMAND_STEP()  (fuzz_steps++)
+
+#endif /* FUZZ_HOOKS_H_ */
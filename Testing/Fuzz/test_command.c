@@ -0,0 +1,219 @@
+/*
+ * test_command.c
+ * Property tests for the Control command parser, run on the host:
+ *
+ *   make test
+ *
+ * Every seed corpus file given on the command line, a set of known edge
+ * cases and a stream of generated inputs go through Fuzz_Input, which
+ * aborts on any property violation (see fuzz_command.c). The edge cases
+ * also check the parse results themselves.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz_command.h"
+#include "command.h"
+
+#define GENERATED_INPUTS    200000UL
+#define GENERATED_TOKENS    12U
+
+static int failures = 0;
+
+static void Log_Result(const char *test_name, int status)
+{
+    printf("%s %s\n", status ? "[PASS]" : "[FAIL]", test_name);
+    if(!status)
+    {
+        failures++;
+    }
+}
+
+static Command Parse(const char *text)
+{
+    Frame_View line;
+    Command command;
+
+    line.text = text;
+    line.length = (uint32_t)strlen(text);
+    Command_Parse(line, &command);
+    return command;
+}
+
+/* TEST A: SEED CORPUS (lines captured from the HMI) */
+static int Test_Corpus(int argc, char **argv)
+{
+    static uint8_t data[1U << 16];
+    uint32_t lines = 0;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        FILE *f = fopen(argv[i], "rb");
+        size_t size;
+
+        if(f == NULL)
+        {
+            return 0;
+        }
+        size = fread(data, 1, sizeof(data), f);
+        fclose(f);
+        lines += Fuzz_Input(data, size);
+    }
+    return (argc < 2) || (lines > 0U);
+}
+
+/* TEST B: NUMBERS (no digits, overflow, trailing text) */
+static int Test_Numbers(void)
+{
+    int ok = 1;
+    Command c;
+
+    c = Parse("TIMEOUT:");
+    ok &= (c.code == COMMAND_TIMEOUT && c.valid == 0U);
+    c = Parse("TIMEOUT:30");
+    ok &= (c.valid == 1U && c.number == 30U);
+    c = Parse("D2/TIMEOUT:4294967295");
+    ok &= (c.valid == 1U && c.number == 4294967295UL && c.door == 1U);
+    c = Parse("TIMEOUT:4294967296");
+    ok &= (c.valid == 0U);
+    c = Parse("TIMEOUT:99999999999999999999");
+    ok &= (c.valid == 0U);
+    c = Parse("TIMEOUT:12abc");
+    ok &= (c.valid == 0U);
+    c = Parse("BAUD:921600");
+    ok &= (c.code == COMMAND_BAUD && c.valid == 1U && c.number == 921600U);
+    c = Parse("BAUD:COMMIT");
+    ok &= (c.code == COMMAND_BAUD_COMMIT);
+    c = Parse("@05 HB:86400000");
+    ok &= (c.code == COMMAND_HEARTBEAT && c.valid == 1U && c.number == 86400000UL);
+    c = Parse("STATS?");
+    ok &= (c.code == COMMAND_STATS && c.valid == 1U && c.argument.length == 0U);
+    c = Parse("STATS?12");
+    ok &= (c.code == COMMAND_STATS && c.valid == 1U && c.number == 12U);
+    c = Parse("STATS?x");
+    ok &= (c.code == COMMAND_STATS && c.valid == 0U);
+    return ok;
+}
+
+/* TEST C: PREFIXES AND NAMES */
+static int Test_Prefixes(void)
+{
+    int ok = 1;
+    Command c;
+
+    c = Parse("@1F D1/VERIFY:1234");
+    ok &= (c.code == COMMAND_VERIFY && c.sequence.length == 4U && c.door == 0U);
+    ok &= (c.argument.length == 4U && memcmp(c.argument.text, "1234", 4) == 0);
+    c = Parse("VERIFYPWD:1234");
+    ok &= (c.code == COMMAND_VERIFY_SETTINGS);
+    c = Parse("D9/HOLD");
+    ok &= (c.code == COMMAND_BAD_DOOR);
+    c = Parse("@01 ");
+    ok &= (c.code == COMMAND_NONE && c.sequence.length == 4U);
+    c = Parse("HOLDX");
+    ok &= (c.code == COMMAND_UNKNOWN);
+    c = Parse("L");
+    ok &= (c.code == COMMAND_ALARM);
+    c = Parse("SETPWD:1234567890123456789");
+    ok &= (c.code == COMMAND_SET_PASSWORD && c.valid == 1U);
+    c = Parse("SETPWD:12345678901234567890");
+    ok &= (c.valid == 0U);
+    return ok;
+}
+
+/* TEST D: CFG FIELDS */
+static int Test_Config(void)
+{
+    Config_Request request;
+    Command c;
+    int ok = 1;
+
+    c = Parse("CFG:1234;PWD=5678;TMO=45");
+    ok &= (Command_ParseConfig(c.argument, &request) == 1U);
+    ok &= (strcmp(request.credential, "1234") == 0 && strcmp(request.password, "5678") == 0);
+    ok &= (request.has_timeout == 1U && request.timeout == 45U);
+    c = Parse("CFG:1234;TMO=");
+    ok &= (Command_ParseConfig(c.argument, &request) == 0U);
+    c = Parse("CFG:1234;TMO=123456");
+    ok &= (Command_ParseConfig(c.argument, &request) == 0U);
+    c = Parse("CFG:1234;TMO=1;TMO=2");
+    ok &= (Command_ParseConfig(c.argument, &request) == 0U);
+    c = Parse("CFG:1234;");
+    ok &= (Command_ParseConfig(c.argument, &request) == 0U);
+    c = Parse("CFG:1234");
+    ok &= (Command_ParseConfig(c.argument, &request) == 0U);
+    return ok;
+}
+
+/* TEST E: OVERLONG AND NUL LINES ARE DROPPED, NEVER MERGED */
+static int Test_Framing(void)
+{
+    static const char overlong[] =
+        "VERIFY:12345678901234567890123456789012345678901234567890HOLD\nHOLD\n";
+    static const char nul[] = "VERIFY:12\0" "34\nHOLD\n";
+
+    return Fuzz_Input((const uint8_t *)overlong, sizeof(overlong) - 1U) == 1U &&
+           Fuzz_Input((const uint8_t *)nul, sizeof(nul) - 1U) == 1U;
+}
+
+/* TEST F: GENERATED INPUT (command fragments, digits, separators, noise) */
+static uint32_t rng = 0x12345678UL;
+static uint32_t Next(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+static int Test_Generated(void)
+{
+    static const char *const tokens[] =
+    {
+        "@07 ", "D1/", "D4/", "D0/", "L", "SETPWD:", "TIMEOUT:", "VERIFYPWD:", "VERIFY:",
+        "CLOSE", "HOLD", "AUDIT?", "CFG:", ";PWD=", ";TMO=", ";", "BAUD:", "BAUD:COMMIT",
+        "PING:", "HB:", "STATS?", "4294967295", "4294967296", "0", "12345", "\n", "\n", "@"
+    };
+    uint8_t data[256];
+    unsigned long n;
+
+    for(n = 0; n < GENERATED_INPUTS; n++)
+    {
+        size_t size = 0;
+        uint32_t t;
+
+        for(t = 0; t < GENERATED_TOKENS; t++)
+        {
+            uint32_t r = Next();
+
+            if((r & 7U) == 0U)
+            {
+                data[size++] = (uint8_t)(r >> 8);           /* Any byte */
+            }
+            else
+            {
+                const char *token = tokens[(r >> 3) % (sizeof(tokens) / sizeof(tokens[0]))];
+                size_t length = strlen(token);
+
+                memcpy(&data[size], token, length);
+                size += length;
+            }
+        }
+        (void)Fuzz_Input(data, size);
+    }
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    printf("=== CONTROL COMMAND PARSER PROPERTY TESTS ===\n");
+    Log_Result("1. Seed Corpus", Test_Corpus(argc, argv));
+    Log_Result("2. Numbers (empty / overflow)", Test_Numbers());
+    Log_Result("3. Prefixes and Names", Test_Prefixes());
+    Log_Result("4. CFG Fields", Test_Config());
+    Log_Result("5. Overlong / NUL Lines", Test_Framing());
+    Log_Result("6. Generated Input", Test_Generated());
+    printf("--- TESTS COMPLETE ---\n");
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,674 @@
+/*
+ * host.c
+ * Catches the target code's register accesses and runs its interrupts.
+ *
+ * The peripheral ranges are mapped with no access rights, so every
+ * register access faults. The plain 32-bit moves compiled code uses for
+ * volatile registers are carried out by the fault handler itself. For any
+ * other instruction it opens the page, puts the value the peripheral model
+ * gives for the register there, and single-steps the instruction (x86 trap
+ * flag); the trap after it hands any value written back to the model and
+ * closes the page again. Bit-band alias accesses are turned into accesses
+ * of their bit.
+ *
+ * Interrupts are taken at the end of a register access, on a clock update
+ * (SIGALRM every HOST_TICK_US) or when __set_PRIMASK() re-enables them.
+ * From a signal the interrupted context is redirected to Host_IrqEntry,
+ * which saves every register the handlers may change, as the exception
+ * entry does. This only happens while the CPU is in the program's own
+ * code (not in the C library), which is built with -mno-red-zone so that
+ * nothing lives below its stack pointer.
+ */
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "host.h"
+#include "host_internal.h"
+#include "stack.h"
+#include "wdt.h"
+
+#define PAGE_SIZE               0x1000UL
+#define TRAP_FLAG               0x100UL         /* EFLAGS.TF */
+#define FAULT_WRITE             0x2UL           /* Page fault error code W/R */
+
+/* Instructions Emulate() carries out */
+#define OP_LOAD                 0x8BU           /* mov r32, [m32] */
+#define OP_STORE                0x89U           /* mov [m32], r32 */
+#define OP_STORE_IMM            0xC7U           /* mov [m32], imm32 */
+
+#define PERIPH_BASE             0x40000000UL
+#define BITBAND_BASE            0x42000000UL
+#define BITBAND_SIZE            0x02000000UL
+
+typedef struct
+{
+    uintptr_t base;
+    size_t    size;
+} Region;
+
+static const Region regions[] =
+{
+    { PERIPH_BASE,  0x00100000UL },     /* APB and AHB peripherals, system control */
+    { BITBAND_BASE, BITBAND_SIZE },     /* Their bit-band alias */
+    { 0xE0001000UL, PAGE_SIZE },        /* DWT */
+    { 0xE000E000UL, PAGE_SIZE }         /* SysTick, NVIC, SCB */
+};
+
+/* The access being single-stepped */
+static struct
+{
+    uintptr_t page;
+    volatile uint32_t *word;
+    uint32_t before;
+    int write;
+    volatile int active;
+} step;
+
+volatile uint32_t host_primask = 0;
+static volatile int in_irq = 0;
+static int started = 0;
+static uint64_t start_ns;
+static uint64_t scale = HOST_TIME_SCALE;
+static sigset_t tick_signal;
+
+extern char __executable_start[];
+extern char etext[];
+
+/* The handlers of startup_ewarm.c; weak, as each image has its own set */
+extern void SystickHandler(void) __attribute__((weak));
+extern void GPIOPortA_Handler(void) __attribute__((weak));
+extern void GPIOPortB_Handler(void) __attribute__((weak));
+extern void GPIOPortC_Handler(void) __attribute__((weak));
+extern void GPIOPortD_Handler(void) __attribute__((weak));
+extern void GPIOPortE_Handler(void) __attribute__((weak));
+extern void GPIOPortF_Handler(void) __attribute__((weak));
+extern void Timer1A_Handler(void) __attribute__((weak));
+extern void UART2_Handler(void) __attribute__((weak));
+
+static void (*vectors[HOST_VECTOR_COUNT])(void);
+
+/* startup_ewarm.c's stack. The programs here run on their own stack, so it
+   is never painted: Stack_GetUsed() reports all of it */
+uint32_t pui32Stack[STACK_WORDS];
+
+/* Control's startup_ewarm.c watchdog record. It starts zeroed here, so no
+   boot finds a watchdog reset */
+Wdt_Record wdt_record;
+
+/* ModRM register numbers (with REX.R/B) -> gregs[] */
+static const int gregs_index[16] =
+{
+    REG_RAX, REG_RCX, REG_RDX, REG_RBX, REG_RSP, REG_RBP, REG_RSI, REG_RDI,
+    REG_R8,  REG_R9,  REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15
+};
+
+void Host_IrqEntry(void);
+void Host_RunIrqs(void);
+
+/* Saves what a C function may change (the exception entry stacks the same
+   for the Cortex-M), runs the handlers, returns to the interrupted code */
+__asm__(
+    "    .text\n"
+    "    .globl Host_IrqEntry\n"
+    "Host_IrqEntry:\n"
+    "    pushfq\n"
+    "    cld\n"
+    "    push %rax\n"
+    "    push %rcx\n"
+    "    push %rdx\n"
+    "    push %rsi\n"
+    "    push %rdi\n"
+    "    push %r8\n"
+    "    push %r9\n"
+    "    push %r10\n"
+    "    push %r11\n"
+    "    push %rbx\n"
+    "    mov %rsp, %rbx\n"
+    "    and $-16, %rsp\n"
+    "    sub $512, %rsp\n"
+    "    fxsave (%rsp)\n"
+    "    call Host_RunIrqs\n"
+    "    fxrstor (%rsp)\n"
+    "    mov %rbx, %rsp\n"
+    "    pop %rbx\n"
+    "    pop %r11\n"
+    "    pop %r10\n"
+    "    pop %r9\n"
+    "    pop %r8\n"
+    "    pop %rdi\n"
+    "    pop %rsi\n"
+    "    pop %rdx\n"
+    "    pop %rcx\n"
+    "    pop %rax\n"
+    "    popfq\n"
+    "    ret\n");
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint64_t Nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+/*
+ * SetScale
+ * Changes the clock rate from now on, without a jump in simulated time.
+ */
+static void SetScale(uint64_t new_scale)
+{
+    sigset_t saved;
+    uint64_t now;
+
+    sigprocmask(SIG_BLOCK, &tick_signal, &saved);
+    now = Nanoseconds();
+    start_ns = now - (((now - start_ns) * scale) / new_scale);
+    scale = new_scale;
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+}
+
+static void Fatal(const char *what, uintptr_t address, uintptr_t pc)
+{
+    char text[160];
+    int length = snprintf(text, sizeof(text), "host: %s at 0x%08lx (pc %p)\n",
+                          what, (unsigned long)address, (void *)pc);
+
+    (void)write(2, text, (size_t)length);
+    signal(SIGABRT, SIG_DFL);
+    abort();
+}
+
+static int InRegion(uintptr_t address)
+{
+    size_t i;
+
+    for(i = 0; i < sizeof(regions) / sizeof(regions[0]); i++)
+    {
+        if(address >= regions[i].base && address < regions[i].base + regions[i].size)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Bit-band alias word -> peripheral word and bit */
+static int BitBand(uintptr_t address, uint32_t *word, uint32_t *bit)
+{
+    uint32_t offset;
+
+    if(address < BITBAND_BASE || address >= BITBAND_BASE + BITBAND_SIZE)
+    {
+        return 0;
+    }
+    offset = (uint32_t)(address - BITBAND_BASE);
+    *word = (uint32_t)PERIPH_BASE + ((offset >> 5) & ~3U);
+    *bit = (((offset >> 5) & 3U) * 8U) + ((offset >> 2) & 7U);
+    return 1;
+}
+
+static uint32_t AccessRead(uintptr_t address, int write)
+{
+    uint32_t word;
+    uint32_t bit;
+
+    if(BitBand(address, &word, &bit))
+    {
+        return (Periph_Peek(word) >> bit) & 1U;
+    }
+    return write ? Periph_Peek((uint32_t)address) : Periph_Read((uint32_t)address);
+}
+
+static void AccessWrite(uintptr_t address, uint32_t value)
+{
+    uint32_t word;
+    uint32_t bit;
+
+    if(BitBand(address, &word, &bit))
+    {
+        uint32_t current = Periph_Peek(word);
+
+        Periph_Write(word, (value & 1U) ? (current | (1U << bit)) : (current & ~(1U << bit)));
+        return;
+    }
+    Periph_Write((uint32_t)address, value);
+}
+
+/* mov between a register (or immediate) and a 32-bit word, addressed
+   through a base register plus displacement; 0 if it is anything else */
+static int Emulate(ucontext_t *context, uintptr_t address)
+{
+    greg_t *regs = context->uc_mcontext.gregs;
+    const uint8_t *code = (const uint8_t *)regs[REG_RIP];
+    uint32_t length = 0;
+    uint8_t rex = 0;
+    uint8_t opcode;
+    uint8_t modrm;
+    uint32_t reg;
+
+    if((address & 3U) != 0U)
+    {
+        return 0;
+    }
+    if((code[0] & 0xF0U) == 0x40U)
+    {
+        rex = code[length++];
+        if((rex & 0x08U) != 0U)
+        {
+            return 0;               /* REX.W: 64-bit operand */
+        }
+    }
+    opcode = code[length++];
+    modrm = code[length++];
+    reg = ((modrm >> 3) & 7U) | ((rex & 0x04U) ? 8U : 0U);
+    if((modrm & 7U) == 4U || (modrm >> 6) == 3U || (modrm & 0xC7U) == 0x05U)
+    {
+        return 0;                   /* SIB byte, register operand, RIP-relative */
+    }
+    length += ((modrm >> 6) == 1U) ? 1U : (((modrm >> 6) == 2U) ? 4U : 0U);
+
+    switch(opcode)
+    {
+    case OP_LOAD:
+        regs[gregs_index[reg]] = (greg_t)AccessRead(address, 0);
+        break;
+    case OP_STORE:
+        AccessWrite(address, (uint32_t)regs[gregs_index[reg]]);
+        break;
+    case OP_STORE_IMM:
+        if((reg & 7U) != 0U)
+        {
+            return 0;
+        }
+        AccessWrite(address, (uint32_t)code[length] | ((uint32_t)code[length + 1U] << 8) |
+                             ((uint32_t)code[length + 2U] << 16) | ((uint32_t)code[length + 3U] << 24));
+        length += 4U;
+        break;
+    default:
+        return 0;
+    }
+    regs[REG_RIP] += (greg_t)length;
+    return 1;
+}
+
+/* Enters Host_IrqEntry from a signal when an interrupt can be taken */
+static void Interrupt(ucontext_t *context)
+{
+    greg_t *regs = context->uc_mcontext.gregs;
+    uintptr_t pc = (uintptr_t)regs[REG_RIP];
+
+    if(host_primask != 0U || in_irq || Periph_NextVector() == HOST_VECTOR_NONE)
+    {
+        return;
+    }
+    if(pc < (uintptr_t)__executable_start || pc >= (uintptr_t)etext)
+    {
+        return;                 /* In the C library: the next tick tries again */
+    }
+    in_irq = 1;
+    regs[REG_RSP] -= (greg_t)sizeof(greg_t);
+    *(greg_t *)regs[REG_RSP] = regs[REG_RIP];
+    regs[REG_RIP] = (greg_t)(uintptr_t)Host_IrqEntry;
+}
+
+static void OnFault(int signal_number, siginfo_t *info, void *raw)
+{
+    ucontext_t *context = raw;
+    uintptr_t address = (uintptr_t)info->si_addr;
+    uintptr_t pc = (uintptr_t)context->uc_mcontext.gregs[REG_RIP];
+
+    (void)signal_number;
+    if(!InRegion(address))
+    {
+        Fatal("segmentation fault", address, pc);
+    }
+    if(step.active)
+    {
+        Fatal("second register access in one instruction", address, pc);
+    }
+    if(Emulate(context, address))
+    {
+        Interrupt(context);
+        return;
+    }
+
+    step.page = address & ~(PAGE_SIZE - 1U);
+    step.word = (volatile uint32_t *)(address & ~(uintptr_t)3U);
+    step.write = (context->uc_mcontext.gregs[REG_ERR] & FAULT_WRITE) != 0;
+    mprotect((void *)step.page, PAGE_SIZE, PROT_READ | PROT_WRITE);
+    step.before = AccessRead((uintptr_t)step.word, step.write);
+    *step.word = step.before;
+    step.active = 1;
+    context->uc_mcontext.gregs[REG_EFL] |= (greg_t)TRAP_FLAG;
+}
+
+static void OnStep(int signal_number, siginfo_t *info, void *raw)
+{
+    ucontext_t *context = raw;
+    uint32_t after;
+
+    (void)signal_number;
+    (void)info;
+    if(!step.active)
+    {
+        Fatal("unexpected trap", 0, (uintptr_t)context->uc_mcontext.gregs[REG_RIP]);
+    }
+    context->uc_mcontext.gregs[REG_EFL] &= ~(greg_t)TRAP_FLAG;
+    after = *step.word;
+    mprotect((void *)step.page, PAGE_SIZE, PROT_NONE);
+    step.active = 0;
+    if(step.write || after != step.before)
+    {
+        AccessWrite((uintptr_t)step.word, after);
+    }
+    Interrupt(context);
+}
+
+static void OnTick(int signal_number, siginfo_t *info, void *raw)
+{
+    (void)signal_number;
+    (void)info;
+    Periph_Uart2_Poll();
+    Periph_Advance(Host_Cycles());
+    if(!step.active)
+    {
+        Interrupt(raw);
+    }
+}
+
+static void Handle(int signal_number, void (*handler)(int, siginfo_t *, void *), int flags)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = handler;
+    action.sa_flags = SA_SIGINFO | flags;
+    sigemptyset(&action.sa_mask);
+    sigaddset(&action.sa_mask, SIGALRM);
+    sigaction(signal_number, &action, NULL);
+}
+
+static void Vector(int vector, void (*handler)(void))
+{
+    vectors[vector] = handler;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+uint64_t Host_Cycles(void)
+{
+    return ((Nanoseconds() - start_ns) * scale * (HOST_CPU_HZ / 1000000U)) / 1000U;
+}
+
+uint64_t Host_Micros(void)
+{
+    return ((Nanoseconds() - start_ns) * scale) / 1000U;
+}
+
+/*
+ * Host_RunIrqs
+ * Called by Host_IrqEntry (and Host_InterruptsEnabled) with in_irq set;
+ * takes exceptions until none is pending.
+ */
+void Host_RunIrqs(void)
+{
+    for(;;)
+    {
+        sigset_t saved;
+        int vector;
+
+        sigprocmask(SIG_BLOCK, &tick_signal, &saved);
+        vector = Periph_NextVector();
+        if(vector == HOST_VECTOR_NONE)
+        {
+            in_irq = 0;
+            sigprocmask(SIG_SETMASK, &saved, NULL);
+            return;
+        }
+        if(vectors[vector] == 0)
+        {
+            Fatal("no handler for exception", (uintptr_t)vector, 0);
+        }
+        Periph_Take(vector);
+        sigprocmask(SIG_SETMASK, &saved, NULL);
+        vectors[vector]();
+    }
+}
+
+void Host_InterruptsEnabled(void)
+{
+    sigset_t saved;
+
+    sigprocmask(SIG_BLOCK, &tick_signal, &saved);
+    if(in_irq || host_primask != 0U || Periph_NextVector() == HOST_VECTOR_NONE)
+    {
+        sigprocmask(SIG_SETMASK, &saved, NULL);
+        return;
+    }
+    in_irq = 1;
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+    Host_RunIrqs();
+}
+
+void Host_Idle(void)
+{
+    struct timespec pause = { 0, HOST_TICK_US * 1000L };
+
+    nanosleep(&pause, NULL);
+    Host_InterruptsEnabled();
+}
+
+void Host_Delay(uint64_t micros)
+{
+    uint64_t end = Host_Micros() + micros;
+
+    for(;;)
+    {
+        uint64_t now = Host_Micros();
+        struct timespec pause = { 0, 0 };
+
+        if(now >= end)
+        {
+            return;
+        }
+        pause.tv_nsec = (long)(((end - now) * 1000U) / scale);
+        if(pause.tv_nsec > (long)HOST_TICK_US * 1000L)
+        {
+            pause.tv_nsec = (long)HOST_TICK_US * 1000L;
+        }
+        nanosleep(&pause, NULL);
+        Host_InterruptsEnabled();
+    }
+}
+
+/* delayMs() callers in other files (the images link with --wrap=delayMs):
+   the target's calibrated busy loops would not track simulated time */
+void __wrap_delayMs(int ms)
+{
+    Host_Delay((uint64_t)ms * 1000U);
+}
+
+/* The scheduler's main loop (--wrap=Sched_Run), sleeping when a pass finds
+   nothing to do as WFI would: two images on one host CPU would otherwise
+   each hold it for a whole time slice while the other waits for a reply */
+extern uint8_t Sched_RunOnce(void);
+
+void __wrap_Sched_Run(void)
+{
+    for(;;)
+    {
+        if(Sched_RunOnce() == 0U)
+        {
+            Host_Idle();
+        }
+    }
+}
+
+void Host_Init(void)
+{
+    struct itimerval timer;
+    const char *text;
+    size_t i;
+
+    if(started)
+    {
+        return;
+    }
+    started = 1;
+
+    for(i = 0; i < sizeof(regions) / sizeof(regions[0]); i++)
+    {
+        void *at = mmap((void *)regions[i].base, regions[i].size, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+
+        if(at != (void *)regions[i].base)
+        {
+            Fatal("cannot map peripheral range", regions[i].base, 0);
+        }
+    }
+
+    Vector(HOST_VECTOR_SYSTICK, SystickHandler);
+    Vector(HOST_VECTOR_IRQ(0), GPIOPortA_Handler);
+    Vector(HOST_VECTOR_IRQ(1), GPIOPortB_Handler);
+    Vector(HOST_VECTOR_IRQ(2), GPIOPortC_Handler);
+    Vector(HOST_VECTOR_IRQ(3), GPIOPortD_Handler);
+    Vector(HOST_VECTOR_IRQ(4), GPIOPortE_Handler);
+    Vector(HOST_VECTOR_IRQ(21), Timer1A_Handler);
+    Vector(HOST_VECTOR_IRQ(30), GPIOPortF_Handler);
+    Vector(HOST_VECTOR_IRQ(33), UART2_Handler);
+
+    text = getenv("HOST_TIME_SCALE");
+    if(text != NULL && atoi(text) > 0)
+    {
+        scale = (uint64_t)atoi(text);
+    }
+    text = getenv("HOST_UART2_FD");
+    if(text != NULL)
+    {
+        Periph_Uart2_Connect(HOST_LINK_PEER, atoi(text));
+    }
+    else
+    {
+        Periph_Uart2_Connect(HOST_LINK_STDIO, -1);
+    }
+
+    sigemptyset(&tick_signal);
+    sigaddset(&tick_signal, SIGALRM);
+    Handle(SIGSEGV, OnFault, 0);
+    Handle(SIGTRAP, OnStep, 0);
+    Handle(SIGALRM, OnTick, SA_RESTART);
+
+    start_ns = Nanoseconds();
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = HOST_TICK_US;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+/* Before main(), so that control_sim runs Control's own main() unchanged */
+__attribute__((constructor)) static void Host_Start(void)
+{
+    Host_Init();
+}
+
+void Host_Uart2_Connect(uint8_t mode, int fd)
+{
+    sigset_t saved;
+
+    sigprocmask(SIG_BLOCK, &tick_signal, &saved);
+    Periph_Uart2_Connect(mode, fd);
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+}
+
+int Host_Uart2_Spawn(const char *path)
+{
+    struct sched_param none = { 0 };
+    int link[2];
+    char fd[16];
+    char rate[24];
+    int pid;
+
+    if(getenv("HOST_TIME_SCALE") == NULL)
+    {
+        SetScale(HOST_PEER_TIME_SCALE);
+    }
+
+    if(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, link) != 0)
+    {
+        perror("socketpair");
+        return -1;
+    }
+    pid = fork();
+    if(pid < 0)
+    {
+        perror("fork");
+        close(link[0]);
+        close(link[1]);
+        return -1;
+    }
+    if(pid == 0)
+    {
+        close(link[0]);
+        snprintf(fd, sizeof(fd), "%d", link[1]);
+        snprintf(rate, sizeof(rate), "%llu", (unsigned long long)scale);
+        setenv("HOST_UART2_FD", fd, 1);
+        setenv("HOST_TIME_SCALE", rate, 1);
+        execl(path, path, (char *)NULL);
+        perror(path);
+        _exit(127);
+    }
+    close(link[1]);
+    Host_Uart2_Connect(HOST_LINK_PEER, link[0]);
+
+    /* Both programs busy-wait. On a single host CPU the peer must not wait
+       out this one's time slice for each reply; as SCHED_IDLE this one
+       gives way whenever the peer wakes (it sleeps when idle, see above) */
+    (void)sched_setscheduler(0, SCHED_IDLE, &none);
+    return pid;
+}
+
+size_t Host_Uart0_Take(char *out, size_t size)
+{
+    sigset_t saved;
+    uint32_t length;
+
+    sigprocmask(SIG_BLOCK, &tick_signal, &saved);
+    length = Periph_Uart0_Take(out, (uint32_t)size);
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+    return length;
+}
+
+void Host_SetInput(uint8_t port, uint8_t mask, uint8_t level)
+{
+    sigset_t saved;
+
+    sigprocmask(SIG_BLOCK, &tick_signal, &saved);
+    Periph_SetInput(port, mask, level);
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+    Host_InterruptsEnabled();
+}
+
+void Host_SetAdc(uint32_t value)
+{
+    sigset_t saved;
+
+    sigprocmask(SIG_BLOCK, &tick_signal, &saved);
+    Periph_SetAdc(value);
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+}
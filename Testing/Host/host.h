@@ -0,0 +1,115 @@
+/*
+ * host.h
+ * Runs the target sources on a Linux x86-64 host against emulated
+ * TM4C123GH6PM peripherals (see host.c for how register accesses are
+ * caught, host_periph.c for what the peripherals do).
+ *
+ * Time is simulated: the SysTick, the timers and DWT CYCCNT run
+ * HOST_TIME_SCALE times faster than the host clock (environment variable
+ * of the same name to override), so a 5 s lockout window passes in 50 ms.
+ * Interrupt handlers run asynchronously, between any two instructions of
+ * the target code, as on the chip; __disable_interrupt() holds them off.
+ *
+ * UART2 goes wherever Host_Uart2_Connect() points it. The environment
+ * picks the start-up setting, which is what control_sim relies on:
+ *
+ *   HOST_UART2_FD=<n>  a SOCK_SEQPACKET peer (the other ECU's host build):
+ *                      rate mismatches arrive as framing errors and a break
+ *                      as a break, so link negotiation behaves as on wires
+ *   otherwise          raw bytes on stdin/stdout
+ *
+ * UART0 output (Debug_Log, trace dumps) is collected for Host_Uart0_Take().
+ */
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HOST_TIME_SCALE         100U    /* Simulated seconds per host second */
+#define HOST_PEER_TIME_SCALE    30U     /* The same, once Host_Uart2_Spawn has linked two */
+#define HOST_TICK_US            100U    /* Host microseconds between clock updates */
+
+/* Host_Uart2_Connect modes */
+#define HOST_LINK_NONE          0U      /* Nothing attached: sent bytes are lost */
+#define HOST_LINK_WIRE          1U      /* PD6 wired to PD7: TX comes back on RX */
+#define HOST_LINK_PEER          2U      /* SOCK_SEQPACKET to another host build */
+#define HOST_LINK_STDIO         3U      /* Raw bytes on stdin/stdout */
+
+/* Host_SetInput port numbers (PORTA..PORTF in dio.h) */
+#define HOST_PORT_COUNT         6U
+
+/*
+ * Host_Init
+ * Maps the peripheral address ranges and starts the simulated clock. Runs
+ * before main(); later calls do nothing.
+ */
+void Host_Init(void);
+
+/*
+ * Host_Micros
+ * Simulated microseconds since Host_Init.
+ */
+uint64_t Host_Micros(void);
+
+/*
+ * Host_Idle
+ * Sleeps until the next clock update and runs whatever interrupts it made
+ * due. For host code that waits on simulated time.
+ */
+void Host_Idle(void);
+
+/*
+ * Host_Delay
+ * Waits the given simulated time with interrupts running. delayMs() calls
+ * from another file come here too (-Wl,--wrap=delayMs).
+ */
+void Host_Delay(uint64_t micros);
+
+/*
+ * Host_Uart2_Connect
+ * Attaches UART2 (fd is only used by HOST_LINK_PEER). Empties its FIFOs.
+ */
+void Host_Uart2_Connect(uint8_t mode, int fd);
+
+/*
+ * Host_Uart2_Spawn
+ * Starts another host build (path) with its UART2 and this one's joined
+ * (HOST_LINK_PEER on both ends). Returns its process ID, or -1. Both then
+ * run at HOST_PEER_TIME_SCALE, unless the environment sets a scale: every
+ * reply waits for the other process to get the CPU.
+ */
+int Host_Uart2_Spawn(const char *path);
+
+/*
+ * Host_Uart0_Take
+ * Moves up to size - 1 bytes of collected UART0 output into out and
+ * terminates it; returns the length.
+ */
+size_t Host_Uart0_Take(char *out, size_t size);
+
+/*
+ * Host_SetInput
+ * Drives the input pins in mask of a port high or low (keypad columns,
+ * buttons). Pins with pull-ups read high until driven.
+ */
+void Host_SetInput(uint8_t port, uint8_t mask, uint8_t level);
+
+/*
+ * Host_SetAdc
+ * Value ADC0 returns from its next conversions (0..4095).
+ */
+void Host_SetAdc(uint32_t value);
+
+/*
+ * Host_EepromErase
+ * Returns the emulated EEPROM to its erased state.
+ */
+void Host_EepromErase(void);
+
+/* Used by intrinsics.h */
+extern volatile uint32_t host_primask;
+void Host_InterruptsEnabled(void);
+
+#endif /* HOST_H_ */
@@ -0,0 +1,47 @@
+/*
+ * host_internal.h
+ * Between the access trap (host.c) and the peripheral models
+ * (host_periph.c). Everything here runs with the host signals blocked.
+ */
+
+#ifndef HOST_INTERNAL_H_
+#define HOST_INTERNAL_H_
+
+#include <stdint.h>
+
+#define HOST_CPU_HZ             16000000U       /* SYSTEM_CLOCK_HZ */
+
+/* Exception numbers as in the vector table */
+#define HOST_VECTOR_NONE        0
+#define HOST_VECTOR_SYSTICK     15
+#define HOST_VECTOR_IRQ(n)      (16 + (n))
+#define HOST_VECTOR_COUNT       (16 + 139)
+
+/* Simulated CPU cycles since Host_Init */
+uint64_t Host_Cycles(void);
+
+/* A read as the CPU does it (a UART DR read takes the character) */
+uint32_t Periph_Read(uint32_t address);
+
+/* The same value without side effects, for the other half of a
+   read-modify-write and for bit-band writes */
+uint32_t Periph_Peek(uint32_t address);
+
+void Periph_Write(uint32_t address, uint32_t value);
+
+/* Called on every clock update with the current Host_Cycles() */
+void Periph_Advance(uint64_t cycles);
+
+/* Highest priority exception that is pending and enabled, or
+   HOST_VECTOR_NONE; taking it clears what the hardware clears on entry */
+int  Periph_NextVector(void);
+void Periph_Take(int vector);
+
+/* UART2 attachment, UART0 capture, inputs (see host.h) */
+void Periph_Uart2_Connect(uint8_t mode, int fd);
+void Periph_Uart2_Poll(void);
+uint32_t Periph_Uart0_Take(char *out, uint32_t size);
+void Periph_SetInput(uint8_t port, uint8_t mask, uint8_t level);
+void Periph_SetAdc(uint32_t value);
+
+#endif /* HOST_INTERNAL_H_ */
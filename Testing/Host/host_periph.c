@@ -0,0 +1,922 @@
+/*
+ * host_periph.c
+ * What the TM4C123GH6PM peripherals do, as far as the two images and
+ * their tests use them. Registers without a model keep what was written.
+ *
+ *   System control  PRxxx ready registers always read ready
+ *   GPIO A-F        masked DATA aperture (APB and AHB, one port state),
+ *                   inputs with pull-ups, edge interrupts
+ *   UART0           output collected for the test runner
+ *   UART2           16-entry RX FIFO, loopback (LBE), transmit is instant;
+ *                   the far end per Host_Uart2_Connect
+ *   Timer 0-2 A     periodic and one-shot time-outs
+ *   ADC0            conversions complete at once with Host_SetAdc's value
+ *   SysTick, NVIC   enables, COUNTFLAG, CURRENT; DWT CYCCNT
+ *
+ * Time-outs that fell due between clock updates are each delivered, so a
+ * tick handler still runs once per period.
+ */
+
+#define _GNU_SOURCE
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "host.h"
+#include "host_internal.h"
+
+#define PERIPH_BASE             0x40000000UL
+#define PERIPH_SIZE             0x00100000UL
+#define DWT_BASE                0xE0001000UL
+#define SCS_BASE                0xE000E000UL
+#define BLOCK_SIZE              0x1000UL
+
+#define SYSCTL_BASE             0x400FE000UL
+#define SYSCTL_READY_FIRST      0x400FEA00UL    /* PRWD .. PRWTIMER */
+#define SYSCTL_READY_LAST       0x400FEA5CUL
+
+#define GPIO_AHB_BASE           0x40058000UL
+#define GPIO_DATA_END           0x400U
+#define GPIO_DIR                0x400U
+#define GPIO_IS                 0x404U
+#define GPIO_IBE                0x408U
+#define GPIO_IEV                0x40CU
+#define GPIO_IM                 0x410U
+#define GPIO_RIS                0x414U
+#define GPIO_MIS                0x418U
+#define GPIO_ICR                0x41CU
+#define GPIO_PUR                0x510U
+#define GPIO_PDR                0x514U
+
+#define UART_COUNT              3U
+#define UART_FIFO_SIZE          16U
+#define UART_DR                 0x000U
+#define UART_FR                 0x018U
+#define UART_IBRD               0x024U
+#define UART_FBRD               0x028U
+#define UART_LCRH               0x02CU
+#define UART_CTL                0x030U
+#define UART_IM                 0x038U
+#define UART_RIS                0x03CU
+#define UART_MIS                0x040U
+#define UART_ICR                0x044U
+#define UART_FR_RXFE            0x10U
+#define UART_FR_RXFF            0x40U
+#define UART_FR_TXFE            0x80U
+#define UART_INT_RX             0x10U
+#define UART_INT_TX             0x20U
+#define UART_INT_RT             0x40U
+#define UART_LCRH_BRK           0x01U
+#define UART_CTL_UARTEN         0x001U
+#define UART_CTL_LBE            0x080U
+#define UART_CTL_RXE            0x200U
+#define UART_DR_FE              0x100U
+#define UART_DR_BE              0x400U
+#define UART_DR_OE              0x800U
+#define UART_CONSOLE_SIZE       65536U
+
+#define TIMER_BASE              0x40030000UL
+#define TIMER_COUNT             3U
+#define TIMER_TAMR              0x004U
+#define TIMER_CTL               0x00CU
+#define TIMER_IMR               0x018U
+#define TIMER_RIS               0x01CU
+#define TIMER_MIS               0x020U
+#define TIMER_ICR               0x024U
+#define TIMER_TAILR             0x028U
+#define TIMER_TAV               0x050U
+#define TIMER_TATO              0x01U
+#define TIMER_TAEN              0x01U
+#define TIMER_ONE_SHOT          0x01U
+#define TIMER_DUE_LIMIT         1000U
+
+#define ADC0_BASE               0x40038000UL
+#define ADC_RIS                 0x004U
+#define ADC_IM                  0x008U
+#define ADC_ISC                 0x00CU
+#define ADC_PSSI                0x028U
+#define ADC_SSFIFO0             0x048U
+#define ADC_SSFIFO_STEP         0x020U
+#define ADC0_IRQ_SS3            17U
+
+#define ST_CTRL                 0x010U
+#define ST_RELOAD               0x014U
+#define ST_CURRENT              0x018U
+#define ST_ENABLE               0x01U
+#define ST_TICKINT              0x02U
+#define ST_COUNTFLAG            0x00010000U
+#define NVIC_EN0                0x100U
+#define NVIC_DIS0               0x180U
+#define NVIC_WORDS              5U
+
+#define DWT_CTRL                0x000U
+#define DWT_CYCCNT              0x004U
+
+/* One link transfer to a peer: the sender's divisor stands in for the line
+   rate, so a receiver at another rate sees a framing error */
+typedef struct
+{
+    uint32_t divisor;
+    uint8_t  data;
+    uint8_t  is_break;
+} Link_Unit;
+
+typedef struct
+{
+    uint32_t base;
+    uint8_t  irq;
+    uint16_t rx[UART_FIFO_SIZE];
+    uint32_t rx_head;
+    uint32_t rx_count;
+    uint8_t  tx_ris;
+} Uart;
+
+typedef struct
+{
+    uint32_t data;                      /* Output latch */
+    uint32_t ris;
+    uint8_t  input_level;
+    uint8_t  input_driven;
+} Gpio;
+
+typedef struct
+{
+    uint64_t start;
+    uint64_t seen;
+    uint32_t due;
+} Counter;
+
+static uint32_t periph[PERIPH_SIZE / 4U];
+static uint32_t dwt[BLOCK_SIZE / 4U];
+static uint32_t scs[BLOCK_SIZE / 4U];
+
+static Gpio gpio[HOST_PORT_COUNT];
+static const uint32_t gpio_apb[HOST_PORT_COUNT] =
+{
+    0x40004000UL, 0x40005000UL, 0x40006000UL, 0x40007000UL, 0x40024000UL, 0x40025000UL
+};
+static const uint8_t gpio_irq[HOST_PORT_COUNT] = { 0, 1, 2, 3, 4, 30 };
+
+static Uart uarts[UART_COUNT] =
+{
+    { 0x4000C000UL, 5 },
+    { 0x4000D000UL, 6 },
+    { 0x4000E000UL, 33 }
+};
+static uint8_t link_mode = HOST_LINK_NONE;
+static int link_fd = -1;
+static char console[UART_CONSOLE_SIZE];
+static uint32_t console_length = 0;
+
+static Counter timers[TIMER_COUNT];
+static Counter systick;
+static uint8_t systick_flag = 0;
+static uint64_t cyccnt_origin = 0;
+static uint32_t adc_value = 2048U;
+
+/******************************************************************************
+ *                              Register store                                 *
+ ******************************************************************************/
+
+static uint32_t *Store(uint32_t address)
+{
+    if(address >= PERIPH_BASE && address < PERIPH_BASE + PERIPH_SIZE)
+    {
+        return &periph[(address - PERIPH_BASE) / 4U];
+    }
+    if(address >= DWT_BASE && address < DWT_BASE + BLOCK_SIZE)
+    {
+        return &dwt[(address - DWT_BASE) / 4U];
+    }
+    return &scs[(address - SCS_BASE) / 4U];
+}
+
+static uint32_t Reg(uint32_t base, uint32_t offset)
+{
+    return *Store(base + offset);
+}
+
+/******************************************************************************
+ *                                  GPIO                                       *
+ ******************************************************************************/
+
+/* Port of an APB or AHB GPIO address; the APB block holds the registers */
+static int GpioPort(uint32_t address, uint32_t *offset)
+{
+    uint32_t block = address & ~(uint32_t)(BLOCK_SIZE - 1U);
+    uint32_t port;
+
+    for(port = 0; port < HOST_PORT_COUNT; port++)
+    {
+        if(block == gpio_apb[port] || block == GPIO_AHB_BASE + (port << 12))
+        {
+            *offset = address & (uint32_t)(BLOCK_SIZE - 1U);
+            return (int)port;
+        }
+    }
+    return -1;
+}
+
+static uint32_t GpioReg(uint32_t port, uint32_t offset)
+{
+    return Reg(gpio_apb[port], offset);
+}
+
+/* Outputs read back their latch, inputs what drives them or the pull */
+static uint32_t GpioLevels(uint32_t port)
+{
+    Gpio *g = &gpio[port];
+    uint32_t dir = GpioReg(port, GPIO_DIR);
+    uint32_t inputs = (g->input_level & g->input_driven) |
+                      (GpioReg(port, GPIO_PUR) & ~(uint32_t)g->input_driven);
+
+    return ((g->data & dir) | (inputs & ~dir)) & 0xFFU;
+}
+
+static void GpioEdges(uint32_t port, uint32_t before)
+{
+    uint32_t after = GpioLevels(port);
+    uint32_t changed = (before ^ after) & ~GpioReg(port, GPIO_IS);
+    uint32_t both = GpioReg(port, GPIO_IBE);
+    uint32_t rising = GpioReg(port, GPIO_IEV);
+
+    gpio[port].ris |= changed & (both | (rising & after) | (~rising & ~after));
+    gpio[port].ris &= 0xFFU;
+}
+
+static uint32_t GpioRead(uint32_t port, uint32_t offset)
+{
+    if(offset < GPIO_DATA_END)
+    {
+        return GpioLevels(port) & (offset >> 2);
+    }
+    switch(offset)
+    {
+    case GPIO_RIS:  return gpio[port].ris;
+    case GPIO_MIS:  return gpio[port].ris & GpioReg(port, GPIO_IM);
+    case GPIO_ICR:  return 0;
+    default:        return GpioReg(port, offset);
+    }
+}
+
+static void GpioWrite(uint32_t port, uint32_t offset, uint32_t value)
+{
+    uint32_t before = GpioLevels(port);
+
+    if(offset < GPIO_DATA_END)
+    {
+        uint32_t mask = offset >> 2;
+
+        gpio[port].data = (gpio[port].data & ~mask) | (value & mask);
+    }
+    else if(offset == GPIO_ICR)
+    {
+        gpio[port].ris &= ~value;
+        return;
+    }
+    else if(offset == GPIO_RIS || offset == GPIO_MIS)
+    {
+        return;
+    }
+    else
+    {
+        *Store(gpio_apb[port] + offset) = value;
+    }
+    GpioEdges(port, before);
+}
+
+/******************************************************************************
+ *                                  UART                                       *
+ ******************************************************************************/
+
+static Uart *UartAt(uint32_t address)
+{
+    uint32_t i;
+
+    for(i = 0; i < UART_COUNT; i++)
+    {
+        if((address & ~(uint32_t)(BLOCK_SIZE - 1U)) == uarts[i].base)
+        {
+            return &uarts[i];
+        }
+    }
+    return 0;
+}
+
+static uint32_t UartDivisor(const Uart *u)
+{
+    return (Reg(u->base, UART_IBRD) << 6) | (Reg(u->base, UART_FBRD) & 0x3FU);
+}
+
+static int UartReceiving(const Uart *u)
+{
+    return (Reg(u->base, UART_CTL) & (UART_CTL_UARTEN | UART_CTL_RXE)) == (UART_CTL_UARTEN | UART_CTL_RXE);
+}
+
+static void UartReceive(Uart *u, uint16_t entry)
+{
+    if(u->rx_count == UART_FIFO_SIZE)
+    {
+        u->rx[(u->rx_head + u->rx_count - 1U) % UART_FIFO_SIZE] |= UART_DR_OE;
+        return;
+    }
+    u->rx[(u->rx_head + u->rx_count) % UART_FIFO_SIZE] = entry;
+    u->rx_count++;
+}
+
+static uint32_t UartRis(const Uart *u)
+{
+    return ((u->rx_count != 0U) ? (UART_INT_RX | UART_INT_RT) : 0U) | (u->tx_ris ? UART_INT_TX : 0U);
+}
+
+static void LinkSend(const Uart *u, uint8_t data, uint8_t is_break)
+{
+    Link_Unit unit;
+
+    if(link_mode == HOST_LINK_PEER)
+    {
+        unit.divisor = UartDivisor(u);
+        unit.data = data;
+        unit.is_break = is_break;
+        (void)send(link_fd, &unit, sizeof(unit), MSG_NOSIGNAL);
+    }
+    else if(link_mode == HOST_LINK_STDIO && !is_break)
+    {
+        (void)write(1, &data, 1);
+    }
+}
+
+/* A character (or break) leaving a UART */
+static void UartTransmit(Uart *u, uint8_t data, uint8_t is_break)
+{
+    uint16_t entry = is_break ? UART_DR_BE : data;
+
+    if(u == &uarts[0])
+    {
+        if(!is_break && console_length < UART_CONSOLE_SIZE)
+        {
+            console[console_length++] = (char)data;
+        }
+    }
+    else if((Reg(u->base, UART_CTL) & UART_CTL_LBE) != 0U)
+    {
+        UartReceive(u, entry);
+    }
+    else if(u == &uarts[2])
+    {
+        if(link_mode == HOST_LINK_WIRE)
+        {
+            UartReceive(u, entry);
+        }
+        else
+        {
+            LinkSend(u, data, is_break);
+        }
+    }
+    u->tx_ris = 1;
+}
+
+static uint32_t UartRead(Uart *u, uint32_t offset, int peek)
+{
+    switch(offset)
+    {
+    case UART_DR:
+    {
+        uint32_t entry;
+
+        if(u->rx_count == 0U)
+        {
+            return 0;
+        }
+        entry = u->rx[u->rx_head];
+        if(!peek)
+        {
+            u->rx_head = (u->rx_head + 1U) % UART_FIFO_SIZE;
+            u->rx_count--;
+        }
+        return entry;
+    }
+    case UART_FR:
+        if(!peek && u == &uarts[2])
+        {
+            Periph_Uart2_Poll();
+        }
+        return UART_FR_TXFE | ((u->rx_count == 0U) ? UART_FR_RXFE : 0U) |
+               ((u->rx_count == UART_FIFO_SIZE) ? UART_FR_RXFF : 0U);
+    case UART_RIS:
+        return UartRis(u);
+    case UART_MIS:
+        return UartRis(u) & Reg(u->base, UART_IM);
+    case UART_ICR:
+        return 0;
+    default:
+        return Reg(u->base, offset);
+    }
+}
+
+static void UartWrite(Uart *u, uint32_t offset, uint32_t value)
+{
+    switch(offset)
+    {
+    case UART_DR:
+        UartTransmit(u, (uint8_t)value, 0);
+        return;
+    case UART_ICR:
+        if((value & UART_INT_TX) != 0U)
+        {
+            u->tx_ris = 0;
+        }
+        return;
+    case UART_LCRH:
+        if((value & UART_LCRH_BRK) != 0U && (Reg(u->base, UART_LCRH) & UART_LCRH_BRK) == 0U)
+        {
+            UartTransmit(u, 0, 1);
+        }
+        break;
+    case UART_FR:
+    case UART_RIS:
+    case UART_MIS:
+        return;
+    default:
+        break;
+    }
+    *Store(u->base + offset) = value;
+}
+
+/******************************************************************************
+ *                        Timers, SysTick and DWT                              *
+ ******************************************************************************/
+
+static uint32_t TimerIndex(uint32_t address)
+{
+    return (address - TIMER_BASE) / BLOCK_SIZE;
+}
+
+static uint32_t TimerPeriod(uint32_t index)
+{
+    return Reg(TIMER_BASE + (index * BLOCK_SIZE), TIMER_TAILR) + 1U;
+}
+
+static uint32_t TimerRead(uint32_t index, uint32_t offset)
+{
+    uint32_t base = TIMER_BASE + (index * BLOCK_SIZE);
+
+    switch(offset)
+    {
+    case TIMER_RIS:
+        return (timers[index].due != 0U) ? TIMER_TATO : 0U;
+    case TIMER_MIS:
+        return ((timers[index].due != 0U) ? TIMER_TATO : 0U) & Reg(base, TIMER_IMR);
+    case TIMER_TAV:
+        return TimerPeriod(index) - 1U - (uint32_t)((Host_Cycles() - timers[index].start) % TimerPeriod(index));
+    default:
+        return Reg(base, offset);
+    }
+}
+
+static void TimerWrite(uint32_t index, uint32_t offset, uint32_t value)
+{
+    uint32_t base = TIMER_BASE + (index * BLOCK_SIZE);
+    Counter *t = &timers[index];
+
+    switch(offset)
+    {
+    case TIMER_ICR:
+        if((value & TIMER_TATO) != 0U && t->due != 0U)
+        {
+            t->due--;
+        }
+        return;
+    case TIMER_CTL:
+        if((value & TIMER_TAEN) != 0U && (Reg(base, TIMER_CTL) & TIMER_TAEN) == 0U)
+        {
+            t->start = Host_Cycles();
+            t->seen = 0;
+        }
+        break;
+    case TIMER_RIS:
+    case TIMER_MIS:
+        return;
+    default:
+        break;
+    }
+    *Store(base + offset) = value;
+}
+
+static void TimerAdvance(uint32_t index, uint64_t cycles)
+{
+    uint32_t base = TIMER_BASE + (index * BLOCK_SIZE);
+    Counter *t = &timers[index];
+    uint64_t periods;
+
+    if((Reg(base, TIMER_CTL) & TIMER_TAEN) == 0U)
+    {
+        return;
+    }
+    periods = (cycles - t->start) / TimerPeriod(index);
+    if(periods > t->seen)
+    {
+        uint64_t fresh = periods - t->seen;
+
+        t->seen = periods;
+        if((Reg(base, TIMER_TAMR) & 0x3U) == TIMER_ONE_SHOT)
+        {
+            fresh = 1U;
+            *Store(base + TIMER_CTL) &= ~TIMER_TAEN;
+        }
+        t->due = (t->due + fresh > TIMER_DUE_LIMIT) ? TIMER_DUE_LIMIT : (uint32_t)(t->due + fresh);
+    }
+}
+
+static uint32_t SysTickPeriod(void)
+{
+    return (scs[ST_RELOAD / 4U] & 0x00FFFFFFU) + 1U;
+}
+
+static void SysTickAdvance(uint64_t cycles)
+{
+    uint64_t periods;
+
+    if((scs[ST_CTRL / 4U] & ST_ENABLE) == 0U)
+    {
+        return;
+    }
+    periods = (cycles - systick.start) / SysTickPeriod();
+    if(periods > systick.seen)
+    {
+        uint64_t fresh = periods - systick.seen;
+
+        systick.seen = periods;
+        systick_flag = 1;
+        if((scs[ST_CTRL / 4U] & ST_TICKINT) != 0U)
+        {
+            systick.due = (systick.due + fresh > TIMER_DUE_LIMIT) ? TIMER_DUE_LIMIT
+                                                                 : (uint32_t)(systick.due + fresh);
+        }
+    }
+}
+
+static uint32_t ScsRead(uint32_t offset, int peek)
+{
+    switch(offset)
+    {
+    case ST_CTRL:
+    {
+        uint32_t value;
+
+        SysTickAdvance(Host_Cycles());
+        value = scs[ST_CTRL / 4U] | (systick_flag ? ST_COUNTFLAG : 0U);
+        if(!peek)
+        {
+            systick_flag = 0;
+        }
+        return value;
+    }
+    case ST_CURRENT:
+        if((scs[ST_CTRL / 4U] & ST_ENABLE) == 0U)
+        {
+            return scs[ST_CURRENT / 4U];
+        }
+        /* A count that has wrapped has its tick pending, taken at the end
+           of this access, as SysTick_GetMicros() expects */
+        SysTickAdvance(Host_Cycles());
+        return SysTickPeriod() - 1U - (uint32_t)((Host_Cycles() - systick.start) % SysTickPeriod());
+    default:
+        if(offset >= NVIC_DIS0 && offset < NVIC_DIS0 + (NVIC_WORDS * 4U))
+        {
+            return scs[(offset - NVIC_DIS0 + NVIC_EN0) / 4U];
+        }
+        return scs[offset / 4U];
+    }
+}
+
+static void ScsWrite(uint32_t offset, uint32_t value)
+{
+    if(offset >= NVIC_EN0 && offset < NVIC_EN0 + (NVIC_WORDS * 4U))
+    {
+        scs[offset / 4U] |= value;
+        return;
+    }
+    if(offset >= NVIC_DIS0 && offset < NVIC_DIS0 + (NVIC_WORDS * 4U))
+    {
+        scs[(offset - NVIC_DIS0 + NVIC_EN0) / 4U] &= ~value;
+        return;
+    }
+    switch(offset)
+    {
+    case ST_CTRL:
+        if((value & ST_ENABLE) != 0U && (scs[ST_CTRL / 4U] & ST_ENABLE) == 0U)
+        {
+            systick.start = Host_Cycles();
+            systick.seen = 0;
+        }
+        scs[ST_CTRL / 4U] = value & ~ST_COUNTFLAG;
+        return;
+    case ST_CURRENT:
+        systick.start = Host_Cycles();
+        systick.seen = 0;
+        systick_flag = 0;
+        return;
+    default:
+        scs[offset / 4U] = value;
+        return;
+    }
+}
+
+static int Enabled(uint32_t irq)
+{
+    return (scs[(NVIC_EN0 / 4U) + (irq / 32U)] >> (irq % 32U)) & 1U;
+}
+
+/******************************************************************************
+ *                                  ADC0                                       *
+ ******************************************************************************/
+
+static uint32_t AdcRead(uint32_t offset)
+{
+    if(offset >= ADC_SSFIFO0 && (offset - ADC_SSFIFO0) % ADC_SSFIFO_STEP == 0U &&
+       (offset - ADC_SSFIFO0) / ADC_SSFIFO_STEP < 4U)
+    {
+        return adc_value;
+    }
+    if(offset == ADC_ISC)
+    {
+        return Reg(ADC0_BASE, ADC_RIS) & Reg(ADC0_BASE, ADC_IM);
+    }
+    return Reg(ADC0_BASE, offset);
+}
+
+static void AdcWrite(uint32_t offset, uint32_t value)
+{
+    if(offset == ADC_PSSI)
+    {
+        *Store(ADC0_BASE + ADC_RIS) |= (value & 0x0FU);
+        return;
+    }
+    if(offset == ADC_ISC)
+    {
+        *Store(ADC0_BASE + ADC_RIS) &= ~value;
+        return;
+    }
+    *Store(ADC0_BASE + offset) = value;
+}
+
+/******************************************************************************
+ *                              Dispatch                                       *
+ ******************************************************************************/
+
+static uint32_t Access(uint32_t address, int peek, int write, uint32_t value)
+{
+    uint32_t offset;
+    int port;
+    Uart *u;
+
+    address &= ~3U;
+    if(address >= SCS_BASE && address < SCS_BASE + BLOCK_SIZE)
+    {
+        if(write)
+        {
+            ScsWrite(address - SCS_BASE, value);
+            return 0;
+        }
+        return ScsRead(address - SCS_BASE, peek);
+    }
+    if(address == DWT_BASE + DWT_CYCCNT)
+    {
+        if(write)
+        {
+            cyccnt_origin = Host_Cycles() - value;
+            return 0;
+        }
+        return ((dwt[DWT_CTRL / 4U] & 1U) != 0U) ? (uint32_t)(Host_Cycles() - cyccnt_origin) : 0U;
+    }
+
+    port = GpioPort(address, &offset);
+    if(port >= 0)
+    {
+        if(write)
+        {
+            GpioWrite((uint32_t)port, offset, value);
+            return 0;
+        }
+        return GpioRead((uint32_t)port, offset);
+    }
+    u = UartAt(address);
+    if(u != 0)
+    {
+        if(write)
+        {
+            UartWrite(u, address - u->base, value);
+            return 0;
+        }
+        return UartRead(u, address - u->base, peek);
+    }
+    if(address >= TIMER_BASE && address < TIMER_BASE + (TIMER_COUNT * BLOCK_SIZE))
+    {
+        if(write)
+        {
+            TimerWrite(TimerIndex(address), address & (BLOCK_SIZE - 1U), value);
+            return 0;
+        }
+        return TimerRead(TimerIndex(address), address & (BLOCK_SIZE - 1U));
+    }
+    if(address >= ADC0_BASE && address < ADC0_BASE + BLOCK_SIZE)
+    {
+        if(write)
+        {
+            AdcWrite(address - ADC0_BASE, value);
+            return 0;
+        }
+        return AdcRead(address - ADC0_BASE);
+    }
+    if(!write && address >= SYSCTL_READY_FIRST && address <= SYSCTL_READY_LAST)
+    {
+        return 0xFFFFFFFFU;
+    }
+
+    if(write)
+    {
+        *Store(address) = value;
+        return 0;
+    }
+    return *Store(address);
+}
+
+uint32_t Periph_Read(uint32_t address)
+{
+    return Access(address, 0, 0, 0);
+}
+
+uint32_t Periph_Peek(uint32_t address)
+{
+    return Access(address, 1, 0, 0);
+}
+
+void Periph_Write(uint32_t address, uint32_t value)
+{
+    (void)Access(address, 0, 1, value);
+}
+
+void Periph_Advance(uint64_t cycles)
+{
+    uint32_t i;
+
+    SysTickAdvance(cycles);
+    for(i = 0; i < TIMER_COUNT; i++)
+    {
+        TimerAdvance(i, cycles);
+    }
+}
+
+int Periph_NextVector(void)
+{
+    uint32_t asserted[NVIC_WORDS];
+    uint32_t i;
+
+    if(systick.due != 0U && (scs[ST_CTRL / 4U] & (ST_ENABLE | ST_TICKINT)) == (ST_ENABLE | ST_TICKINT))
+    {
+        return HOST_VECTOR_SYSTICK;
+    }
+
+    memset(asserted, 0, sizeof(asserted));
+    for(i = 0; i < HOST_PORT_COUNT; i++)
+    {
+        if((gpio[i].ris & GpioReg(i, GPIO_IM)) != 0U)
+        {
+            asserted[gpio_irq[i] / 32U] |= 1U << (gpio_irq[i] % 32U);
+        }
+    }
+    for(i = 0; i < UART_COUNT; i++)
+    {
+        if((UartRis(&uarts[i]) & Reg(uarts[i].base, UART_IM)) != 0U)
+        {
+            asserted[uarts[i].irq / 32U] |= 1U << (uarts[i].irq % 32U);
+        }
+    }
+    for(i = 0; i < TIMER_COUNT; i++)
+    {
+        if(timers[i].due != 0U && (Reg(TIMER_BASE + (i * BLOCK_SIZE), TIMER_IMR) & TIMER_TATO) != 0U)
+        {
+            asserted[0] |= 1U << (19U + (2U * i));
+        }
+    }
+    if((Reg(ADC0_BASE, ADC_RIS) & Reg(ADC0_BASE, ADC_IM) & 0x08U) != 0U)
+    {
+        asserted[0] |= 1U << ADC0_IRQ_SS3;
+    }
+
+    for(i = 0; i < NVIC_WORDS * 32U; i++)
+    {
+        if(((asserted[i / 32U] >> (i % 32U)) & 1U) != 0U && Enabled(i))
+        {
+            return HOST_VECTOR_IRQ((int)i);
+        }
+    }
+    return HOST_VECTOR_NONE;
+}
+
+void Periph_Take(int vector)
+{
+    if(vector == HOST_VECTOR_SYSTICK && systick.due != 0U)
+    {
+        systick.due--;
+    }
+}
+
+/******************************************************************************
+ *                          Outside connections                                *
+ ******************************************************************************/
+
+void Periph_Uart2_Connect(uint8_t mode, int fd)
+{
+    link_mode = mode;
+    link_fd = (mode == HOST_LINK_STDIO) ? 0 : fd;
+    uarts[2].rx_count = 0;
+    uarts[2].rx_head = 0;
+}
+
+/* Moves what the far end sent into the RX FIFO while it has room; the rest
+   waits in the socket as it would behind a full FIFO. The far end closing
+   the link ends this process. */
+void Periph_Uart2_Poll(void)
+{
+    Uart *u = &uarts[2];
+
+    if(!UartReceiving(u))
+    {
+        return;
+    }
+    while(u->rx_count < UART_FIFO_SIZE)
+    {
+        if(link_mode == HOST_LINK_PEER)
+        {
+            Link_Unit unit;
+            ssize_t got = recv(link_fd, &unit, sizeof(unit), MSG_DONTWAIT);
+
+            if(got == 0)
+            {
+                _exit(0);
+            }
+            if(got != (ssize_t)sizeof(unit))
+            {
+                return;
+            }
+            if(unit.is_break)
+            {
+                UartReceive(u, UART_DR_BE);
+            }
+            else if(unit.divisor != UartDivisor(u))
+            {
+                UartReceive(u, (uint16_t)(UART_DR_FE | (uint8_t)(unit.data ^ 0x5AU)));
+            }
+            else
+            {
+                UartReceive(u, unit.data);
+            }
+        }
+        else if(link_mode == HOST_LINK_STDIO)
+        {
+            struct pollfd ready = { 0, POLLIN, 0 };
+            uint8_t data;
+
+            if(poll(&ready, 1, 0) != 1)
+            {
+                return;
+            }
+            if(read(0, &data, 1) != 1)
+            {
+                _exit(0);
+            }
+            UartReceive(u, data);
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+uint32_t Periph_Uart0_Take(char *out, uint32_t size)
+{
+    uint32_t length = (console_length < size) ? console_length : size - 1U;
+
+    memcpy(out, console, length);
+    out[length] = '\0';
+    memmove(console, console + length, console_length - length);
+    console_length -= length;
+    return length;
+}
+
+void Periph_SetInput(uint8_t port, uint8_t mask, uint8_t level)
+{
+    uint32_t before = GpioLevels(port);
+
+    gpio[port].input_driven |= mask;
+    gpio[port].input_level = (uint8_t)((gpio[port].input_level & ~mask) | (level ? mask : 0U));
+    GpioEdges(port, before);
+}
+
+void Periph_SetAdc(uint32_t value)
+{
+    adc_value = value & 0xFFFU;
+}
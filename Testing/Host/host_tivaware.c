@@ -0,0 +1,82 @@
+/*
+ * host_tivaware.c
+ * The TivaWare EEPROM calls eeprom.c makes, on a RAM copy of the 2 KB
+ * EEPROM that starts erased (all ones) in every run.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "driverlib/eeprom.h"
+#include "driverlib/sysctl.h"
+#include "host.h"
+
+#define EEPROM_WORDS            512U            /* 32 blocks of 16 words */
+#define EEPROM_ERASED           0xFFFFFFFFU
+
+static uint32_t eeprom[EEPROM_WORDS];
+static int formatted = 0;
+
+static void Format(void)
+{
+    if(!formatted)
+    {
+        Host_EepromErase();
+    }
+}
+
+void Host_EepromErase(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < EEPROM_WORDS; i++)
+    {
+        eeprom[i] = EEPROM_ERASED;
+    }
+    formatted = 1;
+}
+
+void SysCtlPeripheralEnable(uint32_t peripheral)
+{
+    (void)peripheral;
+}
+
+bool SysCtlPeripheralReady(uint32_t peripheral)
+{
+    (void)peripheral;
+    return true;
+}
+
+uint32_t EEPROMInit(void)
+{
+    Format();
+    return EEPROM_INIT_OK;
+}
+
+/* Byte address and count, both word aligned; 0 is success */
+uint32_t EEPROMProgram(uint32_t *data, uint32_t address, uint32_t count)
+{
+    Format();
+    if((address % 4U) != 0U || (count % 4U) != 0U || (address + count) > (EEPROM_WORDS * 4U))
+    {
+        return 1U;
+    }
+    memcpy(&eeprom[address / 4U], data, count);
+    return 0U;
+}
+
+void EEPROMRead(uint32_t *data, uint32_t address, uint32_t count)
+{
+    Format();
+    if((address % 4U) != 0U || (count % 4U) != 0U || (address + count) > (EEPROM_WORDS * 4U))
+    {
+        return;
+    }
+    memcpy(data, &eeprom[address / 4U], count);
+}
+
+uint32_t EEPROMMassErase(void)
+{
+    Host_EepromErase();
+    return 0U;
+}
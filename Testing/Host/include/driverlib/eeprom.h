@@ -0,0 +1,14 @@
+/* eeprom.h (host): TivaWare calls, implemented in host_tivaware.c */
+#ifndef HOST_DRIVERLIB_EEPROM_H_
+#define HOST_DRIVERLIB_EEPROM_H_
+
+#include <stdint.h>
+
+#define EEPROM_INIT_OK          0
+
+uint32_t EEPROMInit(void);
+uint32_t EEPROMProgram(uint32_t *data, uint32_t address, uint32_t count);
+void EEPROMRead(uint32_t *data, uint32_t address, uint32_t count);
+uint32_t EEPROMMassErase(void);
+
+#endif
@@ -0,0 +1,13 @@
+/* sysctl.h (host): TivaWare calls, implemented in host_tivaware.c */
+#ifndef HOST_SYSCTL_H_
+#define HOST_SYSCTL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SYSCTL_PERIPH_EEPROM0   0xf0005800
+
+void SysCtlPeripheralEnable(uint32_t peripheral);
+bool SysCtlPeripheralReady(uint32_t peripheral);
+
+#endif
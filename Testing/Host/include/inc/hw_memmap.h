@@ -0,0 +1,7 @@
+/* hw_memmap.h (host): the TivaWare names the sources use */
+#ifndef HOST_HW_MEMMAP_H_
+#define HOST_HW_MEMMAP_H_
+
+#define EEPROM_BASE             0x400AF000
+
+#endif
@@ -0,0 +1,10 @@
+/* hw_types.h (host) */
+#ifndef HOST_HW_TYPES_H_
+#define HOST_HW_TYPES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HWREG(x)                (*((volatile uint32_t *)(x)))
+
+#endif
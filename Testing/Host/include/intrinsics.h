@@ -0,0 +1,41 @@
+/*
+ * intrinsics.h (host)
+ * The IAR intrinsics the sources use. PRIMASK is host_primask; clearing
+ * it takes the interrupts that became pending meanwhile (host.c).
+ */
+
+#ifndef HOST_INTRINSICS_H_
+#define HOST_INTRINSICS_H_
+
+#include <stdint.h>
+#include "host.h"
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return host_primask;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+    host_primask = primask & 1U;
+    if(host_primask == 0U)
+    {
+        Host_InterruptsEnabled();
+    }
+}
+
+static inline void __disable_interrupt(void)
+{
+    host_primask = 1U;
+}
+
+static inline void __enable_interrupt(void)
+{
+    __set_PRIMASK(0U);
+}
+
+static inline void __no_operation(void)
+{
+}
+
+#endif /* HOST_INTRINSICS_H_ */
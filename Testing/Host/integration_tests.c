@@ -0,0 +1,180 @@
+/*
+ * integration_tests.c
+ * The HMI ECU integration suite (test_integration.c) on the host:
+ *
+ *   make integration_tests && ./integration_tests [-l] [-v] [-j report.xml] [filter ...]
+ *
+ * The Control ECU is control_sim, Control's unchanged image built for the
+ * host, started next to this program with the two UART2s joined by a
+ * socket pair. Boots as HMI's main() does before its scheduler starts the
+ * suite.
+ * Filtered runs still share one Control, so later tests can depend on the
+ * password and lockout state earlier ones left (as on the boards).
+ */
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "host.h"
+#include "runner.h"
+#include "uart.h"
+#include "dio.h"
+#include "systick.h"
+#include "lcd.h"
+#include "keypad.h"
+#include "adc.h"
+
+#define PEER_PROGRAM            "control_sim"
+#define PEER_READY_TIMEOUT_US   5000000U    /* HMI main() waits 5000 x 1 ms */
+#define PEER_LINE_SIZE          20U
+
+/* test_integration.c */
+extern void Debug_UART0_Init(void);
+extern int Test_Initial_Setup(void);
+extern int Test_Door_Open(void);
+extern int Test_Access_Denied(void);
+extern int Test_Lockout_Sequence(void);
+extern int Test_Timeout_Setting(void);
+extern int Test_LCD_Screen(void);
+extern int Test_Hmi_StateMachine(void);
+extern int Test_Pipelined_Requests(void);
+extern int Test_Config_Command(void);
+extern int Test_Link_Rate(void);
+extern int Test_Gpio_Aperture(void);
+extern int Test_Link_Heartbeat(void);
+extern int Test_Runtime_Stats(void);
+
+static const Runner_Test tests[] =
+{
+    { "1. PWD Setup",                       Test_Initial_Setup,         0 },
+    { "2. Door Open",                       Test_Door_Open,             0 },
+    { "3. Wrong PWD",                       Test_Access_Denied,         0 },
+    { "4. Lockout (Buzzer)",                Test_Lockout_Sequence,      0 },
+    { "5. Timeout Setting",                 Test_Timeout_Setting,       0 },
+    { "6. LCD Screen",                      Test_LCD_Screen,            0 },
+    { "7. HMI State Machine",               Test_Hmi_StateMachine,      0 },
+    { "8. Pipelined Requests",              Test_Pipelined_Requests,    0 },
+    { "9. CFG Command",                     Test_Config_Command,        0 },
+    { "10. Link Rate Negotiation",          Test_Link_Rate,             0 },
+    { "11. GPIO Aperture Toggle Rate",      Test_Gpio_Aperture,
+      "times APB against AHB bus cycles; run it on the board" },
+    { "12. Link Heartbeat",                 Test_Link_Heartbeat,        0 },
+    { "13. Runtime Stats",                  Test_Runtime_Stats,         0 }
+};
+
+static char program[4096];
+static pid_t peer = -1;
+
+/* control_sim from the directory this program was started from */
+static int StartPeer(void)
+{
+    char *slash = strrchr(program, '/');
+
+    if(slash != NULL)
+    {
+        strcpy(slash + 1, PEER_PROGRAM);
+    }
+    else
+    {
+        strcpy(program, "./" PEER_PROGRAM);
+    }
+    peer = Host_Uart2_Spawn(program);
+    return peer > 0;
+}
+
+/* Detached first: the end of the link would otherwise end this program too */
+static void StopPeer(void)
+{
+    if(peer > 0)
+    {
+        Host_Uart2_Connect(HOST_LINK_NONE, -1);
+        kill(peer, SIGTERM);
+        (void)waitpid(peer, NULL, 0);
+        peer = -1;
+    }
+}
+
+/* HMI main() listening for Control's start-up line */
+static int WaitForPeer(void)
+{
+    char line[PEER_LINE_SIZE];
+    uint32_t length = 0;
+    uint64_t until = Host_Micros() + PEER_READY_TIMEOUT_US;
+
+    while(Host_Micros() < until)
+    {
+        char c;
+
+        if(!UART2_Available())
+        {
+            Host_Idle();
+            continue;
+        }
+        c = UART2_ReadChar();
+        if(c == '\n')
+        {
+            line[length] = '\0';
+            if(strstr(line, "CONTROL_READY") != NULL)
+            {
+                return 1;
+            }
+            length = 0;
+        }
+        else if(length < PEER_LINE_SIZE - 1U)
+        {
+            line[length++] = c;
+        }
+    }
+    return 0;
+}
+
+static int Boot(void)
+{
+    if(!StartPeer())
+    {
+        return 0;
+    }
+
+    SysTick_Init(SYSTICK_RELOAD_1MS, SYSTICK_INT);
+    DIO_EnableAHB();
+    Keypad_Init();
+    UART2_Init();
+    ADC_Pot_Init();
+    DIO_Init(PORTF, PIN3, OUTPUT);
+    DIO_WritePin(PORTF, PIN3, LOW);
+    DIO_Init(PORTF, PIN1, OUTPUT);
+    DIO_WritePin(PORTF, PIN1, LOW);
+    LCD_Init();
+    if(!WaitForPeer())
+    {
+        return 0;
+    }
+
+    /* Run_Integration_Tests() from here */
+    Debug_UART0_Init();
+    UART2_Init();
+    return 1;
+}
+
+static const Runner_Suite suite =
+{
+    "hmi.integration",
+    "HMI ECU INTEGRATION TESTS",
+    tests,
+    sizeof(tests) / sizeof(tests[0]),
+    Boot,
+    StopPeer
+};
+
+int main(int argc, char **argv)
+{
+    int result;
+
+    snprintf(program, sizeof(program), "%s", argv[0]);
+    result = Runner_Main(argc, argv, &suite);
+    StopPeer();
+    return result;
+}
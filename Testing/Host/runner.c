@@ -0,0 +1,303 @@
+/*
+ * runner.c
+ * See runner.h. The report is written once the suite is complete.
+ */
+
+#define _GNU_SOURCE
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "host.h"
+#include "runner.h"
+
+#define OUTPUT_SIZE     8192U
+
+#define RESULT_PASS     0
+#define RESULT_FAIL     1
+#define RESULT_SKIP     2
+
+typedef struct
+{
+    int result;
+    double seconds;                 /* Host time */
+    uint64_t simulated_us;
+    char output[OUTPUT_SIZE];       /* UART0 */
+} Outcome;
+
+static const char *const result_names[] = { "PASS", "FAIL", "SKIP" };
+
+static double Seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+static int Contains(const char *text, const char *part)
+{
+    size_t length = strlen(part);
+
+    for(; *text != '\0'; text++)
+    {
+        if(strncasecmp(text, part, length) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* "9" picks "9. ...", anything else is part of the name */
+static int Selected(const Runner_Test *test, char **filters, int count)
+{
+    int i;
+
+    if(count == 0)
+    {
+        return 1;
+    }
+    for(i = 0; i < count; i++)
+    {
+        size_t length = strspn(filters[i], "0123456789");
+
+        if(length > 0U && filters[i][length] == '\0')
+        {
+            if(strncmp(test->name, filters[i], length) == 0 && test->name[length] == '.')
+            {
+                return 1;
+            }
+        }
+        else if(Contains(test->name, filters[i]))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void PrintOutput(const char *text)
+{
+    const char *line = text;
+
+    while(*line != '\0')
+    {
+        size_t length = strcspn(line, "\r\n");
+
+        if(length > 0U)
+        {
+            printf("       | %.*s\n", (int)length, line);
+        }
+        line += length;
+        line += strspn(line, "\r\n");
+    }
+}
+
+/* XML 1.0 text: markup escaped, control characters other than tab/newline dropped */
+static void XmlText(FILE *f, const char *text)
+{
+    for(; *text != '\0'; text++)
+    {
+        unsigned char c = (unsigned char)*text;
+
+        switch(c)
+        {
+        case '&':  fputs("&amp;", f); break;
+        case '<':  fputs("&lt;", f); break;
+        case '>':  fputs("&gt;", f); break;
+        case '"':  fputs("&quot;", f); break;
+        default:
+            if(c >= 0x20U || c == '\t' || c == '\n')
+            {
+                fputc(c, f);
+            }
+            break;
+        }
+    }
+}
+
+static int WriteJUnit(const char *path, const Runner_Suite *suite, const Outcome *outcomes,
+                      const int *selected, double total)
+{
+    FILE *f = fopen(path, "w");
+    uint32_t tests = 0;
+    uint32_t failures = 0;
+    uint32_t skipped = 0;
+    uint32_t i;
+
+    if(f == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+    for(i = 0; i < suite->count; i++)
+    {
+        if(selected[i])
+        {
+            tests++;
+            failures += (outcomes[i].result == RESULT_FAIL);
+            skipped += (outcomes[i].result == RESULT_SKIP);
+        }
+    }
+
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(f, "<testsuite name=\"%s\" tests=\"%u\" failures=\"%u\" errors=\"0\" skipped=\"%u\" time=\"%.6f\">\n",
+            suite->name, tests, failures, skipped, total);
+    for(i = 0; i < suite->count; i++)
+    {
+        const Outcome *o = &outcomes[i];
+
+        if(!selected[i])
+        {
+            continue;
+        }
+        fprintf(f, "  <testcase classname=\"%s\" name=\"", suite->name);
+        XmlText(f, suite->tests[i].name);
+        fprintf(f, "\" time=\"%.6f\">\n", o->seconds);
+        if(o->result == RESULT_FAIL)
+        {
+            fprintf(f, "    <failure message=\"returned 0\"/>\n");
+        }
+        else if(o->result == RESULT_SKIP)
+        {
+            fprintf(f, "    <skipped message=\"");
+            XmlText(f, suite->tests[i].skip);
+            fprintf(f, "\"/>\n");
+        }
+        if(o->output[0] != '\0')
+        {
+            fprintf(f, "    <system-out>");
+            XmlText(f, o->output);
+            fprintf(f, "</system-out>\n");
+        }
+        fprintf(f, "  </testcase>\n");
+    }
+    fprintf(f, "</testsuite>\n");
+    return fclose(f) == 0;
+}
+
+static void Usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [-l] [-v] [-j report.xml] [filter ...]\n", program);
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+int Runner_Main(int argc, char **argv, const Runner_Suite *suite)
+{
+    static Outcome outcomes[64];
+    static int selected[64];
+    const char *junit = NULL;
+    int list = 0;
+    int verbose = 0;
+    int option;
+    uint32_t passed = 0;
+    uint32_t failed = 0;
+    uint32_t skipped = 0;
+    uint32_t i;
+    double started;
+
+    while((option = getopt(argc, argv, "lvj:")) != -1)
+    {
+        switch(option)
+        {
+        case 'l': list = 1; break;
+        case 'v': verbose = 1; break;
+        case 'j': junit = optarg; break;
+        default:  Usage(argv[0]); return 2;
+        }
+    }
+
+    for(i = 0; i < suite->count && i < 64U; i++)
+    {
+        selected[i] = Selected(&suite->tests[i], &argv[optind], argc - optind);
+        if(list && selected[i])
+        {
+            printf("%s%s%s\n", suite->tests[i].name,
+                   suite->tests[i].skip ? "  (skipped: " : "",
+                   suite->tests[i].skip ? suite->tests[i].skip : "");
+            if(suite->tests[i].skip)
+            {
+                printf(")\n");
+            }
+        }
+    }
+    if(list)
+    {
+        return 0;
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    printf("=== %s (host) ===\n", suite->title);
+    started = Seconds();
+    if(!suite->boot())
+    {
+        char output[OUTPUT_SIZE];
+
+        (void)Host_Uart0_Take(output, sizeof(output));
+        printf("[FAIL] boot\n");
+        PrintOutput(output);
+        return 1;
+    }
+    (void)Host_Uart0_Take(outcomes[0].output, OUTPUT_SIZE);    /* Boot output */
+    outcomes[0].output[0] = '\0';
+
+    for(i = 0; i < suite->count; i++)
+    {
+        const Runner_Test *test = &suite->tests[i];
+        Outcome *o = &outcomes[i];
+        uint64_t simulated;
+        double start;
+
+        if(!selected[i])
+        {
+            continue;
+        }
+        if(test->skip != NULL)
+        {
+            o->result = RESULT_SKIP;
+            skipped++;
+            printf("[SKIP] %-36s %s\n", test->name, test->skip);
+            continue;
+        }
+
+        start = Seconds();
+        simulated = Host_Micros();
+        o->result = test->run() ? RESULT_PASS : RESULT_FAIL;
+        o->seconds = Seconds() - start;
+        o->simulated_us = Host_Micros() - simulated;
+        (void)Host_Uart0_Take(o->output, OUTPUT_SIZE);
+
+        printf("[%s] %-36s %8.2f ms  (%llu ms simulated)\n", result_names[o->result], test->name,
+               o->seconds * 1000.0, (unsigned long long)(o->simulated_us / 1000U));
+        if(o->result == RESULT_FAIL || verbose)
+        {
+            PrintOutput(o->output);
+        }
+        if(o->result == RESULT_PASS)
+        {
+            passed++;
+        }
+        else
+        {
+            failed++;
+        }
+    }
+
+    if(suite->finish != 0)
+    {
+        suite->finish();
+    }
+    printf("--- %u passed, %u failed, %u skipped in %.1f ms ---\n",
+           passed, failed, skipped, (Seconds() - started) * 1000.0);
+    if(junit != NULL && !WriteJUnit(junit, suite, outcomes, selected, Seconds() - started))
+    {
+        return 2;
+    }
+    return failed ? 1 : 0;
+}
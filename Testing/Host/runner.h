@@ -0,0 +1,41 @@
+/*
+ * runner.h
+ * Test runner for the on-target suites built for the host:
+ *
+ *   ./unit_tests [-l] [-v] [-j report.xml] [filter ...]
+ *
+ *   -l          list the tests and exit
+ *   -v          print each test's UART0 output (Debug_Log), not only on failure
+ *   -j FILE     write a JUnit XML report
+ *   filter      run only matching tests: a number ("9") or part of the name,
+ *               case-insensitive ("xoff"); the boot sequence always runs
+ *
+ * Each line gives host time and simulated time. Exits with 1 if a test
+ * failed.
+ */
+
+#ifndef RUNNER_H_
+#define RUNNER_H_
+
+#include <stdint.h>
+
+typedef struct
+{
+    const char *name;               /* As Log_Result prints it: "9. UART Ring / XON-XOFF" */
+    int (*run)(void);               /* The suite's function, 1 = pass */
+    const char *skip;               /* Why it cannot run on the host, or 0 */
+} Runner_Test;
+
+typedef struct
+{
+    const char *name;               /* JUnit suite name */
+    const char *title;
+    const Runner_Test *tests;
+    uint32_t count;
+    int (*boot)(void);              /* What main() does before the suite; 0 = failed */
+    void (*finish)(void);           /* Or 0 */
+} Runner_Suite;
+
+int Runner_Main(int argc, char **argv, const Runner_Suite *suite);
+
+#endif /* RUNNER_H_ */
@@ -0,0 +1,144 @@
+/*
+ * unit_tests.c
+ * The Control ECU unit suite (test_unit.c) on the host:
+ *
+ *   make unit_tests && ./unit_tests [-l] [-v] [-j report.xml] [filter ...]
+ *
+ * Boots as Control's main() does before its scheduler starts the suite,
+ * with UART2's TX looped back to its RX (the PD6-PD7 wire test 2 asks for).
+ * main()'s tasks are added and watched as there, but never run: on the
+ * board SelfTestTask holds the CPU for the whole suite.
+ */
+
+#include <stdint.h>
+#include "host.h"
+#include "runner.h"
+#include "uart.h"
+#include "systick.h"
+#include "eeprom.h"
+#include "buzzer.h"
+#include "pattern.h"
+#include "Servo.h"
+#include "password.h"
+#include "lockout.h"
+#include "auditlog.h"
+#include "door.h"
+#include "sched.h"
+#include "wdt.h"
+
+/* As main.c: a SELF_TEST build leaves the watchdog off */
+#ifndef WDT_ENABLE
+#define WDT_ENABLE  (!SELF_TEST)
+#endif
+
+/* test_unit.c */
+extern void Debug_UART0_Init(void);
+extern int UnitTest_EEPROM(void);
+extern int UnitTest_UART_Loopback(void);
+extern int UnitTest_GPIO_LED(void);
+extern int UnitTest_Buzzer(void);
+extern int UnitTest_Servo(void);
+extern int UnitTest_SHA256(void);
+extern int UnitTest_SettingsCommit(void);
+extern int UnitTest_LinkRate(void);
+extern int UnitTest_UART_FlowControl(void);
+extern int UnitTest_BusPolling(void);
+extern int UnitTest_Doors(void);
+extern int UnitTest_DIO(void);
+extern int UnitTest_FrameParser(void);
+extern int UnitTest_BootTimeline(void);
+extern int UnitTest_StackHighWater(void);
+extern int UnitTest_Watchdog(void);
+extern int UnitTest_AuditLog(void);
+extern int UnitTest_Scheduler(void);
+extern int UnitTest_LegacyPassword(void);
+
+static const Runner_Test tests[] =
+{
+    { "1. EEPROM Read/Write",               UnitTest_EEPROM,            0 },
+    { "2. UART Driver Loopback",            UnitTest_UART_Loopback,     0 },
+    { "3. GPIO Register Logic",             UnitTest_GPIO_LED,          0 },
+    { "4. Buzzer Actuation",                UnitTest_Buzzer,            0 },
+    { "5. Servo Movement",                  UnitTest_Servo,             0 },
+    { "6. SHA-256 / Password Hash",         UnitTest_SHA256,            0 },
+    { "7. Atomic Settings Commit",          UnitTest_SettingsCommit,    0 },
+    { "8. CRC-16 / Baud Divisors",          UnitTest_LinkRate,          0 },
+    { "9. UART Ring / XON-XOFF",            UnitTest_UART_FlowControl,  0 },
+    { "10. RS-485 Bus Polling",             UnitTest_BusPolling,        0 },
+    { "11. Door State Machines",            UnitTest_Doors,             0 },
+    { "12. DIO Masked Access / Edge IRQ",   UnitTest_DIO,               0 },
+    { "13. Frame Parser / Cycle Count",     UnitTest_FrameParser,
+      "compares Cortex-M4 cycle counts; run it on the board" },
+    { "14. Boot Timeline",                  UnitTest_BootTimeline,
+      "times the boot on the chip, not under emulation; run it on the board" },
+    { "15. Stack High-Water Mark",          UnitTest_StackHighWater,
+      "reads the paint ResetISR leaves on the board's stack; run it on the board" },
+    { "16. Watchdog Check-ins / Record",    UnitTest_Watchdog,          0 },
+    { "17. Audit Log Recovery / Dump",      UnitTest_AuditLog,          0 },
+    { "18. Scheduler Order / Timers",       UnitTest_Scheduler,         0 },
+    { "19. Plaintext Password Conversion",  UnitTest_LegacyPassword,    0 }
+};
+
+/* Stands in for CommTask, DoorTask and AuditTask */
+static void Starved(const Sched_Event *event)
+{
+    (void)event;
+}
+
+static int Boot(void)
+{
+    uint8_t comm_task;
+    uint8_t door_task;
+    uint8_t audit_task;
+
+    Host_Uart2_Connect(HOST_LINK_WIRE, -1);
+    (void)Wdt_Init();
+
+    SysTick_Init(SYSTICK_RELOAD_1MS, SYSTICK_INT);
+    Buzzer_Init();
+    Pattern_Init();
+    Servo_Init();
+    UART2_Init();
+    if(EEPROM_Init() != EEPROM_SUCCESS || Password_Init() != PASSWORD_SUCCESS ||
+       Lockout_Init() != LOCKOUT_SUCCESS)
+    {
+        return 0;
+    }
+    AuditLog_Init();
+    Door_Init();
+
+    /* Priorities and deadlines of main.c */
+    Sched_Init();
+    comm_task = Sched_AddTask(Starved, SCHED_PRIORITY_HIGH, 1U);
+    door_task = Sched_AddTask(Starved, SCHED_PRIORITY_NORMAL, DOOR_FRAME_MS);
+    audit_task = Sched_AddTask(Starved, SCHED_PRIORITY_LOW, 100U);
+#if WDT_ENABLE
+    Wdt_Watch(comm_task, 250U);
+    Wdt_Watch(door_task, 250U);
+    Wdt_Watch(audit_task, 1000U);
+#else
+    (void)comm_task;
+    (void)door_task;
+    (void)audit_task;
+#endif
+
+    /* Run_Unit_Tests() from here */
+    Debug_UART0_Init();
+    UART2_Init();
+    return 1;
+}
+
+static const Runner_Suite suite =
+{
+    "control.unit",
+    "CONTROL ECU UNIT TESTS",
+    tests,
+    sizeof(tests) / sizeof(tests[0]),
+    Boot,
+    0
+};
+
+int main(int argc, char **argv)
+{
+    return Runner_Main(argc, argv, &suite);
+}
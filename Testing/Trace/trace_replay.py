@@ -0,0 +1,301 @@
+#!/usr/bin/env python3
+"""Reads link trace dumps (trace.c, TRACE_ENABLE builds) and measures
+command latency, or replays the captured requests against a target.
+
+Capture: build with TRACE_ENABLE=1, open UART0 (the debugger's virtual COM
+port, 115200 8N1) in a terminal that logs to a file, exercise the system,
+then send 'D'. The log can hold dumps from one or both ECUs.
+
+    trace_replay.py report capture.log
+        Latency per command from the recorded timing.
+
+    trace_replay.py replay capture.log --serial COM5
+    trace_replay.py replay capture.log --exec "./control_sim"
+        Sends the recorded requests to Control with the recorded spacing,
+        times the replies and compares them with the capture. --serial
+        needs pyserial; --exec runs any program that speaks the link
+        protocol on stdin/stdout (a simulated Control build). Exits with 1
+        if a command's mean latency grew by more than --tolerance percent.
+
+Requests are the lines the HMI sent: RX in a CONTROL dump, TX in an HMI
+dump. A reply is matched by its "@SS " sequence prefix, or for unprefixed
+requests by being the next line back. CLOSE, HOLD and the lockout alarm
+(L) have no reply and are counted but not timed.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+import threading
+import time
+from collections import OrderedDict, defaultdict
+
+HEADER = re.compile(r"^TRACE (\S+) (\d+) (\d+)\s*$")
+ENTRY = re.compile(r"^(\d+) ([RTE]) ([0-9A-F]{2})\s*$")
+SEQ = re.compile(r"^(#[0-9A-F]{2})?(@[0-9A-F]{2} )")
+BUS_ONLY = re.compile(r"^#[0-9A-F]{2}\??$")   # RS-485 poll, or a panel with nothing to say
+NO_REPLY = ("CLOSE", "HOLD", "L")
+XON_XOFF = (0x11, 0x13)
+
+
+class Line:
+    def __init__(self, start, end, text, error=False):
+        self.start = start      # Microseconds, first byte
+        self.end = end          # Microseconds, the '\n'
+        self.text = text
+        self.error = error      # A byte had a UART error
+
+
+def read_dumps(path):
+    """Returns {name: [(micros, kind, byte)]}; a later dump of the same ECU
+    is appended, its times continuing from the earlier one."""
+    dumps = OrderedDict()
+    current = None
+    with open(path, "r", errors="replace") as f:
+        for raw in f:
+            raw = raw.strip("\r\n")
+            m = HEADER.match(raw)
+            if m:
+                current = dumps.setdefault(m.group(1), [])
+                if int(m.group(3)):
+                    print("warning: %s dump lost %s bytes" % (m.group(1), m.group(3)), file=sys.stderr)
+                continue
+            if raw.strip() == "END":
+                current = None
+                continue
+            m = ENTRY.match(raw)
+            if m and current is not None:
+                current.append((int(m.group(1)), m.group(2), int(m.group(3), 16)))
+    return dumps
+
+
+def unwrap(times):
+    """SysTick_GetMicros wraps at 2^32 us (about 71 minutes)."""
+    out, offset, last = [], 0, None
+    for t in times:
+        if last is not None and t + offset < last - (1 << 31):
+            offset += 1 << 32
+        last = t + offset
+        out.append(last)
+    return out
+
+
+def split_lines(entries, sent, requests):
+    """Lines in one direction: sent=True for T, False for R/E. In the
+    request direction an 'L' between lines is the lockout byte."""
+    lines, buf, start, error = [], [], None, False
+    picked = [e for e in entries if (e[1] == "T") == sent]
+    times = unwrap([e[0] for e in picked])
+    for t, (_, kind, byte) in zip(times, picked):
+        if byte in XON_XOFF:
+            continue
+        if requests and not buf and byte == 0x4C:
+            lines.append(Line(t, t, "L"))
+            continue
+        if start is None:
+            start = t
+        error = error or kind == "E"
+        if byte == 0x0A:
+            lines.append(Line(start, t, bytes(buf).decode("latin-1"), error))
+            buf, start, error = [], None, False
+        else:
+            buf.append(byte)
+    return lines
+
+
+def command_name(text):
+    body = SEQ.sub("", text)
+    body = re.sub(r"^D[1-9]/", "", body)
+    m = re.match(r"^[A-Z?]+:?", body)
+    return m.group(0) if m else (body[:8] or "(empty)")
+
+
+def expects_reply(text):
+    return command_name(text) not in NO_REPLY
+
+
+def pair(requests, replies):
+    """[(request, reply or None)] in request order."""
+    pairs, used = [], set()
+    for req in requests:
+        m = SEQ.match(req.text)
+        found = None
+        for j, rep in enumerate(replies):
+            if j in used or rep.start < req.end:
+                continue
+            if m:
+                if rep.text.startswith(m.group(0)):
+                    found = j
+                    break
+            elif not SEQ.match(rep.text):
+                found = j
+                break
+        if found is not None and expects_reply(req.text):
+            used.add(found)
+            pairs.append((req, replies[found]))
+        else:
+            pairs.append((req, None))
+    return pairs
+
+
+def capture(path):
+    """Request/reply pairs from the log, seen from the Control side when
+    there is a CONTROL dump (no link time in the latency)."""
+    dumps = read_dumps(path)
+    if not dumps:
+        sys.exit("no TRACE dump in %s" % path)
+    name = "CONTROL" if "CONTROL" in dumps else next(iter(dumps))
+    entries = dumps[name]
+    control_side = (name != "HMI")
+    requests = [r for r in split_lines(entries, not control_side, True) if not BUS_ONLY.match(r.text)]
+    replies = [r for r in split_lines(entries, control_side, False) if not BUS_ONLY.match(r.text)]
+    return name, pair(requests, replies)
+
+
+def stats(pairs):
+    table = defaultdict(list)
+    counts = defaultdict(int)
+    for req, rep in pairs:
+        name = command_name(req.text)
+        counts[name] += 1
+        if rep is not None:
+            table[name].append(rep.start - req.end)
+    return counts, table
+
+
+def summary(values):
+    if not values:
+        return None
+    values = sorted(values)
+    return {
+        "min": values[0],
+        "mean": sum(values) / len(values),
+        "p95": values[min(len(values) - 1, int(0.95 * len(values)))],
+        "max": values[-1],
+    }
+
+
+def print_table(title, counts, table, baseline=None):
+    print(title)
+    head = "%-12s %6s %10s %10s %10s %10s" % ("command", "count", "min us", "mean us", "p95 us", "max us")
+    if baseline is not None:
+        head += " %10s" % "vs capture"
+    print(head)
+    for name in sorted(counts):
+        s = summary(table.get(name, []))
+        if s is None:
+            print("%-12s %6d %10s" % (name, counts[name], "-"))
+            continue
+        row = "%-12s %6d %10d %10d %10d %10d" % (name, counts[name], s["min"], s["mean"], s["p95"], s["max"])
+        if baseline is not None:
+            b = summary(baseline.get(name, []))
+            row += " %+9.1f%%" % (100.0 * (s["mean"] - b["mean"]) / b["mean"]) if b and b["mean"] else " %10s" % "-"
+        print(row)
+
+
+class ExecTarget:
+    def __init__(self, command):
+        self.proc = subprocess.Popen(command, shell=True, stdin=subprocess.PIPE, stdout=subprocess.PIPE, bufsize=0)
+
+    def write(self, data):
+        self.proc.stdin.write(data)
+        self.proc.stdin.flush()
+
+    def readline(self):
+        return self.proc.stdout.readline()
+
+    def close(self):
+        self.proc.kill()
+
+
+class SerialTarget:
+    def __init__(self, spec):
+        import serial  # pyserial, only needed here
+        port, _, baud = spec.partition(":")
+        self.port = serial.Serial(port, int(baud or 115200), timeout=0.05)
+
+    def write(self, data):
+        self.port.write(data)
+
+    def readline(self):
+        return self.port.readline()
+
+    def close(self):
+        self.port.close()
+
+
+def replay(target, pairs, timeout_s):
+    """Sends each recorded request at its recorded offset and returns new
+    request/reply pairs timed on the host clock."""
+    replies, lock = [], threading.Lock()
+    done = threading.Event()
+
+    def reader():
+        while not done.is_set():
+            raw = target.readline()
+            if raw:
+                now = int(time.perf_counter() * 1e6)
+                with lock:
+                    replies.append(Line(now, now, raw.decode("latin-1").rstrip("\r\n")))
+
+    thread = threading.Thread(target=reader, daemon=True)
+    thread.start()
+
+    sent = []
+    origin_rec = pairs[0][0].start if pairs else 0
+    origin_host = time.perf_counter()
+    for req, _ in pairs:
+        delay = (req.start - origin_rec) / 1e6 - (time.perf_counter() - origin_host)
+        if delay > 0:
+            time.sleep(delay)
+        target.write(req.text.encode("latin-1") + b"\n")
+        now = int(time.perf_counter() * 1e6)
+        sent.append(Line(now, now, req.text))
+
+    time.sleep(timeout_s)
+    done.set()
+    target.close()
+    with lock:
+        return pair(sent, list(replies))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="mode", required=True)
+    rep = sub.add_parser("report", help="latency per command from a capture")
+    rep.add_argument("capture")
+    rpl = sub.add_parser("replay", help="replay a capture against a target")
+    rpl.add_argument("capture")
+    where = rpl.add_mutually_exclusive_group(required=True)
+    where.add_argument("--serial", metavar="PORT[:BAUD]")
+    where.add_argument("--exec", metavar="COMMAND")
+    rpl.add_argument("--tolerance", type=float, default=20.0, help="allowed mean latency growth, percent")
+    rpl.add_argument("--wait", type=float, default=1.0, help="seconds to wait for the last replies")
+    args = parser.parse_args()
+
+    name, pairs = capture(args.capture)
+    counts, recorded = stats(pairs)
+    print_table("Recorded (%s side, %d requests)" % (name, len(pairs)), counts, recorded)
+    if args.mode == "report":
+        return 0
+
+    target = SerialTarget(args.serial) if args.serial else ExecTarget(args.exec)
+    new_counts, measured = stats(replay(target, pairs, args.wait))
+    print()
+    print_table("Replayed", new_counts, measured, baseline=recorded)
+
+    failed = []
+    for cmd, values in recorded.items():
+        before, after = summary(values), summary(measured.get(cmd, []))
+        if after is None:
+            failed.append("%s no reply" % cmd)
+        elif before["mean"] and after["mean"] > before["mean"] * (1.0 + args.tolerance / 100.0):
+            failed.append("%s mean %d us, was %d us" % (cmd, after["mean"], before["mean"]))
+    for line in failed:
+        print("REGRESSION " + line)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
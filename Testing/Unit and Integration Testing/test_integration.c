@@ -1,8 +1,23 @@
 #include <stdint.h>
 #include <string.h>
-#include <stdio.h>
+#include <stdlib.h>
 #include "tm4c123gh6pm.h"
 #include "uart.h" 
+#include "hmi_fsm.h"
+#include "link.h"
+#include "dio.h"
+#include "systick.h"
+#include "fmt.h"
+#include "stack.h"
+#include "sched.h"
+
+/* Built into the image only with SELF_TEST=1 (see main.c); Testing/Host runs
+   these tests on a PC */
+#ifndef SELF_TEST
+#define SELF_TEST 0
+#endif
+
+#if SELF_TEST
 
 /* --- LCD EXTERNS (Must match your LCD driver) --- */
 extern void LCD_Clear(void);
@@ -15,11 +30,13 @@ void Debug_UART0_Init(void) {
     SYSCTL_RCGCUART_R |= 0x01;            // Enable UART0
     SYSCTL_RCGCGPIO_R |= 0x01;            // Enable Port A
     volatile int delay = SYSCTL_RCGCGPIO_R; 
+    (void)delay;                          // Only the read matters: clock settling
     
-    GPIO_PORTA_AFSEL_R |= 0x03;           // PA0, PA1 Alt Function
-    GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R & 0xFFFFFF00) | 0x00000011; 
-    GPIO_PORTA_DEN_R |= 0x03;             // Digital Enable
-    GPIO_PORTA_AMSEL_R &= ~0x03;          // Disable Analog
+    // Port A is the keypad's: reach it through dio.h (AHB in DIO_USE_AHB builds)
+    DIO_PORT_REG(PORTA, DIO_OFFSET_AFSEL) |= 0x03;   // PA0, PA1 Alt Function
+    DIO_PORT_REG(PORTA, DIO_OFFSET_PCTL) = (DIO_PORT_REG(PORTA, DIO_OFFSET_PCTL) & 0xFFFFFF00) | 0x00000011; 
+    DIO_PORT_REG(PORTA, DIO_OFFSET_DEN) |= 0x03;     // Digital Enable
+    DIO_PORT_REG(PORTA, DIO_OFFSET_AMSEL) &= ~0x03;  // Disable Analog
 
     UART0_CTL_R &= ~0x01;                 // Disable UART0
     UART0_IBRD_R = 8;                     // 115200 baud @ 16MHz
@@ -52,8 +69,8 @@ void Test_Receive(char* buffer) {
     
     Debug_Log("Waiting"); 
     while(timeout < 30) { // Increased timeout to 3 seconds
-        if((UART2_FR_R & 0x10) == 0) { // If RX FIFO not empty
-            char c = (char)(UART2_DR_R & 0xFF);
+        if(UART2_Available()) { // UART2_Handler has buffered a character
+            char c = UART2_ReadChar();
             if(c == '\n') {
                 buffer[i] = '\0';
                 Debug_Log(" -> Recv: ");
@@ -113,7 +130,8 @@ int Test_Access_Denied(void) {
     UART2_SendString("99999");
     UART2_SendChar('\n');
     Test_Receive(response);
-    return (strcmp(response, "DENY") == 0);
+    // Control appends the lockout time it enforces: "DENY:<seconds>"
+    return (strncmp(response, "DENY", 4) == 0);
 }
 
 /* FIXED LOCKOUT TEST */
@@ -136,10 +154,12 @@ int Test_Lockout_Sequence(void) {
     UART2_SendString("VERIFY:88888\n");
     Test_Receive(response);
     
-    // 4. TRIGGER LOCKOUT MANUALLY
-    // Since the HMI Logic (in main.c) usually handles the counting,
-    // the Test Suite must manually send the 'L' command to prove
-    // the Control Board's Buzzer works.
+    // Control now owns the failure counter: the third failure must open a
+    // lockout window and report it as "DENY:<seconds>"
+    int locked = (strncmp(response, "DENY:", 5) == 0 && atoi(response + 5) > 0);
+    
+    // 4. TRIGGER LOCKOUT ALARM
+    // The 'L' command still drives the Control board's buzzer.
     Debug_Log("Sending 'L' Command (Trigger Buzzer)...\r\n");
     UART2_SendChar('L'); 
     
@@ -147,8 +167,7 @@ int Test_Lockout_Sequence(void) {
     delayMs(2000); 
     
     // Note: Control board does not reply to 'L', it just acts.
-    // So we just return 1 (PASS) assuming you heard the beep.
-    return 1; 
+    return locked; 
 }
 // TEST 6: TIMEOUT CONFIGURATION
 // Simulates user selecting a value (e.g., 20s) and saving it.
@@ -167,6 +186,14 @@ int Test_Timeout_Setting(void) {
     
     Test_Receive(response);
     
+    // The lockout test left a backoff window open: wait it out and retry
+    if (strncmp(response, "AUTH_FAILED:", 12) == 0 && atoi(response + 12) > 0) {
+        Debug_Log("   -> Locked out, waiting...\r\n");
+        delayMs((atoi(response + 12) * 1000) + 100);
+        UART2_SendString("VERIFYPWD:12345\n");
+        Test_Receive(response);
+    }
+    
     // If authentication fails, the test fails
     if (strcmp(response, "AUTH_OK") != 0) {
         Debug_Log("   -> Auth Failed!\r\n");
@@ -188,6 +215,58 @@ int Test_Timeout_Setting(void) {
     // STEP 3: Verify Save Confirmation
     return (strcmp(response, "TIMEOUT_SAVED") == 0);
 }
+/* Two sequenced requests in one write; Control answers each under its own ID */
+int Test_Pipelined_Requests(void) {
+    char reply1[20];
+    char reply2[20];
+
+    Debug_Log("--- PIPELINED REQUEST TEST ---\r\n");
+    UART2_SendString("@21 VERIFYPWD:12345\n@22 TIMEOUT:20\n");
+
+    Test_Receive(reply1);
+    Test_Receive(reply2);
+    return (strcmp(reply1, "@21 AUTH_OK") == 0 && strcmp(reply2, "@22 TIMEOUT_SAVED") == 0);
+}
+
+/* Credential plus setting in one frame, applied with one EEPROM write */
+int Test_Config_Command(void) {
+    char reply[20];
+
+    Debug_Log("--- CFG COMMAND TEST ---\r\n");
+    UART2_SendString("@31 CFG:12345;TMO=20\n");
+
+    Test_Receive(reply);
+    return (strcmp(reply, "@31 CFG_OK") == 0);
+}
+
+/* Negotiated rate carries a request; after a fallback 115200 still does */
+int Test_Link_Rate(void) {
+    char reply[20];
+    char rate[24];
+    int ok;
+
+    Debug_Log("--- LINK RATE TEST ---\r\n");
+    {
+        Fmt_Buffer out;
+        Fmt_Begin(&out, rate, sizeof(rate));
+        Fmt_String(&out, "Rate: ");
+        Fmt_Uint(&out, Link_Negotiate());
+        Fmt_String(&out, "\r\n");
+    }
+    Debug_Log(rate);
+
+    UART2_SendString("@41 VERIFYPWD:12345\n");
+    Test_Receive(reply);
+    ok = (strcmp(reply, "@41 AUTH_OK") == 0);
+
+    Link_FallBack();
+    DelayMs(LINK_SWITCH_DELAY_MS);
+    Link_Poll();
+    UART2_SendString("@42 VERIFYPWD:12345\n");
+    Test_Receive(reply);
+    return ok && (strcmp(reply, "@42 AUTH_OK") == 0) && (UART2_GetBaud() == UART2_BAUD_DEFAULT);
+}
+
 int Test_LCD_Screen(void) {
     Debug_Log("--- LCD VISUAL TEST ---\r\n");
     
@@ -208,9 +287,335 @@ int Test_LCD_Screen(void) {
     return 1;
 }
 
+/* --- HMI STATE MACHINE (no hardware: runs against a fake platform) --- */
+static char fake_lcd[2][17];
+static char fake_request[HMI_REQUEST_SIZE];
+static uint8_t fake_seq;
+static uint32_t fake_timer_tag;
+static int fake_alarms;
+
+static void Fake_Clear(void) {
+    memset(fake_lcd, ' ', sizeof(fake_lcd));
+    fake_lcd[0][16] = '\0';
+    fake_lcd[1][16] = '\0';
+}
+static void Fake_Put(uint8_t row, uint8_t col, const char *text) {
+    while (*text && col < 16) fake_lcd[row - 1][col++] = *text++;
+}
+static uint8_t Fake_Request(const char *command) { strcpy(fake_request, command); return ++fake_seq; }
+static void Fake_Send(const char *command) { strcpy(fake_request, command); }
+static void Fake_Alarm(void) { fake_alarms++; }
+static void Fake_Led(uint8_t led, uint8_t on) { (void)led; (void)on; }
+static uint8_t Fake_StartTimer(uint32_t ms, uint32_t tag) { (void)ms; fake_timer_tag = tag; return 1; }
+static uint8_t Fake_SchedTimer(uint32_t ms, uint32_t tag) {
+    uint8_t timer = Sched_StartTimer(SCHED_INVALID, SCHED_EVENT_USER, ms, 0);
+    fake_timer_tag = tag;
+    if (timer == SCHED_INVALID) return 0;
+    Sched_StopTimer(timer);
+    return 1;
+}
+static uint32_t Fake_ReadPot(void) { return HMI_POT_FULL_SCALE; }
+
+static const Hmi_Platform fake_platform = {
+    Fake_Clear, Fake_Put, Fake_Request, Fake_Send,
+    Fake_Alarm, Fake_Led, Fake_StartTimer, Fake_ReadPot
+};
+
+// Same, but timers come from the scheduler's table
+static const Hmi_Platform sched_platform = {
+    Fake_Clear, Fake_Put, Fake_Request, Fake_Send,
+    Fake_Alarm, Fake_Led, Fake_SchedTimer, Fake_ReadPot
+};
+
+static void Fake_Keys(Hmi_Fsm *fsm, const char *keys) {
+    while (*keys) Hmi_Fsm_HandleKey(fsm, *keys++);
+}
+static void Fake_TimerExpires(Hmi_Fsm *fsm) {
+    Hmi_Event ev = { HMI_EV_TIMER, 0, 0, 0, 0 };
+    ev.value = fake_timer_tag;
+    Hmi_Fsm_Dispatch(fsm, &ev);
+}
+
+int Test_Hmi_StateMachine(void) {
+    Hmi_Fsm fsm;
+    int ok = 1;
+    int tick;
+
+    Debug_Log("--- HMI STATE MACHINE TEST ---\r\n");
+    fake_alarms = 0;
+    Hmi_Fsm_Init(&fsm, &fake_platform);
+
+    // Create + confirm, '*' erases one digit
+    Fake_Keys(&fsm, "12349*5#12345#");
+    ok &= (strcmp(fake_request, "SETPWD:12345") == 0);
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "PWD_SAVED");
+    ok &= (fsm.state == HMI_STATE_MESSAGE);
+    Fake_TimerExpires(&fsm);
+    ok &= (fsm.state == HMI_STATE_MENU);
+
+    // Incomplete entry is ignored; two wrong passwords, then Control locks
+    Fake_Keys(&fsm, "A123#");
+    ok &= (fsm.state == HMI_STATE_OPEN_PWD);
+    Fake_Keys(&fsm, "45#");
+    ok &= (strcmp(fake_request, "VERIFY:12345") == 0);
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "DENY:0");
+    Fake_TimerExpires(&fsm);
+    ok &= (fsm.state == HMI_STATE_OPEN_PWD);
+    Fake_Keys(&fsm, "99999#");
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "DENY:40");
+    ok &= (fake_alarms == 1 && fsm.locked == 1);
+    ok &= (strncmp(fake_lcd[1], "Retry in 40s", 12) == 0);
+    Fake_TimerExpires(&fsm);
+    Fake_Keys(&fsm, "B");
+    ok &= (fsm.state == HMI_STATE_LOCKED_NOTICE);
+    Fake_Keys(&fsm, "*");
+    ok &= (fsm.state == HMI_STATE_MENU && fsm.locked == 0);
+
+    // Timeout: pot at full scale gives 30 s. Credential and value travel in
+    // one CFG frame; a reply to any other request is ignored.
+    Fake_Keys(&fsm, "C#12345#");
+    ok &= (strcmp(fake_request, "CFG:12345;TMO=30") == 0 && fsm.state == HMI_STATE_TMO_SAVING);
+    Hmi_Fsm_HandleReply(&fsm, (uint8_t)(fake_seq - 1U), "CFG_OK");
+    ok &= (fsm.state == HMI_STATE_TMO_SAVING && fsm.auto_lock_timeout != 30);
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "CFG_OK");
+    ok &= (fsm.auto_lock_timeout == 30);
+    Fake_TimerExpires(&fsm);
+
+    // Door opens, and a stale timer tag does not close it early
+    Fake_Keys(&fsm, "A12345#");
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "ALLOW");
+    ok &= (fsm.state == HMI_STATE_DOOR_OPEN);
+    {
+        Hmi_Event stale = { HMI_EV_TIMER, 0, 0, 0, 0 };
+        stale.value = fake_timer_tag - 1U;
+        Hmi_Fsm_Dispatch(&fsm, &stale);
+    }
+    ok &= (fsm.state == HMI_STATE_DOOR_OPEN);
+    ok &= (strncmp(fake_lcd[1], "Closing in 30s", 14) == 0);
+
+    // Countdown redraws each second, '*' extends, '#' re-locks at once
+    Fake_TimerExpires(&fsm);
+    ok &= (strncmp(fake_lcd[1], "Closing in 29s", 14) == 0);
+    Fake_Keys(&fsm, "*");
+    ok &= (fsm.door_remaining == 59 && strncmp(fake_lcd[1], "Closing in 59s", 14) == 0);
+    ok &= (strcmp(fake_request, "HOLD") == 0);
+    Fake_Keys(&fsm, "#");
+    ok &= (strcmp(fake_request, "CLOSE") == 0 && fsm.state == HMI_STATE_MENU);
+
+    // Left alone, the door closes after auto_lock_timeout ticks
+    Fake_Keys(&fsm, "A12345#");
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "ALLOW");
+    for (tick = 1; tick < 30; tick++) Fake_TimerExpires(&fsm);
+    ok &= (fsm.state == HMI_STATE_DOOR_OPEN && strncmp(fake_lcd[1], "Closing in 1s ", 14) == 0);
+    Fake_TimerExpires(&fsm);
+    ok &= (strcmp(fake_request, "CLOSE") == 0 && fsm.state == HMI_STATE_MENU);
+
+    // Reset: new password and default timeout in a single frame
+    Fake_Keys(&fsm, "D12345#11111#11111#");
+    ok &= (strcmp(fake_request, "CFG:12345;PWD=11111;TMO=10") == 0);
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "CFG_OK");
+    ok &= (strcmp(fsm.pass, "11111") == 0 && fsm.auto_lock_timeout == 10);
+
+    // Every scheduler timer taken: a screen that cannot arm its timer moves
+    // on at once instead of waiting for an event that never comes
+    {
+        uint8_t fillers[SCHED_MAX_TIMERS];
+        uint8_t taken = 0;
+
+        while (taken < SCHED_MAX_TIMERS) {
+            fillers[taken] = Sched_StartTimer(SCHED_INVALID, SCHED_EVENT_USER, 60000U, 0);
+            if (fillers[taken] == SCHED_INVALID) break;
+            taken++;
+        }
+        ok &= (Sched_StartTimer(SCHED_INVALID, SCHED_EVENT_USER, 60000U, 0) == SCHED_INVALID);
+
+        Hmi_Fsm_Init(&fsm, &sched_platform);
+        Fake_Keys(&fsm, "12345#12345#");
+        Hmi_Fsm_HandleReply(&fsm, fake_seq, "PWD_SAVED");
+        ok &= (fsm.state == HMI_STATE_MENU);
+        Fake_Keys(&fsm, "A12345#");
+        Hmi_Fsm_HandleReply(&fsm, fake_seq, "ALLOW");
+        ok &= (strcmp(fake_request, "CLOSE") == 0 && fsm.state == HMI_STATE_MENU);
+
+        while (taken > 0) Sched_StopTimer(fillers[--taken]);
+    }
+
+    return ok;
+}
+
+
+/* --- TEST 11: GPIO APERTURE TOGGLE RATE --- */
+// Toggles PF2 (blue LED, unused by the HMI) through the legacy APB
+// aperture and then through AHB, switching port F over just for the
+// run. Passes if AHB is no slower; the rates are logged for comparison.
+#define TOGGLE_PAIRS    50000U
+
+static uint32_t Toggle_Ms(uint32_t port_base) {
+    volatile uint32_t *pin = (volatile uint32_t *)(port_base + (0x04U << 2)); // PF2 only
+    uint32_t start;
+    uint32_t i;
+
+    start = SysTick_GetTicks();
+    while (SysTick_GetTicks() == start);                // Start on a tick edge
+    start = SysTick_GetTicks();
+    for (i = 0; i < TOGGLE_PAIRS; i++) {
+        *pin = 0x04U; *pin = 0U;
+        *pin = 0x04U; *pin = 0U;
+    }
+    return SysTick_GetTicks() - start;
+}
+
+int Test_Gpio_Aperture(void) {
+    uint32_t hbctl = SYSCTL_GPIOHBCTL_R;
+    uint32_t apb_ms, ahb_ms;
+    char line[64];
+    Fmt_Buffer out;
+
+    Debug_Log("--- GPIO APERTURE BENCHMARK ---\r\n");
+    DIO_Init(PORTF, PIN2, OUTPUT);
+
+    SYSCTL_GPIOHBCTL_R = hbctl & ~SYSCTL_GPIOHBCTL_PORTF;
+    apb_ms = Toggle_Ms(DIO_APB_BASE(PORTF));
+    SYSCTL_GPIOHBCTL_R = hbctl | SYSCTL_GPIOHBCTL_PORTF;
+    ahb_ms = Toggle_Ms(DIO_AHB_BASE(PORTF));
+    SYSCTL_GPIOHBCTL_R = hbctl;                         // Port F back as DIO expects it
+
+    Fmt_Begin(&out, line, sizeof(line));
+    Fmt_String(&out, "APB: ");
+    Fmt_Uint(&out, (4U * TOGGLE_PAIRS) / (apb_ms ? apb_ms : 1U));
+    Fmt_String(&out, " toggles/ms, AHB: ");
+    Fmt_Uint(&out, (4U * TOGGLE_PAIRS) / (ahb_ms ? ahb_ms : 1U));
+    Fmt_String(&out, " toggles/ms\r\n");
+    Debug_Log(line);
+    return (ahb_ms <= apb_ms);
+}
+
+
+/* --- TEST 12: LINK HEARTBEAT --- */
+// Control answers a beat with its uptime, and a beat from a restarted
+// panel (uptime gone backwards) ends that panel's authorization. The HMI
+// side stays online and times the round trips; on the menu, the link
+// going down shows the offline screen and coming back returns to the
+// screen the flow belongs on.
+#define HEARTBEAT_SAMPLES   4U
+
+int Test_Link_Heartbeat(void) {
+    char reply[20];
+    char line[64];
+    Fmt_Buffer out;
+    Link_Stats stats;
+    Hmi_Fsm fsm;
+    Hmi_Event ev = { HMI_EV_LINK_DOWN, 0, 0, 0, 0 };
+    uint32_t start;
+    int ok;
+
+    Debug_Log("--- LINK HEARTBEAT TEST ---\r\n");
+    UART2_SendString("@51 HB:60000\n");
+    Test_Receive(reply);
+    ok = (strncmp(reply, "@51 HB:", 7) == 0);
+    UART2_SendString("@52 VERIFYPWD:12345\n");
+    Test_Receive(reply);
+    ok &= (strcmp(reply, "@52 AUTH_OK") == 0);
+    UART2_SendString("@53 HB:5\n");
+    Test_Receive(reply);
+    UART2_SendString("@54 TIMEOUT:20\n");
+    Test_Receive(reply);
+    ok &= (strcmp(reply, "@54 TIMEOUT_DENIED") == 0);
+
+    Link_Init(0);
+    start = SysTick_GetTicks();
+    do {
+        uint32_t sent = SysTick_GetTicks();
+
+        Link_Heartbeat();
+        Link_GetStats(&stats);
+        while (stats.answered < stats.beats && (SysTick_GetTicks() - sent) < LINK_HEARTBEAT_MS) {
+            Link_Poll();
+            Link_GetStats(&stats);
+        }
+    } while (stats.answered < HEARTBEAT_SAMPLES && (SysTick_GetTicks() - start) < 2000U);
+
+    Fmt_Begin(&out, line, sizeof(line));
+    Fmt_String(&out, "RTT us: ");
+    Fmt_Uint(&out, stats.rtt_min_us);
+    Fmt_Char(&out, '/');
+    Fmt_Uint(&out, stats.rtt_mean_us);
+    Fmt_Char(&out, '/');
+    Fmt_Uint(&out, stats.rtt_max_us);
+    Fmt_String(&out, ", jitter ");
+    Fmt_Uint(&out, stats.jitter_us);
+    Fmt_String(&out, "\r\n");
+    Debug_Log(line);
+    ok &= (stats.answered >= HEARTBEAT_SAMPLES && Link_IsOnline() && stats.reconnects == 0U);
+    ok &= (stats.rtt_min_us <= stats.rtt_mean_us && stats.rtt_mean_us <= stats.rtt_max_us);
+
+    // Password creation is resumed, not skipped; the menu is returned to
+    Hmi_Fsm_Init(&fsm, &fake_platform);
+    Fake_Keys(&fsm, "123");
+    Hmi_Fsm_Dispatch(&fsm, &ev);
+    ok &= (fsm.state == HMI_STATE_OFFLINE && strncmp(fake_lcd[0], "Control Offline", 15) == 0);
+    Hmi_Fsm_Dispatch(&fsm, &ev);
+    ev.id = HMI_EV_LINK_UP;
+    Hmi_Fsm_Dispatch(&fsm, &ev);
+    ok &= (fsm.state == HMI_STATE_CREATE && fsm.entry_len == 0);
+    Fake_Keys(&fsm, "12345#12345#");
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "PWD_SAVED");
+    Fake_TimerExpires(&fsm);
+    Fake_Keys(&fsm, "A12");
+    ev.id = HMI_EV_LINK_UP;                 // Control restarted unnoticed
+    Hmi_Fsm_Dispatch(&fsm, &ev);
+    ok &= (fsm.state == HMI_STATE_MENU);
+
+    return ok;
+}
+
+
+/* STATS? one field at a time, and the service page reading it */
+int Test_Runtime_Stats(void) {
+    char reply[40];
+    Hmi_Fsm fsm;
+    int ok;
+
+    Debug_Log("--- RUNTIME STATS TEST ---\r\n");
+    UART2_SendString("@61 STATS?0\n");
+    Test_Receive(reply);
+    Debug_Log(reply);
+    Debug_Log("\r\n");
+    ok = (strncmp(reply, "@61 UPTIME_S=", 13) == 0);
+    UART2_SendString("@62 STATS?3\n");
+    Test_Receive(reply);
+    ok &= (strncmp(reply, "@62 AUTH_OK=", 12) == 0 && atoi(reply + 12) > 0);
+    UART2_SendString("@63 STATS?99\n");
+    Test_Receive(reply);
+    ok &= (strcmp(reply, "@63 STATS_END") == 0);
+    UART2_SendString("@64 STATS?X\n");
+    Test_Receive(reply);
+    ok &= (strcmp(reply, "@64 STATS_ERROR") == 0);
+
+    Hmi_Fsm_Init(&fsm, &fake_platform);
+    Fake_Keys(&fsm, "12345#12345#");
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "PWD_SAVED");
+    Fake_TimerExpires(&fsm);
+    Fake_Keys(&fsm, "#");
+    ok &= (fsm.state == HMI_STATE_SERVICE && strcmp(fake_request, "STATS?0") == 0);
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "UPTIME_S=42");
+    ok &= (strncmp(fake_lcd[0], "UPTIME_S", 8) == 0 && strncmp(fake_lcd[1], "42", 2) == 0);
+    Fake_Keys(&fsm, "#");
+    ok &= (strcmp(fake_request, "STATS?1") == 0);
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "STATS_END");   // Past the last: start over
+    ok &= (fsm.state == HMI_STATE_SERVICE && strcmp(fake_request, "STATS?0") == 0);
+    Hmi_Fsm_HandleReply(&fsm, fake_seq, "UPTIME_S=43");
+    Fake_Keys(&fsm, "*");
+    ok &= (fsm.state == HMI_STATE_MENU);
+
+    return ok;
+}
 
 /* --- MAIN RUNNER --- */
 void Run_Integration_Tests(void) {
+    char line[40];
+    Fmt_Buffer out;
+
     Debug_UART0_Init();
     UART2_Init();
     
@@ -239,7 +644,39 @@ void Run_Integration_Tests(void) {
     delayMs(500);
     
     Log_Result("6. LCD Screen", Test_LCD_Screen());
+    delayMs(500);
+
+    Log_Result("7. HMI State Machine", Test_Hmi_StateMachine());
+    delayMs(500);
+
+    Log_Result("8. Pipelined Requests", Test_Pipelined_Requests());
+    delayMs(500);
+
+    Log_Result("9. CFG Command", Test_Config_Command());
+    delayMs(500);
+
+    Log_Result("10. Link Rate Negotiation", Test_Link_Rate());
+    delayMs(500);
+
+    Log_Result("11. GPIO Aperture Toggle Rate", Test_Gpio_Aperture());
+    delayMs(500);
+
+    Log_Result("12. Link Heartbeat", Test_Link_Heartbeat());
+    delayMs(500);
+
+    Log_Result("13. Runtime Stats", Test_Runtime_Stats());
+
+    // HMI's own high-water mark; Control's is STATS? field STACK_USED
+    Fmt_Begin(&out, line, sizeof(line));
+    Fmt_String(&out, "HMI stack: ");
+    Fmt_Uint(&out, Stack_GetUsed());
+    Fmt_String(&out, " of ");
+    Fmt_Uint(&out, Stack_GetSize());
+    Fmt_String(&out, " bytes\r\n");
+    Debug_Log(line);
     
     Debug_Log("--- ALL TESTS COMPLETE ---\r\n");
     while(1); 
-}
\ No newline at end of file
+}
+
+#endif /* SELF_TEST */
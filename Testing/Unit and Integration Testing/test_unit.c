@@ -1,18 +1,39 @@
 #include <stdint.h>
 #include <string.h>
-#include <stdio.h>
 #include "tm4c123gh6pm.h"
 #include "uart.h"   // Your UART driver
 #include "eeprom.h" // Your EEPROM driver
 #include "dio.h"    // Your GPIO/DIO driver
 #include "Servo.h"
 #include "buzzer.h"
+#include "pattern.h"
+#include "sha256.h"
+#include "password.h"
+#include "crc16.h"
+#include "bus.h"
+#include "door.h"
+#include "fmt.h"
+#include "frame.h"
+#include "boot.h"
+#include "stack.h"
+#include "sched.h"
+#include "wdt.h"
+#include "auditlog.h"
+
+/* Built into the image only with SELF_TEST=1 (see main.c); Testing/Host runs
+   these tests on a PC */
+#ifndef SELF_TEST
+#define SELF_TEST 0
+#endif
+
+#if SELF_TEST
 
 /* --- 1. SELF-CONTAINED LOGGER (UART0) --- */
 void Debug_UART0_Init(void) {
     SYSCTL_RCGCUART_R |= 0x01;
     SYSCTL_RCGCGPIO_R |= 0x01;
     volatile int delay = SYSCTL_RCGCGPIO_R; 
+    (void)delay;                          // Only the read matters: clock settling
     GPIO_PORTA_AFSEL_R |= 0x03;           
     GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R & 0xFFFFFF00) | 0x00000011; 
     GPIO_PORTA_DEN_R |= 0x03;             
@@ -66,7 +87,11 @@ int UnitTest_EEPROM(void) {
     
     // Debug info if failed
     char buf[30];
-    sprintf(buf, " (Got: %x)", read_val);
+    Fmt_Buffer out;
+    Fmt_Begin(&out, buf, sizeof(buf));
+    Fmt_String(&out, " (Got: ");
+    Fmt_Hex(&out, read_val, 8);
+    Fmt_Char(&out, ')');
     Debug_Log(buf);
     return 0; // FAIL
 }
@@ -78,21 +103,21 @@ int UnitTest_UART_Loopback(void) {
     char sent = 'X';
     char received = 0;
     
-    // 1. Clear any old data
-    while((UART2_FR_R & 0x10) == 0) { volatile int x = UART2_DR_R; }
+    // 1. Clear any old data (reception is buffered by UART2_Handler)
+    while(UART2_Available()) { (void)UART2_ReadChar(); }
     
     // 2. Send Character
     UART2_SendChar(sent);
     
     // 3. Wait for Receive (Short timeout)
     int timeout = 0;
-    while((UART2_FR_R & 0x10) != 0) { // While Empty
+    while(!UART2_Available()) { // While Empty
         timeout++;
         if(timeout > 100000) return 0; // FAIL: Timeout (Wire missing?)
     }
     
     // 4. Read Character
-    received = (char)(UART2_DR_R & 0xFF);
+    received = UART2_ReadChar();
     
     // 5. Verify
     if (received == sent) return 1; // PASS
@@ -123,39 +148,55 @@ int UnitTest_GPIO_LED(void) {
     return 0; // FAIL
 }
 int UnitTest_Buzzer(void) {
+    static const Pattern_Step beep[] = {
+        PATTERN_STEP(PATTERN_BUZZER, 1000U),
+        PATTERN_END
+    };
+    volatile uint32_t spin;
+    int pass = 1;
+
     Debug_Log("TEST 4: Buzzer Driver... Listen for beep.\r\n");
     
     // 1. Initialize
     Buzzer_Init();
+    Pattern_Init();
     
-    // 2. Turn ON
+    // 2. Turn ON: the pattern timer plays it, this code is free meanwhile
     Debug_Log("   -> Buzzer ON (1 sec)\r\n");
-    Buzzer_Beep(1000); 
+    Pattern_Play(0, beep);
+#if !BUZZER_PWM
+    if ((GPIO_PORTE_DATA_R & 0x10) == 0) pass = 0; // PE4 high at once
+#endif
     
-    // 3. Wait 1 second (Manual verification by ear) 
+    // 3. Wait 1 second (Manual verification by ear); bounded in case the
+    //    Timer1A interrupt never fires
+    for (spin = 0; spin < 8000000U && Pattern_IsPlaying(0); spin++);
     
-    // 4. Turn OFF
+    // 4. Turned OFF by the interrupt
     Debug_Log("   -> Buzzer OFF\r\n");
+    if (Pattern_IsPlaying(0)) {
+        Pattern_Stop(0);
+        pass = 0;
+    }
     
     // Since we can't programmatically "hear" the beep without a microphone,
-    // we assume pass if the code didn't crash.
-    // Ideally, you verify the GPIO pin state like we did in Test C.
-    if ((GPIO_PORTF_DATA_R & 0x02) == 0) { // Check if pin went low
-        return 1; // PASS
-    }
-    return 0; 
+    // we verify the pin states and that the pattern ended on its own.
+    if ((GPIO_PORTE_DATA_R & 0x10) != 0) pass = 0; // PE4 low again
+    if ((GPIO_PORTF_DATA_R & 0x02) != 0) pass = 0; // Red LED untouched
+    return pass;
 }
 
 // TEST E: SERVO MOTOR DRIVER
 // Requirement: "Motor control for door locking/unlocking"
 int UnitTest_Servo(void) {
-    Debug_Log("TEST 5: Servo Driver... Watch the Motor.\r\n");
+    Debug_Log("TEST 5: Servo Driver... Watch the Motors.\r\n");
     
     Servo_Init();
     
-    // 1. Move to UNLOCK (90 degrees)
+    // 1. Move to UNLOCK (90 degrees), all channels at once
     Debug_Log("   -> Set Angle: 90 (Unlock)\r\n");
-    Servo_SetAngle(90);
+    uint8_t ch;
+    for(ch=0; ch<SERVO_COUNT; ch++) Servo_SetAngle(ch, 90);
     
     // Wait for movement
     int i;
@@ -163,14 +204,681 @@ int UnitTest_Servo(void) {
     
     // 2. Move to LOCK (0 degrees)
     Debug_Log("   -> Set Angle: 0 (Lock)\r\n");
-    Servo_SetAngle(0);
+    for(ch=0; ch<SERVO_COUNT; ch++) Servo_SetAngle(ch, 0);
     
     // Wait for movement
     for(i=0; i<4000000; i++); 
     
+    // 1.5 ms on a 250 kHz PWM clock is 375 counts below the load value
+    if (PWM0_2_LOAD_R != 4999U) return 0;
+    Servo_SetPulse(0, 1500U);
+    if (PWM0_2_CMPB_R != 4999U - 375U) return 0;
+    Servo_SetPulse(0, SERVO_PULSE_MIN_US);
     return 1; // PASS (Visual confirmation required)
 }
 
+// TEST F: SHA-256 KNOWN ANSWER + PASSWORD CHECK
+// Requirement: "Password and configuration stored securely in EEPROM"
+#define SHA_TWO_BLOCK_MESSAGE "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+#define SHA_TWO_BLOCK_LENGTH  56U   /* Padding no longer fits its block */
+
+/* Both password slots, put back after a test writes its own PIN */
+static uint32_t saved_slots[2][EEPROM_BLOCK_SIZE];
+
+/* Record words: magic, iterations, salt 2-5, digest 6-13, generation last */
+#define RECORD_ITERATIONS   1U
+#define RECORD_SALT         2U
+#define RECORD_DIGEST       6U
+#define RECORD_GENERATION   15U
+static uint32_t record_slot[2][EEPROM_BLOCK_SIZE];
+static void PutWords(uint8_t *bytes, const uint32_t *words, uint32_t count) {
+    uint32_t i;
+    for (i = 0; i < count * 4U; i++) bytes[i] = (uint8_t)(words[i / 4U] >> (24U - ((i % 4U) * 8U)));
+}
+/* The newest stored record against d(1) = SHA256(salt || pin),
+   d(i) = SHA256(d(i-1) || salt), streamed rather than pre-padded */
+static int RecordMatches(const char *pin) {
+    const uint32_t *r;
+    SHA256_Context ctx;
+    uint8_t salt[PASSWORD_SALT_WORDS * 4U];
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint8_t stored[SHA256_DIGEST_SIZE];
+    uint32_t i;
+
+    if (EEPROM_ReadBuffer(PASSWORD_EEPROM_BLOCK, 0U, (uint8_t *)record_slot[0], sizeof(record_slot[0])) != EEPROM_SUCCESS ||
+        EEPROM_ReadBuffer(PASSWORD_EEPROM_BLOCK_B, 0U, (uint8_t *)record_slot[1], sizeof(record_slot[1])) != EEPROM_SUCCESS) return 0;
+    r = record_slot[0];
+    if (record_slot[1][0] == PASSWORD_RECORD_MAGIC &&
+        (r[0] != PASSWORD_RECORD_MAGIC || (int32_t)(record_slot[1][RECORD_GENERATION] - r[RECORD_GENERATION]) > 0)) r = record_slot[1];
+    if (r[0] != PASSWORD_RECORD_MAGIC || r[RECORD_ITERATIONS] == 0U) return 0;
+
+    PutWords(salt, &r[RECORD_SALT], PASSWORD_SALT_WORDS);
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, salt, sizeof(salt));
+    SHA256_Update(&ctx, (const uint8_t *)pin, strlen(pin));
+    SHA256_Final(&ctx, digest);
+    for (i = 1; i < r[RECORD_ITERATIONS]; i++) {
+        SHA256_Init(&ctx);
+        SHA256_Update(&ctx, digest, sizeof(digest));
+        SHA256_Update(&ctx, salt, sizeof(salt));
+        SHA256_Final(&ctx, digest);
+    }
+    PutWords(stored, &r[RECORD_DIGEST], SHA256_DIGEST_WORDS);
+    return (memcmp(digest, stored, sizeof(digest)) == 0);
+}
+
+int UnitTest_SHA256(void) {
+    /* FIPS 180-4 examples: SHA256("abc") and the 448-bit two-block message */
+    static const uint8_t expected[SHA256_DIGEST_SIZE] = {
+        0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+        0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+    };
+    static const uint8_t expected_two_block[SHA256_DIGEST_SIZE] = {
+        0x24, 0x8D, 0x6A, 0x61, 0xD2, 0x06, 0x38, 0xB8, 0xE5, 0xC0, 0x26, 0x93, 0x0C, 0x3E, 0x60, 0x39,
+        0xA3, 0x3C, 0xE4, 0x59, 0x64, 0xFF, 0x21, 0x67, 0xF6, 0xEC, 0xED, 0xD4, 0x19, 0xDB, 0x06, 0xC1
+    };
+    const uint8_t *message = (const uint8_t *)SHA_TWO_BLOCK_MESSAGE;
+    SHA256_Context ctx;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    int ok = 1;
+
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, (const uint8_t *)"abc", 3);
+    SHA256_Final(&ctx, digest);
+    if (memcmp(digest, expected, SHA256_DIGEST_SIZE) != 0) return 0; // FAIL
+
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, message, SHA_TWO_BLOCK_LENGTH);
+    SHA256_Final(&ctx, digest);
+    if (memcmp(digest, expected_two_block, SHA256_DIGEST_SIZE) != 0) return 0;
+
+    // The same message streamed in uneven pieces, one of them empty
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, message, 1U);
+    SHA256_Update(&ctx, message + 1U, 0U);
+    SHA256_Update(&ctx, message + 1U, 30U);
+    SHA256_Update(&ctx, message + 31U, SHA_TWO_BLOCK_LENGTH - 31U);
+    SHA256_Final(&ctx, digest);
+    if (memcmp(digest, expected_two_block, SHA256_DIGEST_SIZE) != 0) return 0;
+
+    // The keypad only produces digits, so this candidate must never verify
+    if (Password_Init() != PASSWORD_SUCCESS) return 0;
+    if (Password_Verify("not-a-pin!") != PASSWORD_MISMATCH) return 0;
+
+    // A committed PIN verifies, its neighbour does not; then the old record
+    // is put back
+    if (EEPROM_ReadBuffer(PASSWORD_EEPROM_BLOCK, 0U, (uint8_t *)saved_slots[0], sizeof(saved_slots[0])) != EEPROM_SUCCESS ||
+        EEPROM_ReadBuffer(PASSWORD_EEPROM_BLOCK_B, 0U, (uint8_t *)saved_slots[1], sizeof(saved_slots[1])) != EEPROM_SUCCESS) return 0;
+    if (Password_Set("2468") != PASSWORD_SUCCESS) ok = 0;
+    if (ok && Password_Verify("2468") != PASSWORD_MATCH) ok = 0;
+    if (ok && Password_Verify("2469") != PASSWORD_MISMATCH) ok = 0;
+    if (ok && !RecordMatches("2468")) ok = 0;      // Reproducible from the formula alone
+    if (EEPROM_WriteBuffer(PASSWORD_EEPROM_BLOCK, 0U, (const uint8_t *)saved_slots[0], sizeof(saved_slots[0])) != EEPROM_SUCCESS ||
+        EEPROM_WriteBuffer(PASSWORD_EEPROM_BLOCK_B, 0U, (const uint8_t *)saved_slots[1], sizeof(saved_slots[1])) != EEPROM_SUCCESS ||
+        Password_Init() != PASSWORD_SUCCESS) ok = 0;
+
+    return ok;
+}
+
+// TEST G: ATOMIC SETTINGS COMMIT
+// A timeout-only commit keeps the password and the other doors' timeouts,
+// and a re-read picks the newest slot
+int UnitTest_SettingsCommit(void) {
+    uint32_t original = Password_GetTimeout(1U);
+    uint32_t door0 = Password_GetTimeout(0U);
+    uint32_t probe = (original == 7U) ? 8U : 7U;
+    int ok = 1;
+
+    if (Password_Commit(PASSWORD_KEEP, 1U, 0U) == PASSWORD_SUCCESS) ok = 0;   // Out of range
+    if (Password_Commit(PASSWORD_KEEP, PASSWORD_DOOR_COUNT, probe) == PASSWORD_SUCCESS) ok = 0;
+    if (Password_Commit(PASSWORD_KEEP, 1U, probe) != PASSWORD_SUCCESS) return 0;
+    if (Password_Init() != PASSWORD_SUCCESS) return 0;
+    if (Password_GetTimeout(1U) != probe) ok = 0;
+    if (Password_GetTimeout(0U) != door0) ok = 0;
+    if (Password_Verify("not-a-pin!") != PASSWORD_MISMATCH) ok = 0;
+
+    if (Password_Commit(PASSWORD_KEEP, 1U, original) != PASSWORD_SUCCESS) ok = 0;  // Restore
+    return ok;
+}
+
+// TEST H: CRC-16 KNOWN ANSWER + BAUD DIVISORS
+// The link probe CRC, and the divisors UART2_SetBaud() programs at 16 MHz
+int UnitTest_LinkRate(void) {
+    int ok = 1;
+
+    if (CRC16_Update(CRC16_INIT, (const uint8_t *)"123456789", 9) != 0x29B1U) return 0;
+    if (CRC16_CheckText("12345678929B1") != 1U) ok = 0;
+    if (CRC16_CheckText("12345678829B1") != 0U) ok = 0;   // One character changed
+
+    if (UART2_CheckBaud(2000000U) != 0) ok = 0;            // Above clock / 16
+    if (UART2_SetBaud(1000000U) != 1) return 0;
+    if (UART2_IBRD_R != 1U || UART2_FBRD_R != 0U) ok = 0;
+    if (UART2_SetBaud(921600U) != 1 || UART2_IBRD_R != 1U || UART2_FBRD_R != 5U) ok = 0;
+    if (UART2_SetBaud(460800U) != 1 || UART2_IBRD_R != 2U || UART2_FBRD_R != 11U) ok = 0;
+
+    if (UART2_SetBaud(UART2_BAUD_DEFAULT) != 1) return 0;  // Restore
+    if (UART2_IBRD_R != 8U || UART2_FBRD_R != 44U) ok = 0;
+    return ok;
+}
+
+// TEST I: RX RING + XON/XOFF (internal loopback, no wire needed)
+// Overfilling the ring sends XOFF (here to ourselves, so sending resumes on
+// the XOFF timeout), keeps exactly UART2_RX_BUFFER_SIZE characters and
+// counts the rest as dropped
+int UnitTest_UART_FlowControl(void) {
+    UART2_Stats before;
+    UART2_Stats after;
+    uint32_t received = 0;
+    uint32_t i;
+    int ok = 1;
+
+    UART2_CTL_R |= 0x80;                    // LBE: TX looped to RX inside the UART
+    while(UART2_Available()) { (void)UART2_ReadChar(); }
+    UART2_GetStats(&before);
+
+    for(i = 0; i < UART2_RX_BUFFER_SIZE + 16U; i++) {
+        UART2_SendChar((char)('A' + (i % 26U)));
+    }
+    for(i = 0; i < 100000; i++);            // Let the last characters arrive
+
+    while(UART2_Available()) {
+        char c;
+        if(UART2_ReadCharStatus(&c) != 0U || c != (char)('A' + (received % 26U))) ok = 0;
+        received++;
+    }
+    UART2_GetStats(&after);
+    UART2_CTL_R &= ~0x80;
+
+#if UART2_FLOW_XONXOFF
+    if(after.xoff_sent != before.xoff_sent + 1U) ok = 0;
+    if(after.xoff_timeouts != before.xoff_timeouts + 1U) ok = 0;
+#endif
+    if(received != UART2_RX_BUFFER_SIZE) ok = 0;
+    if(after.rx_dropped != before.rx_dropped + 16U) ok = 0;
+    return ok;
+}
+
+// TEST J: RS-485 BUS ADDRESSING
+// Only the panel being polled is accepted, once; the poll itself goes out on
+// UART2 ("#01?") and needs no reply
+int UnitTest_BusPolling(void) {
+    char address[BUS_ADDRESS_LENGTH + 1];
+    const char *body = 0;
+    int ok = 1;
+
+    Bus_FormatAddress(10, address);
+    if (strcmp(address, "#0A") != 0) ok = 0;
+
+    Bus_Init();
+    Bus_Service();                                          // Polls panel 1
+    if (Bus_Accept("#02@01 CLOSE", &body) != BUS_NODE_NONE) ok = 0;
+    if (Bus_Accept("#01@01 CLOSE", &body) != 1U) return 0;
+    if (strcmp(body, "@01 CLOSE") != 0) ok = 0;
+    if (Bus_Accept("#01@01 CLOSE", &body) != BUS_NODE_NONE) ok = 0;  // Slot closed
+    if (Bus_IsPresent(1) != 1U || Bus_IsPresent(BUS_NODE_NONE) != 0U) ok = 0;
+
+    Bus_Init();
+    return ok;
+}
+
+// TEST K: DOOR STATE MACHINES
+// Two doors move in the same frames; closing one leaves the other open
+int UnitTest_Doors(void) {
+    uint32_t closed = 0;
+    int frame;
+    int ok = 1;
+
+    Door_Init();
+    if (Door_Open(DOOR_COUNT, 5U) != DOOR_ERROR) ok = 0;
+    if (Door_Hold(0, 5U) != DOOR_ERROR) ok = 0;           // Not open
+    if (Door_Open(0, 5U) != DOOR_SUCCESS) return 0;
+    if (DOOR_COUNT > 1U && Door_Open(1, 5U) != DOOR_SUCCESS) return 0;
+
+    // 500 us at 50 us per frame: both open after 10 frames
+    for (frame = 0; frame < 10; frame++) closed |= Door_Service();
+    if (Door_GetState(0) != DOOR_OPEN) ok = 0;
+    if (DOOR_COUNT > 1U && Door_GetState(1) != DOOR_OPEN) ok = 0;
+    if (Door_Hold(0, 5U) != DOOR_SUCCESS) ok = 0;
+
+    Door_Close(0);
+    for (frame = 0; frame < 10; frame++) closed |= Door_Service();
+    if (closed != 0x01U || Door_GetState(0) != DOOR_CLOSED) ok = 0;
+    if (DOOR_COUNT > 1U && Door_GetState(1) != DOOR_OPEN) ok = 0;
+
+    Door_Init();
+    return ok;
+}
+
+// TEST L: DIO MASKED ACCESS / EDGE INTERRUPTS
+// Pin writes leave the rest of the port alone; an output pin's own edges
+// reach its callback through the port F interrupt
+static volatile uint32_t dio_edges = 0;
+static void CountEdge(uint8_t port, uint8_t pin) {
+    if (port == PORTF && pin == PIN2) dio_edges++;
+}
+int UnitTest_DIO(void) {
+    volatile uint32_t spin;
+    int ok = 1;
+
+    DIO_Init(PORTF, PIN2, OUTPUT);                      // Blue LED, otherwise unused
+    GPIO_PORTF_DATA_R |= 0x02;                          // Red on: must survive
+    DIO_WritePin(PORTF, PIN2, HIGH);
+    if ((GPIO_PORTF_DATA_R & 0x06) != 0x06) ok = 0;
+    DIO_TogglePin(PORTF, PIN2);
+    if (DIO_ReadPin(PORTF, PIN2) != LOW) ok = 0;
+    if ((GPIO_PORTF_DATA_R & 0x02) == 0) ok = 0;
+    DIO_WRITE(PORTF, PIN2, HIGH);                       // Constant-pin form
+    if (DIO_READ(PORTF, PIN2) != HIGH) ok = 0;
+    DIO_WRITE(PORTF, PIN2, LOW);
+    GPIO_PORTF_DATA_R &= ~0x02;
+
+    dio_edges = 0;
+    DIO_AttachInterrupt(PORTF, PIN2, DIO_EDGE_BOTH, CountEdge);
+    DIO_WRITE(PORTF, PIN2, HIGH);
+    for (spin = 0; spin < 1000U && dio_edges < 1U; spin++);
+    DIO_WRITE(PORTF, PIN2, LOW);
+    for (spin = 0; spin < 1000U && dio_edges < 2U; spin++);
+    if (dio_edges != 2U) ok = 0;
+
+    DIO_DetachInterrupt(PORTF, PIN2);
+    DIO_TOGGLE(PORTF, PIN2);
+    DIO_TOGGLE(PORTF, PIN2);
+    for (spin = 0; spin < 1000U; spin++);
+    if (dio_edges != 2U) ok = 0;                        // No callback once detached
+    return ok;
+}
+
+// TEST M: FRAME PARSER (views, overlong lines, cycles against the old path)
+// The old path is reproduced as it was: copy, strlen for the "@SS " check,
+// then memset of the whole 50-byte buffer. DWT CYCCNT counts both.
+#define DEMCR_R         (*((volatile uint32_t *)0xE000EDFC))
+#define DEMCR_TRCENA    0x01000000U
+#define DWT_CTRL_R      (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R    (*((volatile uint32_t *)0xE0001004))
+#define FRAME_SAMPLE    "@07 D1/VERIFY:1234\n"
+static char old_buffer[50];
+static uint32_t old_index = 0;
+static uint32_t OldPath(const char *in) {
+    uint32_t seen = 0;
+    for (; *in != '\0'; in++) {
+        if (*in == '\n') {
+            old_buffer[old_index] = '\0';
+            seen += (uint32_t)strlen(old_buffer);
+            old_index = 0;
+            memset(old_buffer, 0, sizeof(old_buffer));
+        } else if (old_index < 49U) {
+            old_buffer[old_index++] = *in;
+        }
+    }
+    return seen;
+}
+int UnitTest_FrameParser(void) {
+    static char line[50];
+    Frame_Parser parser;
+    Frame_View frame;
+    const char *in;
+    uint32_t old_cycles, new_cycles, seen = 0;
+    uint32_t i, lines = 0;
+    char report[64];
+    Fmt_Buffer out;
+    int ok = 1;
+
+    Frame_Init(&parser, line, sizeof(line));
+    for (i = 0; i < 60U; i++) {                         // Overlong: dropped whole
+        if (Frame_Push(&parser, 'X', &frame) != 0U) ok = 0;
+    }
+    if (Frame_Push(&parser, '\n', &frame) != 0U) ok = 0;
+    for (in = FRAME_SAMPLE; *in != '\0'; in++) {
+        if (Frame_Push(&parser, *in, &frame) != 0U) lines++;
+    }
+    if (lines != 1U || frame.length != 18U || frame.text[frame.length] != '\0') ok = 0;
+    Frame_Skip(&frame, 7U);                             // "@07 D1/"
+    if (!FRAME_STARTS_WITH(frame, "VERIFY:") || FRAME_EQUALS(frame, "VERIFY:")) ok = 0;
+    if (strcmp(frame.text + 7, "1234") != 0) ok = 0;   // Tail usable as a C string
+    Frame_Skip(&frame, 100U);
+    if (frame.length != 0U) ok = 0;
+
+    DEMCR_R |= DEMCR_TRCENA;
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= 1U;                                   // CYCCNTENA
+    old_cycles = DWT_CYCCNT_R;
+    seen += OldPath(FRAME_SAMPLE);
+    old_cycles = DWT_CYCCNT_R - old_cycles;
+    new_cycles = DWT_CYCCNT_R;
+    for (in = FRAME_SAMPLE; *in != '\0'; in++) {
+        if (Frame_Push(&parser, *in, &frame) != 0U) seen += frame.length;
+    }
+    new_cycles = DWT_CYCCNT_R - new_cycles;
+    if (seen != 36U) ok = 0;
+
+    Fmt_Begin(&out, report, sizeof(report));
+    Fmt_String(&out, "Line of 18: old ");
+    Fmt_Uint(&out, old_cycles);
+    Fmt_String(&out, " cycles, frame ");
+    Fmt_Uint(&out, new_cycles);
+    Fmt_String(&out, " cycles\r\n");
+    Debug_Log(report);
+    if (new_cycles >= old_cycles) ok = 0;
+    return ok;
+}
+
+// TEST N: BOOT TIMELINE
+// main() marked its bring-up steps in order and was ready within budget
+int UnitTest_BootTimeline(void) {
+    const Boot_Phase *phases;
+    uint8_t count = Boot_GetTimeline(&phases);
+    uint8_t i;
+    char report[32];
+    Fmt_Buffer out;
+    int ok = (count > 0U);
+
+    for (i = 0; i < count; i++) {
+        Fmt_Begin(&out, report, sizeof(report));
+        Fmt_String(&out, phases[i].name);
+        Fmt_Char(&out, ' ');
+        Fmt_Uint(&out, phases[i].us);
+        Fmt_String(&out, " us\r\n");
+        Debug_Log(report);
+        if (i > 0U && phases[i].us < phases[i - 1U].us) ok = 0;
+    }
+    if (ok && strcmp(phases[count - 1U].name, "ready") != 0) ok = 0;
+    if (ok && phases[count - 1U].us >= BOOT_BUDGET_MS * 1000U) ok = 0;
+    return ok;
+}
+
+// TEST O: STACK HIGH-WATER MARK
+// The high-water mark covers the deepest frame so far and keeps it. The
+// probe puts a frame of known depth below its caller's
+static uint32_t StackProbe(uint32_t *depth) {
+    volatile uint32_t frame[32];
+    uint32_t i;
+
+    for (i = 0; i < 32U; i++) frame[i] = i;
+    *depth = (uint32_t)((uintptr_t)&pui32Stack[STACK_WORDS] - (uintptr_t)&frame[0]);
+    return Stack_GetUsed();
+}
+
+int UnitTest_StackHighWater(void) {
+    uint32_t depth;
+    uint32_t used = StackProbe(&depth);
+    char report[40];
+    Fmt_Buffer out;
+
+    Fmt_Begin(&out, report, sizeof(report));
+    Fmt_String(&out, "Stack: ");
+    Fmt_Uint(&out, used);
+    Fmt_String(&out, " of ");
+    Fmt_Uint(&out, Stack_GetSize());
+    Fmt_String(&out, " bytes\r\n");
+    Debug_Log(report);
+    return (used >= depth && used <= Stack_GetSize() && Stack_GetUsed() >= used);
+}
+
+// TEST P: WATCHDOG CHECK-INS / HANG RECORD
+// Reloads stop once a watched task misses its deadline; the record the
+// NMI would write is taken once, by the next Wdt_Init()
+#define WDT_TEST_TASK   (SCHED_MAX_TASKS - 1U)     /* Past the tasks main() adds */
+int UnitTest_Watchdog(void) {
+    static const uint32_t frame[8] = { 0, 0, 0, 0, 0, 0x00001235U, 0x00002468U, 0x01000000U };
+    Wdt_Record record;
+    int ok = 1;
+
+    Wdt_Watch(WDT_TEST_TASK, 20U);
+    Wdt_CheckIn(WDT_TEST_TASK);
+    if (Wdt_Service() != 1U) ok = 0;
+    DelayMs(30U);
+    if (Wdt_Service() != 0U) ok = 0;
+    Wdt_CheckIn(WDT_TEST_TASK);
+    if (Wdt_Service() != 1U) ok = 0;
+
+    DelayMs(30U);
+    (void)Wdt_Service();
+    Wdt_Expired(frame);
+    Wdt_Watch(WDT_TEST_TASK, 0U);
+    if (Wdt_Init() != 1U || Wdt_GetLastReset(&record) != 1U) ok = 0;
+    if (ok && (record.pc != 0x00002468U || record.lr != 0x00001235U ||
+               record.late != WDT_TEST_TASK)) ok = 0;
+    if (Wdt_Init() != 0U || Wdt_Service() != 1U) ok = 0;
+    return ok;
+}
+
+// TEST Q: AUDIT LOG HEAD RECOVERY / STAGING / DUMP
+// A wrapped log is found at its oldest record, appends wait in RAM until a
+// full batch is written across the end of the region, and the AUDIT? dump
+// walks EEPROM then staging in sequence order, also when the log moves
+// under a walk taken in pieces. The log is put back after.
+#define AUDIT_TEST_HEAD     (AUDITLOG_CAPACITY - 4U)    /* Batch crosses the end */
+#define AUDIT_TEST_EVENT    0x0FU
+static uint32_t saved_log[AUDITLOG_BLOCK_COUNT][EEPROM_BLOCK_SIZE];
+static AuditLog_Record audit_seed[AUDITLOG_CAPACITY];
+static AuditLog_Cursor audit_cursor;
+static AuditLog_Record audit_record;
+static uint16_t audit_next;
+static uint32_t audit_seen;
+static int audit_ok;
+static void CheckAuditOrder(const AuditLog_Record *record) {
+    if (record->sequence != audit_next) audit_ok = 0;
+    audit_next++;
+    audit_seen++;
+}
+static int AuditDumpFrom(uint16_t first, uint32_t count) {
+    audit_next = first;
+    audit_seen = 0;
+    audit_ok = 1;
+    return (AuditLog_ForEach(CheckAuditOrder) == count && audit_seen == count && audit_ok);
+}
+int UnitTest_AuditLog(void) {
+    uint32_t i;
+    int ok = 1;
+
+    if (AuditLog_Flush() != AUDITLOG_SUCCESS) return 0;
+    for (i = 0; i < AUDITLOG_BLOCK_COUNT; i++) {
+        if (EEPROM_ReadBuffer(AUDITLOG_FIRST_BLOCK + i, 0U, (uint8_t *)saved_log[i], sizeof(saved_log[i])) != EEPROM_SUCCESS) return 0;
+    }
+
+    // Sequences 1..4 in the last slots, 5..128 from slot 0: wrapped, with
+    // the head on the oldest record
+    for (i = 0; i < AUDITLOG_CAPACITY; i++) {
+        audit_seed[i].sequence = (uint16_t)((i >= AUDIT_TEST_HEAD) ? (i - AUDIT_TEST_HEAD + 1U) : (i + 5U));
+        audit_seed[i].timestamp = audit_seed[i].sequence;
+        audit_seed[i].event = AUDIT_TEST_EVENT;
+        audit_seed[i].result = AUDIT_RESULT_OK;
+    }
+    if (EEPROM_WriteBuffer(AUDITLOG_FIRST_BLOCK, 0U, (const uint8_t *)audit_seed, sizeof(audit_seed)) != EEPROM_SUCCESS) ok = 0;
+    if (ok && AuditLog_Init() != AUDITLOG_SUCCESS) ok = 0;
+    if (ok && !AuditDumpFrom(1U, AUDITLOG_CAPACITY)) ok = 0;
+
+    // Staged records follow the stored ones in the dump but stay off the
+    // EEPROM until the batch is full
+    for (i = 0; ok && i < AUDITLOG_STAGE_RECORDS - 1U; i++) AuditLog_Append(AUDIT_TEST_EVENT, AUDIT_RESULT_OK);
+    AuditLog_Service();
+    if (ok && !AuditDumpFrom(1U, AUDITLOG_CAPACITY + AUDITLOG_STAGE_RECORDS - 1U)) ok = 0;
+    if (ok && AuditLog_Init() != AUDITLOG_SUCCESS) ok = 0;  // Drops the staging
+    if (ok && !AuditDumpFrom(1U, AUDITLOG_CAPACITY)) ok = 0;
+
+    // A full batch is written at once, 4 slots at the end and 4 from slot 0;
+    // a reboot finds the head after them
+    for (i = 0; ok && i < AUDITLOG_STAGE_RECORDS; i++) AuditLog_Append(AUDIT_TEST_EVENT, AUDIT_RESULT_OK);
+    AuditLog_Service();
+    if (ok && AuditLog_Init() != AUDITLOG_SUCCESS) ok = 0;
+    if (ok && !AuditDumpFrom(1U + AUDITLOG_STAGE_RECORDS, AUDITLOG_CAPACITY)) ok = 0;
+    AuditLog_Append(AUDIT_TEST_EVENT, AUDIT_RESULT_OK);
+    if (ok && !AuditDumpFrom(1U + AUDITLOG_STAGE_RECORDS, AUDITLOG_CAPACITY + 1U)) ok = 0;
+
+    // The dump's walk, a few records at a time: a batch flushed midway
+    // overwrites its next records, which it passes over, and records
+    // appended after it began are not part of it
+    AuditLog_Begin(&audit_cursor);
+    for (i = 0; i < 3U; i++) {
+        if (AuditLog_Next(&audit_cursor, &audit_record) != AUDITLOG_SUCCESS ||
+            audit_record.sequence != 1U + AUDITLOG_STAGE_RECORDS + i) ok = 0;
+    }
+    for (i = 0; i < AUDITLOG_STAGE_RECORDS - 1U; i++) AuditLog_Append(AUDIT_TEST_EVENT, AUDIT_RESULT_OK);
+    AuditLog_Service();
+    audit_next = 1U + (2U * AUDITLOG_STAGE_RECORDS);   // Oldest left after the flush
+    audit_seen = 0;
+    while (AuditLog_Next(&audit_cursor, &audit_record) == AUDITLOG_SUCCESS) {
+        if (audit_record.sequence != audit_next) ok = 0;
+        audit_next++;
+        audit_seen++;
+    }
+    if (audit_next != 2U + AUDITLOG_STAGE_RECORDS + AUDITLOG_CAPACITY) ok = 0;  // Stopped at the walk's end
+    if (AuditLog_Next(&audit_cursor, &audit_record) != AUDITLOG_END) ok = 0;
+
+    for (i = 0; i < AUDITLOG_BLOCK_COUNT; i++) {
+        if (EEPROM_WriteBuffer(AUDITLOG_FIRST_BLOCK + i, 0U, (const uint8_t *)saved_log[i], sizeof(saved_log[i])) != EEPROM_SUCCESS) ok = 0;
+    }
+    if (AuditLog_Init() != AUDITLOG_SUCCESS) ok = 0;
+    return ok;
+}
+
+// TEST R: SCHEDULER ORDER / QUEUES / TIMERS / STATS
+// Ready tasks run highest priority first, one slice per pass; a full queue
+// drops and counts; one-shot timers fire once, periodic ones until stopped.
+// Takes the scheduler over: Run_Unit_Tests() never returns to main()'s tasks.
+#define SCHED_TEST_SLOW_MS  3U      /* DelayMs() waits at least 2 ms of it */
+static uint8_t sched_ran[8];
+static uint8_t sched_runs;
+static Sched_Event sched_last;
+static uint8_t sched_running = SCHED_INVALID;
+static void RecordHigh(const Sched_Event *event) {
+    if (sched_runs < sizeof(sched_ran)) sched_ran[sched_runs] = SCHED_PRIORITY_HIGH;
+    sched_runs++;
+    sched_last = *event;
+}
+static void RecordNormal(const Sched_Event *event) {
+    if (sched_runs < sizeof(sched_ran)) sched_ran[sched_runs] = SCHED_PRIORITY_NORMAL;
+    sched_runs++;
+    sched_last = *event;
+}
+static void RecordLow(const Sched_Event *event) {
+    uint32_t slice_us;
+    if (sched_runs < sizeof(sched_ran)) sched_ran[sched_runs] = SCHED_PRIORITY_LOW;
+    sched_runs++;
+    sched_last = *event;
+    sched_running = Sched_GetRunning(&slice_us);
+    if (event->param == SCHED_TEST_SLOW_MS) DelayMs(SCHED_TEST_SLOW_MS);
+}
+int UnitTest_Scheduler(void) {
+    Sched_TaskStats stats;
+    uint32_t slice_us;
+    uint8_t low, high, normal, timer;
+    uint32_t i;
+    int ok = 1;
+
+    Sched_Init();
+    low = Sched_AddTask(RecordLow, SCHED_PRIORITY_LOW, 0U);
+    high = Sched_AddTask(RecordHigh, SCHED_PRIORITY_HIGH, 0U);
+    normal = Sched_AddTask(RecordNormal, SCHED_PRIORITY_NORMAL, 0U);
+    if (low == SCHED_INVALID || high == SCHED_INVALID || normal == SCHED_INVALID) return 0;
+
+    // Priority order, whatever the order of posting, then an idle pass. The
+    // running marker names a task only during its slice
+    sched_runs = 0;
+    Sched_Post(low, SCHED_EVENT_USER, 0U);
+    Sched_Post(normal, SCHED_EVENT_USER, 0U);
+    Sched_Post(high, SCHED_EVENT_USER, 0U);
+    for (i = 0; i < 3U; i++) if (Sched_RunOnce() != 1U) ok = 0;
+    if (Sched_RunOnce() != 0U) ok = 0;
+    if (sched_runs != 3U || sched_ran[0] != SCHED_PRIORITY_HIGH ||
+        sched_ran[1] != SCHED_PRIORITY_NORMAL || sched_ran[2] != SCHED_PRIORITY_LOW) ok = 0;
+    if (sched_running != low) ok = 0;
+    if (Sched_GetRunning(&slice_us) != SCHED_INVALID || slice_us != 0U) ok = 0;
+
+    // Overflow: the events past the queue's depth are refused and counted,
+    // the rest come out in order
+    for (i = 0; i < SCHED_QUEUE_DEPTH + 2U; i++) {
+        uint8_t result = Sched_Post(low, (uint8_t)(SCHED_EVENT_USER + i), i == 0U ? SCHED_TEST_SLOW_MS : 0U);
+        if (result != ((i < SCHED_QUEUE_DEPTH) ? SCHED_SUCCESS : SCHED_ERROR)) ok = 0;
+    }
+    for (i = 0; i < SCHED_QUEUE_DEPTH; i++) {
+        if (Sched_RunOnce() != 1U || sched_last.code != SCHED_EVENT_USER + i) ok = 0;
+    }
+    if (Sched_RunOnce() != 0U) ok = 0;
+
+    // One-shot: not before its delay, once after it. The event carries the
+    // timer's handle
+    timer = Sched_StartTimer(normal, SCHED_EVENT_USER + 1U, 5U, 0U);
+    if (timer == SCHED_INVALID || Sched_RunOnce() != 0U) ok = 0;
+    DelayMs(6U);
+    if (Sched_RunOnce() != 1U || sched_last.code != SCHED_EVENT_USER + 1U || sched_last.param != timer) ok = 0;
+    DelayMs(6U);
+    if (Sched_RunOnce() != 0U) ok = 0;
+
+    // Periodic: every period until stopped
+    timer = Sched_StartTimer(high, SCHED_EVENT_USER + 2U, 3U, 3U);
+    for (i = 0; i < 3U; i++) {
+        DelayMs(3U);
+        if (Sched_RunOnce() != 1U || sched_last.code != SCHED_EVENT_USER + 2U) ok = 0;
+    }
+    Sched_StopTimer(timer);
+    DelayMs(6U);
+    if (Sched_RunOnce() != 0U) ok = 0;
+
+    // Accounting: slices per task, the slow one as the longest, the drops
+    Sched_GetTaskStats(low, &stats);
+    if (stats.runs != 1U + SCHED_QUEUE_DEPTH || stats.dropped != 2U ||
+        stats.max_us < (SCHED_TEST_SLOW_MS - 1U) * 1000U || stats.total_us < stats.max_us) ok = 0;
+    Sched_GetTaskStats(high, &stats);
+    if (stats.runs != 4U || stats.dropped != 0U) ok = 0;
+    Sched_GetTaskStats(normal, &stats);
+    if (stats.runs != 2U) ok = 0;
+    return ok;
+}
+
+// TEST S: PLAINTEXT PASSWORD CONVERSION
+// A plaintext PIN in block 0 still verifies once converted, and neither
+// slot holds its bytes afterwards, also when a reset came between the new
+// record's write and the blanking of block 0. The slots are put back after.
+#define LEGACY_PIN      "7531"
+static uint32_t legacy_slot[EEPROM_BLOCK_SIZE];
+static void SeedLegacyPin(uint32_t block) {
+    memset(legacy_slot, 0xFF, sizeof(legacy_slot));
+    memset(legacy_slot, 0, PASSWORD_MAX_LENGTH);
+    memcpy(legacy_slot, LEGACY_PIN, sizeof(LEGACY_PIN) - 1U);
+    EEPROM_WriteBuffer(block, 0U, (const uint8_t *)legacy_slot, sizeof(legacy_slot));
+}
+static int SlotHoldsPin(uint32_t block) {
+    const uint8_t *bytes = (const uint8_t *)legacy_slot;
+    uint32_t i;
+
+    if (EEPROM_ReadBuffer(block, 0U, (uint8_t *)legacy_slot, sizeof(legacy_slot)) != EEPROM_SUCCESS) return 1;
+    for (i = 0; i + (sizeof(LEGACY_PIN) - 1U) <= sizeof(legacy_slot); i++) {
+        if (memcmp(&bytes[i], LEGACY_PIN, sizeof(LEGACY_PIN) - 1U) == 0) return 1;
+    }
+    return 0;
+}
+int UnitTest_LegacyPassword(void) {
+    uint32_t i;
+    int ok = 1;
+
+    if (EEPROM_ReadBuffer(PASSWORD_EEPROM_BLOCK, 0U, (uint8_t *)saved_slots[0], sizeof(saved_slots[0])) != EEPROM_SUCCESS ||
+        EEPROM_ReadBuffer(PASSWORD_EEPROM_BLOCK_B, 0U, (uint8_t *)saved_slots[1], sizeof(saved_slots[1])) != EEPROM_SUCCESS) return 0;
+
+    // Block 0 as the first firmware left it, block B never written
+    SeedLegacyPin(PASSWORD_EEPROM_BLOCK);
+    memset(legacy_slot, 0xFF, sizeof(legacy_slot));
+    EEPROM_WriteBuffer(PASSWORD_EEPROM_BLOCK_B, 0U, (const uint8_t *)legacy_slot, sizeof(legacy_slot));
+    if (Password_Init() != PASSWORD_SUCCESS) ok = 0;
+    if (ok && Password_Verify(LEGACY_PIN) != PASSWORD_MATCH) ok = 0;
+    if (SlotHoldsPin(PASSWORD_EEPROM_BLOCK_B) || SlotHoldsPin(PASSWORD_EEPROM_BLOCK)) ok = 0;
+    for (i = 0; i < EEPROM_BLOCK_SIZE; i++) {
+        if (legacy_slot[i] != 0xFFFFFFFFU) ok = 0;     // Block 0 as read last: erased
+    }
+
+    // The PIN back in block 0 next to the converted record: the next boot
+    // finishes the job
+    SeedLegacyPin(PASSWORD_EEPROM_BLOCK);
+    if (Password_Init() != PASSWORD_SUCCESS) ok = 0;
+    if (ok && Password_Verify(LEGACY_PIN) != PASSWORD_MATCH) ok = 0;
+    if (SlotHoldsPin(PASSWORD_EEPROM_BLOCK)) ok = 0;
+
+    if (EEPROM_WriteBuffer(PASSWORD_EEPROM_BLOCK, 0U, (const uint8_t *)saved_slots[0], sizeof(saved_slots[0])) != EEPROM_SUCCESS ||
+        EEPROM_WriteBuffer(PASSWORD_EEPROM_BLOCK_B, 0U, (const uint8_t *)saved_slots[1], sizeof(saved_slots[1])) != EEPROM_SUCCESS ||
+        Password_Init() != PASSWORD_SUCCESS) ok = 0;
+    return ok;
+}
+
 /* --- 3. RUNNER --- */
 void Run_Unit_Tests(void) {
     Debug_UART0_Init();
@@ -190,7 +898,23 @@ void Run_Unit_Tests(void) {
     Log_Result("3. GPIO Register Logic", UnitTest_GPIO_LED());
     Log_Result("4. Buzzer Actuation", UnitTest_Buzzer());
     Log_Result("5. Servo Movement", UnitTest_Servo());
+    Log_Result("6. SHA-256 / Password Hash", UnitTest_SHA256());
+    Log_Result("7. Atomic Settings Commit", UnitTest_SettingsCommit());
+    Log_Result("8. CRC-16 / Baud Divisors", UnitTest_LinkRate());
+    Log_Result("9. UART Ring / XON-XOFF", UnitTest_UART_FlowControl());
+    Log_Result("10. RS-485 Bus Polling", UnitTest_BusPolling());
+    Log_Result("11. Door State Machines", UnitTest_Doors());
+    Log_Result("12. DIO Masked Access / Edge IRQ", UnitTest_DIO());
+    Log_Result("13. Frame Parser / Cycle Count", UnitTest_FrameParser());
+    Log_Result("14. Boot Timeline", UnitTest_BootTimeline());
+    Log_Result("15. Stack High-Water Mark", UnitTest_StackHighWater());
+    Log_Result("16. Watchdog Check-ins / Record", UnitTest_Watchdog());
+    Log_Result("17. Audit Log Recovery / Dump", UnitTest_AuditLog());
+    Log_Result("18. Scheduler Order / Timers", UnitTest_Scheduler());
+    Log_Result("19. Plaintext Password Conversion", UnitTest_LegacyPassword());
     
     Debug_Log("--- TESTS COMPLETE ---\r\n");
     while(1);
-}
\ No newline at end of file
+}
+
+#endif /* SELF_TEST */
@@ -77,6 +77,53 @@ try {
     Write-Host "   Could not get section details" -ForegroundColor Yellow
 }
 
+# 7b. Formatting code: fmt.c replaces the printf family, which must not be linked.
+#     Every symbol counts, sized or not; a match, or an image nm cannot read,
+#     fails the run (exit code 1)
+Write-Host "`n7b. FORMATTING CODE:" -ForegroundColor Green
+$printfBytes = 0
+$fmtBytes = 0
+$printfNames = @()
+arm-none-eabi-nm --print-size CONTROL.axf | ForEach-Object {
+    $f = $_.Trim() -split '\s+'
+    $name = $f[$f.Count - 1]
+    $size = if ($f.Count -ge 4) { [Convert]::ToInt32($f[1], 16) } else { 0 }
+    if ($name -match 'printf|Printf') { $printfBytes += $size; $printfNames += $name }
+    elseif ($name -match '^Fmt_') { $fmtBytes += $size }
+}
+if ($LASTEXITCODE -ne 0) { $printfNames += "nm failed" }
+Write-Host "   fmt.c (Fmt_*):       $fmtBytes bytes" -ForegroundColor White
+if ($printfNames.Count -eq 0) {
+    Write-Host "   printf family:       not linked ✅" -ForegroundColor Green
+} else {
+    Write-Host "   printf family:       $printfBytes bytes ($($printfNames -join ', ')) ❌" -ForegroundColor Red
+}
+
+# 7c. Stack: the linker's worst case (stack.suc) against pui32Stack (stack.h)
+Write-Host "`n7c. STACK USAGE:" -ForegroundColor Green
+$stackSize = 1536
+$stackTask = 0
+$stackIrq = 0
+$stackNmi = 0
+if (Test-Path "..\List\CONTROL.map") {
+    Get-Content "..\List\CONTROL.map" | ForEach-Object {
+        if ($_ -match '^\s*Program entry\s+(\d+)') { $stackTask = [int]$Matches[1] }
+        elseif ($_ -match '^\s*interrupt\s+(\d+)') { $stackIrq = [int]$Matches[1] }
+        elseif ($_ -match '^\s*nmi\s+(\d+)') { $stackNmi = [int]$Matches[1] }
+    }
+}
+$stackWorst = $stackTask + $stackIrq + 104 + $stackNmi + 104
+Write-Host "   Deepest task:        $stackTask bytes" -ForegroundColor White
+Write-Host "   Deepest interrupt:   $stackIrq bytes (+104 exception frame)" -ForegroundColor White
+Write-Host "   Watchdog NMI:        $stackNmi bytes (+104 exception frame)" -ForegroundColor White
+if ($stackTask -eq 0) {
+    Write-Host "   No STACK USAGE in ..\List\CONTROL.map - is stack usage analysis on?" -ForegroundColor Yellow
+} elseif ($stackWorst -le $stackSize) {
+    Write-Host "   Worst case:          $stackWorst of $stackSize bytes ✅" -ForegroundColor Green
+} else {
+    Write-Host "   Worst case:          $stackWorst of $stackSize bytes ❌" -ForegroundColor Red
+}
+
 # 8. Generate report
 $timestamp = Get-Date -Format "yyyyMMdd_HHmmss"
 $report = "control_analysis_$timestamp.txt"
@@ -110,6 +157,16 @@ Flash Used:      $flashUsed bytes ($flashPercent%)
 RAM Available:   32,768 bytes (32 KB)
 RAM Used:        $ramUsed bytes ($ramPercent%)
 
+=== FORMATTING CODE ===
+fmt.c (Fmt_*):   $fmtBytes bytes
+printf family:   $printfBytes bytes $(if ($printfNames.Count -eq 0) { "(not linked)" } else { "(" + ($printfNames -join ', ') + ")" })
+
+=== STACK (linker analysis, stack.suc) ===
+Deepest task:      $stackTask bytes
+Deepest interrupt: $stackIrq bytes (+104 exception frame)
+Watchdog NMI:      $stackNmi bytes (+104 exception frame)
+Worst case:        $stackWorst of $stackSize bytes (pui32Stack, stack.h)
+
 === UART COMPONENTS (from your code) ===
 • master_password[20]: 20 bytes
 • rx_buffer[50]: 50 bytes  
@@ -126,4 +183,9 @@ RAM Used:        $ramUsed bytes ($ramPercent%)
 Write-Host "Report saved to: $report" -ForegroundColor Green
 
 # Open the report
-notepad $report
\ No newline at end of file
+notepad $report
+
+if ($printfNames.Count -ne 0) {
+    Write-Host "FAILED: the printf family is linked - see fmt.h" -ForegroundColor Red
+    exit 1
+}
\ No newline at end of file
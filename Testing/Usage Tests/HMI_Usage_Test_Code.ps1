@@ -68,6 +68,60 @@ if ($ctrlLines.Count -ge 2) {
     }
 }
 
+# Formatting code: fmt.c replaces the printf family, which must not be linked.
+# Every symbol counts, sized or not; a match, or an image nm cannot read,
+# fails the run (exit code 1)
+function Get-FormatBytes($axf) {
+    $printf = 0
+    $fmt = 0
+    $names = 0
+    arm-none-eabi-nm --print-size $axf | ForEach-Object {
+        $f = $_.Trim() -split '\s+'
+        $name = $f[$f.Count - 1]
+        $size = if ($f.Count -ge 4) { [Convert]::ToInt32($f[1], 16) } else { 0 }
+        if ($name -match 'printf|Printf') { $printf += $size; $names++ }
+        elseif ($name -match '^Fmt_') { $fmt += $size }
+    }
+    if ($LASTEXITCODE -ne 0) { $names++ }
+    return @($fmt, $printf, $names)
+}
+Set-Location "D:\University\7th Semester Senior 1\Introduction to Enbedded Systems\Project\adeem\HMI\Debug\Exe"
+$hmiFormat = Get-FormatBytes "HMI.axf"
+Set-Location "D:\University\7th Semester Senior 1\Introduction to Enbedded Systems\Project\adeem\CONTROL\Debug\Exe"
+$ctrlFormat = Get-FormatBytes "CONTROL.axf"
+Write-Host "`nFORMATTING CODE (fmt.c / printf family):" -ForegroundColor Green
+Write-Host "   HMI:     $($hmiFormat[0]) / $($hmiFormat[1]) bytes" -ForegroundColor White
+Write-Host "   CONTROL: $($ctrlFormat[0]) / $($ctrlFormat[1]) bytes" -ForegroundColor White
+$printfLinked = ($hmiFormat[2] -ne 0 -or $ctrlFormat[2] -ne 0)
+if ($printfLinked) {
+    Write-Host "   ❌ printf family is linked - see fmt.h" -ForegroundColor Red
+}
+
+# Stack: the linker's worst case (stack.suc) against pui32Stack (stack.h),
+# from the map file's STACK USAGE section
+function Get-StackBytes($map) {
+    $task = 0
+    $irq = 0
+    if (Test-Path $map) {
+        Get-Content $map | ForEach-Object {
+            if ($_ -match '^\s*Program entry\s+(\d+)') { $task = [int]$Matches[1] }
+            elseif ($_ -match '^\s*interrupt\s+(\d+)') { $irq = [int]$Matches[1] }
+        }
+    }
+    return @($task, $irq, ($task + $irq + 104))
+}
+$stackSize = 1536
+Set-Location "D:\University\7th Semester Senior 1\Introduction to Enbedded Systems\Project\adeem\HMI\Debug\List"
+$hmiStack = Get-StackBytes "HMI.map"
+Set-Location "D:\University\7th Semester Senior 1\Introduction to Enbedded Systems\Project\adeem\CONTROL\Debug\List"
+$ctrlStack = Get-StackBytes "CONTROL.map"
+Write-Host "`nSTACK (task + interrupt + 104 = worst case, of $stackSize bytes):" -ForegroundColor Green
+Write-Host "   HMI:     $($hmiStack[0]) + $($hmiStack[1]) + 104 = $($hmiStack[2])" -ForegroundColor White
+Write-Host "   CONTROL: $($ctrlStack[0]) + $($ctrlStack[1]) + 104 = $($ctrlStack[2])" -ForegroundColor White
+if ($hmiStack[2] -gt $stackSize -or $ctrlStack[2] -gt $stackSize) {
+    Write-Host "   ❌ worst case exceeds the stack - see stack.h" -ForegroundColor Red
+}
+
 # System Summary
 Write-Host "`n3. SYSTEM SUMMARY:" -ForegroundColor Cyan
 Write-Host "==================" -ForegroundColor Cyan
@@ -111,6 +165,14 @@ CONTROL RAM:   $ctrlRam bytes ($([math]::Round($ctrlRam/32768*100,2))% of 32KB)
 Average Flash per TM4C: $([math]::Round($totalFlash/2)) bytes
 Average RAM per TM4C:   $([math]::Round($totalRam/2)) bytes
 
+=== FORMATTING CODE (fmt.c / printf family, bytes) ===
+HMI:     $($hmiFormat[0]) / $($hmiFormat[1])
+CONTROL: $($ctrlFormat[0]) / $($ctrlFormat[1])
+
+=== STACK (linker analysis; task / interrupt / worst case of $stackSize bytes) ===
+HMI:     $($hmiStack[0]) / $($hmiStack[1]) / $($hmiStack[2])
+CONTROL: $($ctrlStack[0]) / $($ctrlStack[1]) / $($ctrlStack[2])
+
 === UART BUFFER ANALYSIS ===
 From HMI.c:
   • Password buffers: ~18 bytes (pass[6], Confirmpass[6], new_pass[6])
@@ -138,4 +200,9 @@ Total UART buffers in system: ~148 bytes
 "@ | Out-File $comparisonReport -Encoding UTF8
 
 Write-Host "`nComparison report saved to: $comparisonReport" -ForegroundColor Green
-notepad $comparisonReport
\ No newline at end of file
+notepad $comparisonReport
+
+if ($printfLinked) {
+    Write-Host "FAILED: the printf family is linked - see fmt.h" -ForegroundColor Red
+    exit 1
+}
\ No newline at end of file